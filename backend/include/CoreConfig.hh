@@ -35,6 +35,11 @@ public:
   static const std::string CFG_KEY_TIMER_MONITOR;
   static const std::string CFG_KEY_TIMER_ACTIVITY_SENSITIVE;
 
+  static const std::string CFG_KEY_USER_TIMERS;
+  static const std::string CFG_KEY_USER_TIMER_NAMES;
+  static const std::string CFG_KEY_USER_TIMER_LIMIT;
+  static const std::string CFG_KEY_USER_TIMER_AUTO_RESET;
+
   static const std::string CFG_KEY_BREAKS;
   static const std::string CFG_KEY_BREAK;
   static const std::string CFG_KEY_BREAK_MAX_PRELUDES;
@@ -47,6 +52,7 @@ public:
   static const std::string CFG_KEY_GENERAL_DATADIR;
   static const std::string CFG_KEY_OPERATION_MODE;
   static const std::string CFG_KEY_USAGE_MODE;
+  static const std::string CFG_KEY_STATISTICS_RETENTION;
 
   static const std::string CFG_KEY_DISTRIBUTION;
   static const std::string CFG_KEY_DISTRIBUTION_ENABLED;
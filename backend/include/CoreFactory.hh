@@ -27,6 +27,7 @@ namespace workrave
   class IConfigurator;
   class INetwork;
   class DBus;
+  class ICoreHost;
 
   //! Main access points to the Core.
   class CoreFactory
@@ -40,6 +41,23 @@ namespace workrave
 
     //! Returns the interface to the DBUS facility.
     static DBus *get_dbus();
+
+    //! Runs the core on a dedicated thread.
+    /*!
+     *  Must be called before the core is initialized. The core and
+     *  configurator returned afterwards may only be used from the GUI
+     *  thread.
+     */
+    static void enable_core_thread();
+
+    //! Stops the core thread, if it is running.
+    static void stop_core_thread();
+
+    //! Returns the host that runs the cores of many sessions.
+    /*!
+     *  A program either uses the host, or get_core(), not both.
+     */
+    static ICoreHost *get_core_host();
   };
 }
 
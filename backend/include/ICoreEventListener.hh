@@ -20,6 +20,8 @@
 #ifndef ICOREEVENTLISTENER_HH
 #define ICOREEVENTLISTENER_HH
 
+#include <string>
+
 #include "ICore.hh"
 
 namespace workrave
@@ -54,6 +56,9 @@ namespace workrave
 
     // Notification that the usage mode has changed..
     virtual void core_event_usage_mode_changed(const UsageMode m) = 0;
+
+    // Notification that a user defined timer reached its limit.
+    virtual void core_event_user_timer_limit_reached(const std::string &name) = 0;
   };
 }
 
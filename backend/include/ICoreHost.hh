@@ -0,0 +1,78 @@
+// ICoreHost.hh --- Runs the cores of many user sessions in one process
+//
+// Copyright (C) 2017 Rob Caelers <robc@krandor.nl>
+// All rights reserved.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef ICOREHOST_HH
+#define ICOREHOST_HH
+
+#include <list>
+#include <string>
+
+#include "ICore.hh"
+
+namespace workrave
+{
+  //! Runs the cores of many user sessions in one process.
+  /*!
+   *  Each session has its own core, configuration, statistics and home
+   *  directory. The host drives all sessions from a single heartbeat and
+   *  passes the input reported for a session to the core of that session.
+   *
+   *  A process either uses the host or CoreFactory::get_core(), not both.
+   */
+  class ICoreHost
+  {
+  public:
+    virtual ~ICoreHost() {}
+
+    //! Initializes the host and registers it on the D-BUS. Must be called first.
+    virtual void init(int argc, char **argv) = 0;
+
+    //! Saves and removes all sessions.
+    virtual void shutdown() = 0;
+
+    //! Periodic heartbeat of all sessions. Must be called every second.
+    virtual void heartbeat() = 0;
+
+    //! Starts a session with the specified home directory. The session belongs to the owner of the directory.
+    virtual bool add_session(const std::string &name, const std::string &home) = 0;
+
+    //! Saves and stops a session.
+    virtual bool remove_session(const std::string &name) = 0;
+
+    //! Returns the names of all sessions.
+    virtual std::list<std::string> get_sessions() const = 0;
+
+    //! Reports generic activity in a session.
+    virtual bool report_activity(const std::string &session) = 0;
+
+    //! Reports mouse movement in a session.
+    virtual bool report_mouse(const std::string &session, int x, int y) = 0;
+
+    //! Reports a mouse button in a session.
+    virtual bool report_button(const std::string &session, bool is_press) = 0;
+
+    //! Reports a key press in a session.
+    virtual bool report_keyboard(const std::string &session) = 0;
+
+    //! Returns the stage of a break in a session, as reported over the D-BUS by the core.
+    virtual std::string get_break_stage(const std::string &session, BreakId id) = 0;
+  };
+}
+
+#endif // ICOREHOST_HH
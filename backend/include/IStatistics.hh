@@ -28,6 +28,10 @@ typedef __int64 int64_t;
 #include <stdint.h>
 #endif
 
+#include <map>
+#include <string>
+#include <vector>
+
 #include "ICore.hh"
 
 namespace workrave {
@@ -58,8 +62,31 @@ namespace workrave {
         STATS_VALUE_SIZEOF
       };
 
+    enum StatsSeriesType
+      {
+        STATS_SERIES_ACTIVE_TIME = 0,
+        STATS_SERIES_KEYSTROKES,
+        STATS_SERIES_CLICKS,
+        STATS_SERIES_MOUSE_MOVEMENT,
+        STATS_SERIES_SIZEOF
+      };
+
+    //! Number of minutes in the series of a day: two days, as a day lasts until the daily reset.
+    static const int STATS_SERIES_MINUTES = 48 * 60;
+
+    enum AggregateType
+      {
+        AGGREGATE_SUM = 0,
+        AGGREGATE_AVERAGE,
+        AGGREGATE_MAX
+      };
+
+    //! Weekday mask containing all days. Bit n is day n of the week, 0 = Sunday.
+    static const int WEEKDAY_ALL = 0x7f;
+
     typedef int BreakStats[STATS_BREAKVALUE_SIZEOF];
     typedef int64_t MiscStats[STATS_VALUE_SIZEOF];
+    typedef std::map<std::string, int> UserTimerStats;
 
     struct DailyStats
     {
@@ -74,6 +101,9 @@ namespace workrave {
 
       //! Misc statistics
       MiscStats misc_stats;
+
+      //! Number of times each user defined timer reached its limit.
+      UserTimerStats user_timer_stats;
     };
 
   public:
@@ -81,11 +111,56 @@ namespace workrave {
 
     virtual bool delete_all_history() = 0;
     virtual void update() = 0;
-    virtual DailyStats *get_current_day() const = 0;
-    virtual DailyStats *get_day(int day) const = 0;
+
+    //! Copies the statistics of the current day.
+    /*!
+     *  The statistics are copied, as the core replaces and frees days.
+     *  \return false if there is no current day.
+     */
+    virtual bool get_current_day(DailyStats &stats) const = 0;
+
+    //! Copies the statistics of a day.
+    /*!
+     *  \return false if the day does not exist.
+     */
+    virtual bool get_day(int day, DailyStats &stats) const = 0;
+
     virtual void get_day_index_by_date(int y, int m, int d, int &idx, int &next, int &prev) const = 0;
     virtual int get_history_size() const = 0;
     virtual void dump() = 0;
+
+    //! Aggregates a value over all days from first to last (inclusive).
+    /*!
+     *  Only the year, month and day of first and last are used. The
+     *  average is taken over the days for which statistics exist.
+     *  \param weekdays only days in this weekday mask are included.
+     */
+    virtual int64_t get_value_aggregate(StatsValueType value, AggregateType type,
+                                        const struct tm &first, const struct tm &last,
+                                        int weekdays = WEEKDAY_ALL) const = 0;
+
+    //! Aggregates a break value over all days from first to last (inclusive).
+    virtual int64_t get_break_value_aggregate(BreakId break_id, StatsBreakValueType value,
+                                              AggregateType type,
+                                              const struct tm &first, const struct tm &last,
+                                              int weekdays = WEEKDAY_ALL) const = 0;
+
+    //! Returns the number of days with statistics from first to last (inclusive).
+    virtual int get_day_count(const struct tm &first, const struct tm &last,
+                              int weekdays = WEEKDAY_ALL) const = 0;
+
+    //! Returns the per-minute values of a series of a day.
+    /*!
+     *  Minutes count from local midnight of the date on which the day
+     *  started, and may exceed 24 hours.
+     *  \param date only the year, month and day are used.
+     *  \param first first minute.
+     *  \param last last minute (inclusive).
+     *  \param values one value per minute from first to last.
+     *  \return false if there is no series for the date.
+     */
+    virtual bool get_series(StatsSeriesType series, const struct tm &date,
+                            int first, int last, std::vector<int> &values) const = 0;
   };
 }
 
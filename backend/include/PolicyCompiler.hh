@@ -0,0 +1,62 @@
+// PolicyCompiler.hh --- Compiles a configuration policy
+//
+// Copyright (C) 2017 Rob Caelers <robc@krandor.nl>
+// All rights reserved.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef POLICYCOMPILER_HH
+#define POLICYCOMPILER_HH
+
+#include <string>
+
+namespace workrave
+{
+  //! Compiles a configuration policy from an ini file.
+  /*!
+   *  The ini file uses the groups and keys of workrave.ini. Values
+   *  become the defaults of all users. The optional [policy] group locks
+   *  keys, so that users cannot change them:
+   *
+   *    [timers]
+   *    micro_pause.limit=300
+   *
+   *    [policy]
+   *    locked=timers/micro_pause/limit;general/
+   *
+   *  A locked key that ends with a slash locks all keys below it.
+   */
+  class PolicyCompiler
+  {
+  public:
+    //! Compiles the policy.
+    /*!
+     *  \param error receives a description of the error, if any.
+     */
+    static bool compile(const std::string &source, const std::string &target, std::string &error);
+
+    //! Handles --compile-policy on the command line.
+    /*!
+     *  Compiles the specified ini file to the system policy file, or to
+     *  the file specified with --policy-output.
+     *
+     *  \return true if the option was present; the program should then
+     *          exit with exit_code instead of starting.
+     */
+    static bool run_command_line(int argc, char **argv, int &exit_code);
+  };
+}
+
+#endif // POLICYCOMPILER_HH
@@ -0,0 +1,109 @@
+// StatisticsExporter.hh --- Exports statistics as CSV or JSON
+//
+// Copyright (C) 2017 Rob Caelers <robc@krandor.nl>
+// All rights reserved.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef STATISTICSEXPORTER_HH
+#define STATISTICSEXPORTER_HH
+
+#include <istream>
+#include <ostream>
+#include <string>
+
+#include "IStatistics.hh"
+
+namespace workrave
+{
+  //! Exports statistics as CSV or JSON.
+  /*!
+   *  Days are written as soon as they are read, so the memory use does
+   *  not depend on the size of the history. CSV has one row per day with
+   *  fixed columns; user timers are only included in JSON.
+   */
+  class StatisticsExporter
+  {
+  public:
+    enum Format
+      {
+        FORMAT_CSV,
+        FORMAT_JSON
+      };
+
+    StatisticsExporter(std::ostream &out, Format format);
+
+    //! Limits the export to the days between from and to (YYYY-MM-DD).
+    /*!
+     *  An empty string leaves that end of the range open.
+     *  \return false if a date cannot be parsed.
+     */
+    bool set_range(const std::string &from, const std::string &to);
+
+    //! Writes the header.
+    void begin();
+
+    //! Writes a day, if it is within the range.
+    void write_day(const IStatistics::DailyStats &stats);
+
+    //! Writes all days of a historystats or todaystats file.
+    /*!
+     *  \return false if the stream is not a statistics file.
+     */
+    bool write_file(std::istream &in);
+
+    //! Writes the trailer.
+    void end();
+
+    //! Returns the number of days written.
+    int get_day_count() const;
+
+    //! Converts "csv" or "json" to a format.
+    static bool parse_format(const std::string &name, Format &format);
+
+    //! Handles --export-statistics on the command line.
+    /*!
+     *  Writes the statistics in the home directory to standard output.
+     *
+     *  \return true if the option was present; the program should then
+     *          exit with exit_code instead of starting.
+     */
+    static bool run_command_line(int argc, char **argv, int &exit_code);
+
+  private:
+    void write_csv(const IStatistics::DailyStats &stats);
+    void write_json(const IStatistics::DailyStats &stats);
+
+    static bool parse_date(const std::string &date, int &day);
+
+  private:
+    //! Output stream.
+    std::ostream &out;
+
+    //! Output format.
+    Format format;
+
+    //! First day (inclusive) to export.
+    int first_day;
+
+    //! Last day (inclusive) to export.
+    int last_day;
+
+    //! Number of days written.
+    int day_count;
+  };
+}
+
+#endif // STATISTICSEXPORTER_HH
@@ -45,14 +45,22 @@
 
 #include "IInputMonitor.hh"
 #include "InputMonitorFactory.hh"
+#include "Metrics.hh"
 
 using namespace std;
 
 //! Constructor.
 ActivityMonitor::ActivityMonitor() :
   activity_state(ACTIVITY_IDLE),
+  published_seq(0),
+  published_state(ACTIVITY_IDLE),
+  published_last_action_sec_hi(0),
+  published_last_action_sec_lo(0),
+  published_last_action_usec(0),
+  published_idle_threshold(0),
   prev_x(-10),
   prev_y(-10),
+  latency_countdown(1),
   button_is_pressed(false),
   listener(NULL)
 {
@@ -73,6 +81,8 @@ ActivityMonitor::ActivityMonitor() :
   idle_threshold.tv_sec = 5;
   idle_threshold.tv_usec = 0;
 
+  publish();
+
   input_monitor = InputMonitorFactory::get_monitor(IInputMonitorFactory::CAPABILITY_ACTIVITY);
   if (input_monitor != NULL)
     {
@@ -116,6 +126,7 @@ ActivityMonitor::suspend()
   TRACE_ENTER_MSG("ActivityMonitor::suspend", activity_state);
   lock.lock();
   activity_state = ACTIVITY_SUSPENDED;
+  publish();
   lock.unlock();
   TRACE_RETURN(activity_state);
 }
@@ -128,6 +139,7 @@ ActivityMonitor::resume()
   TRACE_ENTER_MSG("ActivityMonitor::resume", activity_state);
   lock.lock();
   activity_state = ACTIVITY_IDLE;
+  publish();
   lock.unlock();
   TRACE_RETURN(activity_state);
 }
@@ -144,6 +156,7 @@ ActivityMonitor::force_idle()
       activity_state = ACTIVITY_IDLE;
       last_action_time.tv_sec = 0;
       last_action_time.tv_usec = 0;
+      publish();
     }
   lock.unlock();
   TRACE_RETURN(activity_state);
@@ -151,33 +164,64 @@ ActivityMonitor::force_idle()
 
 
 //! Returns the current state
+/*!
+ *  Does not lock. Reads the published state, and retries if an update
+ *  was in progress.
+ */
 ActivityState
 ActivityMonitor::get_current_state()
 {
-  TRACE_ENTER_MSG("ActivityMonitor::get_current_state", activity_state);
-  lock.lock();
+  gint seq;
+  ActivityState state;
+  gint64 last_action;
+  gint64 idle;
 
-  // First update the state...
-  if (activity_state == ACTIVITY_ACTIVE)
+  do
     {
-      GTimeVal now, tv;
+      seq = g_atomic_int_get(&published_seq);
+      state = (ActivityState) g_atomic_int_get(&published_state);
+      last_action = (((gint64) g_atomic_int_get(&published_last_action_sec_hi) << 32)
+                     | (guint32) g_atomic_int_get(&published_last_action_sec_lo)) * G_USEC_PER_SEC
+        + g_atomic_int_get(&published_last_action_usec);
+      idle = (gint64) g_atomic_int_get(&published_idle_threshold) * 1000;
+    }
+  while ((seq & 1) != 0 || seq != g_atomic_int_get(&published_seq));
 
-      g_get_current_time(&now);
-      tvSUBTIME(tv, now, last_action_time);
+  TRACE_ENTER_MSG("ActivityMonitor::get_current_state", state);
 
-      TRACE_MSG("Active: "
-                << tv.tv_sec << "." << tv.tv_usec << " "
-                << idle_threshold.tv_sec << " " << idle_threshold.tv_usec);
-      if (tvTIMEGT(tv, idle_threshold))
+  if (state == ACTIVITY_ACTIVE)
+    {
+      // No longer active after the idle threshold. The writers apply the
+      // same rule when the next action arrives.
+      gint64 now = g_get_real_time();
+      if (now - last_action > idle)
         {
-          // No longer active.
-          activity_state = ACTIVITY_IDLE;
+          state = ACTIVITY_IDLE;
         }
     }
 
-  lock.unlock();
-  TRACE_RETURN(activity_state);
-  return activity_state;
+  TRACE_RETURN(state);
+  return state;
+}
+
+
+//! Publishes the state to get_current_state(). Must be called with the lock held.
+void
+ActivityMonitor::publish()
+{
+  // All atomic operations are full memory barriers, so readers that see an
+  // even sequence number twice also see consistent fields in between.
+  g_atomic_int_inc(&published_seq);
+
+  g_atomic_int_set(&published_state, activity_state);
+  gint64 sec = last_action_time.tv_sec;
+  g_atomic_int_set(&published_last_action_sec_hi, (gint) (sec >> 32));
+  g_atomic_int_set(&published_last_action_sec_lo, (gint) (guint32) sec);
+  g_atomic_int_set(&published_last_action_usec, (gint) last_action_time.tv_usec);
+  g_atomic_int_set(&published_idle_threshold,
+                   (gint) (idle_threshold.tv_sec * 1000 + idle_threshold.tv_usec / 1000));
+
+  g_atomic_int_inc(&published_seq);
 }
 
 
@@ -186,6 +230,8 @@ ActivityMonitor::get_current_state()
 void
 ActivityMonitor::set_parameters(int noise, int activity, int idle)
 {
+  lock.lock();
+
   noise_threshold.tv_sec = noise / 1000;
   noise_threshold.tv_usec = (noise % 1000) * 1000;
 
@@ -197,6 +243,14 @@ ActivityMonitor::set_parameters(int noise, int activity, int idle)
 
   // The easy way out.
   activity_state = ACTIVITY_IDLE;
+  publish();
+
+  lock.unlock();
+
+  if (input_monitor != NULL)
+    {
+      input_monitor->set_idle_threshold(idle);
+    }
 }
 
 
@@ -227,6 +281,7 @@ ActivityMonitor::shift_time(int delta)
   if (!tvTIMEEQ0(first_action_time))
     tvADDTIME(first_action_time, first_action_time, d);
 
+  publish();
   lock.unlock();
 }
 
@@ -245,11 +300,46 @@ ActivityMonitor::set_listener(ActivityMonitorListener *l)
 void
 ActivityMonitor::action_notify()
 {
+  Metrics::get_instance()->increment(Metrics::COUNTER_INPUT_ACTION);
+  process_action();
+}
+
+
+//! Updates the activity state for an input event.
+/*!
+ *  The caller counts the event in the metrics. Only the latency of one in
+ *  LATENCY_SAMPLES events is recorded, so that the lock of the metrics is
+ *  rarely taken on this path.
+ */
+void
+ActivityMonitor::process_action()
+{
+  static const int LATENCY_SAMPLES = 64;
+
+  bool sampled = g_atomic_int_dec_and_test(&latency_countdown);
+  if (sampled)
+    {
+      g_atomic_int_set(&latency_countdown, LATENCY_SAMPLES);
+    }
+  gint64 start = sampled ? g_get_monotonic_time() : 0;
+
   lock.lock();
 
   GTimeVal now;
   g_get_current_time(&now);
 
+  if (activity_state == ACTIVITY_ACTIVE)
+    {
+      GTimeVal tv;
+
+      tvSUBTIME(tv, now, last_action_time);
+      if (tvTIMEGT(tv, idle_threshold))
+        {
+          // No longer active. Readers do not update the state.
+          activity_state = ACTIVITY_IDLE;
+        }
+    }
+
   switch (activity_state)
     {
     case ACTIVITY_IDLE:
@@ -293,8 +383,14 @@ ActivityMonitor::action_notify()
     }
 
   last_action_time = now;
+  publish();
   lock.unlock();
   call_listener();
+
+  if (sampled)
+    {
+      Metrics::get_instance()->add_latency(Metrics::LATENCY_INPUT_CALLBACK, g_get_monotonic_time() - start);
+    }
 }
 
 
@@ -304,6 +400,8 @@ ActivityMonitor::mouse_notify(int x, int y, int wheel_delta)
 {
   static const int sensitivity = 3;
 
+  Metrics::get_instance()->increment(Metrics::COUNTER_INPUT_MOUSE);
+
   lock.lock();
   const int delta_x = x - prev_x;
   const int delta_y = y - prev_y;
@@ -313,7 +411,7 @@ ActivityMonitor::mouse_notify(int x, int y, int wheel_delta)
   if (abs(delta_x) >= sensitivity || abs(delta_y) >= sensitivity
       || wheel_delta != 0 || button_is_pressed)
     {
-      action_notify();
+      process_action();
     }
   lock.unlock();
 }
@@ -323,13 +421,15 @@ ActivityMonitor::mouse_notify(int x, int y, int wheel_delta)
 void
 ActivityMonitor::button_notify(bool is_press)
 {
+  Metrics::get_instance()->increment(Metrics::COUNTER_INPUT_BUTTON);
+
   lock.lock();
 
   button_is_pressed = is_press;
 
   if (is_press)
     {
-      action_notify();
+      process_action();
     }
 
   lock.unlock();
@@ -342,8 +442,10 @@ ActivityMonitor::keyboard_notify(bool repeat)
 {
   (void)repeat;
 
+  Metrics::get_instance()->increment(Metrics::COUNTER_INPUT_KEYBOARD);
+
   lock.lock();
-  action_notify();
+  process_action();
   lock.unlock();
 }
 
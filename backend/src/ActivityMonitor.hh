@@ -38,6 +38,14 @@
 class ActivityListener;
 class IInputMonitor;
 
+//! Derives the activity state from the events of the input monitor.
+/*!
+ *  The input monitor and the core run on different threads. Events update
+ *  the state under the lock. The state, the time of the last action and the
+ *  idle threshold are then published with a sequence counter, so that
+ *  get_current_state() never takes the lock, and never blocks the input
+ *  thread.
+ */
 class ActivityMonitor :
   public IInputMonitorListener,
   public IActivityMonitor
@@ -65,18 +73,51 @@ public:
   void keyboard_notify(bool repeat);
 
 private:
+  void process_action();
   void call_listener();
+  void publish();
 
 private:
+#ifdef HAVE_TESTS
+  friend class Test;
+#endif
+
   //! The actual monitoring driver.
   IInputMonitor *input_monitor;
 
   //! the current state.
   ActivityState activity_state;
 
-  //! Internal locking
+  //! Internal locking. Serializes all updates of the state.
   Mutex lock;
 
+  //! Sequence number of the published state. Odd while an update is in progress.
+  /*!
+   *  All published fields are 32 bit and only accessed with the atomic
+   *  operations of glib, which are full memory barriers.
+   */
+  volatile gint published_seq;
+
+  //! Published activity state.
+  volatile gint published_state;
+
+  //! Published time of the last action, seconds part, high and low 32 bits.
+  /*!
+   *  time_t does not fit in 32 bits after 2038; the sequence number keeps
+   *  both halves consistent.
+   */
+  volatile gint published_last_action_sec_hi;
+  volatile gint published_last_action_sec_lo;
+
+  //! Published time of the last action, microseconds part.
+  volatile gint published_last_action_usec;
+
+  //! Published idle threshold, in ms.
+  volatile gint published_idle_threshold;
+
+  //! Number of input events until the latency of one is sampled.
+  volatile gint latency_countdown;
+
   //! Previous X coordinate
   int prev_x;
 
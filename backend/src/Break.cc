@@ -27,7 +27,8 @@
 
 #include "IConfigurator.hh"
 #include "ICore.hh"
-#include "CoreFactory.hh"
+#include "Core.hh"
+#include "Configurator.hh"
 
 #include "BreakControl.hh"
 #include "Timer.hh"
@@ -97,7 +98,7 @@ Break::init(BreakId id, IApp *app)
   TRACE_ENTER("Break::init");
 
   break_id = id;
-  config = CoreFactory::get_configurator();
+  config = Core::get_instance()->get_configurator();
   application = app;
 
   Defaults &def = default_config[break_id];
@@ -0,0 +1,255 @@
+// CompositeInputMonitor.cc --- Combines several input monitors
+//
+// Copyright (C) 2017 Rob Caelers <robc@krandor.nl>
+// All rights reserved.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "debug.hh"
+
+#include "CompositeInputMonitor.hh"
+#include "Metrics.hh"
+
+using namespace std;
+
+//! Events of different sources within this window are considered duplicates (µs).
+static const gint64 DEDUP_WINDOW = 50 * G_TIME_SPAN_MILLISECOND;
+
+
+CompositeInputMonitor::Source::Source(CompositeInputMonitor *composite, const string &name, IInputMonitor *monitor) :
+  composite(composite),
+  monitor(monitor)
+{
+  stats.name = name;
+  stats.received = 0;
+  stats.suppressed = 0;
+}
+
+
+CompositeInputMonitor::Source::~Source()
+{
+  delete monitor;
+}
+
+
+void
+CompositeInputMonitor::Source::action_notify()
+{
+  if (composite->accept(this, EVENT_ACTION))
+    {
+      composite->fire_action();
+    }
+}
+
+
+void
+CompositeInputMonitor::Source::mouse_notify(int x, int y, int wheel)
+{
+  if (composite->accept(this, EVENT_MOUSE))
+    {
+      composite->fire_mouse(x, y, wheel);
+    }
+}
+
+
+void
+CompositeInputMonitor::Source::button_notify(bool is_press)
+{
+  if (composite->accept(this, EVENT_BUTTON))
+    {
+      composite->fire_button(is_press);
+    }
+}
+
+
+void
+CompositeInputMonitor::Source::keyboard_notify(bool repeat)
+{
+  if (composite->accept(this, EVENT_KEYBOARD))
+    {
+      composite->fire_keyboard(repeat);
+    }
+}
+
+
+CompositeInputMonitor::CompositeInputMonitor()
+{
+  for (int i = 0; i < EVENT_SIZEOF; i++)
+    {
+      last_source[i] = NULL;
+      last_time[i] = 0;
+    }
+}
+
+
+CompositeInputMonitor::~CompositeInputMonitor()
+{
+  Metrics::get_instance()->remove_provider(this);
+
+  for (vector<Source *>::iterator i = sources.begin(); i != sources.end(); i++)
+    {
+      delete *i;
+    }
+}
+
+
+void
+CompositeInputMonitor::add_source(const string &name, IInputMonitor *monitor)
+{
+  sources.push_back(new Source(this, name, monitor));
+}
+
+
+bool
+CompositeInputMonitor::init()
+{
+  TRACE_ENTER("CompositeInputMonitor::init");
+
+  vector<Source *>::iterator i = sources.begin();
+  while (i != sources.end())
+    {
+      Source *source = *i;
+
+      source->monitor->set_idle_threshold(get_idle_threshold());
+      if (source->monitor->init())
+        {
+          TRACE_MSG("Using " << source->stats.name);
+          source->monitor->subscribe_activity(source);
+          i++;
+        }
+      else
+        {
+          TRACE_MSG("Failed " << source->stats.name);
+          delete source;
+          i = sources.erase(i);
+        }
+    }
+
+  bool ret = !sources.empty();
+  if (ret)
+    {
+      Metrics::get_instance()->add_provider(this);
+    }
+
+  TRACE_RETURN(ret);
+  return ret;
+}
+
+
+void
+CompositeInputMonitor::terminate()
+{
+  TRACE_ENTER("CompositeInputMonitor::terminate");
+
+  Metrics::get_instance()->remove_provider(this);
+
+  for (vector<Source *>::iterator i = sources.begin(); i != sources.end(); i++)
+    {
+      Source *source = *i;
+      source->monitor->terminate();
+      source->monitor->unsubscribe_activity(source);
+
+      TRACE_MSG(source->stats.name << " received " << source->stats.received
+                << " suppressed " << source->stats.suppressed);
+    }
+
+  TRACE_EXIT();
+}
+
+
+void
+CompositeInputMonitor::set_idle_threshold(int idle)
+{
+  InputMonitor::set_idle_threshold(idle);
+
+  for (vector<Source *>::iterator i = sources.begin(); i != sources.end(); i++)
+    {
+      (*i)->monitor->set_idle_threshold(idle);
+    }
+}
+
+
+//! Writes the event counters of all sources.
+/*!
+ *  Sources: input_source <name> <received> <suppressed>
+ */
+void
+CompositeInputMonitor::get_metrics(ostream &out)
+{
+  lock.lock();
+  for (vector<Source *>::iterator i = sources.begin(); i != sources.end(); i++)
+    {
+      const SourceStats &stats = (*i)->stats;
+      out << "input_source " << stats.name << " " << stats.received << " " << stats.suppressed << endl;
+    }
+  lock.unlock();
+}
+
+
+//! Determines if an event from the specified source must be passed on.
+/*!
+ *  An event is a duplicate if a different source reported the same kind of
+ *  event less than DEDUP_WINDOW ago. Actions carry no information besides
+ *  'the user is active', so they are dropped if any event was passed on
+ *  recently.
+ */
+bool
+CompositeInputMonitor::accept(Source *source, EventKind kind)
+{
+  return accept(source, kind, g_get_monotonic_time());
+}
+
+
+//! Determines if an event from the specified source, that arrived at the specified time, must be passed on.
+bool
+CompositeInputMonitor::accept(Source *source, EventKind kind, gint64 now)
+{
+  bool ret = true;
+
+  lock.lock();
+
+  source->stats.received++;
+
+  if (kind == EVENT_ACTION)
+    {
+      for (int i = 0; ret && i < EVENT_SIZEOF; i++)
+        {
+          ret = last_source[i] == NULL || now - last_time[i] >= DEDUP_WINDOW;
+        }
+    }
+  else
+    {
+      ret = last_source[kind] == NULL || last_source[kind] == source || now - last_time[kind] >= DEDUP_WINDOW;
+    }
+
+  if (ret)
+    {
+      last_source[kind] = source;
+      last_time[kind] = now;
+    }
+  else
+    {
+      source->stats.suppressed++;
+    }
+
+  lock.unlock();
+
+  return ret;
+}
@@ -0,0 +1,130 @@
+// CompositeInputMonitor.hh --- Combines several input monitors
+//
+// Copyright (C) 2017 Rob Caelers <robc@krandor.nl>
+// All rights reserved.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#ifndef COMPOSITEINPUTMONITOR_HH
+#define COMPOSITEINPUTMONITOR_HH
+
+#include <string>
+#include <vector>
+
+#include <glib.h>
+
+#include "InputMonitor.hh"
+#include "IInputMonitorListener.hh"
+#include "IMetricsProvider.hh"
+#include "Mutex.hh"
+
+//! Input monitor that merges the events of several input monitors.
+/*!
+ *  All sources run simultaneously. An event is suppressed when another
+ *  source reported the same kind of event within the deduplication
+ *  window, so that a keystroke seen by two backends is only counted once.
+ *
+ *  The window compares arrival times: the backends do not report event
+ *  times, and would not share a clock if they did. The same event that
+ *  arrives from a second backend more than the window later is therefore
+ *  counted twice, and different events of different sources within the
+ *  window are counted once. The activity state only needs one event per
+ *  activity period, so this only affects the input statistics, by at most
+ *  one event per window. backend/test/test_composite_input.py checks
+ *  these limits.
+ *
+ *  The event counters of each source are reported in the metrics.
+ */
+class CompositeInputMonitor :
+  public InputMonitor,
+  public IMetricsProvider
+{
+public:
+  //! Per source event counters.
+  struct SourceStats
+  {
+    std::string name;
+    int received;
+    int suppressed;
+  };
+
+  CompositeInputMonitor();
+  virtual ~CompositeInputMonitor();
+
+  //! Adds a source. The composite takes ownership of the monitor.
+  void add_source(const std::string &name, IInputMonitor *monitor);
+
+  //! Initializes all sources. Succeeds if at least one source works.
+  virtual bool init();
+
+  //! Terminates all sources.
+  virtual void terminate();
+
+  virtual void set_idle_threshold(int idle);
+
+  //! Writes the event counters of all sources.
+  virtual void get_metrics(std::ostream &out);
+
+private:
+  enum EventKind
+    {
+      EVENT_ACTION,
+      EVENT_MOUSE,
+      EVENT_BUTTON,
+      EVENT_KEYBOARD,
+      EVENT_SIZEOF
+    };
+
+  //! Receives the events of a single source.
+  class Source : public IInputMonitorListener
+  {
+  public:
+    Source(CompositeInputMonitor *composite, const std::string &name, IInputMonitor *monitor);
+    virtual ~Source();
+
+    virtual void action_notify();
+    virtual void mouse_notify(int x, int y, int wheel = 0);
+    virtual void button_notify(bool is_press);
+    virtual void keyboard_notify(bool repeat);
+
+    CompositeInputMonitor *composite;
+    IInputMonitor *monitor;
+    SourceStats stats;
+  };
+
+  //! Determines if an event from the specified source must be passed on.
+  bool accept(Source *source, EventKind kind);
+  bool accept(Source *source, EventKind kind, gint64 now);
+
+private:
+#ifdef HAVE_TESTS
+  friend class Test;
+#endif
+
+  //! All sources.
+  std::vector<Source *> sources;
+
+  //! Source of the last accepted event per kind.
+  Source *last_source[EVENT_SIZEOF];
+
+  //! Time of the last accepted event per kind.
+  gint64 last_time[EVENT_SIZEOF];
+
+  //! Internal locking
+  Mutex lock;
+};
+
+#endif // COMPOSITEINPUTMONITOR_HH
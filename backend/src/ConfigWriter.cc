@@ -0,0 +1,181 @@
+// ConfigWriter.cc --- Writes configuration files on a worker thread
+//
+// Copyright (C) 2017 Rob Caelers <robc@krandor.nl>
+// All rights reserved.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "debug.hh"
+
+#include "ConfigWriter.hh"
+#include "Metrics.hh"
+
+using namespace std;
+
+ConfigWriter::ConfigWriter() :
+  thread(NULL),
+  pending(false),
+  busy(false),
+  last_ok(true),
+  failed(false),
+  abort(false)
+{
+  mutex = g_mutex_new();
+  cond = g_cond_new();
+}
+
+
+//! Writes the last snapshot, and stops the thread.
+ConfigWriter::~ConfigWriter()
+{
+  TRACE_ENTER("ConfigWriter::~ConfigWriter");
+  if (thread != NULL)
+    {
+      g_mutex_lock(mutex);
+      abort = true;
+      g_cond_broadcast(cond);
+      g_mutex_unlock(mutex);
+
+      thread->wait();
+      delete thread;
+    }
+
+  g_mutex_free(mutex);
+  g_cond_free(cond);
+  TRACE_EXIT();
+}
+
+
+void
+ConfigWriter::write(const string &filename, const string &data)
+{
+  TRACE_ENTER_MSG("ConfigWriter::write", filename);
+
+  g_mutex_lock(mutex);
+  if (pending)
+    {
+      // Replaces a snapshot that was not written yet.
+      Metrics::get_instance()->increment(Metrics::COUNTER_CONFIG_SAVE_COALESCED);
+    }
+
+  pending = true;
+  pending_filename = filename;
+  pending_data = data;
+
+  if (thread == NULL)
+    {
+      thread = new Thread(this);
+      thread->start();
+    }
+
+  g_cond_broadcast(cond);
+  g_mutex_unlock(mutex);
+
+  TRACE_EXIT();
+}
+
+
+bool
+ConfigWriter::flush()
+{
+  TRACE_ENTER("ConfigWriter::flush");
+
+  g_mutex_lock(mutex);
+  while (pending || busy)
+    {
+      g_cond_wait(cond, mutex);
+    }
+  bool ret = last_ok;
+  g_mutex_unlock(mutex);
+
+  TRACE_RETURN(ret);
+  return ret;
+}
+
+
+bool
+ConfigWriter::get_failure(string &error)
+{
+  g_mutex_lock(mutex);
+  bool ret = failed;
+  if (failed)
+    {
+      error = failure;
+      failed = false;
+    }
+  g_mutex_unlock(mutex);
+
+  return ret;
+}
+
+
+void
+ConfigWriter::run()
+{
+  TRACE_ENTER("ConfigWriter::run");
+
+  g_mutex_lock(mutex);
+  while (true)
+    {
+      while (!pending && !abort)
+        {
+          g_cond_wait(cond, mutex);
+        }
+
+      if (!pending)
+        {
+          break;
+        }
+
+      string filename;
+      string data;
+      filename.swap(pending_filename);
+      data.swap(pending_data);
+      pending = false;
+      busy = true;
+
+      g_mutex_unlock(mutex);
+
+      // Writes to a temporary file, and renames it.
+      GError *error = NULL;
+      gboolean ok = g_file_set_contents(filename.c_str(), data.data(), data.size(), &error);
+      Metrics::get_instance()->increment(ok ? Metrics::COUNTER_CONFIG_SAVE : Metrics::COUNTER_CONFIG_SAVE_FAILED);
+
+      g_mutex_lock(mutex);
+
+      busy = false;
+      last_ok = ok;
+      if (!ok)
+        {
+          failed = true;
+          failure = error != NULL ? error->message : filename;
+          TRACE_MSG("Failed to write " << filename << ": " << failure);
+        }
+
+      if (error != NULL)
+        {
+          g_error_free(error);
+        }
+
+      g_cond_broadcast(cond);
+    }
+  g_mutex_unlock(mutex);
+
+  TRACE_EXIT();
+}
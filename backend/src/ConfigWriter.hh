@@ -0,0 +1,88 @@
+// ConfigWriter.hh --- Writes configuration files on a worker thread
+//
+// Copyright (C) 2017 Rob Caelers <robc@krandor.nl>
+// All rights reserved.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef CONFIGWRITER_HH
+#define CONFIGWRITER_HH
+
+#include <string>
+
+#include <glib.h>
+
+#include "Runnable.hh"
+#include "Thread.hh"
+
+//! Writes configuration files on a worker thread.
+/*!
+ *  The caller passes a complete snapshot of the file. Only the latest
+ *  snapshot that was not yet written is kept, so a burst of changes
+ *  results in a single write. Files are replaced atomically: the new
+ *  contents are written to a temporary file that is renamed over the old
+ *  file.
+ *
+ *  A failed write is kept until it is collected with get_failure().
+ */
+class ConfigWriter : public Runnable
+{
+public:
+  ConfigWriter();
+  virtual ~ConfigWriter();
+
+  //! Queues a snapshot of a file.
+  void write(const std::string &filename, const std::string &data);
+
+  //! Waits until all queued snapshots are written. Returns false if the last write failed.
+  bool flush();
+
+  //! Returns (and clears) the last failure.
+  bool get_failure(std::string &error);
+
+  // Runnable
+  void run();
+
+private:
+  //! The writer thread, started on the first write.
+  Thread *thread;
+
+  GMutex *mutex;
+  GCond *cond;
+
+  //! Whether a snapshot is waiting to be written.
+  bool pending;
+
+  //! The snapshot waiting to be written.
+  std::string pending_filename;
+  std::string pending_data;
+
+  //! Whether a snapshot is being written.
+  bool busy;
+
+  //! Whether the last write succeeded.
+  bool last_ok;
+
+  //! Whether a failure was not yet collected.
+  bool failed;
+
+  //! Message of the last failure.
+  std::string failure;
+
+  //! Stop the thread.
+  bool abort;
+};
+
+#endif // CONFIGWRITER_HH
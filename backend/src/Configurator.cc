@@ -27,30 +27,44 @@
 
 #include "Configurator.hh"
 
+#include "ConfigWriter.hh"
 #include "IConfigBackend.hh"
 #include "ICore.hh"
-#include "CoreFactory.hh"
+#include "Core.hh"
 #include "IConfiguratorListener.hh"
+#include "Metrics.hh"
+#include "SystemPolicy.hh"
 
 using namespace std;
 using namespace workrave;
 
+//! Time to wait before retrying a failed save (in seconds).
+static const int AUTO_SAVE_RETRY = 60;
+
 
 // Constructs a new configurator.
 Configurator::Configurator(IConfigBackend *backend)
 {
   this->auto_save_time = 0;
   this->backend = backend;
+  this->writer = NULL;
+  this->policy = SystemPolicy::get_instance();
   if (dynamic_cast<IConfigBackendMonitoring *>(backend) != NULL)
     {
       dynamic_cast<IConfigBackendMonitoring *>(backend)->set_listener(this);
     }
+  if (dynamic_cast<IConfigBackendSnapshot *>(backend) != NULL)
+    {
+      writer = new ConfigWriter();
+    }
 }
 
 
 // Destructs the configurator.
 Configurator::~Configurator()
 {
+  // Writes the last snapshot.
+  delete writer;
   delete backend;
 }
 
@@ -66,26 +80,55 @@ bool
 Configurator::save(std::string filename)
 {
   TRACE_ENTER_MSG("Configurator::save", filename);
+  if (writer != NULL)
+    {
+      writer->flush();
+    }
   bool ret = backend->save(filename);
   TRACE_RETURN(ret);
   return ret;
 }
 
 
+//! Saves the configuration, and waits until it is written.
 bool
 Configurator::save()
 {
   TRACE_ENTER("Configurator::save");
-  bool ret = backend->save();
+  bool ret = save_async();
+  if (ret && writer != NULL)
+    {
+      ret = writer->flush();
+    }
   TRACE_RETURN(ret);
   return ret;
 }
 
 
+//! Saves the configuration on the writer thread, if the backend supports it.
+bool
+Configurator::save_async()
+{
+  string filename;
+  string data;
+
+  IConfigBackendSnapshot *snapshot = dynamic_cast<IConfigBackendSnapshot *>(backend);
+  if (writer != NULL && snapshot->get_snapshot(filename, data))
+    {
+      writer->write(filename, data);
+      return true;
+    }
+
+  return backend->save();
+}
+
+
 void
 Configurator::heartbeat()
 {
-  ICore *core = CoreFactory::get_core();
+  MetricsTimer timer(Metrics::LATENCY_CONFIGURATOR_HEARTBEAT);
+
+  ICore *core = Core::get_instance();
   time_t now = core->get_time();
 
   DelayedListIter it = delayed_config.begin();
@@ -110,7 +153,7 @@ Configurator::heartbeat()
 
                   if (auto_save_time == 0)
                     {
-                      ICore *core = CoreFactory::get_core();
+                      ICore *core = Core::get_instance();
                       auto_save_time = core->get_time() + 30;
                     }
                 }
@@ -124,9 +167,21 @@ Configurator::heartbeat()
 
   if (auto_save_time != 0 && now >= auto_save_time)
     {
-      save();
+      save_async();
       auto_save_time = 0;
     }
+
+  string error;
+  if (writer != NULL && writer->get_failure(error))
+    {
+      TRACE_ENTER_MSG("Configurator::heartbeat", "save failed: " << error);
+      if (auto_save_time == 0)
+        {
+          // Try again later.
+          auto_save_time = now + AUTO_SAVE_RETRY;
+        }
+      TRACE_EXIT();
+    }
 }
 
 
@@ -152,6 +207,15 @@ Configurator::set_delay(const std::string &key, int delay)
 bool
 Configurator::remove_key(const std::string &key) const
 {
+  string newkey = key;
+  strip_trailing_slash(newkey);
+  strip_leading_slash(newkey);
+
+  if (policy->is_locked(newkey))
+    {
+      return false;
+    }
+
   return backend->remove_key(key);
 }
 
@@ -203,6 +267,14 @@ Configurator::set_value(const std::string &key, Variant &value, ConfigFlags flag
       newkey = key;
       strip_trailing_slash(newkey);
       strip_leading_slash(newkey);
+
+      if (policy->is_locked(newkey))
+        {
+          // The policy value, or the built-in default, is used instead.
+          TRACE_MSG("Locked by policy");
+          TRACE_EXIT();
+          return (flags & CONFIG_FLAG_DEFAULT) != 0;
+        }
     }
 
   if (!skip && flags == CONFIG_FLAG_NONE)
@@ -212,7 +284,7 @@ Configurator::set_value(const std::string &key, Variant &value, ConfigFlags flag
         {
           if (setting.delay)
             {
-              ICore *core = CoreFactory::get_core();
+              ICore *core = Core::get_instance();
 
               DelayedConfig &d = delayed_config[key];
               d.key = (string)key;
@@ -239,7 +311,7 @@ Configurator::set_value(const std::string &key, Variant &value, ConfigFlags flag
 
               if (auto_save_time == 0)
                 {
-                  ICore *core = CoreFactory::get_core();
+                  ICore *core = Core::get_instance();
                   auto_save_time = core->get_time() + 30;
                 }
             }
@@ -263,17 +335,39 @@ Configurator::get_value(const std::string &key, VariantType type, Variant &out)
   strip_trailing_slash(newkey);
   strip_leading_slash(newkey);
 
-  DelayedListCIter it = delayed_config.find(newkey);
-  if (it != delayed_config.end())
+  bool locked = false;
+  Variant policy_value;
+  bool policy_found = policy->get_value(newkey, type, policy_value, locked);
+
+  if (locked)
     {
-      const DelayedConfig &delayed = it->second;
-      out = delayed.value;
-      ret = true;
+      // Ignores the user configuration.
+      if (policy_found)
+        {
+          out = policy_value;
+          ret = true;
+        }
     }
-
-  if (!ret)
+  else
     {
-      ret = backend->get_value(newkey, type, out);
+      DelayedListCIter it = delayed_config.find(newkey);
+      if (it != delayed_config.end())
+        {
+          const DelayedConfig &delayed = it->second;
+          out = delayed.value;
+          ret = true;
+        }
+
+      if (!ret)
+        {
+          ret = backend->get_value(newkey, type, out);
+        }
+
+      if (!ret && policy_found)
+        {
+          out = policy_value;
+          ret = true;
+        }
     }
 
   if (ret && type != VARIANT_TYPE_NONE && out.type != type)
@@ -41,6 +41,8 @@ namespace workrave {
 #include "Variant.hh"
 
 class IConfigBackend;
+class ConfigWriter;
+class SystemPolicy;
 
 class Configurator : public IConfigurator, public IConfiguratorListener
 {
@@ -117,6 +119,7 @@ private:
 
 private:
   bool find_setting(const string &name, Setting &setting) const;
+  bool save_async();
 
   bool set_value(const std::string &key, Variant &value, ConfigFlags flags = CONFIG_FLAG_NONE);
   bool get_value(const std::string &key, VariantType type, Variant &value) const;
@@ -140,6 +143,12 @@ private:
 
   //! Next auto save time.
   time_t auto_save_time;
+
+  //! Writes snapshots of the configuration off the heartbeat, NULL if the backend saves itself.
+  ConfigWriter *writer;
+
+  //! Policy of the administrator, which overrides the backend for locked keys.
+  SystemPolicy *policy;
 };
 
 
@@ -47,6 +47,9 @@
 #include "TimePred.hh"
 #include "TimeSource.hh"
 #include "InputMonitorFactory.hh"
+#include "MonotonicClock.hh"
+#include "Metrics.hh"
+#include "StringUtil.hh"
 
 #ifdef HAVE_DISTRIBUTION
 #include "DistributionManager.hh"
@@ -78,12 +81,20 @@ Core *Core::instance = NULL;
 const char *WORKRAVESTATE="WorkRaveState";
 const int SAVESTATETIME = 60;
 
+//! Wall-clock changes up to this number of seconds are ignored.
+const int CLOCK_CHANGE_TOLERANCE = 2;
+
+//! A gap between heartbeats of this number of seconds is considered a suspend.
+const int MAX_HEARTBEAT_GAP = 30;
+
 #define DBUS_PATH_WORKRAVE         "/org/workrave/Workrave/Core"
 #define DBUS_SERVICE_WORKRAVE      "org.workrave.Workrave"
 
 //! Constructs a new Core.
 Core::Core() :
   last_process_time(0),
+  last_monotonic_time(0),
+  last_boot_time(0),
   master_node(true),
   configurator(NULL),
   monitor(NULL),
@@ -150,10 +161,40 @@ Core::~Core()
 #endif
 #endif
 
+  if (instance == this)
+    {
+      instance = NULL;
+    }
+
   TRACE_EXIT();
 }
 
 
+//! Makes the specified core the current instance.
+/*!
+ *  A host of multiple sessions selects the core of a session before it
+ *  calls into it, so that code that uses get_instance() finds it.
+ */
+void
+Core::set_instance(Core *core)
+{
+  instance = core;
+}
+
+
+//! Runs this core as a session of a host.
+/*!
+ *  Must be called before init(). The session keeps its configuration in
+ *  the specified directory, does not register on the D-BUS, does not
+ *  network and only receives input that the host reports.
+ */
+void
+Core::set_session_home(const string &home)
+{
+  session_home = home;
+}
+
+
 /********************************************************************************/
 /**** Initialization                                                       ******/
 /********************************************************************************/
@@ -167,14 +208,22 @@ Core::init(int argc, char **argv, IApp *app, const string &display_name)
   this->argc = argc;
   this->argv = argv;
 
+  // Create the metrics before the input monitor threads start.
+  Metrics::get_instance();
+
   init_configurator();
   init_monitor(display_name);
 
 #ifdef HAVE_DISTRIBUTION
-  init_distribution_manager();
+  // Sessions of a host share the process and cannot network on their own.
+  if (session_home == "")
+    {
+      init_distribution_manager();
+    }
 #endif
 
   init_breaks();
+  init_user_timers();
   init_statistics();
   init_bus();
 
@@ -189,7 +238,16 @@ Core::init_configurator()
 {
   string ini_file = Util::complete_directory("workrave.ini", Util::SEARCH_PATH_CONFIG);
 
-  if (Util::file_exists(ini_file))
+  if (session_home != "")
+    {
+      // Sessions of a host share the process, and thus the native
+      // configuration backend. Each session keeps its own ini file.
+      ini_file = session_home + "/workrave.ini";
+      configurator = ConfiguratorFactory::create(ConfiguratorFactory::FormatIni);
+      configurator->load(ini_file);
+      configurator->save(ini_file);
+    }
+  else if (Util::file_exists(ini_file))
     {
       configurator = ConfiguratorFactory::create(ConfiguratorFactory::FormatIni);
       configurator->load(ini_file);
@@ -242,6 +300,14 @@ void
 Core::init_bus()
 {
 #ifdef HAVE_DBUS
+  dbus = NULL;
+
+  // Sessions of a host are reached through the host.
+  if (session_home != "")
+    {
+      return;
+    }
+
   try
     {
       dbus = new DBus();
@@ -252,11 +318,15 @@ Core::init_bus()
 
       dbus->connect(DBUS_PATH_WORKRAVE, "org.workrave.CoreInterface", this);
       dbus->connect(DBUS_PATH_WORKRAVE, "org.workrave.ConfigInterface", configurator);
+      dbus->connect(DBUS_PATH_WORKRAVE, "org.workrave.MetricsInterface", Metrics::get_instance());
+      dbus->connect(DBUS_PATH_WORKRAVE, "org.workrave.StatisticsInterface", statistics);
       dbus->register_object_path(DBUS_PATH_WORKRAVE);
+      dbus->set_object_lock(DBUS_PATH_WORKRAVE, &lock);
       
 #ifdef HAVE_TESTS
       dbus->connect("/org/workrave/Workrave/Debug", "org.workrave.DebugInterface", Test::get_instance());
       dbus->register_object_path("/org/workrave/Workrave/Debug");
+      dbus->set_object_lock("/org/workrave/Workrave/Debug", &lock);
 #endif
     }
   catch (DBusException &)
@@ -281,7 +351,11 @@ Core::init_monitor(const string &display_name)
 #endif
 #endif
 
-  InputMonitorFactory::init(display_name);
+  // The input of a session of a host is reported by the host.
+  if (session_home == "")
+    {
+      InputMonitorFactory::init(display_name);
+    }
 
   monitor = new ActivityMonitor();
   load_monitor_config();
@@ -302,6 +376,15 @@ Core::init_breaks()
 }
 
 
+//! Initializes the user defined timers.
+void
+Core::init_user_timers()
+{
+  load_user_timer_config();
+  configurator->add_listener(CoreConfig::CFG_KEY_USER_TIMERS, this);
+}
+
+
 #ifdef HAVE_DISTRIBUTION
 //! Initializes the monitor based on the specified configuration.
 void
@@ -380,6 +463,49 @@ Core::load_monitor_config()
 }
 
 
+//! Loads the configuration of the user defined timers.
+void
+Core::load_user_timer_config()
+{
+  TRACE_ENTER("Core::load_user_timer_config");
+
+  assert(configurator != NULL);
+
+  string names_str;
+  vector<string> names;
+
+  if (configurator->get_value(CoreConfig::CFG_KEY_USER_TIMER_NAMES, names_str))
+    {
+      StringUtil::split(names_str, ',', names);
+    }
+
+  user_timers.retain(names);
+
+  for (vector<string>::const_iterator i = names.begin(); i != names.end(); i++)
+    {
+      const string &name = *i;
+      string key = CoreConfig::CFG_KEY_USER_TIMERS + "/" + name + "/";
+      int limit;
+      int auto_reset;
+
+      if (name.empty() || name.find(' ') != string::npos)
+        {
+          continue;
+        }
+
+      if (! configurator->get_value(key + CoreConfig::CFG_KEY_USER_TIMER_LIMIT, limit))
+        limit = 0;
+      if (! configurator->get_value(key + CoreConfig::CFG_KEY_USER_TIMER_AUTO_RESET, auto_reset))
+        auto_reset = 0;
+
+      TRACE_MSG("User timer " << name << " " << limit << " " << auto_reset);
+      user_timers.add(name, limit, auto_reset);
+    }
+
+  TRACE_EXIT();
+}
+
+
 //! Notification that the configuration has changed.
 void
 Core::config_changed_notify(const string &key)
@@ -398,6 +524,11 @@ Core::config_changed_notify(const string &key)
       load_monitor_config();
     }
 
+  if (path == CoreConfig::CFG_KEY_USER_TIMERS)
+    {
+      load_user_timer_config();
+    }
+
   if (key == CoreConfig::CFG_KEY_OPERATION_MODE)
     {
       int mode;
@@ -1102,11 +1233,17 @@ Core::heartbeat()
   TRACE_ENTER("Core::heartbeat");
   assert(application != NULL);
 
+  MetricsTimer timer(Metrics::LATENCY_HEARTBEAT);
+
   // Set current time.
   current_time = time(NULL);
 
   // Performs timewarp checking.
   bool warped = process_timewarp();
+  if (warped)
+    {
+      Metrics::get_instance()->increment(Metrics::COUNTER_TIMEWARP);
+    }
 
   // Process configuration
   configurator->heartbeat();
@@ -1123,6 +1260,9 @@ Core::heartbeat()
   // Perform timer processing.
   process_timers();
 
+  // Record the per-minute activity.
+  statistics->heartbeat();
+
   // Send heartbeats to other components.
   for (int i = 0; i < BREAK_ID_SIZEOF; i++)
     {
@@ -1140,6 +1280,10 @@ Core::heartbeat()
       save_state();
     }
 
+  Metrics *metrics = Metrics::get_instance();
+  metrics->set_gauge(Metrics::GAUGE_USER_TIMERS, user_timers.size());
+  metrics->heartbeat();
+
   // Done.
   last_process_time = current_time;
 
@@ -1203,22 +1347,10 @@ Core::process_state()
   // Default
   local_state = monitor->get_current_state();
 
-  map<std::string, time_t>::iterator i = external_activity.begin();
-  while (i != external_activity.end())
+  external_activity.expire(current_time);
+  if (external_activity.is_active())
     {
-      map<std::string, time_t>::iterator next = i;
-      next++;
-
-      if (i->second >= current_time)
-        {
-          local_state = ACTIVITY_ACTIVE;
-        }
-      else
-        {
-          external_activity.erase(i);
-        }
-
-      i = next;
+      local_state = ACTIVITY_ACTIVE;
     }
 
   monitor_state = local_state;
@@ -1246,27 +1378,80 @@ Core::process_state()
     }
 
   // Update our idle history.
-  idlelog_manager->update_all_idlelogs(dist_manager->get_master_id(), monitor_state);
+  if (idlelog_manager != NULL)
+    {
+      idlelog_manager->update_all_idlelogs(dist_manager->get_master_id(), monitor_state);
+    }
 #endif
 }
 
 
+//! Reports activity of an external source.
+/*!
+ *  Takes a lease of ExternalActivity::DEFAULT_TTL seconds, so the source
+ *  must report again within that time. New sources should use
+ *  start_external_activity with a longer lease.
+ */
 void
 Core::report_external_activity(std::string who, bool act)
 {
   TRACE_ENTER_MSG("Core::report_external_activity", who << " " << act);
   if (act)
     {
-      external_activity[who] = current_time + 10;
+      external_activity.start(who, ExternalActivity::DEFAULT_TTL, current_time);
     }
   else
     {
-      external_activity.erase(who);
+      external_activity.end(who, current_time);
     }
   TRACE_EXIT();
 }
 
 
+//! Starts (or renews) a lease of ttl seconds on behalf of an external source.
+void
+Core::start_external_activity(std::string who, int ttl)
+{
+  external_activity.start(who, ttl, current_time);
+}
+
+
+//! Renews the lease of an external source. Returns false if it expired.
+bool
+Core::renew_external_activity(std::string who, int ttl)
+{
+  return external_activity.renew(who, ttl, current_time);
+}
+
+
+//! Ends the lease of an external source.
+void
+Core::end_external_activity(std::string who)
+{
+  external_activity.end(who, current_time);
+}
+
+
+//! Returns the statistics of an external source.
+bool
+Core::get_external_activity_stats(std::string who, int &reports, int &leases, int &active_time)
+{
+  ExternalActivity::SourceStats stats;
+  bool ret = external_activity.get_stats(who, current_time, stats);
+  if (ret)
+    {
+      reports = stats.reports;
+      leases = stats.leases;
+      active_time = (int) stats.active_time;
+    }
+  else
+    {
+      reports = leases = active_time = 0;
+    }
+  return ret;
+}
+
+
 void
 Core::is_timer_running(BreakId id, bool &value)
 {
@@ -1298,11 +1483,20 @@ Core::get_timer_overdue(BreakId id, int *value)
   *value = (int) timer->get_total_overdue_time();
 }
 
+
+void
+Core::get_user_timer_elapsed(std::string name, int *value)
+{
+  int index = user_timers.find(name);
+  *value = index != -1 ? (int) user_timers.get_elapsed_time(index) : -1;
+}
+
 //! Processes all timers.
 void
 Core::process_timers()
 {
   TRACE_ENTER("Core::process_timers");
+  MetricsTimer timer(Metrics::LATENCY_PROCESS_TIMERS);
 
   TimerInfo infos[BREAK_ID_SIZEOF];
 
@@ -1369,100 +1563,145 @@ Core::process_timers()
         }
     }
 
+  process_user_timers();
+
   TRACE_EXIT();
 }
 
-#if defined(PLATFORM_OS_WIN32)
 
-//! Process a possible timewarp on Win32
-bool
-Core::process_timewarp()
+//! Processes all user defined timers.
+void
+Core::process_user_timers()
 {
-  bool ret = false;
-
-  TRACE_ENTER("Core::process_timewarp");
-  if (last_process_time != 0)
+  ActivityState state = monitor_state;
+  if (operation_mode == OPERATION_MODE_SUSPENDED)
     {
-      time_t gap = current_time - 1 - last_process_time;
-  
-      if (abs((int)gap) > 5)
-        {
-          TRACE_MSG("gap " << gap << " " << powersave << " " << operation_mode << " " << powersave_resume_time << " " << current_time);
-
-          if (!powersave)
-            {
-              TRACE_MSG("Time warp of " << gap << " seconds. Correcting");
-
-              force_idle();
+      state = ACTIVITY_IDLE;
+    }
 
-              monitor->shift_time((int)gap);
-              for (int i = 0; i < BREAK_ID_SIZEOF; i++)
-                {
-                  breaks[i].get_timer()->shift_time((int)gap);
-                }
+  vector<int> limit_reached;
+  user_timers.process(state, current_time, limit_reached);
 
-              monitor_state = ACTIVITY_IDLE;
-              ret = true;
-            }
-          else
-            {
-              TRACE_MSG("Time warp of " << gap << " seconds because of powersave");
+  for (vector<int>::const_iterator i = limit_reached.begin(); i != limit_reached.end(); i++)
+    {
+      const string &name = user_timers.get_name(*i);
 
-              // In case the windows message was lost. some people reported that
-              // workrave never restarted the timers...
-              remove_operation_mode_override( "powersave" );
-            }
-        }
-      
-      if (powersave && powersave_resume_time != 0 && current_time > powersave_resume_time + 30)
+      statistics->increment_user_timer_counter(name);
+      if (core_event_listener != NULL)
         {
-          TRACE_MSG("End of time warp after powersave");
+          core_event_listener->core_event_user_timer_limit_reached(name);
+        }
 
-          powersave = false;
-          powersave_resume_time = 0;
+#ifdef HAVE_DBUS
+      org_workrave_CoreInterface *iface = org_workrave_CoreInterface::instance(dbus);
+      if (iface != NULL)
+        {
+          iface->UserTimerLimitReached("/org/workrave/Workrave/Core", name);
         }
+#endif
     }
-  TRACE_EXIT();
-  return ret;
 }
 
-#else
-
-//! Process a possible timewarp On Non-Windows
+//! Processes changes of the wall-clock time and system suspends.
+/*!
+ *  The time that really elapsed since the previous heartbeat is measured
+ *  using the monotonic clocks. A difference with the elapsed wall-clock
+ *  time is a clock change (manual or NTP), for which all timers are
+ *  shifted so that their elapsed times are not affected. Time that passed
+ *  on the boot time clock but not on the monotonic clock was spent in
+ *  suspend.
+ *
+ *  \return true if the system was suspended.
+ */
 bool
 Core::process_timewarp()
 {
+  TRACE_ENTER("Core::process_timewarp");
+
   bool ret = false;
+  gint64 monotonic_now = MonotonicClock::get_monotonic_time();
+  gint64 boot_now = MonotonicClock::get_boot_time();
 
-  TRACE_ENTER("Core::process_timewarp");
   if (last_process_time != 0)
     {
-      int gap = current_time - 1 - last_process_time;
+      gint64 running = monotonic_now - last_monotonic_time;
+      gint64 elapsed = boot_now - last_boot_time;
+      gint64 suspended = elapsed - running;
+      gint64 wall_elapsed = ((gint64) (current_time - last_process_time)) * G_USEC_PER_SEC;
+      int clock_change = (int) ((wall_elapsed - elapsed) / G_USEC_PER_SEC);
+
+      if (!MonotonicClock::is_suspend_aware() && clock_change >= MAX_HEARTBEAT_GAP)
+        {
+          // The monotonic clock may have stopped during a suspend.
+          suspended = ((gint64) clock_change) * G_USEC_PER_SEC;
+          clock_change = 0;
+        }
+
+      if (abs(clock_change) > CLOCK_CHANGE_TOLERANCE)
+        {
+          TRACE_MSG("Clock changed by " << clock_change << " seconds. Correcting");
+
+          monitor->shift_time(clock_change);
+          for (int i = 0; i < BREAK_ID_SIZEOF; i++)
+            {
+              breaks[i].get_timer()->shift_time(clock_change);
+            }
+          user_timers.shift_time(clock_change);
+          external_activity.shift_time(clock_change);
 
-      if (gap >= 30)
+          last_process_time += clock_change;
+        }
+
+      // Without a suspend aware clock, a large gap between heartbeats is the
+      // only indication of a suspend.
+      if (suspended >= G_USEC_PER_SEC || elapsed >= MAX_HEARTBEAT_GAP * G_USEC_PER_SEC)
         {
-          TRACE_MSG("Time warp of " << gap << " seconds. Powersafe");
+          TRACE_MSG("Suspended for " << suspended / G_USEC_PER_SEC << " seconds, "
+                    << running / G_USEC_PER_SEC << " seconds running");
 
           force_idle();
 
-          int save_current_time = current_time;
+          // Stop the timers at the moment the system was suspended, so that
+          // the suspend is counted as idle time.
+          time_t save_current_time = current_time;
+          time_t running_time = 1;
+          if (suspended >= G_USEC_PER_SEC)
+            {
+              running_time = MAX((time_t) (running / G_USEC_PER_SEC), (time_t) 1);
+            }
 
-          current_time = last_process_time + 1;
+          current_time = last_process_time + running_time;
           monitor_state = ACTIVITY_IDLE;
 
           process_timers();
 
           current_time = save_current_time;
+
+          if (powersave)
+            {
+              // In case the powersave notification was lost. Some people
+              // reported that workrave never restarted the timers...
+              remove_operation_mode_override("powersave");
+            }
           ret = true;
         }
+
+      if (powersave && powersave_resume_time != 0 && current_time > powersave_resume_time + 30)
+        {
+          TRACE_MSG("End of time warp after powersave");
+
+          powersave = false;
+          powersave_resume_time = 0;
+        }
     }
 
+  last_monotonic_time = monotonic_now;
+  last_boot_time = boot_now;
+
   TRACE_EXIT();
   return ret;
 }
 
-#endif
-
 //! Notication of a timer action.
 /*!
  *  \param timerId ID of the timer that caused the action.
@@ -1644,9 +1883,14 @@ Core::daily_reset()
       t->daily_reset_timer();
     }
 
+  user_timers.daily_reset();
+
 
 #ifdef HAVE_DISTRIBUTION
-  idlelog_manager->reset();
+  if (idlelog_manager != NULL)
+    {
+      idlelog_manager->reset();
+    }
 #endif
 
   save_state();
@@ -1663,6 +1907,8 @@ Core::save_state() const
   ss << Util::get_home_directory();
   ss << "state" << ends;
 
+  Metrics::get_instance()->increment(Metrics::COUNTER_STATE_SAVE);
+
   ofstream stateFile(ss.str().c_str());
 
   stateFile << "WorkRaveState 3"  << endl
@@ -1675,6 +1921,11 @@ Core::save_state() const
       stateFile << stateStr << endl;
     }
 
+  for (int i = 0; i < user_timers.size(); i++)
+    {
+      stateFile << user_timers.serialize_state(i) << endl;
+    }
+
   stateFile.close();
 }
 
@@ -1741,6 +1992,15 @@ Core::load_state()
       string id;
       stateFile >> id;
 
+      if (id.compare(0, UserTimerTable::STATE_PREFIX.size(), UserTimerTable::STATE_PREFIX) == 0)
+        {
+          string state;
+          getline(stateFile, state);
+
+          user_timers.deserialize_state(id.substr(UserTimerTable::STATE_PREFIX.size()), state);
+          continue;
+        }
+
       for (int i = 0; i < BREAK_ID_SIZEOF; i++)
         {
           if (breaks[i].get_timer()->get_id() == id)
@@ -2194,7 +2454,10 @@ Core::send_break_control_message(BreakId break_id, BreakControlMessage message)
   buffer.pack_ushort(break_id);
   buffer.pack_ushort(message);
 
-  dist_manager->broadcast_client_message(DCM_BREAKCONTROL, buffer);
+  if (dist_manager != NULL)
+    {
+      dist_manager->broadcast_client_message(DCM_BREAKCONTROL, buffer);
+    }
 }
 
 //! Sends a break control message with boolean parameter to all workrave clients.
@@ -2210,7 +2473,10 @@ Core::send_break_control_message_bool_param(BreakId break_id, BreakControlMessag
   buffer.pack_ushort(message);
   buffer.pack_byte(param);
 
-  dist_manager->broadcast_client_message(DCM_BREAKCONTROL, buffer);
+  if (dist_manager != NULL)
+    {
+      dist_manager->broadcast_client_message(DCM_BREAKCONTROL, buffer);
+    }
 }
 
 
@@ -44,10 +44,13 @@
 #include "IActivityMonitor.hh"
 #include "ICore.hh"
 #include "ICoreEventListener.hh"
+#include "ExternalActivity.hh"
 #include "IConfiguratorListener.hh"
 #include "TimeSource.hh"
 #include "Timer.hh"
 #include "Statistics.hh"
+#include "UserTimerTable.hh"
+#include "Mutex.hh"
 
 using namespace workrave;
 
@@ -87,6 +90,9 @@ public:
   virtual ~Core();
 
   static Core *get_instance();
+  static void set_instance(Core *core);
+
+  void set_session_home(const std::string &home);
 
   Timer *get_timer(std::string name) const;
   Timer *get_timer(BreakId id) const;
@@ -136,10 +142,15 @@ public:
 
   // DBus functions.
   void report_external_activity(std::string who, bool act);
+  void start_external_activity(std::string who, int ttl);
+  bool renew_external_activity(std::string who, int ttl);
+  void end_external_activity(std::string who);
+  bool get_external_activity_stats(std::string who, int &reports, int &leases, int &active_time);
   void is_timer_running(BreakId id, bool &value);
   void get_timer_elapsed(BreakId id,int *value);
   void get_timer_idle(BreakId id, int *value);
   void get_timer_overdue(BreakId id,int *value);
+  void get_user_timer_elapsed(std::string name, int *value);
 
   // BreakResponseInterface
   void postpone_break(BreakId break_id);
@@ -152,6 +163,12 @@ public:
   }
 #endif
 
+  //! Lock that serializes all access to the core from other threads.
+  Mutex &get_lock()
+  {
+    return lock;
+  }
+
 private:
 
 #ifndef NDEBUG
@@ -163,6 +180,7 @@ private:
 
   void init(int argc, char **argv, IApp *application, const std::string &display_name);
   void init_breaks();
+  void init_user_timers();
   void init_configurator();
   void init_monitor(const std::string &display_name);
   void init_distribution_manager();
@@ -170,6 +188,7 @@ private:
   void init_statistics();
 
   void load_monitor_config();
+  void load_user_timer_config();
   void config_changed_notify(const std::string &key);
   void heartbeat();
   void timer_action(BreakId id, TimerInfo info);
@@ -177,6 +196,7 @@ private:
   void process_state();
   bool process_timewarp();
   void process_timers();
+  void process_user_timers();
   void start_break(BreakId break_id, BreakId resume_this_break = BREAK_ID_NONE);
   void stop_all_breaks();
   void daily_reset();
@@ -235,18 +255,30 @@ private:
   //! Command line arguments passed to the program.
   char **argv;
 
+  //! Home directory of this session, if this core is a session of a host.
+  std::string session_home;
+
   //! The current time.
   time_t current_time;
 
   //! The time we last processed the timers.
   time_t last_process_time;
 
+  //! Monotonic time (µs) at which we last processed the timers.
+  gint64 last_monotonic_time;
+
+  //! Boot time (µs) at which we last processed the timers.
+  gint64 last_boot_time;
+
   //! Are we the master node??
   bool master_node;
 
   //! List of breaks.
   Break breaks[BREAK_ID_SIZEOF];
 
+  //! User defined timers.
+  UserTimerTable user_timers;
+
   //! The Configurator.
   Configurator *configurator;
 
@@ -300,6 +332,9 @@ private:
   DBus *dbus;
 #endif
 
+  //! Serializes access from the GUI thread when the core runs on its own thread.
+  Mutex lock;
+
 #ifdef HAVE_DISTRIBUTION
   //! The Distribution Manager
   DistributionManager *dist_manager;
@@ -316,8 +351,8 @@ private:
 #endif
 #endif
 
-  //! External activity
-  std::map<std::string, time_t> external_activity;
+  //! Leases of external activity sources.
+  ExternalActivity external_activity;
 
 #ifdef HAVE_TESTS
   friend class Test;
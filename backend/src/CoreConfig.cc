@@ -39,6 +39,11 @@ const string CoreConfig::CFG_KEY_TIMER_SNOOZE              = "timers/%b/snooze";
 const string CoreConfig::CFG_KEY_TIMER_MONITOR             = "timers/%b/monitor";
 const string CoreConfig::CFG_KEY_TIMER_ACTIVITY_SENSITIVE  = "timers/%b/activity_sensitive";
 
+const string CoreConfig::CFG_KEY_USER_TIMERS               = "user_timers";
+const string CoreConfig::CFG_KEY_USER_TIMER_NAMES          = "user_timers/names";
+const string CoreConfig::CFG_KEY_USER_TIMER_LIMIT          = "limit";
+const string CoreConfig::CFG_KEY_USER_TIMER_AUTO_RESET     = "auto_reset";
+
 const string CoreConfig::CFG_KEY_BREAKS                    = "breaks";
 const string CoreConfig::CFG_KEY_BREAK                     = "breaks/%b";
 
@@ -54,6 +59,7 @@ const string CoreConfig::CFG_KEY_MONITOR_IDLE              = "monitor/idle";
 const string CoreConfig::CFG_KEY_GENERAL_DATADIR           = "general/datadir";
 const string CoreConfig::CFG_KEY_OPERATION_MODE            = "general/operation-mode";
 const string CoreConfig::CFG_KEY_USAGE_MODE                = "general/usage-mode";
+const string CoreConfig::CFG_KEY_STATISTICS_RETENTION      = "general/statistics-retention";
 
 const string CoreConfig::CFG_KEY_DISTRIBUTION              = "distribution";
 const string CoreConfig::CFG_KEY_DISTRIBUTION_ENABLED      = "distribution/enabled";
@@ -26,11 +26,20 @@
 #include "CoreFactory.hh"
 #include "Configurator.hh"
 #include "Core.hh"
+#include "CoreHost.hh"
+#include "CoreThread.hh"
+#include "CoreThreadProxies.hh"
 
 //! Returns the interface to the core.
 ICore *
 CoreFactory::get_core()
 {
+  CoreThread *core_thread = CoreThread::get_instance();
+  if (core_thread != NULL)
+    {
+      return core_thread;
+    }
+
   return Core::get_instance();
 }
 
@@ -39,6 +48,12 @@ CoreFactory::get_core()
 IConfigurator *
 CoreFactory::get_configurator()
 {
+  CoreThread *core_thread = CoreThread::get_instance();
+  if (core_thread != NULL && core_thread->get_configurator() != NULL)
+    {
+      return core_thread->get_configurator();
+    }
+
   Core *core = Core::get_instance();
   assert(core != NULL);
 
@@ -59,3 +74,31 @@ CoreFactory::get_dbus()
   return NULL;
 #endif
 }
+
+
+//! Runs the core on a dedicated thread.
+void
+CoreFactory::enable_core_thread()
+{
+  CoreThread::create();
+}
+
+
+//! Stops the core thread, if it is running.
+void
+CoreFactory::stop_core_thread()
+{
+  CoreThread *core_thread = CoreThread::get_instance();
+  if (core_thread != NULL)
+    {
+      core_thread->stop();
+    }
+}
+
+
+//! Returns the host that runs the cores of many sessions.
+ICoreHost *
+CoreFactory::get_core_host()
+{
+  return CoreHost::get_instance();
+}
@@ -0,0 +1,719 @@
+// CoreHost.cc --- Runs the cores of many user sessions in one process
+//
+// Copyright (C) 2017 Rob Caelers <robc@krandor.nl>
+// All rights reserved.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "debug.hh"
+
+#include <sstream>
+
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
+#include "CoreHost.hh"
+#include "Core.hh"
+#include "Configurator.hh"
+#include "Statistics.hh"
+#include "SessionInputMonitor.hh"
+#include "InputMonitorFactory.hh"
+#include "Metrics.hh"
+#include "Util.hh"
+
+#ifdef HAVE_DBUS
+#if defined(PLATFORM_OS_WIN32_NATIVE)
+#undef interface
+#endif
+#include "DBus.hh"
+#include "DBusException.hh"
+#include "DBusWorkrave.hh"
+#endif
+
+#define DBUS_PATH_HOST             "/org/workrave/Workrave/Host"
+#define DBUS_SERVICE_HOST          "org.workrave.Host"
+
+//! Maximum number of D-BUS clients whose user is remembered.
+static const size_t MAX_CALLERS = 1024;
+
+using namespace std;
+
+CoreHost *CoreHost::instance = NULL;
+
+
+//! Returns the one and only host.
+CoreHost *
+CoreHost::get_instance()
+{
+  if (instance == NULL)
+    {
+      instance = new CoreHost();
+    }
+  return instance;
+}
+
+
+CoreHost::CoreHost() :
+  argc(0),
+  argv(NULL)
+#ifdef HAVE_DBUS
+  ,
+  dbus(NULL)
+#endif
+{
+}
+
+
+CoreHost::~CoreHost()
+{
+  shutdown();
+#ifdef HAVE_DBUS
+  delete dbus;
+#endif
+}
+
+
+//! Initializes the host.
+void
+CoreHost::init(int argc, char **argv)
+{
+  this->argc = argc;
+  this->argv = argv;
+
+  // Create the metrics before any session starts. They are shared.
+  Metrics::get_instance();
+
+  // Sessions change the home directory.
+  sessions_dir = Util::get_home_directory() + "sessions" + G_DIR_SEPARATOR_S;
+
+  init_bus();
+}
+
+
+//! Registers the host on the system bus.
+/*!
+ *  The bus policy (org.workrave.Host.conf) lets every user call the host;
+ *  the host itself checks which sessions a caller may use.
+ */
+void
+CoreHost::init_bus()
+{
+#ifdef HAVE_DBUS
+  try
+    {
+      dbus = new DBus();
+      dbus->init(true);
+
+      extern void init_DBusWorkrave(DBus *dbus);
+      init_DBusWorkrave(dbus);
+
+      dbus->connect(DBUS_PATH_HOST, "org.workrave.HostInterface", this);
+      dbus->connect(DBUS_PATH_HOST, "org.workrave.MetricsInterface", Metrics::get_instance());
+      dbus->register_object_path(DBUS_PATH_HOST);
+#ifdef HAVE_DBUS_GIO
+      dbus->register_service(DBUS_SERVICE_HOST, this);
+#else
+      dbus->register_service(DBUS_SERVICE_HOST);
+#endif
+    }
+  catch (DBusException &)
+    {
+    }
+#endif
+}
+
+
+//! Saves and removes all sessions.
+void
+CoreHost::shutdown()
+{
+  TRACE_ENTER("CoreHost::shutdown");
+  while (!sessions.empty())
+    {
+      remove_session(sessions.begin()->first);
+    }
+  TRACE_EXIT();
+}
+
+
+//! Runs the heartbeat of all sessions.
+void
+CoreHost::heartbeat()
+{
+  for (SessionIter i = sessions.begin(); i != sessions.end(); i++)
+    {
+      select(i->second);
+      static_cast<ICore *>(i->second->core)->heartbeat();
+    }
+}
+
+
+//! Starts a session.
+/*!
+ *  The session belongs to the owner of its home directory.
+ *
+ *  \param name unique name of the session, e.g. the user name.
+ *  \param home directory for the configuration, statistics and state of
+ *              the session. It is created if needed. It must be an absolute
+ *              path without ".." components.
+ */
+bool
+CoreHost::add_session(const string &name, const string &home)
+{
+  TRACE_ENTER_MSG("CoreHost::add_session", name << " " << home);
+
+  if (!is_valid_home(home) || g_mkdir_with_parents(home.c_str(), 0700) != 0)
+    {
+      TRACE_RETURN(false);
+      return false;
+    }
+
+  guint32 owner = 0;
+#ifdef PLATFORM_OS_UNIX
+  GStatBuf st;
+  if (g_stat(home.c_str(), &st) != 0)
+    {
+      TRACE_RETURN(false);
+      return false;
+    }
+  owner = st.st_uid;
+#endif
+
+  bool ret = add_session(name, home, owner);
+  TRACE_RETURN(ret);
+  return ret;
+}
+
+
+//! Starts a session that belongs to the specified user.
+bool
+CoreHost::add_session(const string &name, const string &home, guint32 owner)
+{
+  TRACE_ENTER_MSG("CoreHost::add_session", name << " " << home << " " << owner);
+
+  if (name == "" || sessions.find(name) != sessions.end())
+    {
+      TRACE_RETURN(false);
+      return false;
+    }
+
+  Session *session = new Session();
+  session->name = name;
+  session->home = home;
+  session->owner = owner;
+  session->input = new SessionInputMonitor();
+
+  Core::set_instance(NULL);
+  Util::set_home_directory(home);
+  InputMonitorFactory::set_override(session->input);
+
+  session->core = new Core();
+  session->core->set_session_home(home);
+  static_cast<ICore *>(session->core)->init(argc, argv, this, "");
+
+  InputMonitorFactory::set_override(NULL);
+
+  // The configuration of the session may move its data elsewhere.
+  session->home = Util::get_home_directory();
+  if (session->home.length() > 1)
+    {
+      session->home.erase(session->home.length() - 1);
+    }
+
+  sessions[name] = session;
+
+  TRACE_RETURN(true);
+  return true;
+}
+
+
+//! Saves and stops a session.
+bool
+CoreHost::remove_session(const string &name)
+{
+  TRACE_ENTER_MSG("CoreHost::remove_session", name);
+
+  SessionIter i = sessions.find(name);
+  if (i == sessions.end())
+    {
+      TRACE_RETURN(false);
+      return false;
+    }
+
+  Session *session = i->second;
+  sessions.erase(i);
+
+  select(session);
+  session->core->get_statistics()->update();
+  session->core->get_configurator()->save();
+
+  // Also deletes the input monitor.
+  delete session->core;
+  delete session;
+
+  Core::set_instance(NULL);
+
+  TRACE_RETURN(true);
+  return true;
+}
+
+
+//! Returns the names of all sessions.
+list<string>
+CoreHost::get_sessions() const
+{
+  list<string> ret;
+  for (SessionCIter i = sessions.begin(); i != sessions.end(); i++)
+    {
+      ret.push_back(i->first);
+    }
+  return ret;
+}
+
+
+bool
+CoreHost::report_activity(const string &session)
+{
+  Session *s = select(session);
+  if (s != NULL)
+    {
+      s->input->report_action();
+    }
+  return s != NULL;
+}
+
+
+bool
+CoreHost::report_mouse(const string &session, int x, int y)
+{
+  Session *s = select(session);
+  if (s != NULL)
+    {
+      s->input->report_mouse(x, y, 0);
+    }
+  return s != NULL;
+}
+
+
+bool
+CoreHost::report_button(const string &session, bool is_press)
+{
+  Session *s = select(session);
+  if (s != NULL)
+    {
+      s->input->report_button(is_press);
+    }
+  return s != NULL;
+}
+
+
+bool
+CoreHost::report_keyboard(const string &session)
+{
+  Session *s = select(session);
+  if (s != NULL)
+    {
+      s->input->report_keyboard(false);
+    }
+  return s != NULL;
+}
+
+
+string
+CoreHost::get_break_stage(const string &session, BreakId id)
+{
+  Session *s = select(session);
+  if (s == NULL)
+    {
+      return "";
+    }
+  return s->core->get_break_stage(id);
+}
+
+
+//! Starts a session for the D-BUS client.
+/*!
+ *  The session belongs to the user of the client, and keeps its data in
+ *  the directory of the host, so that the host never writes to a
+ *  directory of a user.
+ */
+bool
+CoreHost::bus_add_session(const string &sender, const string &name)
+{
+  guint32 uid;
+  if (!get_caller(sender, uid) || !is_valid_name(name))
+    {
+      return false;
+    }
+
+  stringstream ss;
+  ss << sessions_dir << uid << G_DIR_SEPARATOR << name;
+  string home = ss.str();
+
+  return g_mkdir_with_parents(home.c_str(), 0700) == 0 && add_session(name, home, uid);
+}
+
+
+bool
+CoreHost::bus_remove_session(const string &sender, const string &name)
+{
+  return find_session(sender, name) != NULL && remove_session(name);
+}
+
+
+bool
+CoreHost::bus_report_activity(const string &sender, const string &session)
+{
+  return find_session(sender, session) != NULL && report_activity(session);
+}
+
+
+bool
+CoreHost::bus_report_mouse(const string &sender, const string &session, int x, int y)
+{
+  return find_session(sender, session) != NULL && report_mouse(session, x, y);
+}
+
+
+bool
+CoreHost::bus_report_button(const string &sender, const string &session, bool is_press)
+{
+  return find_session(sender, session) != NULL && report_button(session, is_press);
+}
+
+
+bool
+CoreHost::bus_report_keyboard(const string &sender, const string &session)
+{
+  return find_session(sender, session) != NULL && report_keyboard(session);
+}
+
+
+//! Reports a batch of input events of a session, in the order they occurred.
+bool
+CoreHost::bus_report_input(const string &sender, const string &session, const InputEvents &events)
+{
+  Session *s = find_session(sender, session);
+  if (s == NULL)
+    {
+      return false;
+    }
+
+  select(s);
+  for (InputEvents::const_iterator i = events.begin(); i != events.end(); i++)
+    {
+      switch (i->kind)
+        {
+        case INPUT_ACTION:
+          s->input->report_action();
+          break;
+
+        case INPUT_MOUSE:
+          s->input->report_mouse(i->x, i->y, i->value);
+          break;
+
+        case INPUT_BUTTON:
+          s->input->report_button(i->value != 0);
+          break;
+
+        case INPUT_KEYBOARD:
+          s->input->report_keyboard(i->value != 0);
+          break;
+        }
+    }
+  return true;
+}
+
+
+string
+CoreHost::bus_get_break_stage(const string &sender, const string &session, BreakId id)
+{
+  if (find_session(sender, session) == NULL)
+    {
+      return "";
+    }
+  return get_break_stage(session, id);
+}
+
+
+//! Returns the named session if the D-BUS client may use it, or NULL.
+/*!
+ *  A client may use the sessions of its user. The user that runs the host
+ *  may use all sessions.
+ */
+CoreHost::Session *
+CoreHost::find_session(const string &sender, const string &name)
+{
+  SessionIter i = sessions.find(name);
+  guint32 uid;
+  if (i == sessions.end() || !get_caller(sender, uid))
+    {
+      return NULL;
+    }
+
+#ifdef PLATFORM_OS_UNIX
+  if (uid != i->second->owner && uid != getuid())
+    {
+      return NULL;
+    }
+#endif
+
+  return i->second;
+}
+
+
+//! Returns the user of a D-BUS client.
+bool
+CoreHost::get_caller(const string &sender, guint32 &uid)
+{
+  TRACE_ENTER_MSG("CoreHost::get_caller", sender);
+  bool ret = false;
+  uid = 0;
+
+#if defined(HAVE_DBUS) && defined(PLATFORM_OS_UNIX)
+  map<string, guint32>::const_iterator i = callers.find(sender);
+  if (i != callers.end())
+    {
+      uid = i->second;
+      ret = true;
+    }
+  else if (dbus != NULL && sender != "")
+    {
+#ifdef HAVE_DBUS_GIO
+      GError *error = NULL;
+      GVariant *result = g_dbus_connection_call_sync(dbus->get_connection(),
+                                                     "org.freedesktop.DBus",
+                                                     "/org/freedesktop/DBus",
+                                                     "org.freedesktop.DBus",
+                                                     "GetConnectionUnixUser",
+                                                     g_variant_new("(s)", sender.c_str()),
+                                                     G_VARIANT_TYPE("(u)"),
+                                                     G_DBUS_CALL_FLAGS_NONE,
+                                                     -1,
+                                                     NULL,
+                                                     &error);
+      if (result != NULL)
+        {
+          g_variant_get(result, "(u)", &uid);
+          g_variant_unref(result);
+          ret = true;
+        }
+      else
+        {
+          TRACE_MSG("Cannot get user of " << sender << ": " << error->message);
+          g_error_free(error);
+        }
+#else
+      DBusError error;
+      dbus_error_init(&error);
+
+      unsigned long user = dbus_bus_get_unix_user(dbus->conn(), sender.c_str(), &error);
+      if (dbus_error_is_set(&error))
+        {
+          TRACE_MSG("Cannot get user of " << sender << ": " << error.message);
+          dbus_error_free(&error);
+        }
+      else
+        {
+          uid = (guint32) user;
+          ret = true;
+        }
+#endif
+
+      if (ret)
+        {
+          // Unique bus names are never reused, so their user never changes.
+          if (callers.size() >= MAX_CALLERS)
+            {
+              callers.clear();
+            }
+          callers[sender] = uid;
+        }
+    }
+#elif defined(HAVE_DBUS)
+  // There are no user ids to compare; all sessions belong to one user.
+  (void) sender;
+  ret = true;
+#else
+  (void) sender;
+#endif
+
+  TRACE_RETURN(ret << " " << uid);
+  return ret;
+}
+
+
+//! Returns whether a directory may be used as the home of a session.
+bool
+CoreHost::is_valid_home(const string &home)
+{
+  if (home == "" || !g_path_is_absolute(home.c_str()))
+    {
+      return false;
+    }
+
+  bool ret = true;
+  gchar **parts = g_strsplit(home.c_str(), G_DIR_SEPARATOR_S, -1);
+  for (int i = 0; ret && parts[i] != NULL; i++)
+    {
+      ret = (strcmp(parts[i], "..") != 0);
+    }
+  g_strfreev(parts);
+
+  GStatBuf st;
+  if (ret && g_lstat(home.c_str(), &st) == 0)
+    {
+      ret = S_ISDIR(st.st_mode);
+    }
+
+  return ret;
+}
+
+
+//! Returns whether a name may be used for a session added over the D-BUS.
+/*!
+ *  The name becomes a directory name: letters, digits, '-', '_' and '.',
+ *  not starting with '.'.
+ */
+bool
+CoreHost::is_valid_name(const string &name)
+{
+  if (name == "" || name.length() > 64 || name[0] == '.')
+    {
+      return false;
+    }
+
+  for (string::const_iterator i = name.begin(); i != name.end(); i++)
+    {
+      if (!g_ascii_isalnum(*i) && *i != '-' && *i != '_' && *i != '.')
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+
+//! Makes the named session current. Returns NULL if it does not exist.
+CoreHost::Session *
+CoreHost::select(const string &name)
+{
+  SessionIter i = sessions.find(name);
+  if (i == sessions.end())
+    {
+      return NULL;
+    }
+
+  select(i->second);
+  return i->second;
+}
+
+
+//! Makes a session current.
+void
+CoreHost::select(Session *session)
+{
+  Core::set_instance(session->core);
+  Util::set_home_directory(session->home);
+}
+
+
+void
+CoreHost::set_break_response(IBreakResponse *rep)
+{
+  (void) rep;
+}
+
+
+void
+CoreHost::create_prelude_window(BreakId break_id)
+{
+  (void) break_id;
+}
+
+
+void
+CoreHost::create_break_window(BreakId break_id, BreakHint break_hint)
+{
+  (void) break_id;
+  (void) break_hint;
+}
+
+
+void
+CoreHost::hide_break_window()
+{
+}
+
+
+void
+CoreHost::show_break_window()
+{
+}
+
+
+void
+CoreHost::refresh_break_window()
+{
+}
+
+
+void
+CoreHost::set_break_progress(int value, int max_value)
+{
+  (void) value;
+  (void) max_value;
+}
+
+
+void
+CoreHost::set_prelude_stage(PreludeStage stage)
+{
+  (void) stage;
+}
+
+
+void
+CoreHost::set_prelude_progress_text(PreludeProgressText text)
+{
+  (void) text;
+}
+
+
+//! A session cannot terminate the host.
+void
+CoreHost::terminate()
+{
+}
+
+
+#ifdef HAVE_DBUS_GIO
+void
+CoreHost::bus_name_presence(const string &name, bool present)
+{
+  (void) name;
+  (void) present;
+}
+#endif
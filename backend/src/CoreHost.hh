@@ -0,0 +1,195 @@
+// CoreHost.hh --- Runs the cores of many user sessions in one process
+//
+// Copyright (C) 2017 Rob Caelers <robc@krandor.nl>
+// All rights reserved.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef COREHOST_HH
+#define COREHOST_HH
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <glib.h>
+
+#include "ICoreHost.hh"
+#include "IApp.hh"
+#ifdef HAVE_DBUS_GIO
+#include "IDBusWatch.hh"
+#endif
+
+using namespace workrave;
+
+namespace workrave
+{
+  class DBus;
+}
+
+class Core;
+class SessionInputMonitor;
+
+//! Runs the cores of many user sessions in one process.
+/*!
+ *  The backend keeps the current core and home directory in process wide
+ *  singletons. Before the host calls into a session, it makes the core
+ *  and home directory of that session current.
+ *
+ *  Sessions have no user interface: the host is their IApp, and ignores
+ *  break windows. Clients query the state of the breaks of a session over
+ *  the D-BUS.
+ *
+ *  The host runs on the system bus. Each session belongs to a user, and
+ *  only processes of that user (or of the user that runs the host) may
+ *  report its input, query it or remove it. Sessions added over the D-BUS
+ *  belong to the caller and keep their data in the directory of the host.
+ */
+class CoreHost :
+#ifdef HAVE_DBUS_GIO
+  public IDBusWatch,
+#endif
+  public ICoreHost,
+  public IApp
+{
+public:
+  //! Kind of an input event reported over the D-BUS.
+  enum InputKind
+    {
+      INPUT_ACTION,
+      INPUT_MOUSE,
+      INPUT_BUTTON,
+      INPUT_KEYBOARD
+    };
+
+  //! An input event reported over the D-BUS.
+  struct InputEvent
+  {
+    //! One of InputKind.
+    int kind;
+
+    //! Position of a mouse event.
+    int x;
+    int y;
+
+    //! Wheel of a mouse event, press of a button event, repeat of a keyboard event.
+    int value;
+  };
+
+  typedef std::vector<InputEvent> InputEvents;
+
+  static CoreHost *get_instance();
+
+  CoreHost();
+  virtual ~CoreHost();
+
+  // ICoreHost
+  void init(int argc, char **argv);
+  void shutdown();
+  void heartbeat();
+  bool add_session(const std::string &name, const std::string &home);
+  bool remove_session(const std::string &name);
+  std::list<std::string> get_sessions() const;
+  bool report_activity(const std::string &session);
+  bool report_mouse(const std::string &session, int x, int y);
+  bool report_button(const std::string &session, bool is_press);
+  bool report_keyboard(const std::string &session);
+  std::string get_break_stage(const std::string &session, BreakId id);
+
+  // IApp
+  void set_break_response(IBreakResponse *rep);
+  void create_prelude_window(BreakId break_id);
+  void create_break_window(BreakId break_id, BreakHint break_hint);
+  void hide_break_window();
+  void show_break_window();
+  void refresh_break_window();
+  void set_break_progress(int value, int max_value);
+  void set_prelude_stage(PreludeStage stage);
+  void set_prelude_progress_text(PreludeProgressText text);
+  void terminate();
+
+  // D-BUS
+  bool bus_add_session(const std::string &sender, const std::string &name);
+  bool bus_remove_session(const std::string &sender, const std::string &name);
+  bool bus_report_activity(const std::string &sender, const std::string &session);
+  bool bus_report_mouse(const std::string &sender, const std::string &session, int x, int y);
+  bool bus_report_button(const std::string &sender, const std::string &session, bool is_press);
+  bool bus_report_keyboard(const std::string &sender, const std::string &session);
+  bool bus_report_input(const std::string &sender, const std::string &session, const InputEvents &events);
+  std::string bus_get_break_stage(const std::string &sender, const std::string &session, BreakId id);
+
+#ifdef HAVE_DBUS_GIO
+  // IDBusWatch
+  void bus_name_presence(const std::string &name, bool present);
+#endif
+
+private:
+  struct Session
+  {
+    //! Name of the session.
+    std::string name;
+
+    //! Home directory, without trailing separator.
+    std::string home;
+
+    //! User that owns the session.
+    guint32 owner;
+
+    //! The core of the session.
+    Core *core;
+
+    //! Receives the input of the session. Owned by the core.
+    SessionInputMonitor *input;
+  };
+
+  typedef std::map<std::string, Session *> Sessions;
+  typedef Sessions::iterator SessionIter;
+  typedef Sessions::const_iterator SessionCIter;
+
+  bool add_session(const std::string &name, const std::string &home, guint32 owner);
+  Session *select(const std::string &name);
+  void select(Session *session);
+  void init_bus();
+  Session *find_session(const std::string &sender, const std::string &name);
+  bool get_caller(const std::string &sender, guint32 &uid);
+  static bool is_valid_home(const std::string &home);
+  static bool is_valid_name(const std::string &name);
+
+private:
+  //! The one and only instance.
+  static CoreHost *instance;
+
+  //! Number of command line arguments passed to the program.
+  int argc;
+
+  //! Command line arguments passed to the program.
+  char **argv;
+
+  //! All sessions, by name.
+  Sessions sessions;
+
+  //! Directory of the sessions added over the D-BUS, with trailing separator.
+  std::string sessions_dir;
+
+  //! Users of D-BUS clients, by unique bus name.
+  std::map<std::string, guint32> callers;
+
+#ifdef HAVE_DBUS
+  //! D-BUS bridge of the host.
+  DBus *dbus;
+#endif
+};
+
+#endif // COREHOST_HH
@@ -0,0 +1,803 @@
+// CoreThread.cc --- Runs the core on a dedicated thread
+//
+// Copyright (C) 2017 Rob Caelers <robc@krandor.nl>
+// All rights reserved.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "debug.hh"
+
+#include "CoreThread.hh"
+#include "CoreThreadProxies.hh"
+#include "Core.hh"
+#include "Break.hh"
+#include "Configurator.hh"
+#include "Statistics.hh"
+
+CoreThread *CoreThread::instance = NULL;
+
+
+//! Creates the one and only core thread.
+CoreThread *
+CoreThread::create()
+{
+  if (instance == NULL)
+    {
+      instance = new CoreThread();
+    }
+  return instance;
+}
+
+
+//! Returns the core thread, or NULL if the core runs on the GUI thread.
+CoreThread *
+CoreThread::get_instance()
+{
+  return instance;
+}
+
+
+CoreThread::CoreThread() :
+  core(Core::get_instance()),
+  app(NULL),
+  listener(NULL),
+  break_response(NULL),
+  statistics(NULL),
+  configurator(NULL),
+#ifdef HAVE_DISTRIBUTION
+  distribution_manager(NULL),
+#endif
+  thread(NULL),
+  core_thread(NULL),
+  context(NULL),
+  loop(NULL),
+  commands_scheduled(0),
+  events_scheduled(0)
+{
+  for (int i = 0; i < BREAK_ID_SIZEOF; i++)
+    {
+      breaks[i] = NULL;
+    }
+}
+
+
+CoreThread::~CoreThread()
+{
+  stop();
+
+  for (int i = 0; i < BREAK_ID_SIZEOF; i++)
+    {
+      delete breaks[i];
+    }
+  delete statistics;
+  delete configurator;
+#ifdef HAVE_DISTRIBUTION
+  delete distribution_manager;
+#endif
+
+  if (loop != NULL)
+    {
+      g_main_loop_unref(loop);
+    }
+  if (context != NULL)
+    {
+      g_main_context_unref(context);
+    }
+}
+
+
+//! Initializes the core and starts the core thread.
+/*!
+ *  The core is initialized on the calling thread, with the main context
+ *  of the core thread as thread default, so that all main loop sources
+ *  of the core end up on the core thread.
+ */
+void
+CoreThread::init(int argc, char **argv, IApp *app, const std::string &display)
+{
+  TRACE_ENTER("CoreThread::init");
+
+  this->app = app;
+
+  context = g_main_context_new();
+  loop = g_main_loop_new(context, FALSE);
+  g_main_context_set_poll_func(context, static_poll);
+
+  g_main_context_push_thread_default(context);
+  static_cast<ICore *>(core)->init(argc, argv, this, display);
+  g_main_context_pop_thread_default(context);
+
+  for (int i = 0; i < BREAK_ID_SIZEOF; i++)
+    {
+      breaks[i] = new BreakProxy(this, core->get_break(BreakId(i)));
+    }
+  statistics = new StatisticsProxy(this, core->get_statistics());
+  configurator = new ConfiguratorProxy(this, core->get_configurator());
+#ifdef HAVE_DISTRIBUTION
+  distribution_manager = new DistributionManagerProxy(this, core->get_distribution_manager());
+#endif
+
+  GSource *source = g_timeout_source_new(1000);
+  g_source_set_callback(source, static_on_heartbeat, this, NULL);
+  g_source_attach(source, context);
+  g_source_unref(source);
+
+  thread = new Thread(this);
+  thread->start();
+
+  TRACE_EXIT();
+}
+
+
+//! Stops the core thread.
+/*!
+ *  Commands that were not processed yet are executed on the calling
+ *  thread. Afterwards, the core is accessed directly.
+ */
+void
+CoreThread::stop()
+{
+  TRACE_ENTER("CoreThread::stop");
+  if (thread != NULL)
+    {
+      g_main_loop_quit(loop);
+      thread->wait();
+      delete thread;
+      thread = NULL;
+
+      ScopedLock l(get_lock());
+      process_commands();
+    }
+  TRACE_EXIT();
+}
+
+
+//! Main loop of the core thread.
+void
+CoreThread::run()
+{
+  TRACE_ENTER("CoreThread::run");
+
+  g_atomic_pointer_set(&core_thread, g_thread_self());
+  g_main_context_push_thread_default(context);
+
+  get_lock().lock();
+  g_main_loop_run(loop);
+  get_lock().unlock();
+
+  g_main_context_pop_thread_default(context);
+  g_atomic_pointer_set(&core_thread, NULL);
+
+  TRACE_EXIT();
+}
+
+
+//! Returns whether the caller runs on the core thread.
+bool
+CoreThread::is_core_thread() const
+{
+  return g_atomic_pointer_get(&core_thread) == g_thread_self();
+}
+
+
+//! Returns the lock that protects the core.
+Mutex &
+CoreThread::get_lock()
+{
+  return core->get_lock();
+}
+
+
+//! Returns the configurator for use by the GUI.
+ConfiguratorProxy *
+CoreThread::get_configurator() const
+{
+  return configurator;
+}
+
+
+//! Posts a configuration change to a listener of the GUI.
+void
+CoreThread::post_config_changed(IConfiguratorListener *listener, const std::string &key)
+{
+  Message event(EVENT_CONFIG_CHANGED);
+  event.target = listener;
+  event.text = key;
+  post_event(event);
+}
+
+
+//! Posts a log message to a distribution log listener of the GUI.
+void
+CoreThread::post_distribution_log(DistributionLogListener *listener, const std::string &msg)
+{
+  Message event(EVENT_DISTRIBUTION_LOG);
+  event.target = listener;
+  event.text = msg;
+  post_event(event);
+}
+
+
+//! Processes the events of the core, on the GUI thread.
+/*!
+ *  The core itself runs its heartbeat on the core thread.
+ */
+void
+CoreThread::heartbeat()
+{
+  process_events();
+}
+
+
+void
+CoreThread::force_break(BreakId id, BreakHint break_hint)
+{
+  post_command(Message(COMMAND_FORCE_BREAK, id, break_hint));
+}
+
+
+IBreak *
+CoreThread::get_break(BreakId id)
+{
+  return breaks[id];
+}
+
+
+IBreak *
+CoreThread::get_break(std::string name)
+{
+  ScopedLock l(get_lock());
+
+  Break *b = core->get_break(name);
+  return b != NULL ? breaks[b->get_id()] : NULL;
+}
+
+
+IStatistics *
+CoreThread::get_statistics() const
+{
+  return statistics;
+}
+
+
+#ifdef HAVE_DISTRIBUTION
+IDistributionManager *
+CoreThread::get_distribution_manager() const
+{
+  return distribution_manager;
+}
+#endif
+
+
+bool
+CoreThread::is_user_active() const
+{
+  ScopedLock l(core->get_lock());
+  return core->is_user_active();
+}
+
+
+OperationMode
+CoreThread::get_operation_mode()
+{
+  ScopedLock l(get_lock());
+  return core->get_operation_mode();
+}
+
+
+OperationMode
+CoreThread::get_operation_mode_regular()
+{
+  ScopedLock l(get_lock());
+  return core->get_operation_mode_regular();
+}
+
+
+bool
+CoreThread::is_operation_mode_an_override()
+{
+  ScopedLock l(get_lock());
+  return core->is_operation_mode_an_override();
+}
+
+
+void
+CoreThread::set_operation_mode(OperationMode mode)
+{
+  post_command(Message(COMMAND_SET_OPERATION_MODE, 0, mode));
+}
+
+
+void
+CoreThread::set_operation_mode_override(OperationMode mode, const std::string &id)
+{
+  Message command(COMMAND_SET_OPERATION_MODE_OVERRIDE, 0, mode);
+  command.text = id;
+  post_command(command);
+}
+
+
+void
+CoreThread::remove_operation_mode_override(const std::string &id)
+{
+  Message command(COMMAND_REMOVE_OPERATION_MODE_OVERRIDE);
+  command.text = id;
+  post_command(command);
+}
+
+
+UsageMode
+CoreThread::get_usage_mode()
+{
+  ScopedLock l(get_lock());
+  return core->get_usage_mode();
+}
+
+
+void
+CoreThread::set_usage_mode(UsageMode mode)
+{
+  post_command(Message(COMMAND_SET_USAGE_MODE, 0, mode));
+}
+
+
+//! Sets the listener of the GUI. The core reports its events to us.
+void
+CoreThread::set_core_events_listener(ICoreEventListener *l)
+{
+  ScopedLock lock(get_lock());
+  listener = l;
+  core->set_core_events_listener(this);
+}
+
+
+void
+CoreThread::set_powersave(bool down)
+{
+  post_command(Message(COMMAND_SET_POWERSAVE, 0, down));
+}
+
+
+void
+CoreThread::time_changed()
+{
+  post_command(Message(COMMAND_TIME_CHANGED));
+}
+
+
+void
+CoreThread::set_insist_policy(InsistPolicy p)
+{
+  post_command(Message(COMMAND_SET_INSIST_POLICY, 0, p));
+}
+
+
+time_t
+CoreThread::get_time() const
+{
+  ScopedLock l(core->get_lock());
+  return core->get_time();
+}
+
+
+void
+CoreThread::force_idle()
+{
+  post_command(Message(COMMAND_FORCE_IDLE));
+}
+
+
+//! Keeps the break response of the core; the GUI responds to us.
+void
+CoreThread::set_break_response(IBreakResponse *rep)
+{
+  break_response = rep;
+  app->set_break_response(this);
+}
+
+
+void
+CoreThread::create_prelude_window(BreakId break_id)
+{
+  post_event(Message(EVENT_CREATE_PRELUDE_WINDOW, break_id));
+}
+
+
+void
+CoreThread::create_break_window(BreakId break_id, BreakHint break_hint)
+{
+  post_event(Message(EVENT_CREATE_BREAK_WINDOW, break_id, break_hint));
+}
+
+
+void
+CoreThread::hide_break_window()
+{
+  post_event(Message(EVENT_HIDE_BREAK_WINDOW));
+}
+
+
+void
+CoreThread::show_break_window()
+{
+  post_event(Message(EVENT_SHOW_BREAK_WINDOW));
+}
+
+
+void
+CoreThread::refresh_break_window()
+{
+  post_event(Message(EVENT_REFRESH_BREAK_WINDOW));
+}
+
+
+void
+CoreThread::set_break_progress(int value, int max_value)
+{
+  post_event(Message(EVENT_SET_BREAK_PROGRESS, value, max_value));
+}
+
+
+void
+CoreThread::set_prelude_stage(PreludeStage stage)
+{
+  post_event(Message(EVENT_SET_PRELUDE_STAGE, 0, stage));
+}
+
+
+void
+CoreThread::set_prelude_progress_text(PreludeProgressText text)
+{
+  post_event(Message(EVENT_SET_PRELUDE_PROGRESS_TEXT, 0, text));
+}
+
+
+void
+CoreThread::terminate()
+{
+  post_event(Message(EVENT_TERMINATE));
+}
+
+
+void
+CoreThread::core_event_notify(const CoreEvent event)
+{
+  post_event(Message(EVENT_CORE_EVENT, 0, event));
+}
+
+
+void
+CoreThread::core_event_operation_mode_changed(const OperationMode m)
+{
+  post_event(Message(EVENT_OPERATION_MODE_CHANGED, 0, m));
+}
+
+
+void
+CoreThread::core_event_usage_mode_changed(const UsageMode m)
+{
+  post_event(Message(EVENT_USAGE_MODE_CHANGED, 0, m));
+}
+
+
+void
+CoreThread::core_event_user_timer_limit_reached(const std::string &name)
+{
+  Message event(EVENT_USER_TIMER_LIMIT_REACHED);
+  event.text = name;
+  post_event(event);
+}
+
+
+void
+CoreThread::postpone_break(BreakId break_id)
+{
+  post_command(Message(COMMAND_POSTPONE_BREAK, break_id));
+}
+
+
+void
+CoreThread::skip_break(BreakId break_id)
+{
+  post_command(Message(COMMAND_SKIP_BREAK, break_id));
+}
+
+
+//! Sends a command to the core.
+/*!
+ *  If the core thread is not running, or if the caller is the core
+ *  thread itself, the command is executed immediately.
+ */
+void
+CoreThread::post_command(const Message &command)
+{
+  if (g_atomic_pointer_get(&core_thread) == NULL || is_core_thread())
+    {
+      ScopedLock l(get_lock());
+      execute_command(command);
+      return;
+    }
+
+  if (!commands.push(command))
+    {
+      TRACE_ENTER_MSG("CoreThread::post_command", command.type);
+      TRACE_MSG("Queue full, command dropped");
+      TRACE_EXIT();
+      return;
+    }
+
+  if (g_atomic_int_compare_and_exchange(&commands_scheduled, 0, 1))
+    {
+      GSource *source = g_idle_source_new();
+      g_source_set_callback(source, static_on_commands, this, NULL);
+      g_source_attach(source, context);
+      g_source_unref(source);
+    }
+}
+
+
+//! Sends an event to the GUI.
+/*!
+ *  If the caller is not the core thread (e.g. a D-BUS call handled on
+ *  the GUI thread), the event is delivered immediately.
+ */
+void
+CoreThread::post_event(const Message &event)
+{
+  if (!is_core_thread())
+    {
+      deliver_event(event);
+      return;
+    }
+
+  if (!events.push(event))
+    {
+      TRACE_ENTER_MSG("CoreThread::post_event", event.type);
+      TRACE_MSG("Queue full, event dropped");
+      TRACE_EXIT();
+      return;
+    }
+
+  if (g_atomic_int_compare_and_exchange(&events_scheduled, 0, 1))
+    {
+      g_idle_add(static_on_events, this);
+    }
+}
+
+
+//! Executes all pending commands. Must be called with the core lock held.
+void
+CoreThread::process_commands()
+{
+  Message command;
+  while (commands.pop(command))
+    {
+      execute_command(command);
+    }
+}
+
+
+//! Executes a command. Must be called with the core lock held.
+void
+CoreThread::execute_command(const Message &command)
+{
+  switch (command.type)
+    {
+    case COMMAND_FORCE_BREAK:
+      core->force_break(BreakId(command.id), BreakHint(command.value));
+      break;
+
+    case COMMAND_SET_OPERATION_MODE:
+      core->set_operation_mode(OperationMode(command.value));
+      break;
+
+    case COMMAND_SET_OPERATION_MODE_OVERRIDE:
+      core->set_operation_mode_override(OperationMode(command.value), command.text);
+      break;
+
+    case COMMAND_REMOVE_OPERATION_MODE_OVERRIDE:
+      core->remove_operation_mode_override(command.text);
+      break;
+
+    case COMMAND_SET_USAGE_MODE:
+      core->set_usage_mode(UsageMode(command.value));
+      break;
+
+    case COMMAND_SET_POWERSAVE:
+      core->set_powersave(command.value != 0);
+      break;
+
+    case COMMAND_TIME_CHANGED:
+      core->time_changed();
+      break;
+
+    case COMMAND_SET_INSIST_POLICY:
+      static_cast<ICore *>(core)->set_insist_policy(InsistPolicy(command.value));
+      break;
+
+    case COMMAND_FORCE_IDLE:
+      core->force_idle();
+      break;
+
+    case COMMAND_POSTPONE_BREAK:
+      if (break_response != NULL)
+        {
+          break_response->postpone_break(BreakId(command.id));
+        }
+      break;
+
+    case COMMAND_SKIP_BREAK:
+      if (break_response != NULL)
+        {
+          break_response->skip_break(BreakId(command.id));
+        }
+      break;
+
+    default:
+      break;
+    }
+}
+
+
+//! Delivers all pending events to the GUI. Must be called on the GUI thread.
+void
+CoreThread::process_events()
+{
+  Message event;
+  while (events.pop(event))
+    {
+      deliver_event(event);
+    }
+}
+
+
+//! Delivers an event to the GUI.
+void
+CoreThread::deliver_event(const Message &event)
+{
+  switch (event.type)
+    {
+    case EVENT_CREATE_PRELUDE_WINDOW:
+      app->create_prelude_window(BreakId(event.id));
+      break;
+
+    case EVENT_CREATE_BREAK_WINDOW:
+      app->create_break_window(BreakId(event.id), BreakHint(event.value));
+      break;
+
+    case EVENT_HIDE_BREAK_WINDOW:
+      app->hide_break_window();
+      break;
+
+    case EVENT_SHOW_BREAK_WINDOW:
+      app->show_break_window();
+      break;
+
+    case EVENT_REFRESH_BREAK_WINDOW:
+      app->refresh_break_window();
+      break;
+
+    case EVENT_SET_BREAK_PROGRESS:
+      app->set_break_progress(event.id, event.value);
+      break;
+
+    case EVENT_SET_PRELUDE_STAGE:
+      app->set_prelude_stage(PreludeStage(event.value));
+      break;
+
+    case EVENT_SET_PRELUDE_PROGRESS_TEXT:
+      app->set_prelude_progress_text(PreludeProgressText(event.value));
+      break;
+
+    case EVENT_TERMINATE:
+      app->terminate();
+      break;
+
+    case EVENT_CORE_EVENT:
+      if (listener != NULL)
+        {
+          listener->core_event_notify(CoreEvent(event.value));
+        }
+      break;
+
+    case EVENT_OPERATION_MODE_CHANGED:
+      if (listener != NULL)
+        {
+          listener->core_event_operation_mode_changed(OperationMode(event.value));
+        }
+      break;
+
+    case EVENT_USAGE_MODE_CHANGED:
+      if (listener != NULL)
+        {
+          listener->core_event_usage_mode_changed(UsageMode(event.value));
+        }
+      break;
+
+    case EVENT_USER_TIMER_LIMIT_REACHED:
+      if (listener != NULL)
+        {
+          listener->core_event_user_timer_limit_reached(event.text);
+        }
+      break;
+
+    case EVENT_CONFIG_CHANGED:
+      configurator->deliver((IConfiguratorListener *) event.target, event.text);
+      break;
+
+#ifdef HAVE_DISTRIBUTION
+    case EVENT_DISTRIBUTION_LOG:
+      distribution_manager->deliver((DistributionLogListener *) event.target, event.text);
+      break;
+#endif
+
+    default:
+      break;
+    }
+}
+
+
+//! Runs the heartbeat of the core, on the core thread.
+gboolean
+CoreThread::static_on_heartbeat(gpointer data)
+{
+  CoreThread *self = (CoreThread *) data;
+
+  self->process_commands();
+  static_cast<ICore *>(self->core)->heartbeat();
+  return TRUE;
+}
+
+
+//! Executes pending commands, on the core thread.
+gboolean
+CoreThread::static_on_commands(gpointer data)
+{
+  CoreThread *self = (CoreThread *) data;
+
+  g_atomic_int_set(&self->commands_scheduled, 0);
+  self->process_commands();
+  return FALSE;
+}
+
+
+//! Delivers pending events, on the GUI thread.
+gboolean
+CoreThread::static_on_events(gpointer data)
+{
+  CoreThread *self = (CoreThread *) data;
+
+  g_atomic_int_set(&self->events_scheduled, 0);
+  self->process_events();
+  return FALSE;
+}
+
+
+//! Waits for events of the core thread without holding the core lock.
+gint
+CoreThread::static_poll(GPollFD *fds, guint nfds, gint timeout)
+{
+  Mutex &lock = instance->get_lock();
+
+  lock.unlock();
+  gint ret = g_poll(fds, nfds, timeout);
+  lock.lock();
+
+  return ret;
+}
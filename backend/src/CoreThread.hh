@@ -0,0 +1,261 @@
+// CoreThread.hh --- Runs the core on a dedicated thread
+//
+// Copyright (C) 2017 Rob Caelers <robc@krandor.nl>
+// All rights reserved.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef CORETHREAD_HH
+#define CORETHREAD_HH
+
+#include <string>
+
+#include <glib.h>
+
+#include "ICore.hh"
+#include "IApp.hh"
+#include "IBreakResponse.hh"
+#include "ICoreEventListener.hh"
+#include "MessageQueue.hh"
+#include "Mutex.hh"
+#include "Runnable.hh"
+#include "Thread.hh"
+
+using namespace workrave;
+
+namespace workrave {
+  class IConfiguratorListener;
+  class DistributionLogListener;
+}
+
+class Core;
+class BreakProxy;
+class StatisticsProxy;
+class ConfiguratorProxy;
+class DistributionManagerProxy;
+
+//! Runs the core on a dedicated thread.
+/*!
+ *  The core thread has its own main context. It runs the heartbeat, and
+ *  all main loop sources of the core (distribution sockets, configuration
+ *  backend notifications), while holding the core lock. It only releases
+ *  the lock while waiting for the next event.
+ *
+ *  The GUI accesses the core through this class, which implements ICore
+ *  (and returns proxies for breaks, statistics and configuration):
+ *  - Requests that do not return a value are posted to the core thread
+ *    as commands.
+ *  - Queries briefly take the core lock. The core thread only holds the
+ *    lock while doing core work, so the GUI never waits for long; the
+ *    core thread never waits for the GUI.
+ *
+ *  Callbacks from the core to the GUI (IApp, ICoreEventListener and
+ *  configuration listeners of the GUI) are posted as events, and handled
+ *  on the GUI thread from the default main context and from heartbeat().
+ *
+ *  Commands and events use lock-free queues with a single producer each.
+ */
+class CoreThread :
+  public ICore,
+  public IApp,
+  public ICoreEventListener,
+  public IBreakResponse,
+  public Runnable
+{
+public:
+  static CoreThread *create();
+  static CoreThread *get_instance();
+
+  virtual ~CoreThread();
+
+  void stop();
+
+  bool is_core_thread() const;
+  Mutex &get_lock();
+
+  ConfiguratorProxy *get_configurator() const;
+
+  void post_config_changed(IConfiguratorListener *listener, const std::string &key);
+  void post_distribution_log(DistributionLogListener *listener, const std::string &msg);
+
+  // ICore
+  void init(int argc, char **argv, IApp *app, const std::string &display);
+  void heartbeat();
+  void force_break(BreakId id, BreakHint break_hint);
+  IBreak *get_break(BreakId id);
+  IBreak *get_break(std::string name);
+  IStatistics *get_statistics() const;
+#ifdef HAVE_DISTRIBUTION
+  IDistributionManager *get_distribution_manager() const;
+#endif
+  bool is_user_active() const;
+  OperationMode get_operation_mode();
+  OperationMode get_operation_mode_regular();
+  bool is_operation_mode_an_override();
+  void set_operation_mode(OperationMode mode);
+  void set_operation_mode_override(OperationMode mode, const std::string &id);
+  void remove_operation_mode_override(const std::string &id);
+  UsageMode get_usage_mode();
+  void set_usage_mode(UsageMode mode);
+  void set_core_events_listener(ICoreEventListener *l);
+  void set_powersave(bool down);
+  void time_changed();
+  void set_insist_policy(InsistPolicy p);
+  time_t get_time() const;
+  void force_idle();
+
+  // IApp
+  void set_break_response(IBreakResponse *rep);
+  void create_prelude_window(BreakId break_id);
+  void create_break_window(BreakId break_id, BreakHint break_hint);
+  void hide_break_window();
+  void show_break_window();
+  void refresh_break_window();
+  void set_break_progress(int value, int max_value);
+  void set_prelude_stage(PreludeStage stage);
+  void set_prelude_progress_text(PreludeProgressText text);
+  void terminate();
+
+  // ICoreEventListener
+  void core_event_notify(const CoreEvent event);
+  void core_event_operation_mode_changed(const OperationMode m);
+  void core_event_usage_mode_changed(const UsageMode m);
+  void core_event_user_timer_limit_reached(const std::string &name);
+
+  // IBreakResponse
+  void postpone_break(BreakId break_id);
+  void skip_break(BreakId break_id);
+
+  // Runnable
+  void run();
+
+private:
+  enum MessageType
+    {
+      // Commands, from the GUI to the core.
+      COMMAND_FORCE_BREAK,
+      COMMAND_SET_OPERATION_MODE,
+      COMMAND_SET_OPERATION_MODE_OVERRIDE,
+      COMMAND_REMOVE_OPERATION_MODE_OVERRIDE,
+      COMMAND_SET_USAGE_MODE,
+      COMMAND_SET_POWERSAVE,
+      COMMAND_TIME_CHANGED,
+      COMMAND_SET_INSIST_POLICY,
+      COMMAND_FORCE_IDLE,
+      COMMAND_POSTPONE_BREAK,
+      COMMAND_SKIP_BREAK,
+
+      // Events, from the core to the GUI.
+      EVENT_CREATE_PRELUDE_WINDOW,
+      EVENT_CREATE_BREAK_WINDOW,
+      EVENT_HIDE_BREAK_WINDOW,
+      EVENT_SHOW_BREAK_WINDOW,
+      EVENT_REFRESH_BREAK_WINDOW,
+      EVENT_SET_BREAK_PROGRESS,
+      EVENT_SET_PRELUDE_STAGE,
+      EVENT_SET_PRELUDE_PROGRESS_TEXT,
+      EVENT_TERMINATE,
+      EVENT_CORE_EVENT,
+      EVENT_OPERATION_MODE_CHANGED,
+      EVENT_USAGE_MODE_CHANGED,
+      EVENT_USER_TIMER_LIMIT_REACHED,
+      EVENT_CONFIG_CHANGED,
+      EVENT_DISTRIBUTION_LOG,
+    };
+
+  struct Message
+  {
+    Message(MessageType type = COMMAND_FORCE_IDLE, int id = 0, int value = 0)
+      : type(type), id(id), value(value), target(NULL)
+    {
+    }
+
+    MessageType type;
+    int id;
+    int value;
+    void *target;
+    std::string text;
+  };
+
+  CoreThread();
+
+  void post_command(const Message &command);
+  void post_event(const Message &event);
+  void process_commands();
+  void process_events();
+  void execute_command(const Message &command);
+  void deliver_event(const Message &event);
+
+  static gboolean static_on_heartbeat(gpointer data);
+  static gboolean static_on_commands(gpointer data);
+  static gboolean static_on_events(gpointer data);
+  static gint static_poll(GPollFD *fds, guint nfds, gint timeout);
+
+private:
+  //! The one and only instance.
+  static CoreThread *instance;
+
+  //! The core.
+  Core *core;
+
+  //! The GUI.
+  IApp *app;
+
+  //! Receives core events in the GUI.
+  ICoreEventListener *listener;
+
+  //! Handles break responses of the GUI in the core.
+  IBreakResponse *break_response;
+
+  //! Break proxies.
+  BreakProxy *breaks[BREAK_ID_SIZEOF];
+
+  //! Statistics proxy.
+  StatisticsProxy *statistics;
+
+  //! Configurator proxy.
+  ConfiguratorProxy *configurator;
+
+#ifdef HAVE_DISTRIBUTION
+  //! Distribution manager proxy.
+  DistributionManagerProxy *distribution_manager;
+#endif
+
+  //! The core thread.
+  Thread *thread;
+
+  //! The thread as seen by glib, NULL if not running.
+  GThread *volatile core_thread;
+
+  //! Main context of the core thread.
+  GMainContext *context;
+
+  //! Main loop of the core thread.
+  GMainLoop *loop;
+
+  //! Commands from the GUI to the core.
+  MessageQueue<Message> commands;
+
+  //! Events from the core to the GUI.
+  MessageQueue<Message> events;
+
+  //! Is a dispatch of commands scheduled?
+  volatile gint commands_scheduled;
+
+  //! Is a dispatch of events scheduled?
+  volatile gint events_scheduled;
+};
+
+#endif // CORETHREAD_HH
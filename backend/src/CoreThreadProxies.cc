@@ -0,0 +1,841 @@
+// CoreThreadProxies.cc --- Access to core objects from the GUI thread
+//
+// Copyright (C) 2017 Rob Caelers <robc@krandor.nl>
+// All rights reserved.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "debug.hh"
+
+#include "CoreThreadProxies.hh"
+#include "CoreThread.hh"
+#include "Mutex.hh"
+
+using namespace std;
+
+BreakProxy::BreakProxy(CoreThread *core_thread, IBreak *target) :
+  core_thread(core_thread),
+  target(target)
+{
+}
+
+
+Mutex &
+BreakProxy::lock() const
+{
+  return core_thread->get_lock();
+}
+
+
+std::string
+BreakProxy::get_name() const
+{
+  ScopedLock l(lock());
+  return target->get_name();
+}
+
+
+BreakId
+BreakProxy::get_id() const
+{
+  ScopedLock l(lock());
+  return target->get_id();
+}
+
+
+bool
+BreakProxy::is_enabled() const
+{
+  ScopedLock l(lock());
+  return target->is_enabled();
+}
+
+
+bool
+BreakProxy::is_running() const
+{
+  ScopedLock l(lock());
+  return target->is_running();
+}
+
+
+time_t
+BreakProxy::get_elapsed_time() const
+{
+  ScopedLock l(lock());
+  return target->get_elapsed_time();
+}
+
+
+time_t
+BreakProxy::get_elapsed_idle_time() const
+{
+  ScopedLock l(lock());
+  return target->get_elapsed_idle_time();
+}
+
+
+time_t
+BreakProxy::get_auto_reset() const
+{
+  ScopedLock l(lock());
+  return target->get_auto_reset();
+}
+
+
+bool
+BreakProxy::is_auto_reset_enabled() const
+{
+  ScopedLock l(lock());
+  return target->is_auto_reset_enabled();
+}
+
+
+time_t
+BreakProxy::get_limit() const
+{
+  ScopedLock l(lock());
+  return target->get_limit();
+}
+
+
+bool
+BreakProxy::is_limit_enabled() const
+{
+  ScopedLock l(lock());
+  return target->is_limit_enabled();
+}
+
+
+bool
+BreakProxy::is_taking() const
+{
+  ScopedLock l(lock());
+  return target->is_taking();
+}
+
+
+StatisticsProxy::StatisticsProxy(CoreThread *core_thread, IStatistics *target) :
+  core_thread(core_thread),
+  target(target)
+{
+}
+
+
+Mutex &
+StatisticsProxy::lock() const
+{
+  return core_thread->get_lock();
+}
+
+
+bool
+StatisticsProxy::delete_all_history()
+{
+  ScopedLock l(lock());
+  return target->delete_all_history();
+}
+
+
+void
+StatisticsProxy::update()
+{
+  ScopedLock l(lock());
+  target->update();
+}
+
+
+bool
+StatisticsProxy::get_current_day(DailyStats &stats) const
+{
+  ScopedLock l(lock());
+  return target->get_current_day(stats);
+}
+
+
+bool
+StatisticsProxy::get_day(int day, DailyStats &stats) const
+{
+  ScopedLock l(lock());
+  return target->get_day(day, stats);
+}
+
+
+void
+StatisticsProxy::get_day_index_by_date(int y, int m, int d, int &idx, int &next, int &prev) const
+{
+  ScopedLock l(lock());
+  target->get_day_index_by_date(y, m, d, idx, next, prev);
+}
+
+
+int
+StatisticsProxy::get_history_size() const
+{
+  ScopedLock l(lock());
+  return target->get_history_size();
+}
+
+
+void
+StatisticsProxy::dump()
+{
+  ScopedLock l(lock());
+  target->dump();
+}
+
+
+int64_t
+StatisticsProxy::get_value_aggregate(StatsValueType value, AggregateType type,
+                                     const struct tm &first, const struct tm &last,
+                                     int weekdays) const
+{
+  ScopedLock l(lock());
+  return target->get_value_aggregate(value, type, first, last, weekdays);
+}
+
+
+int64_t
+StatisticsProxy::get_break_value_aggregate(BreakId break_id, StatsBreakValueType value,
+                                           AggregateType type,
+                                           const struct tm &first, const struct tm &last,
+                                           int weekdays) const
+{
+  ScopedLock l(lock());
+  return target->get_break_value_aggregate(break_id, value, type, first, last, weekdays);
+}
+
+
+int
+StatisticsProxy::get_day_count(const struct tm &first, const struct tm &last, int weekdays) const
+{
+  ScopedLock l(lock());
+  return target->get_day_count(first, last, weekdays);
+}
+
+
+bool
+StatisticsProxy::get_series(StatsSeriesType series, const struct tm &date,
+                            int first, int last, std::vector<int> &values) const
+{
+  ScopedLock l(lock());
+  return target->get_series(series, date, first, last, values);
+}
+
+
+ConfiguratorProxy::Adapter::Adapter(CoreThread *core_thread, IConfiguratorListener *listener) :
+  core_thread(core_thread),
+  listener(listener)
+{
+}
+
+
+//! Passes a change to the GUI listener, on the GUI thread.
+void
+ConfiguratorProxy::Adapter::config_changed_notify(const string &key)
+{
+  if (core_thread->is_core_thread())
+    {
+      core_thread->post_config_changed(listener, key);
+    }
+  else
+    {
+      listener->config_changed_notify(key);
+    }
+}
+
+
+ConfiguratorProxy::ConfiguratorProxy(CoreThread *core_thread, IConfigurator *target) :
+  core_thread(core_thread),
+  target(target)
+{
+}
+
+
+ConfiguratorProxy::~ConfiguratorProxy()
+{
+  ScopedLock l(lock());
+
+  for (AdapterIter i = adapters.begin(); i != adapters.end(); i++)
+    {
+      target->remove_listener(i->second);
+      delete i->second;
+    }
+  adapters.clear();
+}
+
+
+Mutex &
+ConfiguratorProxy::lock() const
+{
+  return core_thread->get_lock();
+}
+
+
+void
+ConfiguratorProxy::deliver(IConfiguratorListener *listener, const string &key)
+{
+  bool registered = false;
+  {
+    ScopedLock l(lock());
+    registered = adapters.find(listener) != adapters.end();
+  }
+
+  if (registered)
+    {
+      listener->config_changed_notify(key);
+    }
+}
+
+
+void
+ConfiguratorProxy::set_delay(const string &key, int delay)
+{
+  ScopedLock l(lock());
+  target->set_delay(key, delay);
+}
+
+
+bool
+ConfiguratorProxy::load(string filename)
+{
+  ScopedLock l(lock());
+  return target->load(filename);
+}
+
+
+bool
+ConfiguratorProxy::save(string filename)
+{
+  ScopedLock l(lock());
+  return target->save(filename);
+}
+
+
+bool
+ConfiguratorProxy::save()
+{
+  ScopedLock l(lock());
+  return target->save();
+}
+
+
+bool
+ConfiguratorProxy::remove_key(const string &key) const
+{
+  ScopedLock l(lock());
+  return target->remove_key(key);
+}
+
+
+bool
+ConfiguratorProxy::rename_key(const string &key, const string &new_key)
+{
+  ScopedLock l(lock());
+  return target->rename_key(key, new_key);
+}
+
+
+bool
+ConfiguratorProxy::get_value(const string &key, string &out) const
+{
+  ScopedLock l(lock());
+  return target->get_value(key, out);
+}
+
+
+bool
+ConfiguratorProxy::get_value(const string &key, bool &out) const
+{
+  ScopedLock l(lock());
+  return target->get_value(key, out);
+}
+
+
+bool
+ConfiguratorProxy::get_value(const string &key, int &out) const
+{
+  ScopedLock l(lock());
+  return target->get_value(key, out);
+}
+
+
+bool
+ConfiguratorProxy::get_value(const string &key, double &out) const
+{
+  ScopedLock l(lock());
+  return target->get_value(key, out);
+}
+
+
+void
+ConfiguratorProxy::get_value_with_default(const string &key, string &out, string s) const
+{
+  ScopedLock l(lock());
+  target->get_value_with_default(key, out, s);
+}
+
+
+void
+ConfiguratorProxy::get_value_with_default(const string &key, bool &out, const bool def) const
+{
+  ScopedLock l(lock());
+  target->get_value_with_default(key, out, def);
+}
+
+
+void
+ConfiguratorProxy::get_value_with_default(const string &key, int &out, const int def) const
+{
+  ScopedLock l(lock());
+  target->get_value_with_default(key, out, def);
+}
+
+
+void
+ConfiguratorProxy::get_value_with_default(const string &key, double &out, const double def) const
+{
+  ScopedLock l(lock());
+  target->get_value_with_default(key, out, def);
+}
+
+
+bool
+ConfiguratorProxy::set_value(const string &key, const string &v, ConfigFlags flags)
+{
+  ScopedLock l(lock());
+  return target->set_value(key, v, flags);
+}
+
+
+bool
+ConfiguratorProxy::set_value(const string &key, const char *v, ConfigFlags flags)
+{
+  ScopedLock l(lock());
+  return target->set_value(key, v, flags);
+}
+
+
+bool
+ConfiguratorProxy::set_value(const string &key, int v, ConfigFlags flags)
+{
+  ScopedLock l(lock());
+  return target->set_value(key, v, flags);
+}
+
+
+bool
+ConfiguratorProxy::set_value(const string &key, bool v, ConfigFlags flags)
+{
+  ScopedLock l(lock());
+  return target->set_value(key, v, flags);
+}
+
+
+bool
+ConfiguratorProxy::set_value(const string &key, double v, ConfigFlags flags)
+{
+  ScopedLock l(lock());
+  return target->set_value(key, v, flags);
+}
+
+
+bool
+ConfiguratorProxy::get_typed_value(const string &key, string &t) const
+{
+  ScopedLock l(lock());
+  return target->get_typed_value(key, t);
+}
+
+
+bool
+ConfiguratorProxy::set_typed_value(const string &key, const string &t)
+{
+  ScopedLock l(lock());
+  return target->set_typed_value(key, t);
+}
+
+
+bool
+ConfiguratorProxy::add_listener(const string &key_prefix, IConfiguratorListener *listener)
+{
+  ScopedLock l(lock());
+
+  Adapter *adapter = NULL;
+  AdapterIter i = adapters.find(listener);
+  if (i != adapters.end())
+    {
+      adapter = i->second;
+    }
+  else
+    {
+      adapter = new Adapter(core_thread, listener);
+      adapters[listener] = adapter;
+    }
+
+  return target->add_listener(key_prefix, adapter);
+}
+
+
+bool
+ConfiguratorProxy::remove_listener(IConfiguratorListener *listener)
+{
+  ScopedLock l(lock());
+
+  AdapterIter i = adapters.find(listener);
+  if (i == adapters.end())
+    {
+      return false;
+    }
+
+  bool ret = target->remove_listener(i->second);
+  delete i->second;
+  adapters.erase(i);
+  return ret;
+}
+
+
+bool
+ConfiguratorProxy::remove_listener(const string &key_prefix, IConfiguratorListener *listener)
+{
+  ScopedLock l(lock());
+
+  AdapterIter i = adapters.find(listener);
+  if (i == adapters.end())
+    {
+      return false;
+    }
+
+  bool ret = target->remove_listener(key_prefix, i->second);
+
+  string key;
+  if (!target->find_listener(i->second, key))
+    {
+      delete i->second;
+      adapters.erase(i);
+    }
+  return ret;
+}
+
+
+bool
+ConfiguratorProxy::find_listener(IConfiguratorListener *listener, string &key) const
+{
+  ScopedLock l(lock());
+
+  Adapters::const_iterator i = adapters.find(listener);
+  if (i == adapters.end())
+    {
+      return false;
+    }
+  return target->find_listener(i->second, key);
+}
+
+
+#ifdef HAVE_DISTRIBUTION
+DistributionManagerProxy::Adapter::Adapter(CoreThread *core_thread, DistributionLogListener *listener) :
+  core_thread(core_thread),
+  listener(listener)
+{
+}
+
+
+//! Passes a log message to the GUI listener, on the GUI thread.
+void
+DistributionManagerProxy::Adapter::distribution_log(string msg)
+{
+  if (core_thread->is_core_thread())
+    {
+      core_thread->post_distribution_log(listener, msg);
+    }
+  else
+    {
+      listener->distribution_log(msg);
+    }
+}
+
+
+DistributionManagerProxy::DistributionManagerProxy(CoreThread *core_thread, IDistributionManager *target) :
+  core_thread(core_thread),
+  target(target)
+{
+}
+
+
+DistributionManagerProxy::~DistributionManagerProxy()
+{
+  ScopedLock l(lock());
+
+  for (AdapterIter i = adapters.begin(); i != adapters.end(); i++)
+    {
+      target->remove_log_listener(i->second);
+      delete i->second;
+    }
+  adapters.clear();
+}
+
+
+Mutex &
+DistributionManagerProxy::lock() const
+{
+  return core_thread->get_lock();
+}
+
+
+void
+DistributionManagerProxy::deliver(DistributionLogListener *listener, const string &msg)
+{
+  bool registered = false;
+  {
+    ScopedLock l(lock());
+    registered = adapters.find(listener) != adapters.end();
+  }
+
+  if (registered)
+    {
+      listener->distribution_log(msg);
+    }
+}
+
+
+bool
+DistributionManagerProxy::add_log_listener(DistributionLogListener *listener)
+{
+  ScopedLock l(lock());
+
+  if (adapters.find(listener) != adapters.end())
+    {
+      return false;
+    }
+
+  Adapter *adapter = new Adapter(core_thread, listener);
+  adapters[listener] = adapter;
+  return target->add_log_listener(adapter);
+}
+
+
+bool
+DistributionManagerProxy::remove_log_listener(DistributionLogListener *listener)
+{
+  ScopedLock l(lock());
+
+  AdapterIter i = adapters.find(listener);
+  if (i == adapters.end())
+    {
+      return false;
+    }
+
+  bool ret = target->remove_log_listener(i->second);
+  delete i->second;
+  adapters.erase(i);
+  return ret;
+}
+
+
+bool
+DistributionManagerProxy::is_master() const
+{
+  ScopedLock l(lock());
+  return target->is_master();
+}
+
+
+int
+DistributionManagerProxy::get_number_of_peers()
+{
+  ScopedLock l(lock());
+  return target->get_number_of_peers();
+}
+
+
+bool
+DistributionManagerProxy::connect(string url)
+{
+  ScopedLock l(lock());
+  return target->connect(url);
+}
+
+
+bool
+DistributionManagerProxy::disconnect_all()
+{
+  ScopedLock l(lock());
+  return target->disconnect_all();
+}
+
+
+bool
+DistributionManagerProxy::reconnect_all()
+{
+  ScopedLock l(lock());
+  return target->reconnect_all();
+}
+
+
+list<string>
+DistributionManagerProxy::get_logs() const
+{
+  ScopedLock l(lock());
+  return target->get_logs();
+}
+
+
+bool
+DistributionManagerProxy::add_peer(string peer)
+{
+  ScopedLock l(lock());
+  return target->add_peer(peer);
+}
+
+
+bool
+DistributionManagerProxy::remove_peer(string peer)
+{
+  ScopedLock l(lock());
+  return target->remove_peer(peer);
+}
+
+
+void
+DistributionManagerProxy::set_peers(string peers, bool connect)
+{
+  ScopedLock l(lock());
+  target->set_peers(peers, connect);
+}
+
+
+list<string>
+DistributionManagerProxy::get_peers() const
+{
+  ScopedLock l(lock());
+  return target->get_peers();
+}
+
+
+bool
+DistributionManagerProxy::get_enabled() const
+{
+  ScopedLock l(lock());
+  return target->get_enabled();
+}
+
+
+void
+DistributionManagerProxy::set_enabled(bool b)
+{
+  ScopedLock l(lock());
+  target->set_enabled(b);
+}
+
+
+bool
+DistributionManagerProxy::get_listening() const
+{
+  ScopedLock l(lock());
+  return target->get_listening();
+}
+
+
+void
+DistributionManagerProxy::set_listening(bool b)
+{
+  ScopedLock l(lock());
+  target->set_listening(b);
+}
+
+
+string
+DistributionManagerProxy::get_username() const
+{
+  ScopedLock l(lock());
+  return target->get_username();
+}
+
+
+void
+DistributionManagerProxy::set_username(string name)
+{
+  ScopedLock l(lock());
+  target->set_username(name);
+}
+
+
+string
+DistributionManagerProxy::get_password() const
+{
+  ScopedLock l(lock());
+  return target->get_password();
+}
+
+
+void
+DistributionManagerProxy::set_password(string name)
+{
+  ScopedLock l(lock());
+  target->set_password(name);
+}
+
+
+int
+DistributionManagerProxy::get_port() const
+{
+  ScopedLock l(lock());
+  return target->get_port();
+}
+
+
+void
+DistributionManagerProxy::set_port(int v)
+{
+  ScopedLock l(lock());
+  target->set_port(v);
+}
+
+
+int
+DistributionManagerProxy::get_reconnect_attempts() const
+{
+  ScopedLock l(lock());
+  return target->get_reconnect_attempts();
+}
+
+
+void
+DistributionManagerProxy::set_reconnect_attempts(int v)
+{
+  ScopedLock l(lock());
+  target->set_reconnect_attempts(v);
+}
+
+
+int
+DistributionManagerProxy::get_reconnect_interval() const
+{
+  ScopedLock l(lock());
+  return target->get_reconnect_interval();
+}
+
+
+void
+DistributionManagerProxy::set_reconnect_interval(int v)
+{
+  ScopedLock l(lock());
+  target->set_reconnect_interval(v);
+}
+#endif
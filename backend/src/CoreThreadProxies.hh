@@ -0,0 +1,236 @@
+// CoreThreadProxies.hh --- Access to core objects from the GUI thread
+//
+// Copyright (C) 2017 Rob Caelers <robc@krandor.nl>
+// All rights reserved.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef CORETHREADPROXIES_HH
+#define CORETHREADPROXIES_HH
+
+#include <map>
+#include <string>
+
+#include "IBreak.hh"
+#include "IStatistics.hh"
+#include "IConfigurator.hh"
+#include "IConfiguratorListener.hh"
+#ifdef HAVE_DISTRIBUTION
+#include "IDistributionManager.hh"
+#include "DistributionLogListener.hh"
+#endif
+
+using namespace workrave;
+
+class CoreThread;
+class Mutex;
+
+//! Access to a break from the GUI thread.
+class BreakProxy : public IBreak
+{
+public:
+  BreakProxy(CoreThread *core_thread, IBreak *target);
+
+  std::string get_name() const;
+  BreakId get_id() const;
+  bool is_enabled() const;
+  bool is_running() const;
+  time_t get_elapsed_time() const;
+  time_t get_elapsed_idle_time() const;
+  time_t get_auto_reset() const;
+  bool is_auto_reset_enabled() const;
+  time_t get_limit() const;
+  bool is_limit_enabled() const;
+  bool is_taking() const;
+
+private:
+  Mutex &lock() const;
+
+  CoreThread *core_thread;
+  IBreak *target;
+};
+
+
+//! Access to the statistics from the GUI thread.
+/*!
+ *  Days are copied while the core is locked, as the core thread replaces
+ *  the current day and frees archived days.
+ */
+class StatisticsProxy : public IStatistics
+{
+public:
+  StatisticsProxy(CoreThread *core_thread, IStatistics *target);
+
+  bool delete_all_history();
+  void update();
+  bool get_current_day(DailyStats &stats) const;
+  bool get_day(int day, DailyStats &stats) const;
+  void get_day_index_by_date(int y, int m, int d, int &idx, int &next, int &prev) const;
+  int get_history_size() const;
+  void dump();
+  int64_t get_value_aggregate(StatsValueType value, AggregateType type,
+                              const struct tm &first, const struct tm &last,
+                              int weekdays = WEEKDAY_ALL) const;
+  int64_t get_break_value_aggregate(BreakId break_id, StatsBreakValueType value,
+                                    AggregateType type,
+                                    const struct tm &first, const struct tm &last,
+                                    int weekdays = WEEKDAY_ALL) const;
+  int get_day_count(const struct tm &first, const struct tm &last,
+                    int weekdays = WEEKDAY_ALL) const;
+  bool get_series(StatsSeriesType series, const struct tm &date,
+                  int first, int last, std::vector<int> &values) const;
+
+private:
+  Mutex &lock() const;
+
+  CoreThread *core_thread;
+  IStatistics *target;
+};
+
+
+//! Access to the configuration from the GUI thread.
+/*!
+ *  Listeners added through the proxy are notified on the GUI thread:
+ *  changes made by the core thread are posted to the GUI as events.
+ */
+class ConfiguratorProxy : public IConfigurator
+{
+public:
+  ConfiguratorProxy(CoreThread *core_thread, IConfigurator *target);
+  virtual ~ConfiguratorProxy();
+
+  //! Notifies a listener of the GUI, unless it was removed in the meantime.
+  void deliver(IConfiguratorListener *listener, const std::string &key);
+
+  void set_delay(const std::string &key, int delay);
+  bool load(std::string filename);
+  bool save(std::string filename);
+  bool save();
+  bool remove_key(const std::string &key) const;
+  bool rename_key(const std::string &key, const std::string &new_key);
+  bool get_value(const std::string &key, std::string &out) const;
+  bool get_value(const std::string &key, bool &out) const;
+  bool get_value(const std::string &key, int &out) const;
+  bool get_value(const std::string &key, double &out) const;
+  void get_value_with_default(const std::string &key, std::string &out, std::string s) const;
+  void get_value_with_default(const std::string &key, bool &out, const bool def) const;
+  void get_value_with_default(const std::string &key, int &out, const int def) const;
+  void get_value_with_default(const std::string &key, double &out, const double def) const;
+  bool set_value(const std::string &key, const std::string &v, ConfigFlags flags = CONFIG_FLAG_NONE);
+  bool set_value(const std::string &key, const char *v, ConfigFlags flags = CONFIG_FLAG_NONE);
+  bool set_value(const std::string &key, int v, ConfigFlags flags = CONFIG_FLAG_NONE);
+  bool set_value(const std::string &key, bool v, ConfigFlags flags = CONFIG_FLAG_NONE);
+  bool set_value(const std::string &key, double v, ConfigFlags flags = CONFIG_FLAG_NONE);
+  bool get_typed_value(const std::string &key, std::string &t) const;
+  bool set_typed_value(const std::string &key, const std::string &t);
+  bool add_listener(const std::string &key_prefix, IConfiguratorListener *listener);
+  bool remove_listener(IConfiguratorListener *listener);
+  bool remove_listener(const std::string &key_prefix, IConfiguratorListener *listener);
+  bool find_listener(IConfiguratorListener *listener, std::string &key) const;
+
+private:
+  //! Registered with the configurator on behalf of a GUI listener.
+  class Adapter : public IConfiguratorListener
+  {
+  public:
+    Adapter(CoreThread *core_thread, IConfiguratorListener *listener);
+    void config_changed_notify(const std::string &key);
+
+  private:
+    CoreThread *core_thread;
+    IConfiguratorListener *listener;
+  };
+
+  typedef std::map<IConfiguratorListener *, Adapter *> Adapters;
+  typedef Adapters::iterator AdapterIter;
+
+  Mutex &lock() const;
+
+  CoreThread *core_thread;
+  IConfigurator *target;
+
+  //! Adapters by GUI listener.
+  Adapters adapters;
+};
+
+
+#ifdef HAVE_DISTRIBUTION
+//! Access to the distribution manager from the GUI thread.
+/*!
+ *  Log listeners added through the proxy are notified on the GUI thread.
+ */
+class DistributionManagerProxy : public IDistributionManager
+{
+public:
+  DistributionManagerProxy(CoreThread *core_thread, IDistributionManager *target);
+  virtual ~DistributionManagerProxy();
+
+  //! Notifies a log listener of the GUI, unless it was removed in the meantime.
+  void deliver(DistributionLogListener *listener, const std::string &msg);
+
+  bool is_master() const;
+  int get_number_of_peers();
+  bool connect(string url);
+  bool disconnect_all();
+  bool reconnect_all();
+  bool add_log_listener(DistributionLogListener *listener);
+  bool remove_log_listener(DistributionLogListener *listener);
+  list<string> get_logs() const;
+  bool add_peer(string peer);
+  bool remove_peer(string peer);
+  void set_peers(string peers, bool connect = true);
+  list<string> get_peers() const;
+  bool get_enabled() const;
+  void set_enabled(bool b);
+  bool get_listening() const;
+  void set_listening(bool b);
+  string get_username() const;
+  void set_username(string name);
+  string get_password() const;
+  void set_password(string name);
+  int get_port() const;
+  void set_port(int v);
+  int get_reconnect_attempts() const;
+  void set_reconnect_attempts(int v);
+  int get_reconnect_interval() const;
+  void set_reconnect_interval(int v);
+
+private:
+  //! Registered with the distribution manager on behalf of a GUI listener.
+  class Adapter : public DistributionLogListener
+  {
+  public:
+    Adapter(CoreThread *core_thread, DistributionLogListener *listener);
+    void distribution_log(string msg);
+
+  private:
+    CoreThread *core_thread;
+    DistributionLogListener *listener;
+  };
+
+  typedef std::map<DistributionLogListener *, Adapter *> Adapters;
+  typedef Adapters::iterator AdapterIter;
+
+  Mutex &lock() const;
+
+  CoreThread *core_thread;
+  IDistributionManager *target;
+
+  //! Adapters by GUI listener.
+  Adapters adapters;
+};
+#endif
+
+#endif // CORETHREADPROXIES_HH
@@ -0,0 +1,446 @@
+// CronTimePred.cc --- Calendar based time predicate
+//
+// Copyright (C) 2017 Rob Caelers <robc@krandor.nl>
+// All rights reserved.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <sstream>
+#include <string.h>
+#include <stdlib.h>
+#include <vector>
+
+#include "debug.hh"
+
+#include "ICore.hh"
+#include "Core.hh"
+#include "CronTimePred.hh"
+
+using namespace std;
+using namespace workrave;
+
+//! Number of days to search for a match, enough to reach a 29th of February on a given weekday.
+static const int MAX_DAYS = 28 * 366 + 1;
+
+//! Minutes per day.
+static const int DAY_MINUTES = 24 * 60;
+
+static const char *const weekday_names[] = { "sun", "mon", "tue", "wed", "thu", "fri", "sat", NULL };
+static const char *const month_names[] = { "jan", "feb", "mar", "apr", "may", "jun",
+                                           "jul", "aug", "sep", "oct", "nov", "dec", NULL };
+
+#define BIT(n) (G_GUINT64_CONSTANT(1) << (n))
+
+//! Weekdays in cron order.
+static const guint64 ALL_WEEKDAYS = 0x7f;
+static const guint64 WORKDAYS = 0x3e;
+
+
+CronTimePred::CronTimePred() :
+  minutes(0),
+  hours(0),
+  days(0),
+  months(0),
+  weekdays(0),
+  either_day(false)
+{
+  next_minute[DAY_MINUTES] = -1;
+  cached_day.julian = 0;
+  cached_day.start = 0;
+  cached_day.end = 0;
+}
+
+
+//! Compiles the specification.
+/*!
+ *  \param type one of day, workday, week and cron.
+ *  \param spec the specification, without the type.
+ */
+bool
+CronTimePred::init(const string &type, const string &spec)
+{
+  TRACE_ENTER_MSG("CronTimePred::init", type << "/" << spec);
+
+  this->type = type;
+  this->spec = spec;
+
+  minutes = 0;
+  hours = 0;
+  days = (BIT(32) - 1) & ~BIT(0);
+  months = (BIT(13) - 1) & ~BIT(0);
+  weekdays = ALL_WEEKDAYS;
+  either_day = false;
+
+  bool ret = false;
+  if (type == "day")
+    {
+      ret = parse_time(spec);
+    }
+  else if (type == "workday")
+    {
+      ret = parse_time(spec);
+      weekdays = WORKDAYS;
+    }
+  else if (type == "week")
+    {
+      string::size_type pos = spec.find(' ');
+      string::size_type time_pos = spec.find_first_not_of(' ', pos);
+      ret = (time_pos != string::npos &&
+             parse_weekdays(spec.substr(0, pos)) &&
+             parse_time(spec.substr(time_pos)));
+    }
+  else if (type == "cron")
+    {
+      ret = parse_cron(spec);
+    }
+
+  if (ret)
+    {
+      compile();
+    }
+
+  TRACE_RETURN(ret);
+  return ret;
+}
+
+
+//! Sets the last time the predicate matched.
+void
+CronTimePred::set_last(time_t lastTime)
+{
+  last_time = lastTime;
+
+  if (last_time == 0)
+    {
+      ICore *core = Core::get_instance();
+      last_time = core->get_time();
+    }
+}
+
+
+//! Computes the first matching minute after the last match.
+/*!
+ *  \return the time of the next match, or 0 if the predicate never matches.
+ */
+time_t
+CronTimePred::get_next()
+{
+  GDate date;
+  g_date_clear(&date, 1);
+
+  int minute;
+  if (last_time >= cached_day.start && last_time < cached_day.end &&
+      cached_day.end - cached_day.start == DAY_MINUTES * 60)
+    {
+      g_date_set_julian(&date, cached_day.julian);
+      minute = (int) ((last_time - cached_day.start) / 60);
+    }
+  else
+    {
+      struct tm tm;
+      if (localtime_r(&last_time, &tm) == NULL)
+        {
+          return 0;
+        }
+
+      g_date_set_dmy(&date, tm.tm_mday, (GDateMonth) (tm.tm_mon + 1), tm.tm_year + 1900);
+      minute = tm.tm_hour * 60 + tm.tm_min;
+    }
+
+  // Strictly after the last match.
+  minute++;
+
+  for (int n = 0; n < MAX_DAYS; n++)
+    {
+      if (matches_day(date))
+        {
+          int next = next_minute[minute];
+          if (next != -1)
+            {
+              return get_time(date, next);
+            }
+        }
+
+      minute = 0;
+      g_date_add_days(&date, 1);
+    }
+
+  return 0;
+}
+
+
+string
+CronTimePred::to_string() const
+{
+  return type + "/" + spec;
+}
+
+
+//! Parses a time of day (e.g. 4:00).
+bool
+CronTimePred::parse_time(const string &spec)
+{
+  string::size_type pos = spec.find(':');
+  if (pos == string::npos)
+    {
+      return false;
+    }
+
+  int hour, minute;
+  if (!parse_value(spec.substr(0, pos), 0, 23, NULL, hour) ||
+      !parse_value(spec.substr(pos + 1), 0, 59, NULL, minute))
+    {
+      return false;
+    }
+
+  hours = BIT(hour);
+  minutes = BIT(minute);
+  return true;
+}
+
+
+//! Parses the five fields of a cron(5) time specification.
+bool
+CronTimePred::parse_cron(const string &spec)
+{
+  istringstream ss(spec);
+  vector<string> fields;
+
+  string field;
+  while (ss >> field)
+    {
+      fields.push_back(field);
+    }
+
+  if (fields.size() != 5 ||
+      !parse_field(fields[0], 0, 59, NULL, minutes) ||
+      !parse_field(fields[1], 0, 23, NULL, hours) ||
+      !parse_field(fields[2], 1, 31, NULL, days) ||
+      !parse_field(fields[3], 1, 12, month_names, months) ||
+      !parse_weekdays(fields[4]))
+    {
+      return false;
+    }
+
+  // As cron: if both the day of the month and the weekday are restricted,
+  // either one must match.
+  either_day = fields[2][0] != '*' && fields[4][0] != '*';
+  return true;
+}
+
+
+//! Parses a list of weekdays. Both 0 and 7 are Sunday.
+bool
+CronTimePred::parse_weekdays(const string &spec)
+{
+  if (!parse_field(spec, 0, 7, weekday_names, weekdays))
+    {
+      return false;
+    }
+
+  if (weekdays & BIT(7))
+    {
+      weekdays = (weekdays & ~BIT(7)) | BIT(0);
+    }
+  return true;
+}
+
+
+//! Parses a cron field: a list of values, ranges and steps (e.g. 1-5,0/15,*/2).
+bool
+CronTimePred::parse_field(const string &field, int min, int max, const char *const *names, guint64 &mask)
+{
+  mask = 0;
+
+  istringstream ss(field);
+  string item;
+  while (getline(ss, item, ','))
+    {
+      int step = 1;
+      bool has_step = false;
+
+      string::size_type pos = item.find('/');
+      if (pos != string::npos)
+        {
+          if (!parse_value(item.substr(pos + 1), 1, max, NULL, step))
+            {
+              return false;
+            }
+          has_step = true;
+          item = item.substr(0, pos);
+        }
+
+      int low, high;
+      pos = item.find('-');
+      if (item == "*")
+        {
+          low = min;
+          high = max;
+        }
+      else if (pos != string::npos)
+        {
+          if (!parse_value(item.substr(0, pos), min, max, names, low) ||
+              !parse_value(item.substr(pos + 1), min, max, names, high) ||
+              low > high)
+            {
+              return false;
+            }
+        }
+      else
+        {
+          if (!parse_value(item, min, max, names, low))
+            {
+              return false;
+            }
+          high = has_step ? max : low;
+        }
+
+      for (int v = low; v <= high; v += step)
+        {
+          mask |= BIT(v);
+        }
+    }
+
+  return mask != 0;
+}
+
+
+//! Parses a number, or a name if names are specified.
+bool
+CronTimePred::parse_value(const string &value, int min, int max, const char *const *names, int &result)
+{
+  for (int i = 0; names != NULL && names[i] != NULL; i++)
+    {
+      if (g_ascii_strcasecmp(value.c_str(), names[i]) == 0)
+        {
+          result = min + i;
+          return true;
+        }
+    }
+
+  if (value.empty() || value.size() > 2 || value.find_first_not_of("0123456789") != string::npos)
+    {
+      return false;
+    }
+
+  result = atoi(value.c_str());
+  return result >= min && result <= max;
+}
+
+
+//! Builds the table of next matching minutes.
+void
+CronTimePred::compile()
+{
+  gint16 next = -1;
+  for (int m = DAY_MINUTES - 1; m >= 0; m--)
+    {
+      if ((hours & BIT(m / 60)) && (minutes & BIT(m % 60)))
+        {
+          next = (gint16) m;
+        }
+      next_minute[m] = next;
+    }
+  next_minute[DAY_MINUTES] = -1;
+
+  cached_day.julian = 0;
+  cached_day.start = 0;
+  cached_day.end = 0;
+}
+
+
+bool
+CronTimePred::matches_day(const GDate &date) const
+{
+  if ((months & BIT(g_date_get_month(&date))) == 0)
+    {
+      return false;
+    }
+
+  bool day = (days & BIT(g_date_get_day(&date))) != 0;
+  bool weekday = (weekdays & BIT(g_date_get_weekday(&date) % 7)) != 0;
+
+  return either_day ? (day || weekday) : (day && weekday);
+}
+
+
+//! Returns the local start and end of a day.
+const CronTimePred::Day &
+CronTimePred::get_day(const GDate &date)
+{
+  guint32 julian = g_date_get_julian(&date);
+  if (cached_day.julian != julian)
+    {
+      GDate next = date;
+      g_date_add_days(&next, 1);
+
+      struct tm tm;
+      memset(&tm, 0, sizeof(tm));
+      tm.tm_isdst = -1;
+
+      tm.tm_year = g_date_get_year(&date) - 1900;
+      tm.tm_mon = g_date_get_month(&date) - 1;
+      tm.tm_mday = g_date_get_day(&date);
+      cached_day.start = mktime(&tm);
+
+      memset(&tm, 0, sizeof(tm));
+      tm.tm_isdst = -1;
+
+      tm.tm_year = g_date_get_year(&next) - 1900;
+      tm.tm_mon = g_date_get_month(&next) - 1;
+      tm.tm_mday = g_date_get_day(&next);
+      cached_day.end = mktime(&tm);
+
+      cached_day.julian = julian;
+    }
+
+  return cached_day;
+}
+
+
+//! Converts a minute of a local day to a time.
+time_t
+CronTimePred::get_time(const GDate &date, int minute)
+{
+  const Day &day = get_day(date);
+  if (day.end - day.start == DAY_MINUTES * 60)
+    {
+      return day.start + minute * 60;
+    }
+
+  // A daylight saving time transition. Take the first occurrence of a
+  // repeated time, and let mktime sort out a skipped time.
+  struct tm tm;
+  time_t t = day.start + minute * 60;
+  if (localtime_r(&t, &tm) != NULL && tm.tm_hour * 60 + tm.tm_min == minute)
+    {
+      return t;
+    }
+
+  memset(&tm, 0, sizeof(tm));
+  tm.tm_isdst = -1;
+
+  tm.tm_year = g_date_get_year(&date) - 1900;
+  tm.tm_mon = g_date_get_month(&date) - 1;
+  tm.tm_mday = g_date_get_day(&date);
+  tm.tm_hour = minute / 60;
+  tm.tm_min = minute % 60;
+
+  return mktime(&tm);
+}
@@ -0,0 +1,113 @@
+// CronTimePred.hh --- Calendar based time predicate
+//
+// Copyright (C) 2017 Rob Caelers <robc@krandor.nl>
+// All rights reserved.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef CRONTIMEPRED_HH
+#define CRONTIMEPRED_HH
+
+#include <string>
+
+#include <glib.h>
+
+#include "TimePred.hh"
+
+//! A time predicate that matches minutes in a calendar.
+/*!
+ *  Supported specifications:
+ *
+ *    day/4:00                   every day at 4:00
+ *    workday/4:00               Monday to Friday at 4:00
+ *    week/mon 4:00              every Monday at 4:00
+ *    week/mon,thu 4:00          every Monday and Thursday at 4:00
+ *    cron/0 4 * * 1-5           cron(5) syntax: minute hour day month weekday
+ *
+ *  The specification is compiled into bit masks and a table that gives,
+ *  for each minute of the day, the next matching minute on that day. The
+ *  local start and end of the last day that was looked at are cached, so
+ *  that on days without a daylight saving time transition the next match
+ *  is computed without calling into the time zone code.
+ */
+class CronTimePred : public TimePred
+{
+public:
+  CronTimePred();
+
+  bool init(const std::string &type, const std::string &spec);
+
+  void set_last(time_t lastTime);
+  time_t get_next();
+  std::string to_string() const;
+
+private:
+  //! A local day.
+  struct Day
+  {
+    //! Julian day number.
+    guint32 julian;
+
+    //! Local midnight at the start of the day.
+    time_t start;
+
+    //! Local midnight at the end of the day.
+    time_t end;
+  };
+
+  bool parse_time(const std::string &spec);
+  bool parse_cron(const std::string &spec);
+  bool parse_weekdays(const std::string &spec);
+  static bool parse_field(const std::string &field, int min, int max,
+                          const char *const *names, guint64 &mask);
+  static bool parse_value(const std::string &value, int min, int max,
+                          const char *const *names, int &result);
+
+  void compile();
+  bool matches_day(const GDate &date) const;
+  const Day &get_day(const GDate &date);
+  time_t get_time(const GDate &date, int minute);
+
+private:
+  //! The specification, as passed to init.
+  std::string type;
+  std::string spec;
+
+  //! Matching minutes (0-59).
+  guint64 minutes;
+
+  //! Matching hours (0-23).
+  guint64 hours;
+
+  //! Matching days of the month (1-31).
+  guint64 days;
+
+  //! Matching months (1-12).
+  guint64 months;
+
+  //! Matching weekdays (0-6, Sunday is 0).
+  guint64 weekdays;
+
+  //! Whether only one of days and weekdays needs to match (cron semantics).
+  bool either_day;
+
+  //! First matching minute at or after each minute of the day, or -1.
+  gint16 next_minute[24 * 60 + 1];
+
+  //! The last day that was looked at.
+  Day cached_day;
+};
+
+#endif // CRONTIMEPRED_HH
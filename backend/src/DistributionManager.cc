@@ -50,7 +50,8 @@ DistributionManager::DistributionManager() :
   network_enabled(false),
   server_enabled(false),
   link(NULL),
-  state(NODE_ACTIVE)
+  state(NODE_ACTIVE),
+  startup_source(NULL)
 {
 }
 
@@ -58,6 +59,11 @@ DistributionManager::DistributionManager() :
 //! Destructs this DistributionManager.
 DistributionManager::~DistributionManager()
 {
+  if (startup_source != NULL)
+    {
+      g_source_destroy(startup_source);
+      g_source_unref(startup_source);
+    }
   delete link;
 }
 
@@ -75,12 +81,28 @@ DistributionManager::init(Configurator *conf)
   socketlink->init();
   link = socketlink;
 
-  // Read configuration.
-  read_configuration();
+  // Starting the server and connecting to peers is not needed to start
+  // Workrave. Read the configuration once the main loop is idle.
+  startup_source = g_idle_source_new();
+  g_source_set_priority(startup_source, G_PRIORITY_LOW);
+  g_source_set_callback(startup_source, static_on_startup_idle, this, NULL);
+  g_source_attach(startup_source, g_main_context_get_thread_default());
   configurator->add_listener(CoreConfig::CFG_KEY_DISTRIBUTION, this);
 }
 
 
+//! Reads the configuration after startup.
+gboolean
+DistributionManager::static_on_startup_idle(gpointer data)
+{
+  DistributionManager *self = (DistributionManager *) data;
+  g_source_unref(self->startup_source);
+  self->startup_source = NULL;
+  self->read_configuration();
+  return FALSE;
+}
+
+
 //! Periodic heartbeat.
 void
 DistributionManager::heartbeart()
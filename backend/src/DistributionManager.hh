@@ -23,6 +23,8 @@
 #include <string>
 #include <list>
 
+#include <glib.h>
+
 using namespace std;
 
 #include "IConfiguratorListener.hh"
@@ -115,6 +117,7 @@ private:
   void write_peers();
   void read_configuration();
   void config_changed_notify(const string &key);
+  static gboolean static_on_startup_idle(gpointer data);
 
   void fire_log_event(string message);
   void fire_signon_client(char *id);
@@ -155,6 +158,9 @@ private:
 
   //! Current master.
   string current_master;
+
+  //! Idle source that enables the network after startup.
+  GSource *startup_source;
 };
 
 
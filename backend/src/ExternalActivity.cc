@@ -0,0 +1,343 @@
+// ExternalActivity.cc --- Activity reported by external sources
+//
+// Copyright (C) 2017 Rob Caelers <robc@krandor.nl>
+// All rights reserved.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <algorithm>
+
+#include "debug.hh"
+
+#include "ExternalActivity.hh"
+
+using namespace std;
+
+
+ExternalActivity::ExternalActivity() :
+  active_count(0)
+{
+}
+
+
+bool
+ExternalActivity::start(const string &who, int ttl, time_t now)
+{
+  TRACE_ENTER_MSG("ExternalActivity::start", who << " " << ttl);
+
+  ttl = max(1, min(ttl, (int) MAX_TTL));
+
+  int index = get_source(who);
+  if (index == -1)
+    {
+      TRACE_RETURN(false);
+      return false;
+    }
+
+  Source &source = sources[index];
+
+  SourceStats *stats = find_stats(who, true);
+  stats->reports++;
+  stats->last_report = now;
+
+  if (source.active && source.expiry_time < now)
+    {
+      // Expired, but not yet processed.
+      finish(source, source.expiry_time);
+    }
+
+  source.expiry_time = now + ttl;
+
+  if (!source.active)
+    {
+      source.active = true;
+      source.start_time = now;
+      stats->leases++;
+      active_count++;
+      push(index, source.expiry_time);
+    }
+  else if (source.expiry_time < source.queued_time)
+    {
+      // The lease was shortened; the old entry is ignored when it expires.
+      push(index, source.expiry_time);
+    }
+
+  TRACE_RETURN(true);
+  return true;
+}
+
+
+bool
+ExternalActivity::renew(const string &who, int ttl, time_t now)
+{
+  TRACE_ENTER_MSG("ExternalActivity::renew", who << " " << ttl);
+
+  map<string, int>::const_iterator i = source_index.find(who);
+  bool ret = i != source_index.end() && sources[i->second].active && sources[i->second].expiry_time >= now;
+  if (ret)
+    {
+      start(who, ttl, now);
+    }
+  else
+    {
+      SourceStats *stats = find_stats(who, false);
+      if (stats != NULL)
+        {
+          stats->reports++;
+          stats->last_report = now;
+        }
+    }
+
+  TRACE_RETURN(ret);
+  return ret;
+}
+
+
+void
+ExternalActivity::end(const string &who, time_t now)
+{
+  TRACE_ENTER_MSG("ExternalActivity::end", who);
+
+  SourceStats *stats = find_stats(who, false);
+  if (stats != NULL)
+    {
+      stats->reports++;
+      stats->last_report = now;
+    }
+
+  map<string, int>::const_iterator i = source_index.find(who);
+  if (i != source_index.end())
+    {
+      Source &source = sources[i->second];
+
+      if (source.active)
+        {
+          finish(source, min(now, source.expiry_time));
+        }
+      release(i->second);
+    }
+
+  TRACE_EXIT();
+}
+
+
+//! Ends all leases that expired before the specified time.
+/*!
+ *  Only looks at the top of the heap, so that this is cheap when called
+ *  every heartbeat. Entries of ended or shortened leases are dropped, and
+ *  entries of extended leases are moved to their new expiry time.
+ */
+void
+ExternalActivity::expire(time_t now)
+{
+  while (!heap.empty() && heap.front().expiry_time < now)
+    {
+      Entry entry = heap.front();
+      pop_heap(heap.begin(), heap.end());
+      heap.pop_back();
+
+      Source &source = sources[entry.source];
+      if (source.generation != entry.generation || !source.active ||
+          source.queued_time != entry.expiry_time)
+        {
+          // Stale entry.
+          continue;
+        }
+
+      if (source.expiry_time >= now)
+        {
+          push(entry.source, source.expiry_time);
+        }
+      else
+        {
+          finish(source, source.expiry_time);
+          release(entry.source);
+        }
+    }
+}
+
+
+void
+ExternalActivity::shift_time(int delta)
+{
+  for (vector<Source>::iterator i = sources.begin(); i != sources.end(); i++)
+    {
+      i->start_time += delta;
+      i->expiry_time += delta;
+      i->queued_time += delta;
+    }
+
+  for (map<string, StatsEntry>::iterator i = source_stats.begin(); i != source_stats.end(); i++)
+    {
+      i->second.stats.last_report += delta;
+    }
+
+  // A uniform shift keeps the heap ordered.
+  for (vector<Entry>::iterator i = heap.begin(); i != heap.end(); i++)
+    {
+      i->expiry_time += delta;
+    }
+}
+
+
+//! Returns the statistics of a source, including the current lease.
+bool
+ExternalActivity::get_stats(const string &who, time_t now, SourceStats &stats) const
+{
+  map<string, StatsEntry>::const_iterator s = source_stats.find(who);
+  if (s == source_stats.end())
+    {
+      return false;
+    }
+
+  stats = s->second.stats;
+
+  map<string, int>::const_iterator i = source_index.find(who);
+  if (i != source_index.end() && sources[i->second].active)
+    {
+      const Source &source = sources[i->second];
+      time_t end_time = min(now, source.expiry_time);
+      if (end_time > source.start_time)
+        {
+          stats.active_time += end_time - source.start_time;
+        }
+    }
+  return true;
+}
+
+
+//! Returns the slot of a source, and creates it if needed. Returns -1 if there are too many sources.
+int
+ExternalActivity::get_source(const string &who)
+{
+  map<string, int>::const_iterator i = source_index.find(who);
+  if (i != source_index.end())
+    {
+      return i->second;
+    }
+
+  if (source_index.size() >= (size_t) MAX_SOURCES)
+    {
+      return -1;
+    }
+
+  int index;
+  if (!free_slots.empty())
+    {
+      index = free_slots.back();
+      free_slots.pop_back();
+    }
+  else
+    {
+      index = (int) sources.size();
+      sources.push_back(Source());
+      sources[index].generation = 0;
+    }
+
+  Source &source = sources[index];
+  source.name = who;
+  source.active = false;
+  source.start_time = 0;
+  source.expiry_time = 0;
+  source.queued_time = 0;
+
+  source_index[who] = index;
+  return index;
+}
+
+
+//! Returns the statistics of a source, and marks them as most recently used.
+/*!
+ *  \param create whether to create the statistics if the source has none.
+ *                 This forgets the least recently used statistics if there
+ *                 are MAX_STATS already.
+ */
+ExternalActivity::SourceStats *
+ExternalActivity::find_stats(const string &who, bool create)
+{
+  map<string, StatsEntry>::iterator i = source_stats.find(who);
+  if (i != source_stats.end())
+    {
+      stats_lru.splice(stats_lru.begin(), stats_lru, i->second.lru);
+      return &i->second.stats;
+    }
+
+  if (!create)
+    {
+      return NULL;
+    }
+
+  if (source_stats.size() >= (size_t) MAX_STATS)
+    {
+      source_stats.erase(stats_lru.back());
+      stats_lru.pop_back();
+    }
+
+  stats_lru.push_front(who);
+
+  StatsEntry &entry = source_stats[who];
+  entry.lru = stats_lru.begin();
+  entry.stats.reports = 0;
+  entry.stats.leases = 0;
+  entry.stats.active_time = 0;
+  entry.stats.last_report = 0;
+  return &entry.stats;
+}
+
+
+void
+ExternalActivity::push(int source, time_t expiry_time)
+{
+  Entry entry;
+  entry.expiry_time = expiry_time;
+  entry.source = source;
+  entry.generation = sources[source].generation;
+
+  heap.push_back(entry);
+  push_heap(heap.begin(), heap.end());
+
+  sources[source].queued_time = expiry_time;
+}
+
+
+void
+ExternalActivity::finish(Source &source, time_t end_time)
+{
+  source.active = false;
+  active_count--;
+
+  SourceStats *stats = find_stats(source.name, true);
+  if (end_time > source.start_time)
+    {
+      stats->active_time += end_time - source.start_time;
+    }
+}
+
+
+//! Forgets a source that no longer holds a lease. Its entries in the heap become stale.
+void
+ExternalActivity::release(int index)
+{
+  Source &source = sources[index];
+
+  source_index.erase(source.name);
+  source.name.clear();
+  source.generation++;
+  free_slots.push_back(index);
+}
@@ -0,0 +1,178 @@
+// ExternalActivity.hh --- Activity reported by external sources
+//
+// Copyright (C) 2017 Rob Caelers <robc@krandor.nl>
+// All rights reserved.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef EXTERNALACTIVITY_HH
+#define EXTERNALACTIVITY_HH
+
+#include <time.h>
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+
+//! Activity reported by external sources (e.g. face detection).
+/*!
+ *  A source reports activity by taking a lease with a time-to-live. The
+ *  user is active for as long as any source holds a lease. A source renews
+ *  its lease before it expires, and ends it when the user left.
+ *
+ *  Expiry is driven by a heap ordered on the expiry time, so that checking
+ *  for expired leases costs nothing while no lease expires. Each lease has
+ *  one entry in the heap. A renewal that extends the lease only updates the
+ *  source; its entry is moved when it reaches the top of the heap.
+ *
+ *  The lease slot of a source is released as soon as its lease ends or
+ *  expires, and at most MAX_SOURCES sources hold a lease at the same time.
+ *  Statistics are kept apart from the slots, for the MAX_STATS sources that
+ *  reported most recently, so that they cover all leases of a source.
+ */
+class ExternalActivity
+{
+public:
+  //! Statistics of a source, over all its leases.
+  struct SourceStats
+  {
+    //! Number of reports (start, renew and end).
+    int reports;
+
+    //! Number of leases started.
+    int leases;
+
+    //! Total time the source held a lease (in seconds).
+    time_t active_time;
+
+    //! Time of the last report.
+    time_t last_report;
+  };
+
+  //! Time-to-live of a lease taken with the old on/off reports.
+  static const int DEFAULT_TTL = 10;
+
+  //! Maximum time-to-live of a lease.
+  static const int MAX_TTL = 3600;
+
+  //! Maximum number of sources that hold a lease.
+  static const int MAX_SOURCES = 64;
+
+  //! Maximum number of sources with statistics.
+  static const int MAX_STATS = 256;
+
+  ExternalActivity();
+
+  //! Starts or renews the lease of a source. Returns false if there are too many sources.
+  bool start(const std::string &who, int ttl, time_t now);
+
+  //! Renews the lease of a source. Returns false if the source holds no lease.
+  bool renew(const std::string &who, int ttl, time_t now);
+
+  //! Ends the lease of a source.
+  void end(const std::string &who, time_t now);
+
+  //! Ends all leases that expired before the specified time.
+  void expire(time_t now);
+
+  //! Returns whether any source holds a lease.
+  bool is_active() const;
+
+  //! Shifts all leases after a change of the wall-clock time.
+  void shift_time(int delta);
+
+  //! Returns the statistics of a source.
+  bool get_stats(const std::string &who, time_t now, SourceStats &stats) const;
+
+private:
+  struct Source
+  {
+    //! Name of the source.
+    std::string name;
+
+    //! Incremented each time the slot is reused by another source.
+    unsigned int generation;
+
+    //! Whether the source holds a lease.
+    bool active;
+
+    //! Start time of the current lease.
+    time_t start_time;
+
+    //! Expiry time of the current lease.
+    time_t expiry_time;
+
+    //! Expiry time of the entry in the heap.
+    time_t queued_time;
+  };
+
+  struct StatsEntry
+  {
+    SourceStats stats;
+
+    //! Position in stats_lru.
+    std::list<std::string>::iterator lru;
+  };
+
+  struct Entry
+  {
+    time_t expiry_time;
+    int source;
+    unsigned int generation;
+
+    //! Heap order: earliest expiry on top.
+    bool operator<(const Entry &other) const
+    {
+      return expiry_time > other.expiry_time;
+    }
+  };
+
+  int get_source(const std::string &who);
+  SourceStats *find_stats(const std::string &who, bool create);
+  void push(int source, time_t expiry_time);
+  void finish(Source &source, time_t end_time);
+  void release(int source);
+
+private:
+  //! All sources, including unused slots.
+  std::vector<Source> sources;
+
+  //! Unused slots in sources.
+  std::vector<int> free_slots;
+
+  //! Index in sources by name.
+  std::map<std::string, int> source_index;
+
+  //! Pending expiries.
+  std::vector<Entry> heap;
+
+  //! Statistics by name.
+  std::map<std::string, StatsEntry> source_stats;
+
+  //! Names in source_stats, most recently reported first.
+  std::list<std::string> stats_lru;
+
+  //! Number of sources that hold a lease.
+  int active_count;
+};
+
+
+inline bool
+ExternalActivity::is_active() const
+{
+  return active_count > 0;
+}
+
+#endif // EXTERNALACTIVITY_HH
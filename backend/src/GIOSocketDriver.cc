@@ -130,7 +130,7 @@ GIOSocket::static_connected_callback(GObject *source_object,
                                               (GIOCondition) (G_IO_IN | G_IO_ERR | G_IO_HUP),
                                               NULL);
       g_source_set_callback(socket->source, (GSourceFunc) static_data_callback, (void*)socket, NULL);
-      g_source_attach(socket->source, NULL);
+      g_source_attach(socket->source, g_main_context_get_thread_default());
       // g_source_unref(source);
 
       if (socket->listener != NULL)
@@ -202,7 +202,7 @@ GIOSocket::GIOSocket(GSocketConnection *connection) :
 
   source = g_socket_create_source(socket, (GIOCondition)G_IO_IN, NULL);
   g_source_set_callback(source, (GSourceFunc) static_data_callback, (void*)this, NULL);
-  g_source_attach(source, NULL);
+  g_source_attach(source, g_main_context_get_thread_default());
   g_source_unref(source);
   TRACE_EXIT();
 }
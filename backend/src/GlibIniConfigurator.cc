@@ -27,7 +27,6 @@
 #include <sstream>
 #include <assert.h>
 #include <iostream>
-#include <fstream>
 
 #include "GlibIniConfigurator.hh"
 #include <glib.h>
@@ -77,24 +76,30 @@ GlibIniConfigurator::load(string filename)
 }
 
 
+//! Saves the configuration.
+/*!
+ *  The file is replaced atomically, so that an interrupted save does not
+ *  leave a truncated file.
+ */
 bool
 GlibIniConfigurator::save(string filename)
 {
+  TRACE_ENTER_MSG("GlibIniConfigurator::save", filename);
+
   GError *error = NULL;
-  char *str = g_key_file_to_data(config, NULL, &error);
+  gsize length = 0;
+  char *str = g_key_file_to_data(config, &length, &error);
 
-  TRACE_ENTER_MSG("GlibIniConfigurator::save", filename);
-  if (error != NULL)
+  if (error == NULL)
     {
-      g_error_free(error);
+      g_file_set_contents(filename.c_str(), str, length, &error);
     }
-  else
-    {
-      ofstream config_file(filename.c_str());
 
-      config_file << str;
-
-      config_file.close();
+  bool ret = error == NULL;
+  if (error != NULL)
+    {
+      TRACE_MSG("Error: " << error->message);
+      g_error_free(error);
     }
 
   if (str != NULL)
@@ -102,8 +107,8 @@ GlibIniConfigurator::save(string filename)
       g_free(str);
     }
 
-  TRACE_EXIT();
-  return error == NULL;
+  TRACE_RETURN(ret);
+  return ret;
 }
 
 
@@ -114,6 +119,28 @@ GlibIniConfigurator::save()
 }
 
 
+bool
+GlibIniConfigurator::get_snapshot(string &filename, string &data) const
+{
+  if (config == NULL || last_filename == "")
+    {
+      return false;
+    }
+
+  gsize length = 0;
+  char *str = g_key_file_to_data(config, &length, NULL);
+  if (str == NULL)
+    {
+      return false;
+    }
+
+  filename = last_filename;
+  data.assign(str, length);
+  g_free(str);
+  return true;
+}
+
+
 bool
 GlibIniConfigurator::remove_key(const std::string &key)
 {
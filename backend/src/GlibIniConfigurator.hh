@@ -29,7 +29,8 @@
 #include "IConfigBackend.hh"
 
 class GlibIniConfigurator :
-  public virtual IConfigBackend
+  public virtual IConfigBackend,
+  public IConfigBackendSnapshot
 {
 public:
   GlibIniConfigurator();
@@ -43,6 +44,9 @@ public:
   virtual bool get_value(const std::string &key, VariantType type, Variant &value) const;
   virtual bool set_value(const std::string &key, Variant &value);
 
+  // IConfigBackendSnapshot
+  virtual bool get_snapshot(std::string &filename, std::string &data) const;
+
 private:
   void split_key(const std::string &key, std::string &group, std::string &out_key) const;
   std::string key_inify(const std::string &key) const;
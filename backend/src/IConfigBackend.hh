@@ -57,4 +57,15 @@ public:
 };
 
 
+//! A backend that can serialize its configuration, so that it can be written by another thread.
+class IConfigBackendSnapshot
+{
+public:
+  virtual ~IConfigBackendSnapshot() {}
+
+  //! Serializes the configuration, and returns the file it is saved to.
+  virtual bool get_snapshot(std::string &filename, std::string &data) const = 0;
+};
+
+
 #endif // ICONFIGBACKEND_HH
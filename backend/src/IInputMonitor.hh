@@ -46,6 +46,9 @@ public:
 
   //! Unsubscribe for statistics monitor.
   virtual void unsubscribe_statistics(IInputMonitorListener *listener) = 0;
+
+  //! Sets the time (in ms) after which the user is considered idle.
+  virtual void set_idle_threshold(int idle) = 0;
 };
 
 #endif // IINPUTMONITOR_HH
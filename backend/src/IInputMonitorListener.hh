@@ -22,6 +22,8 @@
 
 #include <string>
 
+#include "InputEvent.hh"
+
 //! Listener for events from the input monitor.
 class IInputMonitorListener
 {
@@ -39,6 +41,33 @@ public:
 
   //! Reports keyboard activity
   virtual void keyboard_notify(bool repeat) = 0;
+
+  //! Reports a batch of events, oldest first.
+  /*!
+   *  By default, the events are passed on one by one.
+   */
+  virtual void batch_notify(const InputEvent *events, int count)
+  {
+    for (int i = 0; i < count; i++)
+      {
+        const InputEvent &event = events[i];
+        switch (event.type)
+          {
+          case InputEvent::INPUT_EVENT_ACTION:
+            action_notify();
+            break;
+          case InputEvent::INPUT_EVENT_MOUSE:
+            mouse_notify(event.x, event.y, event.wheel);
+            break;
+          case InputEvent::INPUT_EVENT_BUTTON:
+            button_notify(event.is_press);
+            break;
+          case InputEvent::INPUT_EVENT_KEYBOARD:
+            keyboard_notify(event.repeat);
+            break;
+          }
+      }
+  }
 };
 
 #endif // IINPUTMONITORLISTENER_HH
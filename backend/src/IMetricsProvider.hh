@@ -1,6 +1,6 @@
-// DayTimePred.hh --- Daily Time Predicate
+// IMetricsProvider.hh --- Source of run-time metrics
 //
-// Copyright (C) 2001, 2002, 2007 Rob Caelers <robc@krandor.nl>
+// Copyright (C) 2017 Rob Caelers <robc@krandor.nl>
 // All rights reserved.
 //
 // This program is free software: you can redistribute it and/or modify
@@ -17,28 +17,19 @@
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 //
 
-#ifndef DAYTIMEPRED_HH
-#define DAYTIMEPRED_HH
+#ifndef IMETRICSPROVIDER_HH
+#define IMETRICSPROVIDER_HH
 
-#include "TimePred.hh"
+#include <ostream>
 
-class DayTimePred : public TimePred
+//! Source of metrics that are not known at compile time.
+class IMetricsProvider
 {
 public:
-  bool init(std::string spec);
-  bool init(int hour, int min);
+  virtual ~IMetricsProvider() {}
 
-  void set_last(time_t lastTime);
-  time_t get_next();
-  time_t get_time_offset();
-  std::string to_string() const;
-
-private:
-  int days_in_month(int month, int year);
-  int time_cmp(int h1, int m1, int h2, int m2);
-
-  int pred_hour;
-  int pred_min;
+  //! Writes the metrics as text, one metric per line.
+  virtual void get_metrics(std::ostream &out) = 0;
 };
 
-#endif // DAYTIMEPRED_HH
+#endif // IMETRICSPROVIDER_HH
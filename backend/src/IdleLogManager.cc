@@ -35,6 +35,7 @@
 #include "IdleLogManager.hh"
 #include "TimeSource.hh"
 #include "PacketBuffer.hh"
+#include "Metrics.hh"
 
 #define IDLELOG_MAXSIZE     (4000)
 #define IDLELOG_MAXAGE    (12 * 60 * 60)
@@ -57,6 +58,7 @@ void
 IdleLogManager::update_all_idlelogs(string master_id, ActivityState current_state)
 {
   TRACE_ENTER_MSG("IdleLogManager::update_all_idlelogs", master_id << " " << current_state);
+  MetricsTimer timer(Metrics::LATENCY_IDLELOG_UPDATE);
 
   if (current_state == ACTIVITY_NOISE)
     {
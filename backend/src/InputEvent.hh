@@ -0,0 +1,98 @@
+// InputEvent.hh --- A single input event
+//
+// Copyright (C) 2017 Rob Caelers <robc@krandor.nl>
+// All rights reserved.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef INPUTEVENT_HH
+#define INPUTEVENT_HH
+
+#include <glib.h>
+
+//! A single input event, as delivered in batches to IInputMonitorListener.
+struct InputEvent
+{
+  enum Type
+    {
+      INPUT_EVENT_ACTION,
+      INPUT_EVENT_MOUSE,
+      INPUT_EVENT_BUTTON,
+      INPUT_EVENT_KEYBOARD
+    };
+
+  //! Kind of event.
+  Type type;
+
+  //! Time of the event in µs, as g_get_real_time().
+  gint64 time;
+
+  //! Mouse position.
+  int x;
+  int y;
+
+  //! Mouse wheel movement.
+  int wheel;
+
+  //! Was the button pressed (or released)?
+  bool is_press;
+
+  //! Is the key press a repeat?
+  bool repeat;
+
+  static InputEvent action(gint64 time)
+  {
+    return create(INPUT_EVENT_ACTION, time);
+  }
+
+  static InputEvent mouse(gint64 time, int x, int y, int wheel = 0)
+  {
+    InputEvent event = create(INPUT_EVENT_MOUSE, time);
+    event.x = x;
+    event.y = y;
+    event.wheel = wheel;
+    return event;
+  }
+
+  static InputEvent button(gint64 time, bool is_press)
+  {
+    InputEvent event = create(INPUT_EVENT_BUTTON, time);
+    event.is_press = is_press;
+    return event;
+  }
+
+  static InputEvent keyboard(gint64 time, bool repeat)
+  {
+    InputEvent event = create(INPUT_EVENT_KEYBOARD, time);
+    event.repeat = repeat;
+    return event;
+  }
+
+private:
+  static InputEvent create(Type type, gint64 time)
+  {
+    InputEvent event;
+    event.type = type;
+    event.time = time;
+    event.x = 0;
+    event.y = 0;
+    event.wheel = 0;
+    event.is_press = false;
+    event.repeat = false;
+    return event;
+  }
+};
+
+#endif // INPUTEVENT_HH
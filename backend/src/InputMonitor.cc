@@ -28,7 +28,8 @@
 
 InputMonitor::InputMonitor()
   : activity_listener(NULL),
-    statistics_listener(NULL)
+    statistics_listener(NULL),
+    idle_threshold(5000)
 {
 }
 
@@ -70,3 +71,10 @@ InputMonitor::unsubscribe_statistics(IInputMonitorListener *listener)
   assert(statistics_listener != NULL);
   statistics_listener = NULL;
 }
+
+
+void
+InputMonitor::set_idle_threshold(int idle)
+{
+  g_atomic_int_set(&idle_threshold, idle);
+}
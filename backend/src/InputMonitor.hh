@@ -21,6 +21,8 @@
 #define INPUTMONITOR_HH
 
 #include <stdlib.h>
+#include <glib.h>
+
 #include "IInputMonitor.hh"
 #include "IInputMonitorListener.hh"
 
@@ -39,12 +41,16 @@ public:
   virtual void subscribe_statistics(IInputMonitorListener *listener);
   virtual void unsubscribe_activity(IInputMonitorListener *listener);
   virtual void unsubscribe_statistics(IInputMonitorListener *listener);
+  virtual void set_idle_threshold(int idle);
 
 protected:
+  int get_idle_threshold() const;
+
   void fire_action();
   void fire_mouse(int x, int y, int wheel = 0);
   void fire_button(bool is_press);
   void fire_keyboard(bool repeat);
+  void fire_batch(const InputEvent *events, int count);
 
 private:
   //!
@@ -52,6 +58,9 @@ private:
 
   //!
   IInputMonitorListener *statistics_listener;
+
+  //! Idle threshold in ms, read by the monitor thread.
+  volatile gint idle_threshold;
 };
 
 #include "InputMonitor.icc"
@@ -18,7 +18,10 @@
 #include "config.h"
 #endif
 
+#include <stdlib.h>
+
 #include "InputMonitorFactory.hh"
+#include "InputTraceRecorder.hh"
 
 #ifdef PLATFORM_OS_WIN32
 #include "W32InputMonitorFactory.hh"
@@ -33,6 +36,9 @@
 #include "nls.h"
 
 IInputMonitorFactory *InputMonitorFactory::factory = NULL;
+IInputMonitor *InputMonitorFactory::recorder = NULL;
+IInputMonitor *InputMonitorFactory::recorded_monitor = NULL;
+IInputMonitor *InputMonitorFactory::override_monitor = NULL;
 
 void
 InputMonitorFactory::init(const std::string &display)
@@ -57,11 +63,53 @@ InputMonitorFactory::init(const std::string &display)
 IInputMonitor *
 InputMonitorFactory::get_monitor(IInputMonitorFactory::MonitorCapability capability)
 {
+  IInputMonitor *monitor = NULL;
+
+  if (override_monitor != NULL)
+    {
+      return override_monitor;
+    }
+
   if (factory != NULL)
     {
-      return factory->get_monitor(capability);
+      monitor = factory->get_monitor(capability);
     }
 
-  return NULL;
+  // Record the activity events to a trace, if requested.
+  const char *trace = getenv("WORKRAVE_INPUT_TRACE");
+  if (monitor != NULL && trace != NULL && capability == IInputMonitorFactory::CAPABILITY_ACTIVITY)
+    {
+      // A recreated monitor gets a new recorder.
+      if (recorder == NULL || recorded_monitor != monitor)
+        {
+          recorder = new InputTraceRecorder(monitor, trace);
+          recorded_monitor = monitor;
+        }
+      monitor = recorder;
+    }
+
+  return monitor;
 }
 
+
+//! Returns the specified monitor for all capabilities, until reset to NULL.
+/*!
+ *  Used for the sessions of a host, whose input is reported by the host.
+ */
+void
+InputMonitorFactory::set_override(IInputMonitor *monitor)
+{
+  override_monitor = monitor;
+}
+
+
+//! Forgets a recorder that is being deleted, together with the monitor it wraps.
+void
+InputMonitorFactory::recorder_destroyed(IInputMonitor *monitor)
+{
+  if (recorder == monitor)
+    {
+      recorder = NULL;
+      recorded_monitor = NULL;
+    }
+}
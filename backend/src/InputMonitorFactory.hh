@@ -31,9 +31,14 @@ class InputMonitorFactory
 public:
   static void init(const std::string &display);
   static IInputMonitor *get_monitor(IInputMonitorFactory::MonitorCapability capability);
+  static void set_override(IInputMonitor *monitor);
+  static void recorder_destroyed(IInputMonitor *monitor);
 
 private:
   static IInputMonitorFactory *factory;
+  static IInputMonitor *recorder;
+  static IInputMonitor *recorded_monitor;
+  static IInputMonitor *override_monitor;
 };
 
 #endif // INPUTMONITORFACTORY_HH
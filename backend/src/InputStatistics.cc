@@ -0,0 +1,175 @@
+// InputStatistics.cc --- Input counters of the statistics
+//
+// Copyright (C) 2017 Rob Caelers <robc@krandor.nl>
+// All rights reserved.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <math.h>
+#include <stdlib.h>
+
+#include "InputStatistics.hh"
+
+#define MAX_JUMP (10000)
+
+InputStatistics::InputStatistics() :
+  prev_x(-1),
+  prev_y(-1),
+  click_x(-1),
+  click_y(-1),
+  last_mouse_time(0)
+{
+}
+
+
+void
+InputStatistics::process(const InputEvent *events, int count, IStatistics::MiscStats &stats, gint64 &mouse_time)
+{
+  for (int i = 0; i < count; i += CHUNK_SIZE)
+    {
+      int n = count - i < CHUNK_SIZE ? count - i : CHUNK_SIZE;
+      process_chunk(events + i, n, stats, mouse_time);
+    }
+}
+
+
+void
+InputStatistics::process_chunk(const InputEvent *events, int count, IStatistics::MiscStats &stats, gint64 &mouse_time)
+{
+  static const int sensitivity = 3;
+
+  gint64 movement_sq[CHUNK_SIZE];
+  gint64 click_movement_sq[CHUNK_SIZE];
+  int num_movements = 0;
+  int num_click_movements = 0;
+
+  gint64 clicks = 0;
+  gint64 keystrokes = 0;
+  gint64 movement_time = 0;
+  bool movement_timed = false;
+
+  for (int i = 0; i < count; i++)
+    {
+      const InputEvent &event = events[i];
+
+      switch (event.type)
+        {
+        case InputEvent::INPUT_EVENT_MOUSE:
+          if (event.x >= 0 && event.y >= 0)
+            {
+              int delta_x = sensitivity;
+              int delta_y = sensitivity;
+
+              if (prev_x != -1 && prev_y != -1)
+                {
+                  delta_x = abs(event.x - prev_x);
+                  delta_y = abs(event.y - prev_y);
+                }
+
+              prev_x = event.x;
+              prev_y = event.y;
+
+              // Sanity checks, ignore unreasonable large jumps...
+              if (delta_x < MAX_JUMP && delta_y < MAX_JUMP &&
+                  (delta_x >= sensitivity || delta_y >= sensitivity || event.wheel != 0))
+                {
+                  movement_sq[num_movements++] = (gint64) delta_x * delta_x + (gint64) delta_y * delta_y;
+
+                  gint64 delta_time = event.time - last_mouse_time;
+                  if (last_mouse_time != 0 && delta_time >= 0 && delta_time < G_USEC_PER_SEC)
+                    {
+                      movement_time += delta_time;
+                      movement_timed = true;
+                    }
+
+                  last_mouse_time = event.time;
+                }
+            }
+          break;
+
+        case InputEvent::INPUT_EVENT_BUTTON:
+          if (click_x != -1 && click_y != -1 &&
+              prev_x != -1  && prev_y != -1)
+            {
+              gint64 delta_x = click_x - prev_x;
+              gint64 delta_y = click_y - prev_y;
+
+              click_movement_sq[num_click_movements++] = delta_x * delta_x + delta_y * delta_y;
+            }
+
+          click_x = prev_x;
+          click_y = prev_y;
+
+          if (event.is_press)
+            {
+              clicks++;
+            }
+          break;
+
+        case InputEvent::INPUT_EVENT_KEYBOARD:
+          if (!event.repeat)
+            {
+              keystrokes++;
+            }
+          break;
+
+        default:
+          break;
+        }
+    }
+
+  gint64 movement = 0;
+  for (int i = 0; i < num_movements; i++)
+    {
+      movement += (gint64) sqrt((double) movement_sq[i]);
+    }
+
+  gint64 click_movement = 0;
+  for (int i = 0; i < num_click_movements; i++)
+    {
+      click_movement += (gint64) sqrt((double) click_movement_sq[i]);
+    }
+
+  if (num_movements > 0)
+    {
+      movement += stats[IStatistics::STATS_VALUE_TOTAL_MOUSE_MOVEMENT];
+      if (movement > 0)
+        {
+          stats[IStatistics::STATS_VALUE_TOTAL_MOUSE_MOVEMENT] = movement;
+        }
+    }
+
+  if (num_click_movements > 0)
+    {
+      click_movement += stats[IStatistics::STATS_VALUE_TOTAL_CLICK_MOVEMENT];
+      if (click_movement > 0)
+        {
+          stats[IStatistics::STATS_VALUE_TOTAL_CLICK_MOVEMENT] = click_movement;
+        }
+    }
+
+  if (movement_timed)
+    {
+      mouse_time += movement_time;
+      stats[IStatistics::STATS_VALUE_TOTAL_MOVEMENT_TIME] = mouse_time / G_USEC_PER_SEC;
+    }
+
+  stats[IStatistics::STATS_VALUE_TOTAL_CLICKS] += clicks;
+  stats[IStatistics::STATS_VALUE_TOTAL_KEYSTROKES] += keystrokes;
+}
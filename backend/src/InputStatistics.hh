@@ -0,0 +1,75 @@
+// InputStatistics.hh --- Input counters of the statistics
+//
+// Copyright (C) 2017 Rob Caelers <robc@krandor.nl>
+// All rights reserved.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef INPUTSTATISTICS_HH
+#define INPUTSTATISTICS_HH
+
+#include <glib.h>
+
+#include "IStatistics.hh"
+#include "InputEvent.hh"
+
+using namespace workrave;
+
+//! Updates the mouse and keyboard counters of the statistics from input events.
+/*!
+ *  Events are processed in chunks. The first pass over a chunk follows
+ *  the pointer and only uses integer math; it collects the squared
+ *  distances. The second pass takes the square roots in a loop without
+ *  branches, which the compiler can vectorize.
+ */
+class InputStatistics
+{
+public:
+  InputStatistics();
+
+  //! Updates the counters with a batch of events, oldest first.
+  /*!
+   *  \param stats the counters to update.
+   *  \param mouse_time total time the mouse moved, in µs.
+   */
+  void process(const InputEvent *events, int count, IStatistics::MiscStats &stats, gint64 &mouse_time);
+
+private:
+  enum
+    {
+      //! Number of events processed per pass.
+      CHUNK_SIZE = 64
+    };
+
+  void process_chunk(const InputEvent *events, int count, IStatistics::MiscStats &stats, gint64 &mouse_time);
+
+private:
+  //! Previous X coordinate
+  int prev_x;
+
+  //! Previous Y coordinate
+  int prev_y;
+
+  //! Previous X-click coordinate
+  int click_x;
+
+  //! Previous Y-click coordinate
+  int click_y;
+
+  //! Time of the last mouse movement, in µs.
+  gint64 last_mouse_time;
+};
+
+#endif // INPUTSTATISTICS_HH
@@ -0,0 +1,196 @@
+// InputTraceRecorder.cc --- Records input events to a trace file
+//
+// Copyright (C) 2017 Rob Caelers <robc@krandor.nl>
+// All rights reserved.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "debug.hh"
+
+#include "InputTraceRecorder.hh"
+#include "InputMonitorFactory.hh"
+
+using namespace std;
+
+const char *InputTraceRecorder::TRACE_HEADER = "# workrave input trace 1";
+
+
+InputTraceRecorder::InputTraceRecorder(IInputMonitor *monitor, const string &filename) :
+  monitor(monitor),
+  activity_listener(NULL),
+  last_event_time(0)
+{
+  TRACE_ENTER_MSG("InputTraceRecorder::InputTraceRecorder", filename);
+
+  trace.open(filename.c_str(), ios::out | ios::trunc);
+  if (trace.good())
+    {
+      trace << TRACE_HEADER << endl;
+    }
+
+  TRACE_EXIT();
+}
+
+
+InputTraceRecorder::~InputTraceRecorder()
+{
+  InputMonitorFactory::recorder_destroyed(this);
+  delete monitor;
+}
+
+
+bool
+InputTraceRecorder::init()
+{
+  return monitor->init();
+}
+
+
+void
+InputTraceRecorder::terminate()
+{
+  monitor->terminate();
+
+  lock.lock();
+  trace.close();
+  lock.unlock();
+}
+
+
+void
+InputTraceRecorder::subscribe_activity(IInputMonitorListener *listener)
+{
+  activity_listener = listener;
+  monitor->subscribe_activity(this);
+}
+
+
+void
+InputTraceRecorder::subscribe_statistics(IInputMonitorListener *listener)
+{
+  monitor->subscribe_statistics(listener);
+}
+
+
+void
+InputTraceRecorder::unsubscribe_activity(IInputMonitorListener *listener)
+{
+  (void) listener;
+  monitor->unsubscribe_activity(this);
+  activity_listener = NULL;
+}
+
+
+void
+InputTraceRecorder::unsubscribe_statistics(IInputMonitorListener *listener)
+{
+  monitor->unsubscribe_statistics(listener);
+}
+
+
+void
+InputTraceRecorder::set_idle_threshold(int idle)
+{
+  monitor->set_idle_threshold(idle);
+}
+
+
+ofstream &
+InputTraceRecorder::record()
+{
+  gint64 now = g_get_monotonic_time();
+  if (last_event_time == 0)
+    {
+      last_event_time = now;
+    }
+
+  trace << (now - last_event_time) / G_TIME_SPAN_MILLISECOND << " ";
+
+  // Keep the remainder so that rounding errors do not accumulate.
+  last_event_time = now - (now - last_event_time) % G_TIME_SPAN_MILLISECOND;
+  return trace;
+}
+
+
+void
+InputTraceRecorder::action_notify()
+{
+  lock.lock();
+  if (trace.is_open())
+    {
+      record() << "a\n";
+    }
+  lock.unlock();
+
+  if (activity_listener != NULL)
+    {
+      activity_listener->action_notify();
+    }
+}
+
+
+void
+InputTraceRecorder::mouse_notify(int x, int y, int wheel)
+{
+  lock.lock();
+  if (trace.is_open())
+    {
+      record() << "m " << x << " " << y << " " << wheel << "\n";
+    }
+  lock.unlock();
+
+  if (activity_listener != NULL)
+    {
+      activity_listener->mouse_notify(x, y, wheel);
+    }
+}
+
+
+void
+InputTraceRecorder::button_notify(bool is_press)
+{
+  lock.lock();
+  if (trace.is_open())
+    {
+      record() << "b " << is_press << "\n";
+    }
+  lock.unlock();
+
+  if (activity_listener != NULL)
+    {
+      activity_listener->button_notify(is_press);
+    }
+}
+
+
+void
+InputTraceRecorder::keyboard_notify(bool repeat)
+{
+  lock.lock();
+  if (trace.is_open())
+    {
+      record() << "k " << repeat << "\n";
+    }
+  lock.unlock();
+
+  if (activity_listener != NULL)
+    {
+      activity_listener->keyboard_notify(repeat);
+    }
+}
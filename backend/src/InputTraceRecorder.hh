@@ -0,0 +1,93 @@
+// InputTraceRecorder.hh --- Records input events to a trace file
+//
+// Copyright (C) 2017 Rob Caelers <robc@krandor.nl>
+// All rights reserved.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef INPUTTRACERECORDER_HH
+#define INPUTTRACERECORDER_HH
+
+#include <string>
+#include <fstream>
+
+#include <glib.h>
+
+#include "IInputMonitor.hh"
+#include "IInputMonitorListener.hh"
+#include "Mutex.hh"
+
+//! Input monitor decorator that records all activity events.
+/*!
+ *  Each event received from the decorated monitor is written to the trace
+ *  file and then passed on to the activity listener. The trace is a text
+ *  file with one event per line:
+ *
+ *    <delta-ms> a
+ *    <delta-ms> m <x> <y> <wheel>
+ *    <delta-ms> b <is-press>
+ *    <delta-ms> k <repeat>
+ *
+ *  where delta-ms is the time since the previous event. A trace can be
+ *  replayed using the ReplayInputMonitor.
+ */
+class InputTraceRecorder :
+  public IInputMonitor,
+  public IInputMonitorListener
+{
+public:
+  //! Identification of the trace format.
+  static const char *TRACE_HEADER;
+
+  InputTraceRecorder(IInputMonitor *monitor, const std::string &filename);
+  virtual ~InputTraceRecorder();
+
+  // IInputMonitor
+  virtual bool init();
+  virtual void terminate();
+  virtual void subscribe_activity(IInputMonitorListener *listener);
+  virtual void subscribe_statistics(IInputMonitorListener *listener);
+  virtual void unsubscribe_activity(IInputMonitorListener *listener);
+  virtual void unsubscribe_statistics(IInputMonitorListener *listener);
+  virtual void set_idle_threshold(int idle);
+
+  // IInputMonitorListener
+  virtual void action_notify();
+  virtual void mouse_notify(int x, int y, int wheel = 0);
+  virtual void button_notify(bool is_press);
+  virtual void keyboard_notify(bool repeat);
+
+private:
+  //! Writes the timestamp of a new event.
+  std::ofstream &record();
+
+private:
+  //! The decorated monitor.
+  IInputMonitor *monitor;
+
+  //! The actual activity listener.
+  IInputMonitorListener *activity_listener;
+
+  //! The trace file.
+  std::ofstream trace;
+
+  //! Time of the previous event.
+  gint64 last_event_time;
+
+  //! Internal locking
+  Mutex lock;
+};
+
+#endif // INPUTTRACERECORDER_HH
@@ -0,0 +1,222 @@
+// Metrics.cc --- Hot path metrics
+//
+// Copyright (C) 2017 Rob Caelers <robc@krandor.nl>
+// All rights reserved.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <sstream>
+
+#include "debug.hh"
+
+#include "Metrics.hh"
+#include "IMetricsProvider.hh"
+#include "Util.hh"
+
+using namespace std;
+
+Metrics *Metrics::instance = NULL;
+
+//! Upper bounds of the latency buckets (µs). The last bucket is unbounded.
+static const gint64 latency_bounds[Metrics::LATENCY_BUCKETS - 1] =
+  {
+    10, 100, 500, 1000, 5000, 10000, 100000
+  };
+
+static const char *counter_names[Metrics::COUNTER_SIZEOF] =
+  {
+    "input.action",
+    "input.mouse",
+    "input.button",
+    "input.keyboard",
+    "core.timewarp",
+    "core.state_save",
+    "configurator.save",
+    "configurator.save_coalesced",
+    "configurator.save_failed",
+  };
+
+static const char *gauge_names[Metrics::GAUGE_SIZEOF] =
+  {
+    "input.events_per_minute",
+    "core.user_timers",
+  };
+
+static const char *latency_names[Metrics::LATENCY_SIZEOF] =
+  {
+    "core.heartbeat",
+    "core.process_timers",
+    "configurator.heartbeat",
+    "idlelog.update",
+    "input.callback",
+  };
+
+
+Metrics::Metrics() :
+  input_events_minute_start(0)
+{
+  for (int i = 0; i < COUNTER_SIZEOF; i++)
+    {
+      counters[i] = 0;
+    }
+
+  for (int i = 0; i < GAUGE_SIZEOF; i++)
+    {
+      gauges[i] = 0;
+    }
+
+  for (int i = 0; i < LATENCY_SIZEOF; i++)
+    {
+      Histogram &h = histograms[i];
+      h.count = h.total = h.max = 0;
+      for (int j = 0; j < LATENCY_BUCKETS; j++)
+        {
+          h.buckets[j] = 0;
+        }
+    }
+
+  start_time = minute_start = g_get_monotonic_time();
+}
+
+
+void
+Metrics::add_latency(LatencyId id, gint64 usec)
+{
+  int bucket = 0;
+  while (bucket < LATENCY_BUCKETS - 1 && usec > latency_bounds[bucket])
+    {
+      bucket++;
+    }
+
+  lock.lock();
+  Histogram &h = histograms[id];
+  h.count++;
+  h.total += usec;
+  h.max = MAX(h.max, usec);
+  h.buckets[bucket]++;
+  lock.unlock();
+}
+
+
+void
+Metrics::heartbeat()
+{
+  gint64 now = g_get_monotonic_time();
+
+  if (now - minute_start >= 60 * G_USEC_PER_SEC)
+    {
+      gint events = (g_atomic_int_get(&counters[COUNTER_INPUT_ACTION]) +
+                     g_atomic_int_get(&counters[COUNTER_INPUT_MOUSE]) +
+                     g_atomic_int_get(&counters[COUNTER_INPUT_BUTTON]) +
+                     g_atomic_int_get(&counters[COUNTER_INPUT_KEYBOARD]));
+
+      set_gauge(GAUGE_INPUT_EVENTS_PER_MINUTE, events - input_events_minute_start);
+
+      input_events_minute_start = events;
+      minute_start = now;
+    }
+}
+
+
+void
+Metrics::add_provider(IMetricsProvider *provider)
+{
+  lock.lock();
+  providers.push_back(provider);
+  lock.unlock();
+}
+
+
+void
+Metrics::remove_provider(IMetricsProvider *provider)
+{
+  lock.lock();
+  providers.remove(provider);
+  lock.unlock();
+}
+
+
+//! Returns all metrics as text, one metric per line.
+/*!
+ *  Counters:   counter <name> <value>
+ *  Gauges:     gauge <name> <value>
+ *  Histograms: latency <name> <count> <total-us> <max-us> <bucket>...
+ *
+ *  followed by the lines of the providers.
+ */
+string
+Metrics::get_metrics()
+{
+  stringstream ss;
+
+  ss << "uptime " << (g_get_monotonic_time() - start_time) / G_USEC_PER_SEC << endl;
+
+  for (int i = 0; i < COUNTER_SIZEOF; i++)
+    {
+      ss << "counter " << counter_names[i] << " " << g_atomic_int_get(&counters[i]) << endl;
+    }
+
+  for (int i = 0; i < GAUGE_SIZEOF; i++)
+    {
+      ss << "gauge " << gauge_names[i] << " " << g_atomic_int_get(&gauges[i]) << endl;
+    }
+
+  ss << "buckets";
+  for (int j = 0; j < LATENCY_BUCKETS - 1; j++)
+    {
+      ss << " " << latency_bounds[j];
+    }
+  ss << " inf" << endl;
+
+  lock.lock();
+  for (int i = 0; i < LATENCY_SIZEOF; i++)
+    {
+      const Histogram &h = histograms[i];
+
+      ss << "latency " << latency_names[i] << " " << h.count << " " << h.total << " " << h.max;
+      for (int j = 0; j < LATENCY_BUCKETS; j++)
+        {
+          ss << " " << h.buckets[j];
+        }
+      ss << endl;
+    }
+
+  for (list<IMetricsProvider *>::iterator i = providers.begin(); i != providers.end(); i++)
+    {
+      (*i)->get_metrics(ss);
+    }
+  lock.unlock();
+
+  return ss.str();
+}
+
+
+bool
+Metrics::dump()
+{
+  string filename = Util::get_home_directory() + "metrics.txt";
+  TRACE_ENTER_MSG("Metrics::dump", filename);
+
+  string metrics = get_metrics();
+  bool ret = g_file_set_contents(filename.c_str(), metrics.data(), metrics.size(), NULL);
+
+  TRACE_RETURN(ret);
+  return ret;
+}
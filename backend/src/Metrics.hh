@@ -0,0 +1,191 @@
+// Metrics.hh --- Hot path metrics
+//
+// Copyright (C) 2017 Rob Caelers <robc@krandor.nl>
+// All rights reserved.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#ifndef METRICS_HH
+#define METRICS_HH
+
+#include <list>
+#include <string>
+
+#include <glib.h>
+
+#include "Mutex.hh"
+
+class IMetricsProvider;
+
+//! Registry of performance metrics.
+/*!
+ *  All metrics are known at compile time and stored in fixed arrays, so
+ *  updating a metric is an array access. Counters and gauges are updated
+ *  atomically and may be used from any thread. Latency histograms use
+ *  fixed buckets.
+ */
+class Metrics
+{
+public:
+  enum CounterId
+    {
+      COUNTER_INPUT_ACTION,
+      COUNTER_INPUT_MOUSE,
+      COUNTER_INPUT_BUTTON,
+      COUNTER_INPUT_KEYBOARD,
+      COUNTER_TIMEWARP,
+      COUNTER_STATE_SAVE,
+      COUNTER_CONFIG_SAVE,
+      COUNTER_CONFIG_SAVE_COALESCED,
+      COUNTER_CONFIG_SAVE_FAILED,
+      COUNTER_SIZEOF
+    };
+
+  enum GaugeId
+    {
+      GAUGE_INPUT_EVENTS_PER_MINUTE,
+      GAUGE_USER_TIMERS,
+      GAUGE_SIZEOF
+    };
+
+  enum LatencyId
+    {
+      LATENCY_HEARTBEAT,
+      LATENCY_PROCESS_TIMERS,
+      LATENCY_CONFIGURATOR_HEARTBEAT,
+      LATENCY_IDLELOG_UPDATE,
+      // Sampled, see ActivityMonitor::process_action().
+      LATENCY_INPUT_CALLBACK,
+      LATENCY_SIZEOF
+    };
+
+  //! Number of buckets of a latency histogram.
+  static const int LATENCY_BUCKETS = 8;
+
+  static Metrics *get_instance();
+
+  //! Increments a counter.
+  void increment(CounterId id);
+
+  //! Sets a gauge.
+  void set_gauge(GaugeId id, int value);
+
+  //! Records a latency (in µs).
+  void add_latency(LatencyId id, gint64 usec);
+
+  //! Updates the derived gauges. Called once per second.
+  void heartbeat();
+
+  //! Adds a provider of metrics that are not known at compile time.
+  void add_provider(IMetricsProvider *provider);
+
+  //! Removes a provider.
+  void remove_provider(IMetricsProvider *provider);
+
+  //! Returns all metrics as text.
+  std::string get_metrics();
+
+  //! Writes all metrics to metrics.txt in the Workrave directory.
+  bool dump();
+
+private:
+  Metrics();
+
+  struct Histogram
+  {
+    gint64 count;
+    gint64 total;
+    gint64 max;
+    gint64 buckets[LATENCY_BUCKETS];
+  };
+
+private:
+  //! The one and only instance
+  static Metrics *instance;
+
+  //! Counter values.
+  volatile gint counters[COUNTER_SIZEOF];
+
+  //! Gauge values.
+  volatile gint gauges[GAUGE_SIZEOF];
+
+  //! Latency histograms.
+  Histogram histograms[LATENCY_SIZEOF];
+
+  //! Number of input events at the start of the current minute.
+  gint input_events_minute_start;
+
+  //! Monotonic time of the start of the current minute.
+  gint64 minute_start;
+
+  //! Monotonic time at which the metrics were created.
+  gint64 start_time;
+
+  //! Providers of additional metrics.
+  std::list<IMetricsProvider *> providers;
+
+  //! Protects the histograms and the providers.
+  Mutex lock;
+};
+
+
+//! Records the time spent in a scope as a latency.
+class MetricsTimer
+{
+public:
+  MetricsTimer(Metrics::LatencyId id) :
+    id(id),
+    start(g_get_monotonic_time())
+  {
+  }
+
+  ~MetricsTimer()
+  {
+    Metrics::get_instance()->add_latency(id, g_get_monotonic_time() - start);
+  }
+
+private:
+  Metrics::LatencyId id;
+  gint64 start;
+};
+
+
+inline Metrics *
+Metrics::get_instance()
+{
+  if (instance == NULL)
+    {
+      instance = new Metrics();
+    }
+
+  return instance;
+}
+
+
+inline void
+Metrics::increment(CounterId id)
+{
+  g_atomic_int_inc(&counters[id]);
+}
+
+
+inline void
+Metrics::set_gauge(GaugeId id, int value)
+{
+  g_atomic_int_set(&gauges[id], value);
+}
+
+#endif // METRICS_HH
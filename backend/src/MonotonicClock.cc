@@ -0,0 +1,64 @@
+// MonotonicClock.cc --- Suspend aware monotonic clocks
+//
+// Copyright (C) 2017 Rob Caelers <robc@krandor.nl>
+// All rights reserved.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <time.h>
+
+#include "MonotonicClock.hh"
+
+#if defined(HAVE_CLOCK_GETTIME) && defined(CLOCK_BOOTTIME)
+#define HAVE_BOOTTIME 1
+#endif
+
+
+gint64
+MonotonicClock::get_monotonic_time()
+{
+  return g_get_monotonic_time();
+}
+
+
+gint64
+MonotonicClock::get_boot_time()
+{
+#ifdef HAVE_BOOTTIME
+  struct timespec ts;
+  if (clock_gettime(CLOCK_BOOTTIME, &ts) == 0)
+    {
+      return ((gint64) ts.tv_sec) * G_USEC_PER_SEC + ts.tv_nsec / 1000;
+    }
+#endif
+  return get_monotonic_time();
+}
+
+
+bool
+MonotonicClock::is_suspend_aware()
+{
+#ifdef HAVE_BOOTTIME
+  struct timespec ts;
+  return clock_gettime(CLOCK_BOOTTIME, &ts) == 0;
+#else
+  return false;
+#endif
+}
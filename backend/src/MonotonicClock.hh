@@ -0,0 +1,49 @@
+// MonotonicClock.hh --- Suspend aware monotonic clocks
+//
+// Copyright (C) 2017 Rob Caelers <robc@krandor.nl>
+// All rights reserved.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#ifndef MONOTONICCLOCK_HH
+#define MONOTONICCLOCK_HH
+
+#include <glib.h>
+
+//! Access to the monotonic clocks of the system.
+/*!
+ *  Neither clock is affected by changes of the wall-clock time (manual
+ *  changes or NTP). The difference between the two is the time the system
+ *  spent in suspend.
+ */
+class MonotonicClock
+{
+public:
+  //! Returns monotonic time in µs, not counting time spent in suspend.
+  static gint64 get_monotonic_time();
+
+  //! Returns monotonic time in µs, including time spent in suspend.
+  /*!
+   *  Falls back to get_monotonic_time() on systems without CLOCK_BOOTTIME,
+   *  in which case suspend cannot be measured.
+   */
+  static gint64 get_boot_time();
+
+  //! Is time spent in suspend measurable on this system?
+  static bool is_suspend_aware();
+};
+
+#endif // MONOTONICCLOCK_HH
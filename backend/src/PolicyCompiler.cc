@@ -0,0 +1,288 @@
+// PolicyCompiler.cc --- Compiles a configuration policy
+//
+// Copyright (C) 2017 Rob Caelers <robc@krandor.nl>
+// All rights reserved.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <iostream>
+#include <map>
+#include <string.h>
+#include <vector>
+
+#include <glib.h>
+
+#include "debug.hh"
+
+#include "PolicyCompiler.hh"
+#include "SystemPolicy.hh"
+
+using namespace std;
+using namespace workrave;
+
+//! Group of the ini file with the locked keys.
+static const char POLICY_GROUP[] = "policy";
+
+//! A key of the policy.
+struct PolicyItem
+{
+  PolicyItem() : has_value(false), locked(false) {}
+
+  string value;
+  bool has_value;
+  bool locked;
+};
+
+
+//! Converts a key of workrave.ini to a configuration key.
+static string
+make_key(const string &group, const string &inikey)
+{
+  string key = group + "/" + inikey;
+  for (string::size_type i = group.size(); i < key.size(); i++)
+    {
+      if (key[i] == '.')
+        {
+          key[i] = '/';
+        }
+    }
+  return key;
+}
+
+
+//! Adds a string to the string table, and returns its offset.
+static guint32
+add_string(string &strings, const string &s)
+{
+  guint32 offset = (guint32) strings.size();
+  strings += s;
+  return offset;
+}
+
+
+template<class T>
+static void
+append(string &out, const T &value)
+{
+  out.append((const char *) &value, sizeof(value));
+}
+
+
+bool
+PolicyCompiler::compile(const string &source, const string &target, string &error)
+{
+  TRACE_ENTER_MSG("PolicyCompiler::compile", source << " " << target);
+
+  GKeyFile *config = g_key_file_new();
+  GError *gerror = NULL;
+
+  if (!g_key_file_load_from_file(config, source.c_str(), G_KEY_FILE_NONE, &gerror))
+    {
+      error = gerror != NULL ? gerror->message : source;
+      if (gerror != NULL)
+        {
+          g_error_free(gerror);
+        }
+      g_key_file_free(config);
+      TRACE_RETURN(false);
+      return false;
+    }
+
+  map<string, PolicyItem> items;
+  vector<string> prefixes;
+
+  gchar **groups = g_key_file_get_groups(config, NULL);
+  for (int g = 0; groups != NULL && groups[g] != NULL; g++)
+    {
+      if (strcmp(groups[g], POLICY_GROUP) == 0)
+        {
+          continue;
+        }
+
+      gchar **keys = g_key_file_get_keys(config, groups[g], NULL, NULL);
+      for (int k = 0; keys != NULL && keys[k] != NULL; k++)
+        {
+          gchar *value = g_key_file_get_string(config, groups[g], keys[k], NULL);
+          if (value != NULL)
+            {
+              PolicyItem &item = items[make_key(groups[g], keys[k])];
+              item.value = value;
+              item.has_value = true;
+              g_free(value);
+            }
+        }
+      g_strfreev(keys);
+    }
+  g_strfreev(groups);
+
+  gsize count = 0;
+  gchar **locked = g_key_file_get_string_list(config, POLICY_GROUP, "locked", &count, NULL);
+  for (gsize i = 0; i < count; i++)
+    {
+      string key = g_strstrip(locked[i]);
+      while (key.size() > 0 && key[0] == '/')
+        {
+          key = key.substr(1);
+        }
+
+      if (key.empty())
+        {
+          continue;
+        }
+      else if (key[key.size() - 1] == '/')
+        {
+          prefixes.push_back(key);
+        }
+      else
+        {
+          items[key].locked = true;
+        }
+    }
+  g_strfreev(locked);
+  g_key_file_free(config);
+
+  // Hash table with chains, at most half full.
+  guint32 bucket_count = 1;
+  while (bucket_count < items.size() * 2)
+    {
+      bucket_count <<= 1;
+    }
+
+  vector<guint32> buckets(bucket_count, SystemPolicy::NONE);
+  vector<SystemPolicy::Entry> entries;
+  vector<SystemPolicy::Lock> locks;
+  string strings;
+
+  for (map<string, PolicyItem>::const_iterator i = items.begin(); i != items.end(); i++)
+    {
+      SystemPolicy::Entry e;
+      e.hash = SystemPolicy::hash(i->first.data(), i->first.size());
+      e.key = add_string(strings, i->first);
+      e.key_length = (guint32) i->first.size();
+      e.value = add_string(strings, i->second.value);
+      e.value_length = (guint32) i->second.value.size();
+      e.flags = ((i->second.has_value ? SystemPolicy::ENTRY_FLAG_VALUE : 0) |
+                 (i->second.locked ? SystemPolicy::ENTRY_FLAG_LOCKED : 0));
+
+      guint32 &bucket = buckets[e.hash & (bucket_count - 1)];
+      e.next = bucket;
+      bucket = (guint32) entries.size();
+
+      entries.push_back(e);
+    }
+
+  for (vector<string>::const_iterator i = prefixes.begin(); i != prefixes.end(); i++)
+    {
+      SystemPolicy::Lock lock;
+      lock.prefix = add_string(strings, *i);
+      lock.length = (guint32) i->size();
+      locks.push_back(lock);
+    }
+
+  SystemPolicy::Header header;
+  memcpy(header.magic, SystemPolicy::MAGIC, sizeof(header.magic));
+  header.version = SystemPolicy::VERSION;
+  header.byte_order = SystemPolicy::BYTE_ORDER_MARK;
+  header.bucket_count = bucket_count;
+  header.entry_count = (guint32) entries.size();
+  header.lock_count = (guint32) locks.size();
+  header.strings_size = (guint32) strings.size();
+
+  string out;
+  append(out, header);
+  for (vector<guint32>::const_iterator i = buckets.begin(); i != buckets.end(); i++)
+    {
+      append(out, *i);
+    }
+  for (vector<SystemPolicy::Entry>::const_iterator i = entries.begin(); i != entries.end(); i++)
+    {
+      append(out, *i);
+    }
+  for (vector<SystemPolicy::Lock>::const_iterator i = locks.begin(); i != locks.end(); i++)
+    {
+      append(out, *i);
+    }
+  out += strings;
+
+  bool ret = g_file_set_contents(target.c_str(), out.data(), out.size(), &gerror);
+  if (!ret)
+    {
+      error = gerror != NULL ? gerror->message : target;
+    }
+  if (gerror != NULL)
+    {
+      g_error_free(gerror);
+    }
+
+  TRACE_RETURN(ret);
+  return ret;
+}
+
+
+bool
+PolicyCompiler::run_command_line(int argc, char **argv, int &exit_code)
+{
+  TRACE_ENTER("PolicyCompiler::run_command_line");
+
+  const string compile_opt = "--compile-policy=";
+  const string output_opt = "--policy-output=";
+
+  bool found = false;
+  string source;
+  string target = SystemPolicy::get_default_filename();
+
+  for (int i = 1; i < argc; i++)
+    {
+      string arg = argv[i];
+      if (arg.compare(0, compile_opt.length(), compile_opt) == 0)
+        {
+          source = arg.substr(compile_opt.length());
+          found = true;
+        }
+      else if (arg.compare(0, output_opt.length(), output_opt) == 0)
+        {
+          target = arg.substr(output_opt.length());
+        }
+    }
+
+  if (!found)
+    {
+      TRACE_EXIT();
+      return false;
+    }
+
+  string error;
+  if (target == "")
+    {
+      cerr << "No policy file on this platform, use --policy-output." << endl;
+      exit_code = 1;
+    }
+  else if (!compile(source, target, error))
+    {
+      cerr << "Cannot compile policy: " << error << endl;
+      exit_code = 1;
+    }
+  else
+    {
+      exit_code = 0;
+    }
+
+  TRACE_EXIT();
+  return true;
+}
@@ -0,0 +1,218 @@
+// ReplayInputMonitor.cc --- Replays a recorded input trace
+//
+// Copyright (C) 2017 Rob Caelers <robc@krandor.nl>
+// All rights reserved.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "debug.hh"
+
+#include <sstream>
+
+#include "ReplayInputMonitor.hh"
+#include "InputTraceRecorder.hh"
+
+using namespace std;
+
+ReplayInputMonitor::ReplayInputMonitor(const string &filename, double speed) :
+  filename(filename),
+  speed(speed),
+  event_count(0),
+  abort(false)
+{
+  monitor_thread = new Thread(this);
+  mutex = g_mutex_new();
+  cond = g_cond_new();
+}
+
+
+ReplayInputMonitor::~ReplayInputMonitor()
+{
+  TRACE_ENTER("ReplayInputMonitor::~ReplayInputMonitor");
+  if (monitor_thread != NULL)
+    {
+      monitor_thread->wait();
+      delete monitor_thread;
+    }
+
+  g_mutex_free(mutex);
+  g_cond_free(cond);
+  TRACE_EXIT();
+}
+
+
+bool
+ReplayInputMonitor::init()
+{
+  TRACE_ENTER_MSG("ReplayInputMonitor::init", filename << " " << speed);
+
+  if (filename != "")
+    {
+      trace.open(filename.c_str());
+    }
+
+  string header;
+  if (!trace.is_open() || !getline(trace, header) || header != InputTraceRecorder::TRACE_HEADER)
+    {
+      TRACE_RETURN("Not a trace");
+      return false;
+    }
+
+  monitor_thread->start();
+
+  TRACE_EXIT();
+  return true;
+}
+
+
+void
+ReplayInputMonitor::terminate()
+{
+  TRACE_ENTER("ReplayInputMonitor::terminate");
+
+  g_mutex_lock(mutex);
+  abort = true;
+  g_cond_broadcast(cond);
+  g_mutex_unlock(mutex);
+
+  monitor_thread->wait();
+
+  TRACE_EXIT();
+}
+
+
+int
+ReplayInputMonitor::get_event_count() const
+{
+  return g_atomic_int_get(&event_count);
+}
+
+
+void
+ReplayInputMonitor::run()
+{
+  TRACE_ENTER("ReplayInputMonitor::run");
+
+  gint64 start_time = g_get_monotonic_time();
+  gint64 event_time = 0;
+  string line;
+
+  while (!abort && getline(trace, line))
+    {
+      if (line.empty() || line[0] == '#')
+        {
+          continue;
+        }
+
+      if (replay_event(line, start_time, event_time))
+        {
+          g_atomic_int_inc(&event_count);
+        }
+    }
+
+  TRACE_MSG("Replayed " << event_count << " events");
+  TRACE_EXIT();
+}
+
+
+//! Replays a single line of the trace.
+/*!
+ *  \param line the line to replay.
+ *  \param start_time monotonic time at which the replay started.
+ *  \param event_time time of the previous event relative to the start of
+ *                    the trace (in µs), advanced to the time of this event.
+ *  \return whether an event was fired.
+ */
+bool
+ReplayInputMonitor::replay_event(const string &line, gint64 start_time, gint64 &event_time)
+{
+  istringstream ss(line);
+  gint64 delta;
+  char type;
+
+  if (!(ss >> delta >> type))
+    {
+      return false;
+    }
+
+  event_time += delta * G_TIME_SPAN_MILLISECOND;
+
+  if (speed > 0.0 && !wait_until(start_time + (gint64) (event_time / speed)))
+    {
+      return false;
+    }
+
+  switch (type)
+    {
+    case 'a':
+      fire_action();
+      break;
+
+    case 'm':
+      {
+        int x = 0, y = 0, wheel = 0;
+        ss >> x >> y >> wheel;
+        fire_mouse(x, y, wheel);
+      }
+      break;
+
+    case 'b':
+      {
+        int is_press = 0;
+        ss >> is_press;
+        fire_button(is_press != 0);
+      }
+      break;
+
+    case 'k':
+      {
+        int repeat = 0;
+        ss >> repeat;
+        fire_keyboard(repeat != 0);
+      }
+      break;
+
+    default:
+      return false;
+    }
+
+  return true;
+}
+
+
+//! Waits until the specified monotonic time. Returns false on termination.
+bool
+ReplayInputMonitor::wait_until(gint64 end_time)
+{
+  g_mutex_lock(mutex);
+  while (!abort && g_get_monotonic_time() < end_time)
+    {
+#if GLIB_CHECK_VERSION(2, 32, 0)
+      g_cond_wait_until(cond, mutex, end_time);
+#else
+      g_mutex_unlock(mutex);
+      g_usleep(MIN(end_time - g_get_monotonic_time(), G_TIME_SPAN_SECOND / 10));
+      g_mutex_lock(mutex);
+#endif
+    }
+  bool ret = !abort;
+  g_mutex_unlock(mutex);
+
+  return ret;
+}
@@ -0,0 +1,90 @@
+// ReplayInputMonitor.hh --- Replays a recorded input trace
+//
+// Copyright (C) 2017 Rob Caelers <robc@krandor.nl>
+// All rights reserved.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef REPLAYINPUTMONITOR_HH
+#define REPLAYINPUTMONITOR_HH
+
+#include <string>
+#include <fstream>
+
+#include "InputMonitor.hh"
+
+#include "Runnable.hh"
+#include "Thread.hh"
+
+//! Input monitor that replays a trace written by the InputTraceRecorder.
+class ReplayInputMonitor :
+  public InputMonitor,
+  public Runnable
+{
+public:
+  //! Constructor.
+  /*!
+   *  \param filename trace to replay.
+   *  \param speed replay speed relative to the recording, 0 replays as
+   *               fast as possible.
+   */
+  ReplayInputMonitor(const std::string &filename, double speed = 1.0);
+
+  //! Destructor.
+  virtual ~ReplayInputMonitor();
+
+  //! Initialize
+  virtual bool init();
+
+  //! Terminate the monitor.
+  virtual void terminate();
+
+  //! Returns the number of replayed events.
+  int get_event_count() const;
+
+private:
+  //! The monitor's execution thread.
+  virtual void run();
+
+  //! Replays a single line of the trace.
+  bool replay_event(const std::string &line, gint64 start_time, gint64 &event_time);
+
+  //! Waits until the specified monotonic time.
+  bool wait_until(gint64 end_time);
+
+private:
+  //! The trace file name.
+  std::string filename;
+
+  //! The trace.
+  std::ifstream trace;
+
+  //! Replay speed.
+  double speed;
+
+  //! Number of replayed events.
+  volatile gint event_count;
+
+  //! Abort the main loop
+  bool abort;
+
+  //! The activity monitor thread.
+  Thread *monitor_thread;
+
+  GMutex *mutex;
+  GCond *cond;
+};
+
+#endif // REPLAYINPUTMONITOR_HH
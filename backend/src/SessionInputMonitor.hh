@@ -0,0 +1,67 @@
+// SessionInputMonitor.hh --- Input monitor of a session of a host
+//
+// Copyright (C) 2017 Rob Caelers <robc@krandor.nl>
+// All rights reserved.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef SESSIONINPUTMONITOR_HH
+#define SESSIONINPUTMONITOR_HH
+
+#include "InputMonitor.hh"
+
+//! Input monitor that passes on the input the host reports for a session.
+class SessionInputMonitor : public InputMonitor
+{
+public:
+  SessionInputMonitor()
+  {
+  }
+
+  virtual ~SessionInputMonitor() {}
+
+  //! Initializes the monitor.
+  bool init()
+  {
+    return true;
+  }
+
+  //! Stops the monitor.
+  void terminate()
+  {
+  }
+
+  void report_action()
+  {
+    fire_action();
+  }
+
+  void report_mouse(int x, int y, int wheel)
+  {
+    fire_mouse(x, y, wheel);
+  }
+
+  void report_button(bool is_press)
+  {
+    fire_button(is_press);
+  }
+
+  void report_keyboard(bool repeat)
+  {
+    fire_keyboard(repeat);
+  }
+};
+
+#endif // SESSIONINPUTMONITOR_HH
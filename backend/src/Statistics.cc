@@ -22,6 +22,7 @@
 #endif
 
 
+#include <algorithm>
 #include <cstring>
 #include <sstream>
 #include <assert.h>
@@ -29,9 +30,16 @@
 
 #include "debug.hh"
 
+#include <glib/gstdio.h>
+
 #include "Statistics.hh"
+#include "StatisticsArchive.hh"
+#include "StatisticsExporter.hh"
+#include "StatisticsReader.hh"
 
 #include "Core.hh"
+#include "Configurator.hh"
+#include "CoreConfig.hh"
 #include "Util.hh"
 #include "Timer.hh"
 #include "TimePred.hh"
@@ -43,23 +51,24 @@
 #include "DistributionManager.hh"
 #endif
 
-const char *WORKRAVESTATS="WorkRaveStats";
-const int STATSVERSION = 4;
+static bool
+day_less(const IStatistics::DailyStats &a, const IStatistics::DailyStats &b)
+{
+  return StatisticsTable::get_day_number(a.start) < StatisticsTable::get_day_number(b.start);
+}
 
-#define MAX_JUMP (10000)
 
 //! Constructor
 Statistics::Statistics() :
   core(NULL),
   current_day(NULL),
   been_active(false),
-  prev_x(-1),
-  prev_y(-1),
-  click_x(-1),
-  click_y(-1)
+  archive_loaded(false),
+  archive_size(0),
+  table_dirty(true),
+  series_origin(0),
+  series_origin_day(-1)
 {
-  last_mouse_time.tv_sec = 0;
-  last_mouse_time.tv_usec = 0;
 }
 
 
@@ -73,6 +82,7 @@ Statistics::~Statistics()
       delete *i;
     }
 
+  unload_archive();
   delete current_day;
 
   if (input_monitor != NULL)
@@ -106,6 +116,7 @@ Statistics::init(Core *control)
     }
 
   load_history();
+  load_series();
 }
 
 
@@ -131,10 +142,59 @@ Statistics::update()
 
   update_current_day(state == ACTIVITY_ACTIVE);
   save_day(current_day);
+
+  if (series.get_day() != -1)
+    {
+      series.save(Util::get_home_directory() + "todayseries");
+    }
   TRACE_EXIT();
 }
 
 
+//! Records the per-minute activity of the current day. Called every second.
+void
+Statistics::heartbeat()
+{
+  if (current_day == NULL || current_day->is_empty())
+    {
+      return;
+    }
+
+  gint32 day = StatisticsTable::get_day_number(current_day->start);
+  if (day != series.get_day())
+    {
+      // The start of the day moves to the first activity.
+      series.reset(day);
+    }
+
+  if (day != series_origin_day)
+    {
+      struct tm midnight = current_day->start;
+      midnight.tm_hour = 0;
+      midnight.tm_min = 0;
+      midnight.tm_sec = 0;
+      midnight.tm_isdst = -1;
+
+      series_origin = mktime(&midnight);
+      series_origin_day = day;
+    }
+
+  gint64 totals[StatisticsSeries::SERIES_SIZEOF];
+
+  Timer *t = core->get_break(BREAK_ID_DAILY_LIMIT)->get_timer();
+  totals[STATS_SERIES_ACTIVE_TIME] = t->get_elapsed_time();
+
+  // Input counters are updated by the monitor thread.
+  lock.lock();
+  totals[STATS_SERIES_KEYSTROKES] = current_day->misc_stats[STATS_VALUE_TOTAL_KEYSTROKES];
+  totals[STATS_SERIES_CLICKS] = current_day->misc_stats[STATS_VALUE_TOTAL_CLICKS];
+  totals[STATS_SERIES_MOUSE_MOVEMENT] = current_day->misc_stats[STATS_VALUE_TOTAL_MOUSE_MOVEMENT];
+  lock.unlock();
+
+  series.sample((int)((core->get_time() - series_origin) / 60), totals);
+}
+
+
 bool 
 Statistics::delete_all_history()
 {
@@ -151,7 +211,25 @@ Statistics::delete_all_history()
             ;
 
         history.clear();
+        table_dirty = true;
+    }
+
+    string archivefile = Util::get_home_directory() + "archivestats";
+    if( Util::file_exists( archivefile.c_str() ) && std::remove( archivefile.c_str() ) )
+    {
+        return false;
+    }
+    unload_archive();
+    archive_size = 0;
+
+    string histseries = Util::get_home_directory() + "historyseries";
+    string todayseries = Util::get_home_directory() + "todayseries";
+    if( ( Util::file_exists( histseries.c_str() ) && std::remove( histseries.c_str() ) ) ||
+        ( Util::file_exists( todayseries.c_str() ) && std::remove( todayseries.c_str() ) ) )
+    {
+        return false;
     }
+    series.reset(-1);
 
     string todayfile = Util::get_home_directory() + "todaystats";
     if( Util::file_exists( todayfile.c_str() ) && std::remove( todayfile.c_str() ) )
@@ -192,6 +270,7 @@ Statistics::start_new_day()
           TRACE_MSG("Save old day");
           day_to_history(current_day);
           day_to_remote_history(current_day);
+          series_to_history();
         }
 
       current_day = new DailyStatsImpl();
@@ -199,6 +278,10 @@ Statistics::start_new_day()
 
       current_day->start = *tmnow;
       current_day->stop = *tmnow;
+
+      // Return to the steady state once a day.
+      unload_archive();
+      compact_history();
     }
 
   update_current_day(false);
@@ -222,7 +305,7 @@ Statistics::day_to_history(DailyStatsImpl *stats)
 
   if (!exists)
     {
-      stats_file << WORKRAVESTATS << " " << STATSVERSION  << endl;
+      stats_file << StatisticsReader::TAG << " " << StatisticsReader::VERSION  << endl;
     }
 
   save_day(stats, stats_file);
@@ -231,6 +314,207 @@ Statistics::day_to_history(DailyStatsImpl *stats)
 }
 
 
+//! Rewrites the history file with the recent history.
+void
+Statistics::save_history()
+{
+  TRACE_ENTER("Statistics::save_history");
+
+  string filename = Util::get_home_directory() + "historystats";
+  string tmp = filename + ".new";
+
+  ofstream stats_file(tmp.c_str());
+  stats_file << StatisticsReader::TAG << " " << StatisticsReader::VERSION  << endl;
+
+  for (HistoryIter i = history.begin(); i != history.end(); i++)
+    {
+      save_day(*i, stats_file);
+    }
+  stats_file.close();
+
+  if (stats_file.fail() || g_rename(tmp.c_str(), filename.c_str()) != 0)
+    {
+      g_unlink(tmp.c_str());
+    }
+
+  TRACE_EXIT();
+}
+
+
+//! Returns the first day within the retention period, or -1 to keep all days.
+gint32
+Statistics::get_retention_cutoff(gint32 today) const
+{
+  int months = 0;
+  core->get_configurator()->get_value_with_default(CoreConfig::CFG_KEY_STATISTICS_RETENTION, months, 0);
+
+  if (months <= 0 || today < 1)
+    {
+      return -1;
+    }
+
+  GDate date;
+  g_date_clear(&date, 1);
+  g_date_set_julian(&date, today);
+  g_date_subtract_months(&date, months);
+  return g_date_get_julian(&date);
+}
+
+
+//! Moves the days older than the retention period to the archive.
+/*!
+ *  The days are first appended to the archive, and then removed from the
+ *  history file. If the history file is not rewritten, the days are
+ *  moved again later; days that are already archived are skipped. The
+ *  archive itself is not read.
+ */
+void
+Statistics::compact_history()
+{
+  TRACE_ENTER("Statistics::compact_history");
+
+  gint32 today = current_day != NULL ? StatisticsTable::get_day_number(current_day->start) : -1;
+  gint32 cutoff = get_retention_cutoff(today);
+  if (cutoff < 0)
+    {
+      TRACE_EXIT();
+      return;
+    }
+
+  HistoryIter end = history.begin();
+  while (end != history.end() && StatisticsTable::get_day_number((*end)->start) < cutoff)
+    {
+      end++;
+    }
+
+  if (end == history.begin())
+    {
+      TRACE_EXIT();
+      return;
+    }
+
+  string filename = Util::get_home_directory() + "archivestats";
+
+  StatisticsArchive::Days days;
+  for (HistoryIter i = history.begin(); i != end; i++)
+    {
+      days.push_back(**i);
+    }
+  std::stable_sort(days.begin(), days.end(), day_less);
+
+  if (StatisticsArchive::append(filename, days))
+    {
+      unload_archive();
+      archive_size = StatisticsArchive::read_size(filename);
+
+      for (HistoryIter i = history.begin(); i != end; i++)
+        {
+          delete *i;
+        }
+      history.erase(history.begin(), end);
+      table_dirty = true;
+
+      save_history();
+    }
+
+  TRACE_EXIT();
+}
+
+
+//! Loads the archived history.
+void
+Statistics::load_archive() const
+{
+  if (archive_loaded)
+    {
+      return;
+    }
+
+  TRACE_ENTER("Statistics::load_archive");
+
+  StatisticsArchive::Days days;
+  StatisticsArchive::read(Util::get_home_directory() + "archivestats", days);
+
+  for (StatisticsArchive::Days::const_iterator i = days.begin(); i != days.end(); i++)
+    {
+      DailyStatsImpl *stats = new DailyStatsImpl();
+      *static_cast<DailyStats *>(stats) = *i;
+      archive.push_back(stats);
+    }
+
+  archive_size = archive.size();
+  archive_loaded = true;
+  table_dirty = true;
+
+  TRACE_RETURN(archive_size);
+}
+
+
+//! Loads the archived history if it may contain days on or after the specified day.
+void
+Statistics::load_archive_for(gint32 first_day) const
+{
+  if (archive_size > 0 &&
+      (history.empty() || first_day < StatisticsTable::get_day_number(history.front()->start)))
+    {
+      load_archive();
+    }
+}
+
+
+//! Frees the archived history.
+/*!
+ *  get_day only hands out copies of archived days, so no caller refers
+ *  to the freed days.
+ */
+void
+Statistics::unload_archive()
+{
+  if (archive_loaded)
+    {
+      for (HistoryIter i = archive.begin(); i != archive.end(); i++)
+        {
+          delete *i;
+        }
+      archive.clear();
+      archive_loaded = false;
+      table_dirty = true;
+    }
+}
+
+
+//! Returns a day of the archived and recent history, oldest first.
+Statistics::DailyStatsImpl *
+Statistics::get_history_day(int pos) const
+{
+  if (pos < archive_size)
+    {
+      load_archive();
+      return pos < int(archive.size()) ? archive[pos] : NULL;
+    }
+
+  pos -= archive_size;
+  return pos < int(history.size()) ? history[pos] : NULL;
+}
+
+
+//! Appends the series of the current day to the history, and clears it.
+/*!
+ *  Like the daily statistics, the series are kept for the retention
+ *  period; the archive has no per-minute values.
+ */
+void
+Statistics::series_to_history()
+{
+  if (!series.is_empty())
+    {
+      series.append(Util::get_home_directory() + "historyseries",
+                    get_retention_cutoff(series.get_day()));
+    }
+  series.reset(-1);
+}
+
+
 //! Adds the current day to this history.
 void
 Statistics::day_to_remote_history(DailyStatsImpl *stats)
@@ -290,7 +574,10 @@ Statistics::save_day(DailyStatsImpl *stats, ofstream &stats_file)
     }
   stats_file << endl;
 
-  stats_file.close();
+  for (UserTimerStats::const_iterator i = stats->user_timer_stats.begin(); i != stats->user_timer_stats.end(); i++)
+    {
+      stats_file << "U " << i->first << " " << i->second << endl;
+    }
 }
 
 
@@ -304,7 +591,7 @@ Statistics::save_day(DailyStatsImpl *stats)
 
   ofstream stats_file(ss.str().c_str());
 
-  stats_file << WORKRAVESTATS << " " << STATSVERSION  << endl;
+  stats_file << StatisticsReader::TAG << " " << StatisticsReader::VERSION  << endl;
 
   save_day(stats, stats_file);
 }
@@ -314,6 +601,8 @@ Statistics::save_day(DailyStatsImpl *stats)
 void
 Statistics::add_history(DailyStatsImpl *stats)
 {
+  table_dirty = true;
+
   if (history.size() == 0)
     {
       history.push_back(stats);
@@ -396,145 +685,53 @@ Statistics::load_history()
   ifstream stats_file(ss.str().c_str());
 
   load(stats_file, true);
+
+  archive_size = StatisticsArchive::read_size(Util::get_home_directory() + "archivestats");
+  compact_history();
   TRACE_EXIT();
 }
 
 
-//! Loads the statistics.
+//! Loads the series of the current day.
 void
-Statistics::load(ifstream &infile, bool history)
+Statistics::load_series()
 {
-  TRACE_ENTER("Statistics::load");
+  TRACE_ENTER("Statistics::load_series");
 
-  DailyStatsImpl *stats = NULL;
-
-  bool ok = infile.good();
-
-  if (ok)
+  if (series.load(Util::get_home_directory() + "todayseries") &&
+      series.get_day() != StatisticsTable::get_day_number(current_day->start))
     {
-      string tag;
-      infile >> tag;
-
-      ok = (tag == WORKRAVESTATS);
+      // Left behind by a day that did not end properly.
+      series_to_history();
     }
 
-  if (ok)
-    {
-      int version;
-      infile >> version;
-
-      ok = (version == STATSVERSION) || (version == 3);
-    }
+  TRACE_EXIT();
+}
 
 
-  while (ok && !infile.eof())
-    {
-      char line[BUFSIZ] = "";
-      char cmd;
+//! Loads the statistics.
+void
+Statistics::load(ifstream &infile, bool history)
+{
+  TRACE_ENTER("Statistics::load");
 
-      infile.getline(line, BUFSIZ);
+  StatisticsReader reader(infile);
 
-      if (strlen(line) > 1)
+  DailyStatsImpl *stats = new DailyStatsImpl();
+  while (reader.next(*stats))
+    {
+      if (!history)
         {
-          cmd = line[0];
-
-          stringstream ss(line+1);
-
-          if (cmd == 'D')
-            {
-              if (history && stats != NULL)
-                {
-                  add_history(stats);
-                  stats = NULL;
-                }
-              else if (!history && stats != NULL)
-                {
-                  /* Corrupt today stats */
-                  return;
-                }
-
-              stats = new DailyStatsImpl();
-
-              ss >> stats->start.tm_mday
-                 >> stats->start.tm_mon
-                 >> stats->start.tm_year
-                 >> stats->start.tm_hour
-                 >> stats->start.tm_min
-                 >> stats->stop.tm_mday
-                 >> stats->stop.tm_mon
-                 >> stats->stop.tm_year
-                 >> stats->stop.tm_hour
-                 >> stats->stop.tm_min;
-
-              if (!history)
-                {
-                  current_day = stats;
-                }
-            }
-          else if (stats != NULL)
-            {
-              if (cmd == 'B')
-                {
-                  int bt, size;
-                  ss >> bt;
-                  ss >> size;
-
-                  BreakStats &bs = stats->break_stats[bt];
-
-                  if (size > STATS_BREAKVALUE_SIZEOF)
-                    {
-                      size = STATS_BREAKVALUE_SIZEOF;
-                    }
-
-                  for(int j = 0; j < size; j++)
-                    {
-                      int value;
-                      ss >> value;
-
-                      bs[j] = value;
-                    }
-                }
-              else if (cmd == 'M' || cmd == 'm')
-                {
-                  int size;
-                  ss >> size;
-
-                  if (size > STATS_VALUE_SIZEOF)
-                    {
-                      size = STATS_VALUE_SIZEOF;
-                    }
-
-                  for(int j = 0; j < size; j++)
-                    {
-                      int value;
-                      ss >> value;
-
-                      if (cmd == 'm')
-                        {
-                          // Ignore older 'M' stats. they are broken....
-                          stats->misc_stats[j] = value;
-                        }
-                      else
-                        {
-                          stats->misc_stats[j] = 0;
-                        }
-                    }
-                }
-              else if (cmd == 'G')
-                {
-                  int total_active;
-                  ss >> total_active;
-
-                  stats->misc_stats[STATS_VALUE_TOTAL_ACTIVE_TIME] = total_active;
-                }
-            }
+          // Only the first day of the today stats is used.
+          current_day = stats;
+          stats = NULL;
+          break;
         }
-    }
 
-  if (history && stats != NULL)
-    {
       add_history(stats);
+      stats = new DailyStatsImpl();
     }
+  delete stats;
 
   TRACE_EXIT();
 }
@@ -578,6 +775,19 @@ Statistics::add_break_counter(BreakId bt, StatsBreakValueType st, int value)
   bs[st] += value;
 }
 
+//! Increment the limit counter of a user defined timer for the current day.
+void
+Statistics::increment_user_timer_counter(const std::string &name)
+{
+  if (current_day == NULL)
+    {
+      start_new_day();
+    }
+
+  current_day->user_timer_stats[name]++;
+}
+
+
 void
 Statistics::set_counter(StatsValueType t, int value)
 {
@@ -626,15 +836,77 @@ Statistics::dump()
 }
 
 
-Statistics::DailyStatsImpl *
-Statistics::get_current_day() const
+//! Exports the history and the current day as CSV or JSON.
+/*!
+ *  The export is written to export.csv or export.json in the Workrave
+ *  directory; DBus clients cannot choose the file.
+ *
+ *  \return the name of the file, or an empty string on failure.
+ */
+string
+Statistics::export_statistics(string format, string from, string to)
 {
-  return current_day;
+  TRACE_ENTER_MSG("Statistics::export_statistics", format);
+
+  StatisticsExporter::Format fmt;
+  if (!StatisticsExporter::parse_format(format, fmt))
+    {
+      TRACE_RETURN("Unknown format");
+      return "";
+    }
+
+  string filename = Util::get_home_directory() + "export." + format;
+  ofstream out(filename.c_str(), ios::out | ios::trunc);
+  StatisticsExporter exporter(out, fmt);
+  if (!out.good() || !exporter.set_range(from, to))
+    {
+      TRACE_RETURN("Failed");
+      return "";
+    }
+
+  update_current_day(false);
+  load_archive();
+
+  exporter.begin();
+  for (History::const_iterator i = archive.begin(); i != archive.end(); i++)
+    {
+      exporter.write_day(**i);
+    }
+  for (History::const_iterator i = history.begin(); i != history.end(); i++)
+    {
+      exporter.write_day(**i);
+    }
+  if (current_day != NULL)
+    {
+      exporter.write_day(*current_day);
+    }
+  exporter.end();
+
+  if (!out.good())
+    {
+      filename = "";
+    }
+
+  TRACE_RETURN(filename);
+  return filename;
 }
 
 
-Statistics::DailyStatsImpl *
-Statistics::get_day(int day) const
+bool
+Statistics::get_current_day(DailyStats &stats) const
+{
+  if (current_day == NULL)
+    {
+      return false;
+    }
+
+  stats = *current_day;
+  return true;
+}
+
+
+bool
+Statistics::get_day(int day, DailyStats &stats) const
 {
   DailyStatsImpl *ret = NULL;
 
@@ -644,9 +916,10 @@ Statistics::get_day(int day) const
     }
   else
     {
+      int size = get_history_size();
       if (day > 0)
         {
-          day = history.size() - day;
+          day = size - day;
         }
       else
         {
@@ -654,13 +927,17 @@ Statistics::get_day(int day) const
           day--;
         }
 
-      if (day < int(history.size()) && day >= 0)
+      if (day < size && day >= 0)
         {
-          ret = history[day];
+          ret = get_history_day(day);
         }
     }
 
-  return ret;
+  if (ret != NULL)
+    {
+      stats = *ret;
+    }
+  return ret != NULL;
 }
 
 void
@@ -669,10 +946,23 @@ Statistics::get_day_index_by_date(int y, int m, int d,
 {
   TRACE_ENTER_MSG("Statistics::get_day_by_date", y << "/" << m << "/" << d);
   idx = next = prev = -1;
-  for (int i = 0; i <= int(history.size()); i++)
+
+  // The archive is only needed for dates up to the oldest recent day.
+  int size = get_history_size();
+  int first = archive_size;
+  if (history.empty() || !history.front()->starts_before_date(y, m, d))
     {
-      int j = history.size() - i;
-      DailyStatsImpl *stats = j == 0 ? current_day : history[i];
+      first = 0;
+    }
+
+  for (int i = first; i <= size; i++)
+    {
+      int j = size - i;
+      DailyStatsImpl *stats = j == 0 ? current_day : get_history_day(i);
+      if (stats == NULL)
+        {
+          continue;
+        }
       if (idx < 0 && stats->starts_at_date(y, m, d))
         {
           idx = j;
@@ -703,7 +993,7 @@ Statistics::get_day_index_by_date(int y, int m, int d,
 int
 Statistics::get_history_size() const
 {
-  return history.size();
+  return archive_size + history.size();
 }
 
 
@@ -993,104 +1283,218 @@ Statistics::action_notify()
 void
 Statistics::mouse_notify(int x, int y, int wheel_delta)
 {
-  static const int sensitivity = 3;
+  InputEvent event = InputEvent::mouse(g_get_real_time(), x, y, wheel_delta);
+  batch_notify(&event, 1);
+}
 
-  lock.lock();
 
-  if (current_day != NULL && x >=0 && y >= 0)
-    {
-      int delta_x = sensitivity;
-      int delta_y = sensitivity;
+//! Mouse button activity is reported by the input monitor.
+void
+Statistics::button_notify(bool is_press)
+{
+  InputEvent event = InputEvent::button(0, is_press);
+  batch_notify(&event, 1);
+}
 
-      if (prev_x != -1 && prev_y != -1)
-        {
-          delta_x = abs(x - prev_x);
-          delta_y = abs(y - prev_y);
-        }
 
-      prev_x = x;
-      prev_y = y;
+//! Keyboard activity is reported by the input monitor.
+void
+Statistics::keyboard_notify(bool repeat)
+{
+  if (repeat)
+    return;
 
-      // Sanity checks, ignore unreasonable large jumps...
-      if ( delta_x < MAX_JUMP && delta_y < MAX_JUMP &&
-          (delta_x >= sensitivity || delta_y >= sensitivity || wheel_delta != 0 ))
-        {
-          int64_t movement = current_day->misc_stats[STATS_VALUE_TOTAL_MOUSE_MOVEMENT];
-          int distance = int(sqrt((double)(delta_x * delta_x + delta_y * delta_y)));
+  InputEvent event = InputEvent::keyboard(0, repeat);
+  batch_notify(&event, 1);
+}
 
-          movement += distance;
-          if (movement > 0)
-            {
-              current_day->misc_stats[STATS_VALUE_TOTAL_MOUSE_MOVEMENT] = movement;
-            }
 
-          GTimeVal now, tv;
+//! A batch of input events is reported by the input monitor.
+void
+Statistics::batch_notify(const InputEvent *events, int count)
+{
+  lock.lock();
+  if (current_day != NULL)
+    {
+      input.process(events, count, current_day->misc_stats, current_day->total_mouse_time);
+    }
+  lock.unlock();
+}
 
-          g_get_current_time(&now);
-          tvSUBTIME(tv, now, last_mouse_time);
 
-          if (!tvTIMEEQ0(last_mouse_time) && tv.tv_sec < 1 && tv.tv_sec >= 0 && tv.tv_usec >= 0)
-            {
-              tvADDTIME(current_day->total_mouse_time, current_day->total_mouse_time, tv);
+//! Aggregates a value over all days from first to last (inclusive).
+int64_t
+Statistics::get_value_aggregate(StatsValueType value, AggregateType type,
+                                const struct tm &first, const struct tm &last,
+                                int weekdays) const
+{
+  return aggregate(StatisticsTable::get_column(value), type, first, last, weekdays);
+}
 
-              current_day->misc_stats[STATS_VALUE_TOTAL_MOVEMENT_TIME] =
-                current_day->total_mouse_time.tv_sec;
-            }
 
-          last_mouse_time = now;
-        }
-    }
+//! Aggregates a break value over all days from first to last (inclusive).
+int64_t
+Statistics::get_break_value_aggregate(BreakId break_id, StatsBreakValueType value,
+                                      AggregateType type,
+                                      const struct tm &first, const struct tm &last,
+                                      int weekdays) const
+{
+  return aggregate(StatisticsTable::get_column(break_id, value), type, first, last, weekdays);
+}
 
-  lock.unlock();
+
+//! Returns the number of days with statistics from first to last (inclusive).
+int
+Statistics::get_day_count(const struct tm &first, const struct tm &last, int weekdays) const
+{
+  gint32 first_day = StatisticsTable::get_day_number(first);
+  gint32 last_day = StatisticsTable::get_day_number(last);
+
+  load_archive_for(first_day);
+  update_table();
+
+  int ret = table.count(table.lower_bound(first_day), table.upper_bound(last_day), weekdays);
+  if (current_day_in_range(first_day, last_day, weekdays))
+    {
+      ret++;
+    }
+  return ret;
 }
 
 
-//! Mouse button activity is reported by the input monitor.
+//! Rebuilds the columnar table after the history changed.
+/*!
+ *  The current day changes continuously and is not part of the table.
+ */
 void
-Statistics::button_notify(bool is_press)
+Statistics::update_table() const
 {
-  lock.lock();
-  if (current_day != NULL)
+  if (!table_dirty)
     {
-      if (click_x != -1 && click_y != -1 &&
-          prev_x != -1  && prev_y != -1)
-        {
-          int delta_x = click_x - prev_x;
-          int delta_y = click_y - prev_y;
+      return;
+    }
 
-          int64_t movement = current_day->misc_stats[STATS_VALUE_TOTAL_CLICK_MOVEMENT];
-          int64_t distance = int(sqrt((double)(delta_x * delta_x + delta_y * delta_y)));
+  TRACE_ENTER("Statistics::update_table");
+  gint32 today = current_day != NULL ? StatisticsTable::get_day_number(current_day->start) : -1;
 
-          movement += distance;
-          if (movement > 0)
-            {
-              current_day->misc_stats[STATS_VALUE_TOTAL_CLICK_MOVEMENT] = movement;
-            }
+  table.clear();
+  for (History::const_iterator i = archive.begin(); i != archive.end(); i++)
+    {
+      table.append(*i);
+    }
+  for (History::const_iterator i = history.begin(); i != history.end(); i++)
+    {
+      if (!(*i)->is_empty() && StatisticsTable::get_day_number((*i)->start) != today)
+        {
+          table.append(*i);
         }
+    }
+
+  table_dirty = false;
+  TRACE_RETURN(table.size());
+}
+
+
+int64_t
+Statistics::aggregate(int column, AggregateType type,
+                      const struct tm &first, const struct tm &last, int weekdays) const
+{
+  gint32 first_day = StatisticsTable::get_day_number(first);
+  gint32 last_day = StatisticsTable::get_day_number(last);
 
-      click_x = prev_x;
-      click_y = prev_y;
+  load_archive_for(first_day);
+  update_table();
 
-      if (is_press)
+  int begin = table.lower_bound(first_day);
+  int end = table.upper_bound(last_day);
+
+  int64_t ret = 0;
+  int count = table.count(begin, end, weekdays);
+
+  if (type == AGGREGATE_MAX)
+    {
+      ret = table.max(column, begin, end, weekdays);
+    }
+  else
+    {
+      ret = table.sum(column, begin, end, weekdays);
+    }
+
+  if (current_day_in_range(first_day, last_day, weekdays))
+    {
+      // Input counters of the current day are updated by the monitor thread.
+      lock.lock();
+      int64_t value = StatisticsTable::get_value(current_day, column);
+      lock.unlock();
+
+      if (type == AGGREGATE_MAX)
         {
-          current_day->misc_stats[STATS_VALUE_TOTAL_CLICKS]++;
+          ret = value > ret ? value : ret;
         }
+      else
+        {
+          ret += value;
+        }
+      count++;
     }
-  lock.unlock();
+
+  if (type == AGGREGATE_AVERAGE)
+    {
+      ret = count > 0 ? ret / count : 0;
+    }
+
+  return ret;
 }
 
 
-//! Keyboard activity is reported by the input monitor.
-void
-Statistics::keyboard_notify(bool repeat)
+//! Returns the per-minute values of a series of a day.
+/*!
+ *  The series of past days are read from disk.
+ */
+bool
+Statistics::get_series(StatsSeriesType type, const struct tm &date,
+                       int first, int last, vector<int> &values) const
 {
-  if (repeat)
-    return;
+  TRACE_ENTER("Statistics::get_series");
 
-  lock.lock();
-  if (current_day != NULL)
+  values.clear();
+
+  gint32 day = StatisticsTable::get_day_number(date);
+  if (day < 0)
     {
-      current_day->misc_stats[STATS_VALUE_TOTAL_KEYSTROKES]++;
+      TRACE_RETURN(false);
+      return false;
     }
-  lock.unlock();
+
+  if (day == series.get_day())
+    {
+      series.get_values(type, first, last, values);
+      TRACE_RETURN(true);
+      return true;
+    }
+
+  StatisticsSeries *stored = new StatisticsSeries();
+  bool ret = stored->load(Util::get_home_directory() + "historyseries", day);
+  if (ret)
+    {
+      stored->get_values(type, first, last, values);
+    }
+  delete stored;
+
+  TRACE_RETURN(ret);
+  return ret;
+}
+
+
+//! Returns whether the current day falls within the range.
+bool
+Statistics::current_day_in_range(gint32 first, gint32 last, int weekdays) const
+{
+  if (current_day == NULL || current_day->is_empty())
+    {
+      return false;
+    }
+
+  gint32 today = StatisticsTable::get_day_number(current_day->start);
+  return today >= first && today <= last && ((weekdays >> StatisticsTable::get_weekday(today)) & 1);
 }
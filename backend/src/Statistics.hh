@@ -29,6 +29,9 @@
 #include "IStatistics.hh"
 #include "IInputMonitorListener.hh"
 #include "Mutex.hh"
+#include "StatisticsTable.hh"
+#include "StatisticsSeries.hh"
+#include "InputStatistics.hh"
 
 // Forward declarion of external interface.
 namespace workrave {
@@ -71,8 +74,8 @@ private:
 
   struct DailyStatsImpl : public DailyStats
   {
-    //! Total time that the mouse was moving.
-    GTimeVal total_mouse_time;
+    //! Total time that the mouse was moving, in µs.
+    gint64 total_mouse_time;
 
     DailyStatsImpl()
     {
@@ -95,8 +98,7 @@ private:
       // Empty marker.
       start.tm_year = 0;
 
-      total_mouse_time.tv_sec = 0;
-      total_mouse_time.tv_usec = 0;
+      total_mouse_time = 0;
     }
 
     bool starts_at_date(int y, int m, int d);
@@ -123,26 +125,43 @@ public:
 public:
   void init(Core *core);
   void update();
+  void heartbeat();
   void dump();
   void start_new_day();
 
   void increment_break_counter(BreakId, StatsBreakValueType st);
   void set_break_counter(BreakId bt, StatsBreakValueType st, int value);
   void add_break_counter(BreakId bt, StatsBreakValueType st, int value);
+  void increment_user_timer_counter(const std::string &name);
 
-  DailyStatsImpl *get_current_day() const;
-  DailyStatsImpl *get_day(int day) const;
+  bool get_current_day(DailyStats &stats) const;
+  bool get_day(int day, DailyStats &stats) const;
   void get_day_index_by_date(int y, int m, int d, int &idx, int &next, int &prev) const;
 
   int get_history_size() const;
   void set_counter(StatsValueType t, int value);
   int64_t get_counter(StatsValueType t);
 
+  int64_t get_value_aggregate(StatsValueType value, AggregateType type,
+                              const struct tm &first, const struct tm &last,
+                              int weekdays = WEEKDAY_ALL) const;
+  int64_t get_break_value_aggregate(BreakId break_id, StatsBreakValueType value,
+                                    AggregateType type,
+                                    const struct tm &first, const struct tm &last,
+                                    int weekdays = WEEKDAY_ALL) const;
+  int get_day_count(const struct tm &first, const struct tm &last,
+                    int weekdays = WEEKDAY_ALL) const;
+  bool get_series(StatsSeriesType series, const struct tm &date,
+                  int first, int last, std::vector<int> &values) const;
+
+  std::string export_statistics(std::string format, std::string from, std::string to);
+
 private:
   void action_notify();
   void mouse_notify(int x, int y, int wheel = 0);
   void button_notify(bool is_press);
   void keyboard_notify(bool repeat);
+  void batch_notify(const InputEvent *events, int count);
 
   bool load_current_day();
   void update_current_day(bool active);
@@ -158,6 +177,22 @@ private:
 
   void add_history(DailyStatsImpl *stats);
 
+  void update_table() const;
+  int64_t aggregate(int column, AggregateType type,
+                    const struct tm &first, const struct tm &last, int weekdays) const;
+  bool current_day_in_range(gint32 first, gint32 last, int weekdays) const;
+
+  void load_series();
+  void series_to_history();
+
+  gint32 get_retention_cutoff(gint32 today) const;
+  void compact_history();
+  void save_history();
+  void load_archive() const;
+  void load_archive_for(gint32 first_day) const;
+  void unload_archive();
+  DailyStatsImpl *get_history_day(int pos) const;
+
 #ifdef HAVE_DISTRIBUTION
   void init_distribution_manager();
   bool request_client_message(DistributionClientMessageID id, PacketBuffer &buffer);
@@ -173,32 +208,44 @@ private:
   //! Mouse/Keyboard monitoring.
   IInputMonitor *input_monitor;
 
-  //! Last time a mouse event was received.
-  GTimeVal last_mouse_time;
-
   //! Statistics of current day.
   DailyStatsImpl *current_day;
 
   //! Has the user been active on the current day?
   bool been_active;
 
-  //! History
+  //! Recent history, in memory.
   History history;
 
-  //! Internal locking
-  Mutex lock;
+  //! Archived history, loaded on demand. Precedes the recent history.
+  mutable History archive;
 
-  //! Previous X coordinate
-  int prev_x;
+  //! Has the archive been loaded?
+  mutable bool archive_loaded;
 
-  //! Previous Y coordinate
-  int prev_y;
+  //! Number of days in the archive.
+  mutable int archive_size;
 
-  //! Previous X-click coordinate
-  int click_x;
+  //! Columnar copy of the history, used for aggregation.
+  mutable StatisticsTable table;
+
+  //! Must the table be rebuilt from the history?
+  mutable bool table_dirty;
+
+  //! Per-minute activity of the current day.
+  StatisticsSeries series;
+
+  //! Local midnight of the first day of the series.
+  time_t series_origin;
+
+  //! Day number for which series_origin was computed.
+  gint32 series_origin_day;
+
+  //! Internal locking
+  mutable Mutex lock;
 
-  //! Previous Y-click coordinate
-  int click_y;
+  //! Updates the input counters of the current day.
+  InputStatistics input;
 };
 
 #endif // STATISTICS_HH
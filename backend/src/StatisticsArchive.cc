@@ -0,0 +1,425 @@
+// StatisticsArchive.cc --- Compacted statistics of old days
+//
+// Copyright (C) 2017 Rob Caelers <robc@krandor.nl>
+// All rights reserved.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <fstream>
+#include <sstream>
+#include <string.h>
+
+#include <glib.h>
+
+#include "debug.hh"
+
+#include "StatisticsArchive.hh"
+#include "StatisticsReader.hh"
+#include "StatisticsTable.hh"
+#include "Varint.hh"
+
+using namespace std;
+
+// File layout:
+//
+//   MAGIC
+//   block*
+//
+// block:
+//   BLOCK_MARKER varint(days) varint(last day) varint(length) column*
+//
+// Columns of a block, each with one entry per day:
+//   day number                   delta
+//   start time (minute of day)
+//   stop day number              relative to the day
+//   stop time (minute of day)
+//   StatisticsTable columns      delta
+//   user timers                  varint(count) (varint(length) name value)*count
+//
+// Deltas and values that may be negative are zigzag encoded.
+
+static const char MAGIC[] = "WorkraveArchive 2\n";
+static const char BLOCK_MARKER = 'A';
+
+
+//! Converts a day number to a date.
+static void
+set_date(struct tm &date, gint32 day)
+{
+  if (day <= 0)
+    {
+      return;
+    }
+
+  GDate d;
+  g_date_clear(&d, 1);
+  g_date_set_julian(&d, day);
+
+  date.tm_year = g_date_get_year(&d) - 1900;
+  date.tm_mon = g_date_get_month(&d) - 1;
+  date.tm_mday = g_date_get_day(&d);
+}
+
+
+static inline int
+get_minute(const struct tm &date)
+{
+  return date.tm_hour * 60 + date.tm_min;
+}
+
+
+static inline void
+set_minute(struct tm &date, guint64 minute)
+{
+  date.tm_hour = (int) (minute / 60);
+  date.tm_min = (int) (minute % 60);
+}
+
+
+//! Scans the block headers of the archive, without decoding the days.
+/*!
+ *  Stops at the first damaged block.
+ *
+ *  \param size number of days.
+ *  \param last_day day number of the last day, or -1.
+ *  \param end offset after the last good block, or 0 if the file does not exist.
+ *  \param complete whether the file ends after the last good block.
+ *  \return false if the file exists, but is not an archive.
+ */
+bool
+StatisticsArchive::scan(const string &filename, int &size, gint32 &last_day,
+                        streamoff &end, bool &complete)
+{
+  size = 0;
+  last_day = -1;
+  end = 0;
+  complete = true;
+
+  ifstream file(filename.c_str(), ios::binary);
+  if (!file.is_open())
+    {
+      return true;
+    }
+
+  file.seekg(0, ios::end);
+  streamoff total = file.tellg();
+  file.seekg(0, ios::beg);
+
+  char magic[sizeof(MAGIC) - 1];
+  file.read(magic, sizeof(magic));
+  if (!file.good() || memcmp(magic, MAGIC, sizeof(magic)) != 0)
+    {
+      complete = false;
+      return false;
+    }
+  end = sizeof(magic);
+
+  while (file.get() == BLOCK_MARKER)
+    {
+      guint64 count, day, length;
+      if (!Varint::read(file, count) || !Varint::read(file, day) || !Varint::read(file, length) ||
+          length > (guint64) (total - file.tellg()))
+        {
+          break;
+        }
+
+      file.seekg(length, ios::cur);
+      size += (int) count;
+      last_day = (gint32) day;
+      end = file.tellg();
+    }
+
+  complete = (end == total);
+  return true;
+}
+
+
+int
+StatisticsArchive::read_size(const string &filename)
+{
+  int size;
+  gint32 last_day;
+  streamoff end;
+  bool complete;
+
+  scan(filename, size, last_day, end, complete);
+  return size;
+}
+
+
+//! Reads all days from the archive.
+/*!
+ *  Stops at the first damaged block, and returns false if there was one.
+ */
+bool
+StatisticsArchive::read(const string &filename, Days &days)
+{
+  TRACE_ENTER_MSG("StatisticsArchive::read", filename);
+
+  days.clear();
+
+  ifstream file(filename.c_str(), ios::binary);
+  stringstream ss;
+  ss << file.rdbuf();
+
+  string data = ss.str();
+  bool ret = data.compare(0, sizeof(MAGIC) - 1, MAGIC) == 0;
+
+  size_t pos = sizeof(MAGIC) - 1;
+  while (ret && pos < data.size())
+    {
+      guint64 count, day, length;
+      ret = data[pos++] == BLOCK_MARKER &&
+        Varint::get(data, pos, count) && Varint::get(data, pos, day) && Varint::get(data, pos, length) &&
+        length <= data.size() - pos && count <= length;
+      if (ret)
+        {
+          string payload = data.substr(pos, length);
+          pos += length;
+          ret = decode(payload, count, days);
+        }
+    }
+
+  TRACE_RETURN(days.size());
+  return ret;
+}
+
+
+//! Appends the days after the last day of the archive.
+/*!
+ *  Days that are already archived are skipped. Only the new block is
+ *  written; the archive is rewritten only to drop a damaged block left by
+ *  a crash.
+ *
+ *  \param days days in chronological order.
+ */
+bool
+StatisticsArchive::append(const string &filename, const Days &days)
+{
+  TRACE_ENTER_MSG("StatisticsArchive::append", filename << " " << days.size());
+
+  int size;
+  gint32 last_day;
+  streamoff end;
+  bool complete;
+  if (!scan(filename, size, last_day, end, complete))
+    {
+      // Do not overwrite a file that is not an archive.
+      TRACE_RETURN(false);
+      return false;
+    }
+
+  Days new_days;
+  for (Days::const_iterator i = days.begin(); i != days.end(); i++)
+    {
+      if (StatisticsTable::get_day_number(i->start) > last_day)
+        {
+          new_days.push_back(*i);
+        }
+    }
+
+  if (new_days.empty())
+    {
+      TRACE_RETURN(true);
+      return true;
+    }
+
+  string payload;
+  encode(new_days, payload);
+
+  string block(1, BLOCK_MARKER);
+  Varint::put(block, new_days.size());
+  Varint::put(block, StatisticsTable::get_day_number(new_days.back().start));
+  Varint::put(block, payload.size());
+  block += payload;
+
+  bool ret = true;
+  if (end != 0 && complete)
+    {
+      ofstream file(filename.c_str(), ios::binary | ios::app);
+      file.write(block.data(), block.size());
+      file.close();
+      ret = !file.fail();
+    }
+  else
+    {
+      string data(MAGIC, sizeof(MAGIC) - 1);
+      if (end != 0)
+        {
+          ifstream file(filename.c_str(), ios::binary);
+          data.resize(end);
+          file.read(&data[0], end);
+          ret = file.good();
+        }
+      data += block;
+
+      // Writes a temporary file and renames it, so a crash never loses the file.
+      GError *error = NULL;
+      if (ret)
+        {
+          ret = g_file_set_contents(filename.c_str(), data.data(), data.size(), &error);
+        }
+      if (error != NULL)
+        {
+          TRACE_MSG("Cannot write " << filename << ": " << error->message);
+          g_error_free(error);
+        }
+    }
+
+  TRACE_RETURN(ret);
+  return ret;
+}
+
+
+void
+StatisticsArchive::encode(const Days &days, string &out)
+{
+  gint64 prev = 0;
+  for (Days::const_iterator i = days.begin(); i != days.end(); i++)
+    {
+      gint32 day = StatisticsTable::get_day_number(i->start);
+      Varint::put_signed(out, day - prev);
+      prev = day;
+    }
+
+  for (Days::const_iterator i = days.begin(); i != days.end(); i++)
+    {
+      Varint::put(out, get_minute(i->start));
+    }
+
+  for (Days::const_iterator i = days.begin(); i != days.end(); i++)
+    {
+      gint32 day = StatisticsTable::get_day_number(i->start);
+      Varint::put_signed(out, StatisticsTable::get_day_number(i->stop) - day);
+    }
+
+  for (Days::const_iterator i = days.begin(); i != days.end(); i++)
+    {
+      Varint::put(out, get_minute(i->stop));
+    }
+
+  for (int c = 0; c < StatisticsTable::COLUMN_SIZEOF; c++)
+    {
+      prev = 0;
+      for (Days::const_iterator i = days.begin(); i != days.end(); i++)
+        {
+          gint64 value = StatisticsTable::get_value(&*i, c);
+          Varint::put_signed(out, value - prev);
+          prev = value;
+        }
+    }
+
+  for (Days::const_iterator i = days.begin(); i != days.end(); i++)
+    {
+      const IStatistics::UserTimerStats &timers = i->user_timer_stats;
+
+      Varint::put(out, timers.size());
+      for (IStatistics::UserTimerStats::const_iterator t = timers.begin(); t != timers.end(); t++)
+        {
+          Varint::put(out, t->first.size());
+          out += t->first;
+          Varint::put_signed(out, t->second);
+        }
+    }
+}
+
+
+//! Decodes the columns of a block, and appends its days.
+bool
+StatisticsArchive::decode(const string &in, guint64 size, Days &all_days)
+{
+  size_t pos = 0;
+
+  Days days(size);
+  for (Days::iterator i = days.begin(); i != days.end(); i++)
+    {
+      StatisticsReader::clear(*i);
+    }
+
+  vector<gint32> day_numbers(size);
+
+  bool ok = true;
+  gint64 value = 0;
+  for (guint64 i = 0; ok && i < size; i++)
+    {
+      gint64 delta;
+      ok = Varint::get_signed(in, pos, delta);
+      value += delta;
+      day_numbers[i] = (gint32) value;
+      set_date(days[i].start, day_numbers[i]);
+    }
+
+  for (guint64 i = 0; ok && i < size; i++)
+    {
+      guint64 minute;
+      ok = Varint::get(in, pos, minute);
+      set_minute(days[i].start, minute);
+    }
+
+  for (guint64 i = 0; ok && i < size; i++)
+    {
+      gint64 offset;
+      ok = Varint::get_signed(in, pos, offset);
+      set_date(days[i].stop, (gint32) (day_numbers[i] + offset));
+    }
+
+  for (guint64 i = 0; ok && i < size; i++)
+    {
+      guint64 minute;
+      ok = Varint::get(in, pos, minute);
+      set_minute(days[i].stop, minute);
+    }
+
+  for (int c = 0; ok && c < StatisticsTable::COLUMN_SIZEOF; c++)
+    {
+      value = 0;
+      for (guint64 i = 0; ok && i < size; i++)
+        {
+          gint64 delta;
+          ok = Varint::get_signed(in, pos, delta);
+          value += delta;
+          StatisticsTable::set_value(&days[i], c, value);
+        }
+    }
+
+  for (guint64 i = 0; ok && i < size; i++)
+    {
+      guint64 count;
+      ok = Varint::get(in, pos, count);
+      for (guint64 t = 0; ok && t < count; t++)
+        {
+          guint64 length;
+          gint64 limits = 0;
+          ok = Varint::get(in, pos, length) && length <= in.size() - pos;
+          if (ok)
+            {
+              string name = in.substr(pos, length);
+              pos += length;
+              ok = Varint::get_signed(in, pos, limits);
+              days[i].user_timer_stats[name] = (int) limits;
+            }
+        }
+    }
+
+  if (ok)
+    {
+      all_days.insert(all_days.end(), days.begin(), days.end());
+    }
+  return ok;
+}
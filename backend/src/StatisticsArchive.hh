@@ -0,0 +1,66 @@
+// StatisticsArchive.hh --- Compacted statistics of old days
+//
+// Copyright (C) 2017 Rob Caelers <robc@krandor.nl>
+// All rights reserved.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef STATISTICSARCHIVE_HH
+#define STATISTICSARCHIVE_HH
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include <glib.h>
+
+#include "IStatistics.hh"
+
+using namespace workrave;
+
+//! Compacted statistics of old days.
+/*!
+ *  The archive is a sequence of blocks, one per compaction. A block stores
+ *  its days column by column: all dates, then all values of each
+ *  statistic. Each column is delta encoded against the previous day and
+ *  written as varints, so that values that change little cost a byte or
+ *  two per day.
+ *
+ *  New days are appended as a block, and the size of the archive is read
+ *  from the block headers, so neither depends on the size of the archive.
+ *  The days themselves are only decoded on demand.
+ */
+class StatisticsArchive
+{
+public:
+  typedef std::vector<IStatistics::DailyStats> Days;
+
+  //! Returns the number of days in the archive, without reading them.
+  static int read_size(const std::string &filename);
+
+  //! Reads all days from the archive, in chronological order.
+  static bool read(const std::string &filename, Days &days);
+
+  //! Appends the days that are newer than the archive, in chronological order.
+  static bool append(const std::string &filename, const Days &days);
+
+private:
+  static bool scan(const std::string &filename, int &size, gint32 &last_day,
+                   std::streamoff &end, bool &complete);
+  static bool decode(const std::string &in, guint64 size, Days &days);
+  static void encode(const Days &days, std::string &out);
+};
+
+#endif // STATISTICSARCHIVE_HH
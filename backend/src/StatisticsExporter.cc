@@ -0,0 +1,400 @@
+// StatisticsExporter.cc --- Exports statistics as CSV or JSON
+//
+// Copyright (C) 2017 Rob Caelers <robc@krandor.nl>
+// All rights reserved.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include <glib.h>
+
+#include "debug.hh"
+
+#include "StatisticsExporter.hh"
+#include "StatisticsReader.hh"
+#include "StatisticsTable.hh"
+#include "Util.hh"
+
+using namespace std;
+using namespace workrave;
+
+static const char *misc_names[IStatistics::STATS_VALUE_SIZEOF] =
+  {
+    "active_time",
+    "mouse_movement",
+    "click_movement",
+    "movement_time",
+    "clicks",
+    "keystrokes",
+  };
+
+static const char *break_names[BREAK_ID_SIZEOF] =
+  {
+    "micro_break",
+    "rest_break",
+    "daily_limit",
+  };
+
+static const char *break_value_names[IStatistics::STATS_BREAKVALUE_SIZEOF] =
+  {
+    "prompted",
+    "taken",
+    "natural_taken",
+    "skipped",
+    "postponed",
+    "unique_breaks",
+    "total_overdue",
+  };
+
+
+//! Formats a date and time as YYYY-MM-DD HH:MM.
+static string
+format_time(const struct tm &t, bool with_time)
+{
+  char buf[64];
+  if (with_time)
+    {
+      g_snprintf(buf, sizeof(buf), "%04d-%02d-%02d %02d:%02d",
+                 t.tm_year + 1900, t.tm_mon + 1, t.tm_mday, t.tm_hour, t.tm_min);
+    }
+  else
+    {
+      g_snprintf(buf, sizeof(buf), "%04d-%02d-%02d",
+                 t.tm_year + 1900, t.tm_mon + 1, t.tm_mday);
+    }
+  return buf;
+}
+
+
+//! Quotes a string for JSON.
+static string
+json_quote(const string &s)
+{
+  string ret = "\"";
+  for (string::const_iterator i = s.begin(); i != s.end(); i++)
+    {
+      unsigned char c = *i;
+      if (c == '"' || c == '\\')
+        {
+          ret += '\\';
+          ret += c;
+        }
+      else if (c < 0x20)
+        {
+          char buf[8];
+          g_snprintf(buf, sizeof(buf), "\\u%04x", c);
+          ret += buf;
+        }
+      else
+        {
+          ret += c;
+        }
+    }
+  ret += '"';
+  return ret;
+}
+
+
+StatisticsExporter::StatisticsExporter(ostream &out, Format format) :
+  out(out),
+  format(format),
+  first_day(0),
+  last_day(G_MAXINT32),
+  day_count(0)
+{
+}
+
+
+bool
+StatisticsExporter::set_range(const string &from, const string &to)
+{
+  first_day = 0;
+  last_day = G_MAXINT32;
+
+  if (!from.empty() && !parse_date(from, first_day))
+    {
+      return false;
+    }
+
+  if (!to.empty() && !parse_date(to, last_day))
+    {
+      return false;
+    }
+
+  return true;
+}
+
+
+void
+StatisticsExporter::begin()
+{
+  day_count = 0;
+
+  if (format == FORMAT_CSV)
+    {
+      out << "date,start,stop";
+      for (int i = 0; i < IStatistics::STATS_VALUE_SIZEOF; i++)
+        {
+          out << "," << misc_names[i];
+        }
+      for (int b = 0; b < BREAK_ID_SIZEOF; b++)
+        {
+          for (int i = 0; i < IStatistics::STATS_BREAKVALUE_SIZEOF; i++)
+            {
+              out << "," << break_names[b] << "_" << break_value_names[i];
+            }
+        }
+      out << "\n";
+    }
+  else
+    {
+      out << "[";
+    }
+}
+
+
+void
+StatisticsExporter::write_day(const IStatistics::DailyStats &stats)
+{
+  int day = StatisticsTable::get_day_number(stats.start);
+  if (day < 0 || day < first_day || day > last_day)
+    {
+      return;
+    }
+
+  if (format == FORMAT_CSV)
+    {
+      write_csv(stats);
+    }
+  else
+    {
+      write_json(stats);
+    }
+  day_count++;
+}
+
+
+bool
+StatisticsExporter::write_file(istream &in)
+{
+  StatisticsReader reader(in);
+  if (!reader.is_valid())
+    {
+      return false;
+    }
+
+  IStatistics::DailyStats stats;
+  while (reader.next(stats))
+    {
+      write_day(stats);
+    }
+  return true;
+}
+
+
+void
+StatisticsExporter::end()
+{
+  if (format == FORMAT_JSON)
+    {
+      out << (day_count > 0 ? "\n]\n" : "]\n");
+    }
+  out.flush();
+}
+
+
+int
+StatisticsExporter::get_day_count() const
+{
+  return day_count;
+}
+
+
+void
+StatisticsExporter::write_csv(const IStatistics::DailyStats &stats)
+{
+  out << format_time(stats.start, false) << ","
+      << format_time(stats.start, true) << ","
+      << format_time(stats.stop, true);
+
+  for (int i = 0; i < IStatistics::STATS_VALUE_SIZEOF; i++)
+    {
+      out << "," << stats.misc_stats[i];
+    }
+  for (int b = 0; b < BREAK_ID_SIZEOF; b++)
+    {
+      for (int i = 0; i < IStatistics::STATS_BREAKVALUE_SIZEOF; i++)
+        {
+          out << "," << stats.break_stats[b][i];
+        }
+    }
+  out << "\n";
+}
+
+
+void
+StatisticsExporter::write_json(const IStatistics::DailyStats &stats)
+{
+  out << (day_count > 0 ? ",\n" : "\n")
+      << "{\"date\":\"" << format_time(stats.start, false) << "\""
+      << ",\"start\":\"" << format_time(stats.start, true) << "\""
+      << ",\"stop\":\"" << format_time(stats.stop, true) << "\"";
+
+  out << ",\"misc\":{";
+  for (int i = 0; i < IStatistics::STATS_VALUE_SIZEOF; i++)
+    {
+      out << (i > 0 ? "," : "") << "\"" << misc_names[i] << "\":" << stats.misc_stats[i];
+    }
+  out << "}";
+
+  out << ",\"breaks\":{";
+  for (int b = 0; b < BREAK_ID_SIZEOF; b++)
+    {
+      out << (b > 0 ? "," : "") << "\"" << break_names[b] << "\":{";
+      for (int i = 0; i < IStatistics::STATS_BREAKVALUE_SIZEOF; i++)
+        {
+          out << (i > 0 ? "," : "") << "\"" << break_value_names[i] << "\":" << stats.break_stats[b][i];
+        }
+      out << "}";
+    }
+  out << "}";
+
+  out << ",\"user_timers\":{";
+  for (IStatistics::UserTimerStats::const_iterator i = stats.user_timer_stats.begin();
+       i != stats.user_timer_stats.end(); i++)
+    {
+      out << (i != stats.user_timer_stats.begin() ? "," : "") << json_quote(i->first) << ":" << i->second;
+    }
+  out << "}}";
+}
+
+
+bool
+StatisticsExporter::parse_format(const string &name, Format &format)
+{
+  if (name == "csv")
+    {
+      format = FORMAT_CSV;
+    }
+  else if (name == "json")
+    {
+      format = FORMAT_JSON;
+    }
+  else
+    {
+      return false;
+    }
+  return true;
+}
+
+
+bool
+StatisticsExporter::parse_date(const string &date, int &day)
+{
+  struct tm t;
+  memset(&t, 0, sizeof(t));
+
+  int year = 0, month = 0, mday = 0;
+  if (sscanf(date.c_str(), "%d-%d-%d", &year, &month, &mday) != 3)
+    {
+      return false;
+    }
+
+  t.tm_year = year - 1900;
+  t.tm_mon = month - 1;
+  t.tm_mday = mday;
+
+  day = StatisticsTable::get_day_number(t);
+  return day >= 0;
+}
+
+
+bool
+StatisticsExporter::run_command_line(int argc, char **argv, int &exit_code)
+{
+  TRACE_ENTER("StatisticsExporter::run_command_line");
+
+  const string export_opt = "--export-statistics=";
+  const string from_opt = "--export-from=";
+  const string to_opt = "--export-to=";
+
+  bool found = false;
+  string format_name, from, to;
+
+  for (int i = 1; i < argc; i++)
+    {
+      string arg = argv[i];
+      if (arg.compare(0, export_opt.length(), export_opt) == 0)
+        {
+          format_name = arg.substr(export_opt.length());
+          found = true;
+        }
+      else if (arg.compare(0, from_opt.length(), from_opt) == 0)
+        {
+          from = arg.substr(from_opt.length());
+        }
+      else if (arg.compare(0, to_opt.length(), to_opt) == 0)
+        {
+          to = arg.substr(to_opt.length());
+        }
+    }
+
+  if (!found)
+    {
+      TRACE_EXIT();
+      return false;
+    }
+
+  Format format;
+  if (!parse_format(format_name, format))
+    {
+      cerr << "Unknown export format '" << format_name << "', use csv or json." << endl;
+      exit_code = 1;
+      TRACE_EXIT();
+      return true;
+    }
+
+  StatisticsExporter exporter(cout, format);
+  if (!exporter.set_range(from, to))
+    {
+      cerr << "Invalid date, use YYYY-MM-DD." << endl;
+      exit_code = 1;
+      TRACE_EXIT();
+      return true;
+    }
+
+  exporter.begin();
+
+  string home = Util::get_home_directory();
+  ifstream history((home + "historystats").c_str());
+  exporter.write_file(history);
+
+  ifstream today((home + "todaystats").c_str());
+  exporter.write_file(today);
+
+  exporter.end();
+
+  exit_code = cout.good() ? 0 : 1;
+  TRACE_EXIT();
+  return true;
+}
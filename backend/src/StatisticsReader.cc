@@ -0,0 +1,184 @@
+// StatisticsReader.cc --- Reads statistics files one day at a time
+//
+// Copyright (C) 2017 Rob Caelers <robc@krandor.nl>
+// All rights reserved.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <cstring>
+#include <sstream>
+
+#include "debug.hh"
+
+#include "StatisticsReader.hh"
+
+using namespace std;
+
+const char *StatisticsReader::TAG = "WorkRaveStats";
+const int StatisticsReader::VERSION = 4;
+
+
+StatisticsReader::StatisticsReader(istream &in) :
+  in(in),
+  valid(false)
+{
+  if (in.good())
+    {
+      string tag;
+      int version = 0;
+      in >> tag >> version;
+
+      valid = tag == TAG && (version == VERSION || version == 3);
+    }
+}
+
+
+bool
+StatisticsReader::is_valid() const
+{
+  return valid;
+}
+
+
+bool
+StatisticsReader::next(IStatistics::DailyStats &stats)
+{
+  bool found = false;
+
+  clear(stats);
+
+  while (valid)
+    {
+      if (pending.empty() && !getline(in, pending))
+        {
+          break;
+        }
+
+      if (pending.length() > 1)
+        {
+          if (pending[0] == 'D' && found)
+            {
+              // First line of the next day.
+              break;
+            }
+
+          if (pending[0] == 'D' || found)
+            {
+              parse_line(pending, stats);
+              found = true;
+            }
+        }
+      pending.clear();
+    }
+
+  return found;
+}
+
+
+void
+StatisticsReader::clear(IStatistics::DailyStats &stats)
+{
+  memset((void *)&stats.start, 0, sizeof(stats.start));
+  memset((void *)&stats.stop, 0, sizeof(stats.stop));
+  memset((void *)&stats.break_stats, 0, sizeof(stats.break_stats));
+  memset((void *)&stats.misc_stats, 0, sizeof(stats.misc_stats));
+  stats.user_timer_stats.clear();
+}
+
+
+void
+StatisticsReader::parse_line(const string &line, IStatistics::DailyStats &stats)
+{
+  char cmd = line[0];
+  stringstream ss(line.substr(1));
+
+  if (cmd == 'D')
+    {
+      ss >> stats.start.tm_mday
+         >> stats.start.tm_mon
+         >> stats.start.tm_year
+         >> stats.start.tm_hour
+         >> stats.start.tm_min
+         >> stats.stop.tm_mday
+         >> stats.stop.tm_mon
+         >> stats.stop.tm_year
+         >> stats.stop.tm_hour
+         >> stats.stop.tm_min;
+    }
+  else if (cmd == 'B')
+    {
+      int bt = -1, size = 0;
+      ss >> bt;
+      ss >> size;
+
+      if (bt < 0 || bt >= BREAK_ID_SIZEOF)
+        {
+          return;
+        }
+
+      if (size > IStatistics::STATS_BREAKVALUE_SIZEOF)
+        {
+          size = IStatistics::STATS_BREAKVALUE_SIZEOF;
+        }
+
+      for (int j = 0; j < size; j++)
+        {
+          int value = 0;
+          ss >> value;
+          stats.break_stats[bt][j] = value;
+        }
+    }
+  else if (cmd == 'M' || cmd == 'm')
+    {
+      int size = 0;
+      ss >> size;
+
+      if (size > IStatistics::STATS_VALUE_SIZEOF)
+        {
+          size = IStatistics::STATS_VALUE_SIZEOF;
+        }
+
+      for (int j = 0; j < size; j++)
+        {
+          int value = 0;
+          ss >> value;
+
+          // Ignore older 'M' stats. they are broken....
+          stats.misc_stats[j] = cmd == 'm' ? value : 0;
+        }
+    }
+  else if (cmd == 'U')
+    {
+      string name;
+      int count = 0;
+      ss >> name >> count;
+
+      if (!name.empty())
+        {
+          stats.user_timer_stats[name] = count;
+        }
+    }
+  else if (cmd == 'G')
+    {
+      int total_active = 0;
+      ss >> total_active;
+
+      stats.misc_stats[IStatistics::STATS_VALUE_TOTAL_ACTIVE_TIME] = total_active;
+    }
+}
@@ -0,0 +1,69 @@
+// StatisticsReader.hh --- Reads statistics files one day at a time
+//
+// Copyright (C) 2017 Rob Caelers <robc@krandor.nl>
+// All rights reserved.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef STATISTICSREADER_HH
+#define STATISTICSREADER_HH
+
+#include <istream>
+#include <string>
+
+#include "IStatistics.hh"
+
+using namespace workrave;
+
+//! Reads the todaystats and historystats files one day at a time.
+class StatisticsReader
+{
+public:
+  //! Identification of the statistics format.
+  static const char *TAG;
+
+  //! Current version of the statistics format.
+  static const int VERSION;
+
+  StatisticsReader(std::istream &in);
+
+  //! Returns whether the stream is a supported statistics file.
+  bool is_valid() const;
+
+  //! Reads the next day.
+  /*!
+   *  \param stats is cleared and then filled with the next day.
+   *  \return false at the end of the stream.
+   */
+  bool next(IStatistics::DailyStats &stats);
+
+  //! Clears all values of the specified day.
+  static void clear(IStatistics::DailyStats &stats);
+
+private:
+  void parse_line(const std::string &line, IStatistics::DailyStats &stats);
+
+private:
+  //! The statistics file.
+  std::istream &in;
+
+  //! Is the file a supported statistics file?
+  bool valid;
+
+  //! First line of the next day, read while reading the previous one.
+  std::string pending;
+};
+
+#endif // STATISTICSREADER_HH
@@ -0,0 +1,344 @@
+// StatisticsSeries.cc --- Per-minute activity of a day
+//
+// Copyright (C) 2017 Rob Caelers <robc@krandor.nl>
+// All rights reserved.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <fstream>
+#include <string.h>
+
+#include "debug.hh"
+
+#include "StatisticsSeries.hh"
+#include "Varint.hh"
+
+using namespace std;
+
+// File layout:
+//
+//   MAGIC
+//   block*
+//
+// block:
+//   BLOCK_MARKER varint(day) varint(length) payload
+//
+// payload, for each series:
+//   varint(count) zigzag-varint(delta)*count
+//
+// The count excludes trailing zero minutes. Each delta is relative to the
+// previous minute, so a quiet minute costs one byte.
+
+static const char MAGIC[] = "WorkraveSeries 1\n";
+static const char BLOCK_MARKER = 'D';
+
+
+StatisticsSeries::StatisticsSeries()
+{
+  reset(-1);
+}
+
+
+void
+StatisticsSeries::reset(gint32 day)
+{
+  this->day = day;
+  sampled = false;
+  memset(totals, 0, sizeof(totals));
+  memset(values, 0, sizeof(values));
+}
+
+
+bool
+StatisticsSeries::is_empty() const
+{
+  for (int s = 0; s < SERIES_SIZEOF; s++)
+    {
+      for (int m = 0; m < MINUTES; m++)
+        {
+          if (values[s][m] != 0)
+            {
+              return false;
+            }
+        }
+    }
+  return true;
+}
+
+
+//! Records the running totals of all series at the specified minute.
+/*!
+ *  The first sample only sets the reference. A total that decreased was
+ *  reset, and becomes the new reference.
+ */
+void
+StatisticsSeries::sample(int minute, const gint64 new_totals[SERIES_SIZEOF])
+{
+  if (minute >= 0 && minute < MINUTES && sampled)
+    {
+      for (int s = 0; s < SERIES_SIZEOF; s++)
+        {
+          gint64 delta = new_totals[s] - totals[s];
+          if (delta > 0 && delta < G_MAXINT32 - values[s][minute])
+            {
+              values[s][minute] += (gint32) delta;
+            }
+        }
+    }
+
+  memcpy(totals, new_totals, sizeof(totals));
+  sampled = true;
+}
+
+
+void
+StatisticsSeries::get_values(IStatistics::StatsSeriesType series, int first, int last,
+                             vector<int> &out) const
+{
+  out.clear();
+  if (series < 0 || series >= IStatistics::STATS_SERIES_SIZEOF)
+    {
+      return;
+    }
+
+  for (int m = first; m <= last; m++)
+    {
+      out.push_back(m >= 0 && m < MINUTES ? values[series][m] : 0);
+    }
+}
+
+
+bool
+StatisticsSeries::save(const string &filename) const
+{
+  return write(filename, false, -1);
+}
+
+
+bool
+StatisticsSeries::append(const string &filename, gint32 oldest) const
+{
+  return write(filename, true, oldest);
+}
+
+
+bool
+StatisticsSeries::write(const string &filename, bool append, gint32 oldest) const
+{
+  TRACE_ENTER_MSG("StatisticsSeries::write", filename << " " << day);
+
+  string payload;
+  encode(payload);
+
+  string data(MAGIC, sizeof(MAGIC) - 1);
+  if (append)
+    {
+      copy_blocks(filename, oldest, data);
+    }
+
+  data += BLOCK_MARKER;
+  Varint::put(data, (guint64) day);
+  Varint::put(data, payload.size());
+  data += payload;
+
+  // Writes a temporary file and renames it, so a crash never loses the file.
+  GError *error = NULL;
+  bool ret = g_file_set_contents(filename.c_str(), data.data(), data.size(), &error);
+  if (error != NULL)
+    {
+      TRACE_MSG("Cannot write " << filename << ": " << error->message);
+      g_error_free(error);
+    }
+
+  TRACE_RETURN(ret);
+  return ret;
+}
+
+
+//! Copies the blocks of the file from the specified day onwards.
+/*!
+ *  Stops at the first damaged block.
+ */
+void
+StatisticsSeries::copy_blocks(const string &filename, gint32 oldest, string &out)
+{
+  ifstream file(filename.c_str(), ios::binary);
+
+  char magic[sizeof(MAGIC) - 1];
+  file.read(magic, sizeof(magic));
+  if (!file.good() || memcmp(magic, MAGIC, sizeof(magic)) != 0)
+    {
+      return;
+    }
+
+  while (file.get() == BLOCK_MARKER)
+    {
+      guint64 block_day, length;
+      if (!Varint::read(file, block_day) || !Varint::read(file, length) ||
+          length >= (guint64) MINUTES * SERIES_SIZEOF * 10)
+        {
+          break;
+        }
+
+      string payload(length, '\0');
+      file.read(&payload[0], length);
+      if (!file.good())
+        {
+          break;
+        }
+
+      if ((gint32) block_day >= oldest)
+        {
+          out += BLOCK_MARKER;
+          Varint::put(out, block_day);
+          Varint::put(out, length);
+          out += payload;
+        }
+    }
+}
+
+
+bool
+StatisticsSeries::load(const string &filename)
+{
+  return load(filename, -1);
+}
+
+
+//! Loads a day from the file.
+/*!
+ *  Skips the blocks of other days without decoding them. If the day
+ *  occurs more than once, the last block wins.
+ *
+ *  \param wanted the day to load, or -1 for the first day in the file.
+ */
+bool
+StatisticsSeries::load(const string &filename, gint32 wanted)
+{
+  TRACE_ENTER_MSG("StatisticsSeries::load", filename << " " << wanted);
+
+  ifstream file(filename.c_str(), ios::binary);
+
+  char magic[sizeof(MAGIC) - 1];
+  file.read(magic, sizeof(magic));
+  if (!file.good() || memcmp(magic, MAGIC, sizeof(magic)) != 0)
+    {
+      TRACE_RETURN(false);
+      return false;
+    }
+
+  streampos found = -1;
+  guint64 found_length = 0;
+  gint32 found_day = -1;
+
+  while (file.get() == BLOCK_MARKER)
+    {
+      guint64 block_day, length;
+      if (!Varint::read(file, block_day) || !Varint::read(file, length))
+        {
+          break;
+        }
+
+      if (wanted == -1 || (gint32) block_day == wanted)
+        {
+          found = file.tellg();
+          found_length = length;
+          found_day = (gint32) block_day;
+        }
+
+      if (wanted == -1)
+        {
+          break;
+        }
+      file.seekg(length, ios::cur);
+    }
+
+  bool ret = false;
+  if (found != streampos(-1) && found_length < (guint64) MINUTES * SERIES_SIZEOF * 10)
+    {
+      string payload(found_length, '\0');
+
+      file.clear();
+      file.seekg(found);
+      file.read(&payload[0], found_length);
+
+      reset(found_day);
+      ret = file.good() && decode(payload);
+      if (!ret)
+        {
+          reset(-1);
+        }
+    }
+
+  TRACE_RETURN(ret);
+  return ret;
+}
+
+
+void
+StatisticsSeries::encode(string &out) const
+{
+  for (int s = 0; s < SERIES_SIZEOF; s++)
+    {
+      int count = MINUTES;
+      while (count > 0 && values[s][count - 1] == 0)
+        {
+          count--;
+        }
+
+      Varint::put(out, count);
+
+      gint64 prev = 0;
+      for (int m = 0; m < count; m++)
+        {
+          Varint::put_signed(out, values[s][m] - prev);
+          prev = values[s][m];
+        }
+    }
+}
+
+
+bool
+StatisticsSeries::decode(const string &in)
+{
+  size_t pos = 0;
+
+  for (int s = 0; s < SERIES_SIZEOF; s++)
+    {
+      guint64 count;
+      if (!Varint::get(in, pos, count) || count > MINUTES)
+        {
+          return false;
+        }
+
+      gint64 value = 0;
+      for (guint64 m = 0; m < count; m++)
+        {
+          gint64 delta;
+          if (!Varint::get_signed(in, pos, delta))
+            {
+              return false;
+            }
+          value += delta;
+          values[s][m] = (gint32) value;
+        }
+    }
+
+  return true;
+}
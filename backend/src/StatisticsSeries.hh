@@ -0,0 +1,109 @@
+// StatisticsSeries.hh --- Per-minute activity of a day
+//
+// Copyright (C) 2017 Rob Caelers <robc@krandor.nl>
+// All rights reserved.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef STATISTICSSERIES_HH
+#define STATISTICSSERIES_HH
+
+#include <string>
+#include <vector>
+
+#include <glib.h>
+
+#include "IStatistics.hh"
+
+using namespace workrave;
+
+//! Per-minute activity of a single day.
+/*!
+ *  Stores one value per minute for each series, counting from local
+ *  midnight of the first day. The series are fed with running totals;
+ *  the increase since the previous sample is added to the current minute.
+ *
+ *  On disk, a day is a block of delta encoded varints. Finished days are
+ *  appended to the history file, which is scanned block by block when a
+ *  day is queried, so only one day is ever kept in memory. The caller
+ *  decides how far back the history goes. Files are replaced atomically.
+ */
+class StatisticsSeries
+{
+public:
+  enum
+    {
+      SERIES_SIZEOF = IStatistics::STATS_SERIES_SIZEOF,
+      MINUTES = IStatistics::STATS_SERIES_MINUTES
+    };
+
+  StatisticsSeries();
+
+  //! Clears all values and starts the specified day.
+  void reset(gint32 day);
+
+  //! Returns the day number, as in StatisticsTable, or -1 if no day was started.
+  gint32 get_day() const;
+
+  //! Has any value been recorded?
+  bool is_empty() const;
+
+  //! Records the running totals of all series at the specified minute.
+  void sample(int minute, const gint64 totals[SERIES_SIZEOF]);
+
+  //! Returns the values of a series from first to last minute (inclusive).
+  void get_values(IStatistics::StatsSeriesType series, int first, int last,
+                  std::vector<int> &values) const;
+
+  //! Overwrites the file with this day.
+  bool save(const std::string &filename) const;
+
+  //! Appends this day to the file, and drops the days before oldest (-1 keeps all days).
+  bool append(const std::string &filename, gint32 oldest) const;
+
+  //! Loads the first day of the file.
+  bool load(const std::string &filename);
+
+  //! Loads the specified day from the file.
+  bool load(const std::string &filename, gint32 day);
+
+private:
+  void encode(std::string &out) const;
+  bool decode(const std::string &in);
+  bool write(const std::string &filename, bool append, gint32 oldest) const;
+  static void copy_blocks(const std::string &filename, gint32 oldest, std::string &out);
+
+private:
+  //! Day number.
+  gint32 day;
+
+  //! Running totals of the previous sample.
+  gint64 totals[SERIES_SIZEOF];
+
+  //! Have the totals been sampled?
+  bool sampled;
+
+  //! Values per minute.
+  gint32 values[SERIES_SIZEOF][MINUTES];
+};
+
+
+inline gint32
+StatisticsSeries::get_day() const
+{
+  return day;
+}
+
+#endif // STATISTICSSERIES_HH
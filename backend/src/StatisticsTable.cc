@@ -0,0 +1,206 @@
+// StatisticsTable.cc --- Columnar store of the statistics history
+//
+// Copyright (C) 2017 Rob Caelers <robc@krandor.nl>
+// All rights reserved.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <algorithm>
+
+#include "StatisticsTable.hh"
+
+using namespace std;
+
+StatisticsTable::StatisticsTable()
+{
+  clear();
+}
+
+
+void
+StatisticsTable::clear()
+{
+  days.clear();
+  weekdays.clear();
+
+  for (int c = 0; c < COLUMN_SIZEOF; c++)
+    {
+      columns[c].clear();
+      prefix[c].clear();
+      prefix[c].push_back(0);
+    }
+}
+
+
+void
+StatisticsTable::append(const IStatistics::DailyStats *stats)
+{
+  gint32 day = get_day_number(stats->start);
+  if (day < 0 || (!days.empty() && day <= days.back()))
+    {
+      return;
+    }
+
+  days.push_back(day);
+  weekdays.push_back(get_weekday(day));
+
+  for (int c = 0; c < COLUMN_SIZEOF; c++)
+    {
+      gint64 value = get_value(stats, c);
+      columns[c].push_back(value);
+      prefix[c].push_back(prefix[c].back() + value);
+    }
+}
+
+
+int
+StatisticsTable::lower_bound(gint32 day) const
+{
+  return std::lower_bound(days.begin(), days.end(), day) - days.begin();
+}
+
+
+int
+StatisticsTable::upper_bound(gint32 day) const
+{
+  return std::upper_bound(days.begin(), days.end(), day) - days.begin();
+}
+
+
+gint64
+StatisticsTable::sum(int column, int first, int end, int weekday_mask) const
+{
+  if (first >= end)
+    {
+      return 0;
+    }
+
+  if (weekday_mask == IStatistics::WEEKDAY_ALL)
+    {
+      return prefix[column][end] - prefix[column][first];
+    }
+
+  const gint64 *values = &columns[column][0];
+  const gint32 *wd = &weekdays[0];
+  gint64 ret = 0;
+  for (int i = first; i < end; i++)
+    {
+      ret += ((weekday_mask >> wd[i]) & 1) ? values[i] : 0;
+    }
+  return ret;
+}
+
+
+gint64
+StatisticsTable::max(int column, int first, int end, int weekday_mask) const
+{
+  const gint64 *values = columns[column].empty() ? NULL : &columns[column][0];
+  const gint32 *wd = weekdays.empty() ? NULL : &weekdays[0];
+  gint64 ret = 0;
+  for (int i = first; i < end; i++)
+    {
+      gint64 value = ((weekday_mask >> wd[i]) & 1) ? values[i] : 0;
+      ret = value > ret ? value : ret;
+    }
+  return ret;
+}
+
+
+int
+StatisticsTable::count(int first, int end, int weekday_mask) const
+{
+  if (weekday_mask == IStatistics::WEEKDAY_ALL)
+    {
+      return end > first ? end - first : 0;
+    }
+
+  int ret = 0;
+  for (int i = first; i < end; i++)
+    {
+      ret += (weekday_mask >> weekdays[i]) & 1;
+    }
+  return ret;
+}
+
+
+int
+StatisticsTable::get_column(IStatistics::StatsValueType value)
+{
+  return value;
+}
+
+
+int
+StatisticsTable::get_column(BreakId break_id, IStatistics::StatsBreakValueType value)
+{
+  return IStatistics::STATS_VALUE_SIZEOF + break_id * IStatistics::STATS_BREAKVALUE_SIZEOF + value;
+}
+
+
+gint64
+StatisticsTable::get_value(const IStatistics::DailyStats *stats, int column)
+{
+  if (column < IStatistics::STATS_VALUE_SIZEOF)
+    {
+      return stats->misc_stats[column];
+    }
+
+  column -= IStatistics::STATS_VALUE_SIZEOF;
+  return stats->break_stats[column / IStatistics::STATS_BREAKVALUE_SIZEOF][column % IStatistics::STATS_BREAKVALUE_SIZEOF];
+}
+
+
+void
+StatisticsTable::set_value(IStatistics::DailyStats *stats, int column, gint64 value)
+{
+  if (column < IStatistics::STATS_VALUE_SIZEOF)
+    {
+      stats->misc_stats[column] = value;
+      return;
+    }
+
+  column -= IStatistics::STATS_VALUE_SIZEOF;
+  stats->break_stats[column / IStatistics::STATS_BREAKVALUE_SIZEOF][column % IStatistics::STATS_BREAKVALUE_SIZEOF] = (int) value;
+}
+
+
+gint32
+StatisticsTable::get_day_number(const struct tm &date)
+{
+  int year = date.tm_year + 1900;
+  int month = date.tm_mon + 1;
+
+  if (!g_date_valid_dmy((GDateDay) date.tm_mday, (GDateMonth) month, (GDateYear) year))
+    {
+      return -1;
+    }
+
+  GDate d;
+  g_date_clear(&d, 1);
+  g_date_set_dmy(&d, (GDateDay) date.tm_mday, (GDateMonth) month, (GDateYear) year);
+  return g_date_get_julian(&d);
+}
+
+
+int
+StatisticsTable::get_weekday(gint32 day)
+{
+  // Day 1 (January 1st of year 1) is a Monday.
+  return day % 7;
+}
@@ -0,0 +1,106 @@
+// StatisticsTable.hh --- Columnar store of the statistics history
+//
+// Copyright (C) 2017 Rob Caelers <robc@krandor.nl>
+// All rights reserved.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef STATISTICSTABLE_HH
+#define STATISTICSTABLE_HH
+
+#include <vector>
+
+#include <glib.h>
+
+#include "IStatistics.hh"
+
+using namespace workrave;
+
+//! Columnar store of the statistics history.
+/*!
+ *  Each day of the history is a row. Every statistics value has its own
+ *  contiguous column, plus a column of prefix sums, so the sum over a
+ *  range of days takes two lookups. Rows are sorted by day number, so a
+ *  date range maps to a range of rows with two binary searches.
+ */
+class StatisticsTable
+{
+public:
+  enum
+    {
+      //! Number of columns: all misc values followed by all break values.
+      COLUMN_SIZEOF = IStatistics::STATS_VALUE_SIZEOF
+                      + BREAK_ID_SIZEOF * IStatistics::STATS_BREAKVALUE_SIZEOF
+    };
+
+  StatisticsTable();
+
+  //! Removes all rows.
+  void clear();
+
+  //! Appends a day. Days must be appended in chronological order.
+  void append(const IStatistics::DailyStats *stats);
+
+  //! Returns the number of rows.
+  int size() const;
+
+  //! Returns the first row on or after the specified day.
+  int lower_bound(gint32 day) const;
+
+  //! Returns the first row after the specified day.
+  int upper_bound(gint32 day) const;
+
+  //! Returns the sum of the column over rows [first, end).
+  gint64 sum(int column, int first, int end, int weekday_mask) const;
+
+  //! Returns the maximum of the column over rows [first, end).
+  gint64 max(int column, int first, int end, int weekday_mask) const;
+
+  //! Returns the number of rows in [first, end) on the specified weekdays.
+  int count(int first, int end, int weekday_mask) const;
+
+  static int get_column(IStatistics::StatsValueType value);
+  static int get_column(BreakId break_id, IStatistics::StatsBreakValueType value);
+  static gint64 get_value(const IStatistics::DailyStats *stats, int column);
+  static void set_value(IStatistics::DailyStats *stats, int column, gint64 value);
+
+  //! Returns the day number of a date, or -1 if the date is invalid.
+  static gint32 get_day_number(const struct tm &date);
+
+  //! Returns the weekday (0 = Sunday) of a day number.
+  static int get_weekday(gint32 day);
+
+private:
+  //! Day number of each row.
+  std::vector<gint32> days;
+
+  //! Weekday of each row.
+  std::vector<gint32> weekdays;
+
+  //! Values.
+  std::vector<gint64> columns[COLUMN_SIZEOF];
+
+  //! Prefix sums: prefix[c][i] is the sum of rows [0, i) of column c.
+  std::vector<gint64> prefix[COLUMN_SIZEOF];
+};
+
+
+inline int
+StatisticsTable::size() const
+{
+  return days.size();
+}
+
+#endif // STATISTICSTABLE_HH
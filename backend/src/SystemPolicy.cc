@@ -0,0 +1,337 @@
+// SystemPolicy.cc --- Configuration policy of the administrator
+//
+// Copyright (C) 2017 Rob Caelers <robc@krandor.nl>
+// All rights reserved.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "debug.hh"
+
+#include "SystemPolicy.hh"
+
+using namespace std;
+
+SystemPolicy *SystemPolicy::instance = NULL;
+
+const char SystemPolicy::MAGIC[8] = { 'W', 'R', 'P', 'O', 'L', 'I', 'C', 'Y' };
+const guint32 SystemPolicy::VERSION;
+const guint32 SystemPolicy::BYTE_ORDER_MARK;
+const guint32 SystemPolicy::NONE;
+
+
+SystemPolicy *
+SystemPolicy::get_instance()
+{
+  if (instance == NULL)
+    {
+      instance = new SystemPolicy();
+
+      string filename = get_default_filename();
+      if (filename != "")
+        {
+          instance->load(filename);
+        }
+    }
+
+  return instance;
+}
+
+
+//! Returns the policy file: /etc/workrave/policy.bin on Unix.
+/*!
+ *  Test builds load $WORKRAVE_POLICY instead, if set. Other builds ignore
+ *  it, so that users cannot escape the policy of the administrator.
+ */
+string
+SystemPolicy::get_default_filename()
+{
+#ifdef HAVE_TESTS
+  const char *env = getenv("WORKRAVE_POLICY");
+  if (env != NULL)
+    {
+      return env;
+    }
+#endif
+
+#if defined(PLATFORM_OS_UNIX)
+  return "/etc/workrave/policy.bin";
+#else
+  return "";
+#endif
+}
+
+
+//! FNV-1a hash of a key.
+guint32
+SystemPolicy::hash(const char *key, gsize length)
+{
+  guint32 h = 2166136261U;
+  for (gsize i = 0; i < length; i++)
+    {
+      h ^= (guint8) key[i];
+      h *= 16777619U;
+    }
+  return h;
+}
+
+
+SystemPolicy::SystemPolicy() :
+  file(NULL),
+  header(NULL),
+  buckets(NULL),
+  entries(NULL),
+  locks(NULL),
+  strings(NULL)
+{
+}
+
+
+SystemPolicy::~SystemPolicy()
+{
+  unload();
+}
+
+
+bool
+SystemPolicy::load(const string &filename)
+{
+  TRACE_ENTER_MSG("SystemPolicy::load", filename);
+
+  unload();
+
+  file = g_mapped_file_new(filename.c_str(), FALSE, NULL);
+  if (file == NULL)
+    {
+      TRACE_RETURN("No policy");
+      return false;
+    }
+
+  const char *data = g_mapped_file_get_contents(file);
+  gsize size = g_mapped_file_get_length(file);
+
+  bool ret = size >= sizeof(Header);
+  if (ret)
+    {
+      header = (const Header *) data;
+
+      guint64 bucket_size = (guint64) header->bucket_count * sizeof(guint32);
+      guint64 entry_size = (guint64) header->entry_count * sizeof(Entry);
+      guint64 lock_size = (guint64) header->lock_count * sizeof(Lock);
+
+      ret = (memcmp(header->magic, MAGIC, sizeof(MAGIC)) == 0 &&
+             header->version == VERSION &&
+             header->byte_order == BYTE_ORDER_MARK &&
+             header->bucket_count > 0 &&
+             (header->bucket_count & (header->bucket_count - 1)) == 0 &&
+             sizeof(Header) + bucket_size + entry_size + lock_size + header->strings_size == size);
+
+      if (ret)
+        {
+          buckets = (const guint32 *) (data + sizeof(Header));
+          entries = (const Entry *) (data + sizeof(Header) + bucket_size);
+          locks = (const Lock *) (data + sizeof(Header) + bucket_size + entry_size);
+          strings = data + sizeof(Header) + bucket_size + entry_size + lock_size;
+
+          ret = validate();
+        }
+    }
+
+  if (!ret)
+    {
+      unload();
+    }
+
+  TRACE_RETURN(ret);
+  return ret;
+}
+
+
+void
+SystemPolicy::unload()
+{
+  if (file != NULL)
+    {
+      g_mapped_file_unref(file);
+    }
+
+  file = NULL;
+  header = NULL;
+  buckets = NULL;
+  entries = NULL;
+  locks = NULL;
+  strings = NULL;
+}
+
+
+//! Checks that all indices and offsets are within the file, so that lookups need not check them.
+bool
+SystemPolicy::validate() const
+{
+  guint32 strings_size = header->strings_size;
+
+  for (guint32 i = 0; i < header->bucket_count; i++)
+    {
+      if (buckets[i] != NONE && buckets[i] >= header->entry_count)
+        {
+          return false;
+        }
+    }
+
+  for (guint32 i = 0; i < header->entry_count; i++)
+    {
+      const Entry &e = entries[i];
+      if ((e.next != NONE && e.next >= header->entry_count) ||
+          e.key > strings_size || e.key_length > strings_size - e.key ||
+          e.value > strings_size || e.value_length > strings_size - e.value)
+        {
+          return false;
+        }
+    }
+
+  for (guint32 i = 0; i < header->lock_count; i++)
+    {
+      if (locks[i].prefix > strings_size || locks[i].length > strings_size - locks[i].prefix)
+        {
+          return false;
+        }
+    }
+
+  return true;
+}
+
+
+const SystemPolicy::Entry *
+SystemPolicy::find(const string &key) const
+{
+  guint32 h = hash(key.data(), key.size());
+
+  // Bounded, in case the chains of a corrupt file form a cycle.
+  guint32 count = 0;
+  for (guint32 i = buckets[h & (header->bucket_count - 1)];
+       i != NONE && count < header->entry_count;
+       i = entries[i].next, count++)
+    {
+      const Entry &e = entries[i];
+      if (e.hash == h && e.key_length == key.size() &&
+          memcmp(strings + e.key, key.data(), e.key_length) == 0)
+        {
+          return &e;
+        }
+    }
+
+  return NULL;
+}
+
+
+bool
+SystemPolicy::is_locked_prefix(const string &key) const
+{
+  for (guint32 i = 0; i < header->lock_count; i++)
+    {
+      const Lock &lock = locks[i];
+      if (lock.length <= key.size() &&
+          memcmp(strings + lock.prefix, key.data(), lock.length) == 0)
+        {
+          return true;
+        }
+    }
+  return false;
+}
+
+
+bool
+SystemPolicy::get_value(const string &key, VariantType type, Variant &out, bool &locked) const
+{
+  locked = false;
+  if (header == NULL)
+    {
+      return false;
+    }
+
+  const Entry *e = find(key);
+
+  locked = (e != NULL && (e->flags & ENTRY_FLAG_LOCKED) != 0) || is_locked_prefix(key);
+  if (e == NULL || (e->flags & ENTRY_FLAG_VALUE) == 0)
+    {
+      return false;
+    }
+
+  string value(strings + e->value, e->value_length);
+  bool ret = true;
+
+  switch (type)
+    {
+    case VARIANT_TYPE_INT:
+    case VARIANT_TYPE_LONG:
+      {
+        char *end = NULL;
+        long l = strtol(value.c_str(), &end, 10);
+        ret = end != value.c_str() && *end == '\0';
+        if (type == VARIANT_TYPE_INT)
+          {
+            out.int_value = (int) l;
+          }
+        else
+          {
+            out.long_value = l;
+          }
+      }
+      break;
+
+    case VARIANT_TYPE_BOOL:
+      ret = value == "true" || value == "false";
+      out.bool_value = value == "true";
+      break;
+
+    case VARIANT_TYPE_DOUBLE:
+      ret = sscanf(value.c_str(), "%lf", &out.double_value) == 1;
+      break;
+
+    case VARIANT_TYPE_NONE:
+      type = VARIANT_TYPE_STRING;
+      // FALLTHROUGH
+
+    case VARIANT_TYPE_STRING:
+      out.string_value = value;
+      break;
+
+    default:
+      ret = false;
+    }
+
+  out.type = type;
+  return ret;
+}
+
+
+bool
+SystemPolicy::is_locked(const string &key) const
+{
+  if (header == NULL)
+    {
+      return false;
+    }
+
+  const Entry *e = find(key);
+  return (e != NULL && (e->flags & ENTRY_FLAG_LOCKED) != 0) || is_locked_prefix(key);
+}
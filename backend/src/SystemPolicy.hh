@@ -0,0 +1,135 @@
+// SystemPolicy.hh --- Configuration policy of the administrator
+//
+// Copyright (C) 2017 Rob Caelers <robc@krandor.nl>
+// All rights reserved.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef SYSTEMPOLICY_HH
+#define SYSTEMPOLICY_HH
+
+#include <string>
+
+#include <glib.h>
+
+#include "Variant.hh"
+
+//! Configuration policy of the administrator.
+/*!
+ *  The policy is a read-only configuration layer below the user
+ *  configuration. It provides default values, and it can lock keys: the
+ *  user cannot change a locked key, and its policy value (or, without a
+ *  value, the built-in default) is always used.
+ *
+ *  The policy is compiled from an ini file by PolicyCompiler into a
+ *  binary file, which is mapped into memory as is. Lookups hash the key
+ *  and compare it against the mapped strings; nothing is parsed or
+ *  allocated.
+ *
+ *  File layout, in host byte order:
+ *
+ *    Header
+ *    guint32 buckets[bucket_count]    first entry of each hash chain
+ *    Entry entries[entry_count]
+ *    Lock locks[lock_count]           locked key prefixes
+ *    char strings[strings_size]       keys and values, not terminated
+ */
+class SystemPolicy
+{
+public:
+  struct Header
+  {
+    char magic[8];
+    guint32 version;
+    guint32 byte_order;
+    guint32 bucket_count;
+    guint32 entry_count;
+    guint32 lock_count;
+    guint32 strings_size;
+  };
+
+  struct Entry
+  {
+    guint32 hash;
+    guint32 next;
+    guint32 key;
+    guint32 key_length;
+    guint32 value;
+    guint32 value_length;
+    guint32 flags;
+  };
+
+  struct Lock
+  {
+    guint32 prefix;
+    guint32 length;
+  };
+
+  enum EntryFlags
+    {
+      ENTRY_FLAG_VALUE = 1,
+      ENTRY_FLAG_LOCKED = 2
+    };
+
+  static const char MAGIC[8];
+  static const guint32 VERSION = 1;
+  static const guint32 BYTE_ORDER_MARK = 0x01020304;
+  static const guint32 NONE = 0xffffffff;
+
+  //! Returns the policy of this system, loaded on first use.
+  static SystemPolicy *get_instance();
+
+  //! Returns the file from which the policy of this system is loaded.
+  static std::string get_default_filename();
+
+  static guint32 hash(const char *key, gsize length);
+
+  SystemPolicy();
+  ~SystemPolicy();
+
+  //! Maps a compiled policy file.
+  bool load(const std::string &filename);
+
+  //! Looks up the policy of a key.
+  /*!
+   *  \param locked receives whether the user may not change the key.
+   *  \return whether the policy has a value for the key.
+   */
+  bool get_value(const std::string &key, VariantType type, Variant &out, bool &locked) const;
+
+  //! Returns whether the user may not change the key.
+  bool is_locked(const std::string &key) const;
+
+private:
+  void unload();
+  bool validate() const;
+  const Entry *find(const std::string &key) const;
+  bool is_locked_prefix(const std::string &key) const;
+
+private:
+  //! The one and only instance
+  static SystemPolicy *instance;
+
+  //! The mapped file, NULL if there is no policy.
+  GMappedFile *file;
+
+  const Header *header;
+  const guint32 *buckets;
+  const Entry *entries;
+  const Lock *locks;
+  const char *strings;
+};
+
+#endif // SYSTEMPOLICY_HH
@@ -27,15 +27,64 @@
 
 #ifdef HAVE_TESTS
 
+#include <sstream>
+#include <vector>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <glib.h>
+
 #include "nls.h"
 
 #include "Test.hh"
 #include "CoreFactory.hh"
 #include "Core.hh"
 #include "IApp.hh"
+#include "ActivityMonitor.hh"
+#include "SessionInputMonitor.hh"
+#include "InputMonitorFactory.hh"
+#include "InputStatistics.hh"
+#include "CompositeInputMonitor.hh"
+#include "TimePred.hh"
+#include "TimePredFactory.hh"
+#include "Thread.hh"
+#include "Runnable.hh"
+
+using namespace std;
 
 Test *Test::instance = NULL;
 
+//! Reports actions as fast as possible, like a very busy input thread.
+class BenchmarkInput : public Runnable
+{
+public:
+  BenchmarkInput(SessionInputMonitor *input) :
+    input(input),
+    running(1),
+    count(0)
+  {
+  }
+
+  void run()
+  {
+    while (g_atomic_int_get(&running))
+      {
+        input->report_action();
+        count++;
+      }
+  }
+
+  void stop()
+  {
+    g_atomic_int_set(&running, 0);
+  }
+
+  SessionInputMonitor *input;
+  volatile gint running;
+  gint64 count;
+};
+
 void
 Test::quit()
 {
@@ -44,4 +93,347 @@ Test::quit()
   core->application->terminate();
 }
 
+
+//! Measures the contention between the input thread and the readers of the activity state.
+/*!
+ *  Runs each phase for \c duration ms on a private activity monitor:
+ *  actions only, state reads only, and actions with concurrent reads.
+ *  The last phase is repeated with reads that take the lock of the
+ *  monitor, as get_current_state() used to do.
+ *
+ *  \return the number of actions and reads per second of each phase.
+ */
+string
+Test::benchmark_activity_monitor(int duration)
+{
+  if (duration <= 0)
+    {
+      duration = 1000;
+    }
+
+  SessionInputMonitor *input = new SessionInputMonitor();
+  InputMonitorFactory::set_override(input);
+  ActivityMonitor *monitor = new ActivityMonitor();
+  InputMonitorFactory::set_override(NULL);
+
+  stringstream ss;
+  gint64 usec = (gint64)duration * 1000;
+
+  for (int phase = 0; phase < 4; phase++)
+    {
+      bool actions = phase != 1;
+      bool reads = phase != 0;
+      bool locked = phase == 3;
+
+      BenchmarkInput writer(input);
+      Thread *thread = NULL;
+      if (actions)
+        {
+          thread = new Thread(&writer);
+          thread->start();
+        }
+
+      gint64 num_reads = 0;
+      gint64 start = g_get_monotonic_time();
+      gint64 now = start;
+      while (now - start < usec)
+        {
+          if (reads)
+            {
+              for (int i = 0; i < 1024; i++)
+                {
+                  if (locked)
+                    {
+                      monitor->lock.lock();
+                      monitor->get_current_state();
+                      monitor->lock.unlock();
+                    }
+                  else
+                    {
+                      monitor->get_current_state();
+                    }
+                }
+              num_reads += 1024;
+            }
+          else
+            {
+              g_usleep(1000);
+            }
+          now = g_get_monotonic_time();
+        }
+
+      if (thread != NULL)
+        {
+          writer.stop();
+          thread->wait();
+          delete thread;
+        }
+
+      static const char *names[] = { "actions", "reads", "concurrent", "concurrent-locked" };
+      gint64 elapsed = now - start;
+      ss << names[phase]
+         << " actions/s " << writer.count * G_USEC_PER_SEC / elapsed
+         << " reads/s " << num_reads * G_USEC_PER_SEC / elapsed
+         << endl;
+    }
+
+  // Also deletes the input monitor.
+  delete monitor;
+
+  return ss.str();
+}
+
+
+//! Reference implementation of the input counters: one event at a time.
+class ReferenceInputStatistics
+{
+public:
+  ReferenceInputStatistics() :
+    prev_x(-1),
+    prev_y(-1),
+    click_x(-1),
+    click_y(-1),
+    last_mouse_time(0)
+  {
+  }
+
+  void process(const InputEvent &event, IStatistics::MiscStats &stats, gint64 &mouse_time)
+  {
+    static const int sensitivity = 3;
+
+    if (event.type == InputEvent::INPUT_EVENT_MOUSE && event.x >= 0 && event.y >= 0)
+      {
+        int delta_x = sensitivity;
+        int delta_y = sensitivity;
+
+        if (prev_x != -1 && prev_y != -1)
+          {
+            delta_x = abs(event.x - prev_x);
+            delta_y = abs(event.y - prev_y);
+          }
+
+        prev_x = event.x;
+        prev_y = event.y;
+
+        if (delta_x < 10000 && delta_y < 10000 &&
+            (delta_x >= sensitivity || delta_y >= sensitivity || event.wheel != 0))
+          {
+            int64_t movement = stats[IStatistics::STATS_VALUE_TOTAL_MOUSE_MOVEMENT];
+            movement += int(sqrt((double)(delta_x * delta_x + delta_y * delta_y)));
+            if (movement > 0)
+              {
+                stats[IStatistics::STATS_VALUE_TOTAL_MOUSE_MOVEMENT] = movement;
+              }
+
+            gint64 tv = event.time - last_mouse_time;
+            if (last_mouse_time != 0 && tv >= 0 && tv < G_USEC_PER_SEC)
+              {
+                mouse_time += tv;
+                stats[IStatistics::STATS_VALUE_TOTAL_MOVEMENT_TIME] = mouse_time / G_USEC_PER_SEC;
+              }
+            last_mouse_time = event.time;
+          }
+      }
+    else if (event.type == InputEvent::INPUT_EVENT_BUTTON)
+      {
+        if (click_x != -1 && click_y != -1 && prev_x != -1  && prev_y != -1)
+          {
+            int delta_x = click_x - prev_x;
+            int delta_y = click_y - prev_y;
+
+            int64_t movement = stats[IStatistics::STATS_VALUE_TOTAL_CLICK_MOVEMENT];
+            movement += int(sqrt((double)(delta_x * delta_x + delta_y * delta_y)));
+            if (movement > 0)
+              {
+                stats[IStatistics::STATS_VALUE_TOTAL_CLICK_MOVEMENT] = movement;
+              }
+          }
+
+        click_x = prev_x;
+        click_y = prev_y;
+
+        if (event.is_press)
+          {
+            stats[IStatistics::STATS_VALUE_TOTAL_CLICKS]++;
+          }
+      }
+    else if (event.type == InputEvent::INPUT_EVENT_KEYBOARD && !event.repeat)
+      {
+        stats[IStatistics::STATS_VALUE_TOTAL_KEYSTROKES]++;
+      }
+  }
+
+private:
+  int prev_x;
+  int prev_y;
+  int click_x;
+  int click_y;
+  gint64 last_mouse_time;
+};
+
+
+//! Checks that batched input events yield the same statistics as single events.
+/*!
+ *  Feeds the same random events to the reference implementation, and to
+ *  InputStatistics one at a time and in batches of random size.
+ *
+ *  \return "ok", or the first difference.
+ */
+string
+Test::check_statistics_batch(int count)
+{
+  if (count <= 0)
+    {
+      count = 100000;
+    }
+
+  GRand *rand = g_rand_new_with_seed(count);
+
+  vector<InputEvent> events;
+  gint64 time = 1000000;
+  int x = 500, y = 500;
+  for (int i = 0; i < count; i++)
+    {
+      time += g_rand_int_range(rand, 0, 300000);
+      switch (g_rand_int_range(rand, 0, 8))
+        {
+        case 0:
+          events.push_back(InputEvent::button(time, g_rand_boolean(rand)));
+          break;
+        case 1:
+          events.push_back(InputEvent::keyboard(time, g_rand_int_range(rand, 0, 4) == 0));
+          break;
+        case 2:
+          // Large jumps, and positions outside the screen.
+          events.push_back(InputEvent::mouse(time, g_rand_int_range(rand, -100, 20000),
+                                             g_rand_int_range(rand, -100, 20000)));
+          break;
+        default:
+          x += g_rand_int_range(rand, -20, 21);
+          y += g_rand_int_range(rand, -20, 21);
+          events.push_back(InputEvent::mouse(time, x, y, g_rand_int_range(rand, 0, 10) == 0));
+          break;
+        }
+    }
+  g_rand_free(rand);
+
+  IStatistics::MiscStats expected, single, batched;
+  gint64 expected_time = 0, single_time = 0, batched_time = 0;
+  for (int j = 0; j < IStatistics::STATS_VALUE_SIZEOF; j++)
+    {
+      expected[j] = single[j] = batched[j] = 0;
+    }
+
+  ReferenceInputStatistics reference;
+  InputStatistics single_input;
+  InputStatistics batched_input;
+
+  for (int i = 0; i < count; i++)
+    {
+      reference.process(events[i], expected, expected_time);
+      single_input.process(&events[i], 1, single, single_time);
+    }
+
+  for (int i = 0; i < count; )
+    {
+      int n = 1 + (i * 7919) % 200;
+      n = n < count - i ? n : count - i;
+      batched_input.process(&events[i], n, batched, batched_time);
+      i += n;
+    }
+
+  stringstream ss;
+  for (int j = 0; j < IStatistics::STATS_VALUE_SIZEOF; j++)
+    {
+      if (single[j] != expected[j] || batched[j] != expected[j])
+        {
+          ss << "value " << j << " expected " << expected[j]
+             << " single " << single[j] << " batched " << batched[j] << endl;
+        }
+    }
+  if (single_time != expected_time || batched_time != expected_time)
+    {
+      ss << "mouse time expected " << expected_time
+         << " single " << single_time << " batched " << batched_time << endl;
+    }
+
+  return ss.str().empty() ? "ok" : ss.str();
+}
+
+
+//! Runs events through the deduplication of the composite input monitor.
+/*!
+ *  \param events space separated events of the form <source><kind><time>,
+ *                where source is 'a' or 'b', kind is 'a' (action), 'm'
+ *                (mouse), 'b' (button) or 'k' (keyboard), and time is the
+ *                arrival time in ms. E.g. "ak0 bk20".
+ *
+ *  \return '1' for each event that is passed on, '0' for each duplicate,
+ *          or "" if the events cannot be parsed.
+ */
+string
+Test::deduplicate_input(const string &events)
+{
+  CompositeInputMonitor composite;
+  composite.add_source("a", NULL);
+  composite.add_source("b", NULL);
+
+  const char *kinds = "ambk";
+
+  stringstream in(events);
+  string event;
+  string ret;
+  while (in >> event)
+    {
+      const char *kind = event.size() >= 3 ? strchr(kinds, event[1]) : NULL;
+      if ((event[0] != 'a' && event[0] != 'b') || kind == NULL || *kind == '\0')
+        {
+          return "";
+        }
+
+      CompositeInputMonitor::Source *source = composite.sources[event[0] - 'a'];
+      CompositeInputMonitor::EventKind event_kind = CompositeInputMonitor::EventKind(kind - kinds);
+      gint64 now = g_ascii_strtoll(event.c_str() + 2, NULL, 10) * G_TIME_SPAN_MILLISECOND;
+
+      ret += composite.accept(source, event_kind, now) ? '1' : '0';
+    }
+
+  return ret;
+}
+
+
+//! Computes the next matches of a time predicate.
+/*!
+ *  Each match becomes the last match for the next one, as for the daily
+ *  reset of a timer. Uses the time zone of the process (TZ).
+ *
+ *  \param spec the predicate, e.g. "day/4:00".
+ *  \param last time of the last match.
+ *  \param count number of matches.
+ *
+ *  \return the space separated times of the matches, or "" if the
+ *          predicate is invalid.
+ */
+string
+Test::get_next_times(const string &spec, gint64 last, int count)
+{
+  TimePred *pred = TimePredFactory::create_time_pred(spec);
+  if (pred == NULL)
+    {
+      return "";
+    }
+
+  stringstream ss;
+  time_t t = (time_t) last;
+  for (int i = 0; i < count; i++)
+    {
+      pred->set_last(t);
+      t = pred->get_next();
+      ss << (i > 0 ? " " : "") << (gint64) t;
+    }
+
+  delete pred;
+  return ss.str();
+}
+
 #endif
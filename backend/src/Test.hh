@@ -20,12 +20,21 @@
 #ifndef TEST_H
 #define TEST_H
 
+#include <string>
+
+#include <glib.h>
+
 class Test
 {
 public:
   static Test *get_instance();
 
   void quit();
+  std::string benchmark_activity_monitor(int duration);
+  std::string check_statistics_batch(int count);
+  std::string deduplicate_input(const std::string &events);
+  std::string get_next_times(const std::string &spec, gint64 last, int count);
+
 private:
   //! The one and only instance
   static Test *instance;
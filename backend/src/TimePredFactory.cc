@@ -22,7 +22,7 @@
 #endif
 
 #include "TimePredFactory.hh"
-#include "DayTimePred.hh"
+#include "CronTimePred.hh"
 
 using namespace std;
 
@@ -40,11 +40,11 @@ TimePredFactory::create_time_pred(string spec)
       type = spec.substr(0, pos);
       spec = spec.substr(pos + 1);
 
-      if (type == "day")
+      if (type == "day" || type == "workday" || type == "week" || type == "cron")
         {
-          DayTimePred *dayPred = new DayTimePred();
-          ok = dayPred->init(spec);
-          pred = dayPred;
+          CronTimePred *cronPred = new CronTimePred();
+          ok = cronPred->init(type, spec);
+          pred = cronPred;
         }
     }
 
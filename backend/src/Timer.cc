@@ -28,7 +28,7 @@
 #include <math.h>
 #include <time.h>
 
-#include "CoreFactory.hh"
+#include "Core.hh"
 #include "ICore.hh"
 
 #include "Timer.hh"
@@ -81,7 +81,7 @@ Timer::Timer() :
   activity_sensitive(true),
   insensitive_mode(INSENSITIVE_MODE_IDLE_ON_LIMIT_REACHED)
 {
-  core = CoreFactory::get_core();
+  core = Core::get_instance();
 }
 
 
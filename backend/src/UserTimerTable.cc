@@ -0,0 +1,303 @@
+// UserTimerTable.cc --- Table of user defined timers
+//
+// Copyright (C) 2017 Rob Caelers <robc@krandor.nl>
+// All rights reserved.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <sstream>
+
+#include "debug.hh"
+
+#include "UserTimerTable.hh"
+
+using namespace std;
+
+//! Time differences above this value are considered a time warp (seconds).
+static const time_t MAX_PROCESS_DELTA = 60;
+
+const string UserTimerTable::STATE_PREFIX = "user:";
+
+
+UserTimerTable::UserTimerTable() :
+  last_process_time(0)
+{
+}
+
+
+void
+UserTimerTable::clear()
+{
+  names.clear();
+  limits.clear();
+  auto_resets.clear();
+  elapsed.clear();
+  idle.clear();
+  reached.clear();
+}
+
+
+int
+UserTimerTable::add(const string &name, time_t limit, time_t auto_reset)
+{
+  int index = find(name);
+
+  if (index == -1)
+    {
+      index = size();
+      names.push_back(name);
+      limits.push_back(limit);
+      auto_resets.push_back(auto_reset);
+      elapsed.push_back(0);
+      idle.push_back(0);
+      reached.push_back(0);
+    }
+  else
+    {
+      limits[index] = limit;
+      auto_resets[index] = auto_reset;
+      reached[index] = limit > 0 && elapsed[index] >= limit;
+    }
+
+  return index;
+}
+
+
+void
+UserTimerTable::retain(const vector<string> &keep)
+{
+  int to = 0;
+
+  for (int from = 0; from < size(); from++)
+    {
+      bool found = false;
+      for (vector<string>::const_iterator i = keep.begin(); !found && i != keep.end(); i++)
+        {
+          found = (*i == names[from]);
+        }
+
+      if (found)
+        {
+          names[to] = names[from];
+          limits[to] = limits[from];
+          auto_resets[to] = auto_resets[from];
+          elapsed[to] = elapsed[from];
+          idle[to] = idle[from];
+          reached[to] = reached[from];
+          to++;
+        }
+    }
+
+  names.resize(to);
+  limits.resize(to);
+  auto_resets.resize(to);
+  elapsed.resize(to);
+  idle.resize(to);
+  reached.resize(to);
+}
+
+
+int
+UserTimerTable::find(const string &name) const
+{
+  for (int i = 0; i < size(); i++)
+    {
+      if (names[i] == name)
+        {
+          return i;
+        }
+    }
+  return -1;
+}
+
+
+int
+UserTimerTable::size() const
+{
+  return (int) names.size();
+}
+
+
+void
+UserTimerTable::process(ActivityState state, time_t now, vector<int> &limit_reached)
+{
+  time_t delta = now - last_process_time;
+  last_process_time = now;
+
+  if (delta <= 0 || delta > MAX_PROCESS_DELTA)
+    {
+      // First call or time warp. Timers are not advanced.
+      return;
+    }
+
+  int count = size();
+  if (count == 0)
+    {
+      return;
+    }
+
+  if (state == ACTIVITY_ACTIVE)
+    {
+      time_t *e = &elapsed[0];
+      time_t *i = &idle[0];
+      for (int n = 0; n < count; n++)
+        {
+          e[n] += delta;
+          i[n] = 0;
+        }
+    }
+  else
+    {
+      time_t *e = &elapsed[0];
+      time_t *i = &idle[0];
+      const time_t *r = &auto_resets[0];
+      for (int n = 0; n < count; n++)
+        {
+          i[n] += delta;
+          if (r[n] > 0 && i[n] >= r[n])
+            {
+              e[n] = 0;
+              reached[n] = 0;
+            }
+        }
+    }
+
+  for (int n = 0; n < count; n++)
+    {
+      if (!reached[n] && limits[n] > 0 && elapsed[n] >= limits[n])
+        {
+          reached[n] = 1;
+          limit_reached.push_back(n);
+        }
+    }
+}
+
+
+void
+UserTimerTable::shift_time(int delta)
+{
+  if (last_process_time != 0)
+    {
+      last_process_time += delta;
+    }
+}
+
+
+void
+UserTimerTable::daily_reset()
+{
+  for (int n = 0; n < size(); n++)
+    {
+      elapsed[n] = 0;
+      idle[n] = 0;
+      reached[n] = 0;
+    }
+}
+
+
+const string &
+UserTimerTable::get_name(int index) const
+{
+  return names[index];
+}
+
+
+time_t
+UserTimerTable::get_limit(int index) const
+{
+  return limits[index];
+}
+
+
+time_t
+UserTimerTable::get_auto_reset(int index) const
+{
+  return auto_resets[index];
+}
+
+
+time_t
+UserTimerTable::get_elapsed_time(int index) const
+{
+  return elapsed[index];
+}
+
+
+time_t
+UserTimerTable::get_elapsed_idle_time(int index) const
+{
+  return idle[index];
+}
+
+
+bool
+UserTimerTable::is_limit_reached(int index) const
+{
+  return reached[index] != 0;
+}
+
+
+//! Returns the state of a timer as a line for the state file.
+string
+UserTimerTable::serialize_state(int index) const
+{
+  stringstream ss;
+
+  ss << STATE_PREFIX << names[index] << " "
+     << elapsed[index] << " "
+     << idle[index] << " "
+     << (int) reached[index];
+
+  return ss.str();
+}
+
+
+//! Restores the state of a timer from the state file.
+bool
+UserTimerTable::deserialize_state(const string &name, const string &state)
+{
+  TRACE_ENTER_MSG("UserTimerTable::deserialize_state", name << " " << state);
+
+  int index = find(name);
+  if (index == -1)
+    {
+      TRACE_RETURN("Unknown timer");
+      return false;
+    }
+
+  istringstream ss(state);
+  time_t e = 0, i = 0;
+  int r = 0;
+
+  ss >> e >> i >> r;
+
+  if (ss.fail())
+    {
+      TRACE_RETURN("Invalid state");
+      return false;
+    }
+
+  elapsed[index] = e;
+  idle[index] = i;
+  reached[index] = r != 0;
+
+  TRACE_EXIT();
+  return true;
+}
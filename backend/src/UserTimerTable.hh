@@ -0,0 +1,109 @@
+// UserTimerTable.hh --- Table of user defined timers
+//
+// Copyright (C) 2017 Rob Caelers <robc@krandor.nl>
+// All rights reserved.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#ifndef USERTIMERTABLE_HH
+#define USERTIMERTABLE_HH
+
+#include <time.h>
+#include <string>
+#include <vector>
+
+#include "IActivityMonitor.hh"
+
+//! Table of user defined timers.
+/*!
+ *  User defined timers are simple activity timers (e.g. 'look away every
+ *  20 minutes') that are configured under user_timers/. Unlike the break
+ *  timers they have no break window or snooze logic. All timers are stored
+ *  column-wise so that the heartbeat processes them in a single pass over
+ *  contiguous arrays.
+ */
+class UserTimerTable
+{
+public:
+  UserTimerTable();
+
+  //! Removes all timers.
+  void clear();
+
+  //! Adds a timer, or updates its configuration if it already exists.
+  int add(const std::string &name, time_t limit, time_t auto_reset);
+
+  //! Removes all timers that are not in the specified list.
+  void retain(const std::vector<std::string> &names);
+
+  //! Returns the index of the timer with the specified name, or -1.
+  int find(const std::string &name) const;
+
+  //! Returns the number of timers.
+  int size() const;
+
+  //! Processes all timers.
+  /*!
+   *  \param state current activity state.
+   *  \param now current time.
+   *  \param limit_reached receives the indices of the timers that reached their limit.
+   */
+  void process(ActivityState state, time_t now, std::vector<int> &limit_reached);
+
+  //! Shifts the internal time after a change of the wall-clock time.
+  void shift_time(int delta);
+
+  //! Resets all timers back to 0.
+  void daily_reset();
+
+  const std::string &get_name(int index) const;
+  time_t get_limit(int index) const;
+  time_t get_auto_reset(int index) const;
+  time_t get_elapsed_time(int index) const;
+  time_t get_elapsed_idle_time(int index) const;
+  bool is_limit_reached(int index) const;
+
+  // State serialization.
+  std::string serialize_state(int index) const;
+  bool deserialize_state(const std::string &name, const std::string &state);
+
+  //! Prefix of the timer ids in the state file.
+  static const std::string STATE_PREFIX;
+
+private:
+  //! Names of the timers.
+  std::vector<std::string> names;
+
+  //! Limits (in seconds), 0 if the timer has no limit.
+  std::vector<time_t> limits;
+
+  //! Idle time after which a timer resets (in seconds), 0 to disable.
+  std::vector<time_t> auto_resets;
+
+  //! Elapsed active time.
+  std::vector<time_t> elapsed;
+
+  //! Elapsed idle time.
+  std::vector<time_t> idle;
+
+  //! Whether the limit has been reached since the last reset.
+  std::vector<unsigned char> reached;
+
+  //! Time the timers were last processed.
+  time_t last_process_time;
+};
+
+#endif // USERTIMERTABLE_HH
@@ -0,0 +1,106 @@
+// Varint.hh --- Variable length encoding of integers
+//
+// Copyright (C) 2017 Rob Caelers <robc@krandor.nl>
+// All rights reserved.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef VARINT_HH
+#define VARINT_HH
+
+#include <istream>
+#include <stdio.h>
+#include <string>
+
+#include <glib.h>
+
+//! Variable length encoding of integers, 7 bits per byte.
+/*!
+ *  Signed values are zigzag encoded first, so that small negative
+ *  values are short as well.
+ */
+namespace Varint
+{
+  inline void
+  put(std::string &out, guint64 value)
+  {
+    while (value >= 0x80)
+      {
+        out += (char) ((value & 0x7f) | 0x80);
+        value >>= 7;
+      }
+    out += (char) value;
+  }
+
+
+  inline void
+  put_signed(std::string &out, gint64 value)
+  {
+    put(out, ((guint64) value << 1) ^ (guint64) (value >> 63));
+  }
+
+
+  inline bool
+  get(const std::string &in, size_t &pos, guint64 &value)
+  {
+    value = 0;
+    for (int shift = 0; shift < 64 && pos < in.size(); shift += 7)
+      {
+        guint8 b = (guint8) in[pos++];
+        value |= (guint64) (b & 0x7f) << shift;
+        if ((b & 0x80) == 0)
+          {
+            return true;
+          }
+      }
+    return false;
+  }
+
+
+  inline bool
+  get_signed(const std::string &in, size_t &pos, gint64 &value)
+  {
+    guint64 v;
+    if (!get(in, pos, v))
+      {
+        return false;
+      }
+    value = (gint64) (v >> 1) ^ -(gint64) (v & 1);
+    return true;
+  }
+
+
+  inline bool
+  read(std::istream &in, guint64 &value)
+  {
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7)
+      {
+        int c = in.get();
+        if (c == EOF)
+          {
+            return false;
+          }
+        value |= (guint64) (c & 0x7f) << shift;
+        if ((c & 0x80) == 0)
+          {
+            return true;
+          }
+      }
+    return false;
+  }
+}
+
+#endif // VARINT_HH
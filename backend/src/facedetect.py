@@ -57,6 +57,8 @@ class FaceActivityMonitor:
         self.verbose          = False
         self.face_threshold   = 2 
         self.noface_threshold = 5
+        self.lease_ttl        = 60
+        self.lease_renew      = 30
 
         # Parameters for haar detection
         # From the API:
@@ -210,14 +212,23 @@ class FaceActivityMonitor:
                 print "Reporting user presence"
                 
             now = time.time()
-            if now > self.last_time + 5:
-                self.workrave.ReportActivity("facedetect", True)
+            if self.last_time == 0:
+                self.workrave.StartActivity("facedetect", self.lease_ttl)
+                self.last_time = now
+            elif now > self.last_time + self.lease_renew:
+                # Start a new lease if the old one expired meanwhile.
+                if not self.workrave.RenewActivity("facedetect", self.lease_ttl):
+                    self.workrave.StartActivity("facedetect", self.lease_ttl)
                 self.last_time = now
 
         if self.count_noface == self.noface_threshold:
             if self.verbose:
                 print "Reporting user absence"
-            self.workrave.ReportActivity("facedetect", False)
+            self.end_activity()
+
+    def end_activity(self):
+        self.workrave.EndActivity("facedetect")
+        self.last_time = 0
 
     def microbreak_signal(self, progress, sender=None):
         self.break_signal("microbreak", progress)
@@ -233,7 +244,7 @@ class FaceActivityMonitor:
             self.count_face = 0
             self.count_noface = 0
             self.ignore = True;
-            self.workrave.ReportActivity("facedetect", False)
+            self.end_activity()
         else:
             self.ignore = False;
         
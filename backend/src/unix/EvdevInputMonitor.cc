@@ -0,0 +1,536 @@
+// EvdevInputMonitor.cc --- ActivityMonitor for Linux evdev devices
+//
+// Copyright (C) 2017 Rob Caelers <robc@krandor.nl>
+// All rights reserved.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "debug.hh"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <string.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/epoll.h>
+#include <sys/inotify.h>
+#include <sys/ioctl.h>
+
+#include "EvdevInputMonitor.hh"
+
+#include "Thread.hh"
+
+using namespace std;
+
+#define EVDEV_DIRECTORY "/dev/input"
+#define EVDEV_PREFIX "event"
+
+//! Maximum number of events read in one go.
+static const int EVENT_BATCH_SIZE = 64;
+
+//! Tests a bit in an evdev capability mask.
+static bool
+test_bit(unsigned int bit, const unsigned long *mask)
+{
+  const unsigned int bits_per_long = sizeof(unsigned long) * 8;
+  return (mask[bit / bits_per_long] >> (bit % bits_per_long)) & 1;
+}
+
+//! Is the specified key code a mouse, touch or joystick button?
+static bool
+is_button(unsigned int code)
+{
+  return ((code >= BTN_MISC && code < KEY_OK) ||
+          (code >= BTN_DPAD_UP && code <= BTN_DPAD_RIGHT) ||
+          (code >= BTN_TRIGGER_HAPPY && code <= BTN_TRIGGER_HAPPY40));
+}
+
+
+EvdevInputMonitor::EvdevInputMonitor(const string &dump_filename) :
+  dump_filename(dump_filename),
+  dump_fd(-1),
+  epoll_fd(-1),
+  inotify_fd(-1),
+  abort(false),
+  pointer_x(0),
+  pointer_y(0),
+  pointer_wheel(0),
+  pointer_moved(false)
+{
+  wakeup_pipe[0] = -1;
+  wakeup_pipe[1] = -1;
+  monitor_thread = new Thread(this);
+}
+
+
+EvdevInputMonitor::~EvdevInputMonitor()
+{
+  TRACE_ENTER("EvdevInputMonitor::~EvdevInputMonitor");
+  if (monitor_thread != NULL)
+    {
+      monitor_thread->wait();
+      delete monitor_thread;
+    }
+
+  while (!devices.empty())
+    {
+      remove_device(devices.begin()->first);
+    }
+
+  if (dump_fd != -1)
+    {
+      close(dump_fd);
+    }
+  if (inotify_fd != -1)
+    {
+      close(inotify_fd);
+    }
+  if (epoll_fd != -1)
+    {
+      close(epoll_fd);
+    }
+  if (wakeup_pipe[0] != -1)
+    {
+      close(wakeup_pipe[0]);
+      close(wakeup_pipe[1]);
+    }
+  TRACE_EXIT();
+}
+
+
+bool
+EvdevInputMonitor::init()
+{
+  TRACE_ENTER("EvdevInputMonitor::init");
+
+  if (pipe(wakeup_pipe) != 0)
+    {
+      wakeup_pipe[0] = -1;
+      wakeup_pipe[1] = -1;
+      TRACE_RETURN("No pipe");
+      return false;
+    }
+  fcntl(wakeup_pipe[0], F_SETFL, O_NONBLOCK);
+  fcntl(wakeup_pipe[1], F_SETFL, O_NONBLOCK);
+
+  bool ok = false;
+  if (dump_filename != "")
+    {
+      dump_fd = open(dump_filename.c_str(), O_RDONLY);
+      ok = dump_fd != -1;
+    }
+  else
+    {
+      ok = open_devices();
+    }
+
+  if (ok)
+    {
+      monitor_thread->start();
+    }
+
+  TRACE_RETURN(ok);
+  return ok;
+}
+
+
+void
+EvdevInputMonitor::terminate()
+{
+  TRACE_ENTER("EvdevInputMonitor::terminate");
+
+  abort = true;
+  if (wakeup_pipe[1] != -1)
+    {
+      char c = 0;
+      ssize_t ret = write(wakeup_pipe[1], &c, 1);
+      (void) ret;
+    }
+
+  monitor_thread->wait();
+
+  TRACE_EXIT();
+}
+
+
+void
+EvdevInputMonitor::run()
+{
+  TRACE_ENTER("EvdevInputMonitor::run");
+
+  if (dump_fd != -1)
+    {
+      run_dump();
+    }
+  else
+    {
+      run_devices();
+    }
+
+  TRACE_EXIT();
+}
+
+
+void
+EvdevInputMonitor::run_devices()
+{
+  while (!abort)
+    {
+      struct epoll_event events[16];
+
+      int count = epoll_wait(epoll_fd, events, G_N_ELEMENTS(events), -1);
+      if (count < 0 && errno != EINTR)
+        {
+          break;
+        }
+
+      for (int i = 0; i < count && !abort; i++)
+        {
+          int fd = events[i].data.fd;
+
+          if (fd == inotify_fd)
+            {
+              handle_inotify();
+            }
+          else if (fd != wakeup_pipe[0])
+            {
+              if (events[i].events & (EPOLLERR | EPOLLHUP))
+                {
+                  // Device was unplugged.
+                  remove_device(fd);
+                }
+              else
+                {
+                  handle_device(fd);
+                }
+            }
+        }
+    }
+}
+
+
+void
+EvdevInputMonitor::run_dump()
+{
+  TRACE_ENTER_MSG("EvdevInputMonitor::run_dump", dump_filename);
+
+  gint64 first_event_time = -1;
+  gint64 start_time = g_get_monotonic_time();
+
+  struct input_event event;
+  while (!abort && read(dump_fd, &event, sizeof(event)) == sizeof(event))
+    {
+      gint64 event_time = (gint64) event.time.tv_sec * G_TIME_SPAN_SECOND + event.time.tv_usec;
+      if (first_event_time == -1)
+        {
+          first_event_time = event_time;
+        }
+
+      gint64 delay = (event_time - first_event_time) - (g_get_monotonic_time() - start_time);
+      if (delay > 0 && !wait(delay))
+        {
+          break;
+        }
+
+      InputEvent input_event;
+      if (handle_event(event, input_event))
+        {
+          fire_batch(&input_event, 1);
+        }
+    }
+
+  TRACE_EXIT();
+}
+
+
+bool
+EvdevInputMonitor::open_devices()
+{
+  TRACE_ENTER("EvdevInputMonitor::open_devices");
+
+  epoll_fd = epoll_create(16);
+  if (epoll_fd == -1)
+    {
+      TRACE_RETURN("No epoll");
+      return false;
+    }
+
+  struct epoll_event ev;
+  memset(&ev, 0, sizeof(ev));
+  ev.events = EPOLLIN;
+  ev.data.fd = wakeup_pipe[0];
+  epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wakeup_pipe[0], &ev);
+
+  inotify_fd = inotify_init();
+  if (inotify_fd != -1)
+    {
+      fcntl(inotify_fd, F_SETFL, O_NONBLOCK);
+      if (inotify_add_watch(inotify_fd, EVDEV_DIRECTORY, IN_CREATE | IN_ATTRIB) != -1)
+        {
+          ev.data.fd = inotify_fd;
+          epoll_ctl(epoll_fd, EPOLL_CTL_ADD, inotify_fd, &ev);
+        }
+      else
+        {
+          close(inotify_fd);
+          inotify_fd = -1;
+        }
+    }
+
+  DIR *dir = opendir(EVDEV_DIRECTORY);
+  if (dir != NULL)
+    {
+      struct dirent *entry;
+      while ((entry = readdir(dir)) != NULL)
+        {
+          if (strncmp(entry->d_name, EVDEV_PREFIX, strlen(EVDEV_PREFIX)) == 0)
+            {
+              add_device(string(EVDEV_DIRECTORY) + "/" + entry->d_name);
+            }
+        }
+      closedir(dir);
+    }
+
+  TRACE_RETURN(devices.size());
+  return !devices.empty();
+}
+
+
+bool
+EvdevInputMonitor::add_device(const string &path)
+{
+  TRACE_ENTER_MSG("EvdevInputMonitor::add_device", path);
+
+  for (map<int, string>::iterator i = devices.begin(); i != devices.end(); i++)
+    {
+      if (i->second == path)
+        {
+          TRACE_RETURN("Already open");
+          return true;
+        }
+    }
+
+  int fd = open(path.c_str(), O_RDONLY | O_NONBLOCK);
+  if (fd == -1)
+    {
+      TRACE_RETURN("Cannot open");
+      return false;
+    }
+
+  // Only keep devices that report keys, buttons or motion. This
+  // skips lid switches, accelerometers and the like.
+  unsigned long evbits[(EV_MAX + sizeof(unsigned long) * 8) / (sizeof(unsigned long) * 8)];
+  memset(evbits, 0, sizeof(evbits));
+
+  if (ioctl(fd, EVIOCGBIT(0, sizeof(evbits)), evbits) < 0 ||
+      !(test_bit(EV_KEY, evbits) || test_bit(EV_REL, evbits) || test_bit(EV_ABS, evbits)))
+    {
+      close(fd);
+      TRACE_RETURN("Not an input device");
+      return false;
+    }
+
+  struct epoll_event ev;
+  memset(&ev, 0, sizeof(ev));
+  ev.events = EPOLLIN;
+  ev.data.fd = fd;
+
+  if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev) == -1)
+    {
+      close(fd);
+      TRACE_RETURN("Cannot poll");
+      return false;
+    }
+
+  devices[fd] = path;
+
+  TRACE_RETURN(fd);
+  return true;
+}
+
+
+void
+EvdevInputMonitor::remove_device(int fd)
+{
+  TRACE_ENTER_MSG("EvdevInputMonitor::remove_device", fd);
+  if (epoll_fd != -1)
+    {
+      epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, NULL);
+    }
+  close(fd);
+  devices.erase(fd);
+  TRACE_EXIT();
+}
+
+
+void
+EvdevInputMonitor::handle_inotify()
+{
+  char buffer[4096] __attribute__ ((aligned(__alignof__(struct inotify_event))));
+
+  ssize_t len;
+  while ((len = read(inotify_fd, buffer, sizeof(buffer))) > 0)
+    {
+      char *ptr = buffer;
+      while (ptr < buffer + len)
+        {
+          const struct inotify_event *event = (const struct inotify_event *) ptr;
+
+          if (event->len > 0 && strncmp(event->name, EVDEV_PREFIX, strlen(EVDEV_PREFIX)) == 0)
+            {
+              // Permissions are usually set by udev after creation, hence IN_ATTRIB.
+              add_device(string(EVDEV_DIRECTORY) + "/" + event->name);
+            }
+
+          ptr += sizeof(struct inotify_event) + event->len;
+        }
+    }
+}
+
+
+void
+EvdevInputMonitor::handle_device(int fd)
+{
+  struct input_event events[EVENT_BATCH_SIZE];
+  InputEvent batch[EVENT_BATCH_SIZE];
+
+  while (true)
+    {
+      ssize_t len = read(fd, events, sizeof(events));
+      if (len < 0 && errno == EINTR)
+        {
+          continue;
+        }
+
+      if (len < 0 && errno != EAGAIN)
+        {
+          remove_device(fd);
+          break;
+        }
+
+      if (len <= 0)
+        {
+          break;
+        }
+
+      // Each event yields at most one input event.
+      int count = len / sizeof(struct input_event);
+      int batch_size = 0;
+      for (int i = 0; i < count; i++)
+        {
+          if (handle_event(events[i], batch[batch_size]))
+            {
+              batch_size++;
+            }
+        }
+
+      if (batch_size > 0)
+        {
+          fire_batch(batch, batch_size);
+        }
+    }
+}
+
+
+bool
+EvdevInputMonitor::handle_event(const struct input_event &event, InputEvent &out)
+{
+  gint64 time = (gint64) event.time.tv_sec * G_TIME_SPAN_SECOND + event.time.tv_usec;
+
+  switch (event.type)
+    {
+    case EV_KEY:
+      if (is_button(event.code))
+        {
+          if (event.value != 2)
+            {
+              out = InputEvent::button(time, event.value == 1);
+              return true;
+            }
+        }
+      else if (event.value == 1 || event.value == 2)
+        {
+          out = InputEvent::keyboard(time, event.value == 2);
+          return true;
+        }
+      break;
+
+    case EV_REL:
+      if (event.code == REL_X)
+        {
+          pointer_x += event.value;
+          pointer_moved = true;
+        }
+      else if (event.code == REL_Y)
+        {
+          pointer_y += event.value;
+          pointer_moved = true;
+        }
+      else if (event.code == REL_WHEEL || event.code == REL_HWHEEL)
+        {
+          pointer_wheel += event.value;
+          pointer_moved = true;
+        }
+      break;
+
+    case EV_ABS:
+      if (event.code == ABS_X || event.code == ABS_MT_POSITION_X)
+        {
+          pointer_x = event.value;
+          pointer_moved = true;
+        }
+      else if (event.code == ABS_Y || event.code == ABS_MT_POSITION_Y)
+        {
+          pointer_y = event.value;
+          pointer_moved = true;
+        }
+      break;
+
+    case EV_SYN:
+      if (event.code == SYN_REPORT && pointer_moved)
+        {
+          out = InputEvent::mouse(time, pointer_x, pointer_y, pointer_wheel);
+          pointer_wheel = 0;
+          pointer_moved = false;
+          return true;
+        }
+      break;
+
+    default:
+      break;
+    }
+
+  return false;
+}
+
+
+//! Waits for the specified timeout (in µs). Returns false on termination.
+bool
+EvdevInputMonitor::wait(gint64 timeout)
+{
+  struct pollfd fds[1];
+  fds[0].fd = wakeup_pipe[0];
+  fds[0].events = POLLIN;
+
+  int ret = poll(fds, 1, (int) (timeout / G_TIME_SPAN_MILLISECOND));
+  (void) ret;
+
+  return !abort;
+}
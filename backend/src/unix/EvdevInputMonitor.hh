@@ -0,0 +1,131 @@
+// EvdevInputMonitor.hh --- ActivityMonitor for Linux evdev devices
+//
+// Copyright (C) 2017 Rob Caelers <robc@krandor.nl>
+// All rights reserved.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef EVDEVINPUTMONITOR_HH
+#define EVDEVINPUTMONITOR_HH
+
+#include <string>
+#include <map>
+
+#include <linux/input.h>
+
+#include "InputMonitor.hh"
+
+#include "Runnable.hh"
+#include "Thread.hh"
+
+//! Input monitor that reads the kernel event devices.
+/*!
+ *  Reads all /dev/input/event* devices that report keys, buttons or pointer
+ *  motion from a single thread using epoll. New devices are picked up
+ *  using inotify. This monitor does not depend on X11 and works on Wayland
+ *  and on the console, provided the user may read the event devices.
+ *
+ *  Alternatively, the monitor reads a dump of struct input_event records
+ *  (e.g. recorded with 'cat /dev/input/eventN > dump') and replays it with
+ *  the recorded timing.
+ */
+class EvdevInputMonitor :
+  public InputMonitor,
+  public Runnable
+{
+public:
+  //! Constructor.
+  EvdevInputMonitor(const std::string &dump_filename = "");
+
+  //! Destructor.
+  virtual ~EvdevInputMonitor();
+
+  //! Initialize
+  virtual bool init();
+
+  //! Terminate the monitor.
+  virtual void terminate();
+
+private:
+  //! The monitor's execution thread.
+  virtual void run();
+
+  //! Reads events from the event devices.
+  void run_devices();
+
+  //! Replays events from the dump file.
+  void run_dump();
+
+  //! Opens all event devices.
+  bool open_devices();
+
+  //! Opens the specified event device.
+  bool add_device(const std::string &path);
+
+  //! Closes the event device of the specified file descriptor.
+  void remove_device(int fd);
+
+  //! Handles new event devices.
+  void handle_inotify();
+
+  //! Reads all pending events of the specified device.
+  void handle_device(int fd);
+
+  //! Classifies a single event.
+  /*!
+   *  \return true if the event was translated into \c out.
+   */
+  bool handle_event(const struct input_event &event, InputEvent &out);
+
+  //! Waits for a timeout or termination.
+  bool wait(gint64 timeout);
+
+private:
+  //! Recorded events to replay, empty to read the event devices.
+  std::string dump_filename;
+
+  //! File descriptor of the dump file.
+  int dump_fd;
+
+  //! Epoll instance for all devices.
+  int epoll_fd;
+
+  //! Inotify instance watching /dev/input.
+  int inotify_fd;
+
+  //! Pipe used to wake up the monitor thread.
+  int wakeup_pipe[2];
+
+  //! Open event devices.
+  std::map<int, std::string> devices;
+
+  //! Abort the main loop
+  bool abort;
+
+  //! The activity monitor thread.
+  Thread *monitor_thread;
+
+  //! Position of the virtual pointer accumulated from relative motion.
+  int pointer_x;
+  int pointer_y;
+
+  //! Accumulated wheel motion.
+  int pointer_wheel;
+
+  //! Did the pointer move since the last synchronization event?
+  bool pointer_moved;
+};
+
+#endif // EVDEVINPUTMONITOR_HH
@@ -35,8 +35,15 @@
 #include "UnixInputMonitorFactory.hh"
 #include "RecordInputMonitor.hh"
 #include "X11InputMonitor.hh"
+#ifndef HAVE_APP_HEADLESS
 #include "XScreenSaverMonitor.hh"
+#endif
 #include "MutterInputMonitor.hh"
+#include "ReplayInputMonitor.hh"
+#include "CompositeInputMonitor.hh"
+#ifdef HAVE_EVDEV
+#include "EvdevInputMonitor.hh"
+#endif
 
 UnixInputMonitorFactory::UnixInputMonitorFactory()
   : error_reported(false)
@@ -72,6 +79,19 @@ UnixInputMonitorFactory::get_monitor(IInputMonitorFactory::MonitorCapability cap
                                                               configure_monitor_method,
                                                               "default");
 
+      // Replaying a recorded input trace overrides the configured monitor.
+      if (getenv("WORKRAVE_INPUT_REPLAY") != NULL)
+        {
+          available_monitors.push_back("replay");
+          configure_monitor_method = "replay";
+        }
+
+      // Several monitors separated by '+' run simultaneously.
+      if (configure_monitor_method.find('+') != string::npos)
+        {
+          available_monitors.push_back(configure_monitor_method);
+        }
+
       vector<string>::const_iterator start = available_monitors.end();
 
       if (configure_monitor_method != "default")
@@ -89,27 +109,12 @@ UnixInputMonitorFactory::get_monitor(IInputMonitorFactory::MonitorCapability cap
       vector<string>::const_iterator loop = start;
       while(1)
         {
-          string actual_monitor_method = *loop;
+          actual_monitor_method = *loop;
           TRACE_MSG("Test " <<  actual_monitor_method);
 
-          if (actual_monitor_method == "record")
-            {
-              monitor = new RecordInputMonitor(display);
-            }
-          else if (actual_monitor_method == "screensaver")
-            {
-              monitor = new XScreenSaverMonitor();
-            }
-          else if (actual_monitor_method == "x11events")
-            {
-              monitor = new X11InputMonitor(display);
-            }
-          else if (actual_monitor_method == "mutter")
-            {
-              monitor = new MutterInputMonitor();
-            }
+          monitor = create_monitor(actual_monitor_method);
 
-          initialized = monitor->init();
+          initialized = monitor != NULL && monitor->init();
 
           if (initialized)
             {
@@ -139,7 +144,10 @@ UnixInputMonitorFactory::get_monitor(IInputMonitorFactory::MonitorCapability cap
           if (!error_reported)
             {
               error_reported = true;
-              g_idle_add(static_report_failure, NULL);
+              GSource *source = g_idle_source_new();
+              g_source_set_callback(source, static_report_failure, NULL, NULL);
+              g_source_attach(source, g_main_context_get_thread_default());
+              g_source_unref(source);
             }
 
           CoreFactory::get_configurator()->set_value("advanced/monitor", "default");
@@ -149,7 +157,7 @@ UnixInputMonitorFactory::get_monitor(IInputMonitorFactory::MonitorCapability cap
         }
       else
         {
-          if (configure_monitor_method != "default")
+          if (configure_monitor_method != "default" && actual_monitor_method != "replay")
             {
               CoreFactory::get_configurator()->set_value("advanced/monitor", actual_monitor_method);
               CoreFactory::get_configurator()->save();
@@ -163,6 +171,65 @@ UnixInputMonitorFactory::get_monitor(IInputMonitorFactory::MonitorCapability cap
   return monitor;
 }
 
+//! Creates the input monitor for the specified method.
+IInputMonitor *
+UnixInputMonitorFactory::create_monitor(const string &method)
+{
+  IInputMonitor *ret = NULL;
+
+  if (method.find('+') != string::npos)
+    {
+      vector<string> methods;
+      StringUtil::split(method, '+', methods);
+
+      CompositeInputMonitor *composite = new CompositeInputMonitor();
+      for (vector<string>::const_iterator i = methods.begin(); i != methods.end(); i++)
+        {
+          IInputMonitor *source = create_monitor(*i);
+          if (source != NULL)
+            {
+              composite->add_source(*i, source);
+            }
+        }
+      ret = composite;
+    }
+  else if (method == "record")
+    {
+      ret = new RecordInputMonitor(display);
+    }
+#ifndef HAVE_APP_HEADLESS
+  else if (method == "screensaver")
+    {
+      ret = new XScreenSaverMonitor(display);
+    }
+#endif
+  else if (method == "x11events")
+    {
+      ret = new X11InputMonitor(display);
+    }
+  else if (method == "mutter")
+    {
+      ret = new MutterInputMonitor();
+    }
+  else if (method == "replay")
+    {
+      const char *replay = getenv("WORKRAVE_INPUT_REPLAY");
+      const char *speed = getenv("WORKRAVE_INPUT_REPLAY_SPEED");
+      ret = new ReplayInputMonitor(replay != NULL ? replay : "",
+                                   speed != NULL ? g_ascii_strtod(speed, NULL) : 1.0);
+    }
+#ifdef HAVE_EVDEV
+  else if (method == "evdev")
+    {
+      const char *dump = getenv("WORKRAVE_EVDEV_DUMP");
+      ret = new EvdevInputMonitor(dump != NULL ? dump : "");
+    }
+#endif
+
+  return ret;
+}
+
+
 gboolean
 UnixInputMonitorFactory::static_report_failure(void *data)
 {
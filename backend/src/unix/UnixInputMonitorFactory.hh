@@ -37,6 +37,7 @@ public:
   virtual IInputMonitor *get_monitor(IInputMonitorFactory::MonitorCapability capability);
 
 private:
+  IInputMonitor *create_monitor(const std::string &method);
   static gboolean static_report_failure(void *data);
 
   bool error_reported;
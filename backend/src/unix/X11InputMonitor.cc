@@ -66,6 +66,10 @@
 
 #include "X11InputMonitor.hh"
 
+#ifdef HAVE_XSYNC
+#include "XSyncIdleAlarm.hh"
+#endif
+
 #include "Core.hh"
 #include "ICore.hh"
 #include "ICoreEventListener.hh"
@@ -99,9 +103,12 @@ errorHandler(Display *dpy, XErrorEvent *error)
 }
 #endif
 
+//! Poll the pointer this long before the idle threshold may be crossed.
+static const gint64 QUERY_MARGIN = G_TIME_SPAN_MILLISECOND * 500;
+
 //! Obtains the next X11 event with specified timeout.
 static Bool
-XNextEventTimed(Display* dsp, XEvent* event_return, long millis)
+XNextEventTimed(Display* dsp, XEvent* event_return, long millis, int wakeup_fd)
 {
   if (millis == 0)
     {
@@ -125,7 +132,12 @@ XNextEventTimed(Display* dsp, XEvent* event_return, long millis)
       fd_set readset;
       FD_ZERO(&readset);
       FD_SET(fd, &readset);
-      if (select(fd+1, &readset, NULL, NULL, &tv) <= 0)
+      if (wakeup_fd != -1)
+        {
+          FD_SET(wakeup_fd, &readset);
+          fd = MAX(fd, wakeup_fd);
+        }
+      if (select(fd+1, &readset, NULL, NULL, millis < 0 ? NULL : &tv) <= 0)
         {
           return False;
         }
@@ -146,10 +158,13 @@ XNextEventTimed(Display* dsp, XEvent* event_return, long millis)
 
 X11InputMonitor::X11InputMonitor(const string &display_name) :
   x11_display(NULL),
-  abort(false)
+  abort(false),
+  idle_alarm(NULL)
 {
   x11_display_name = display_name;
   monitor_thread = new Thread(this);
+  wakeup_pipe[0] = -1;
+  wakeup_pipe[1] = -1;
 }
 
 
@@ -163,6 +178,12 @@ X11InputMonitor::~X11InputMonitor()
       delete monitor_thread;
     }
 
+  if (wakeup_pipe[0] != -1)
+    {
+      close(wakeup_pipe[0]);
+      close(wakeup_pipe[1]);
+    }
+
   TRACE_EXIT();
 }
 
@@ -170,6 +191,17 @@ X11InputMonitor::~X11InputMonitor()
 bool
 X11InputMonitor::init()
 {
+  if (pipe(wakeup_pipe) == 0)
+    {
+      fcntl(wakeup_pipe[0], F_SETFL, O_NONBLOCK);
+      fcntl(wakeup_pipe[1], F_SETFL, O_NONBLOCK);
+    }
+  else
+    {
+      wakeup_pipe[0] = -1;
+      wakeup_pipe[1] = -1;
+    }
+
   monitor_thread->start();
   return true;
 }
@@ -180,6 +212,12 @@ X11InputMonitor::terminate()
   TRACE_ENTER("X11InputMonitor::terminate");
 
   abort = true;
+  if (wakeup_pipe[1] != -1)
+    {
+      char c = 0;
+      ssize_t ret = write(wakeup_pipe[1], &c, 1);
+      (void) ret;
+    }
   monitor_thread->wait();
 
   TRACE_EXIT();
@@ -207,17 +245,35 @@ X11InputMonitor::run()
 
   error_trap_exit();
 
+#ifdef HAVE_XSYNC
+  if (wakeup_pipe[0] != -1)
+    {
+      idle_alarm = new XSyncIdleAlarm();
+      if (!idle_alarm->init(x11_display))
+        {
+          delete idle_alarm;
+          idle_alarm = NULL;
+        }
+    }
+#endif
+
+  gint64 last_activity_time = g_get_monotonic_time();
+  int prev_x = -1;
+  int prev_y = -1;
+  long timeout = 100;
+
   while (1)
     {
       XEvent event;
-      bool gotEvent = XNextEventTimed(x11_display, &event, 100);
+      bool gotEvent = XNextEventTimed(x11_display, &event, timeout, wakeup_pipe[0]);
 
       if (abort)
         {
-          TRACE_EXIT();
-          return;
+          break;
         }
 
+      gint64 now = g_get_monotonic_time();
+
       if (gotEvent)
         {
           error_trap_enter();
@@ -226,6 +282,7 @@ X11InputMonitor::run()
             {
             case KeyPress:
               handle_keypress(&event);
+              last_activity_time = now;
               break;
 
             case CreateNotify:
@@ -235,12 +292,19 @@ X11InputMonitor::run()
             case ButtonPress:
             case ButtonRelease:
               handle_button(&event);
+              last_activity_time = now;
               break;
             }
 
           error_trap_exit();
         }
 
+#ifdef HAVE_XSYNC
+      if (timeout < 0)
+        {
+          idle_alarm->disarm();
+        }
+#endif
 
       // timeout
       Window root, child;
@@ -253,12 +317,66 @@ X11InputMonitor::run()
 
       error_trap_exit();
 
+      if (root_x != prev_x || root_y != prev_y)
+        {
+          last_activity_time = now;
+          prev_x = root_x;
+          prev_y = root_y;
+        }
+
       fire_mouse(root_x, root_y);
+
+      timeout = get_next_timeout(now - last_activity_time);
     }
 
+#ifdef HAVE_XSYNC
+  delete idle_alarm;
+  idle_alarm = NULL;
+#endif
+
   TRACE_EXIT();
 }
 
+
+//! Computes the next pointer poll timeout.
+/*!
+ *  The pointer is polled every 100ms while it moves. After the last input
+ *  event the activity monitor remains active until the idle threshold is
+ *  crossed, so the next poll is deferred until just before that time.
+ *  Once the user is idle, the monitor thread waits for the XSync idle alarm
+ *  (if available) instead of polling.
+ *
+ *  \param idle time in µs since the last detected input.
+ *  \return timeout in ms, or -1 to wait for the idle alarm.
+ */
+long
+X11InputMonitor::get_next_timeout(gint64 idle)
+{
+  gint64 idle_threshold = (gint64) get_idle_threshold() * G_TIME_SPAN_MILLISECOND;
+  long timeout = 100;
+
+  if (idle < G_TIME_SPAN_SECOND)
+    {
+      // User is active.
+    }
+  else if (idle < idle_threshold)
+    {
+      timeout = MAX((idle_threshold - idle - QUERY_MARGIN) / G_TIME_SPAN_MILLISECOND, timeout);
+    }
+#ifdef HAVE_XSYNC
+  else if (idle_alarm != NULL && idle_alarm->arm())
+    {
+      timeout = -1;
+    }
+#endif
+  else
+    {
+      timeout = 1000;
+    }
+
+  return timeout;
+}
+
 void
 X11InputMonitor::set_event_mask(Window window)
 {
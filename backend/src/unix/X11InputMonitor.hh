@@ -27,6 +27,8 @@
 
 #include "InputMonitor.hh"
 
+class XSyncIdleAlarm;
+
 #include "Runnable.hh"
 #include "Thread.hh"
 
@@ -55,6 +57,9 @@ private:
   void error_trap_enter();
   void error_trap_exit();
 
+  //! Computes the next pointer poll timeout.
+  long get_next_timeout(gint64 idle);
+
 private:
   //! Internal X magic
   void set_event_mask(Window window);
@@ -86,6 +91,12 @@ private:
 
   //! The activity monitor thread.
   Thread *monitor_thread;
+
+  //! Alarm on the X server idle time, NULL if unavailable.
+  XSyncIdleAlarm *idle_alarm;
+
+  //! Pipe used to wake up the monitor thread.
+  int wakeup_pipe[2];
 };
 
 #endif // X11INPUTMONITOR_HH
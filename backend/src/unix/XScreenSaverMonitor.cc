@@ -23,10 +23,18 @@
 
 #include "debug.hh"
 
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+
 #include <gdk/gdkx.h>
 
 #include "XScreenSaverMonitor.hh"
 
+#ifdef HAVE_XSYNC
+#include "XSyncIdleAlarm.hh"
+#endif
+
 #include "Core.hh"
 #include "ICore.hh"
 #include "ICoreEventListener.hh"
@@ -37,13 +45,19 @@
 using namespace std;
 using namespace workrave;
 
-XScreenSaverMonitor::XScreenSaverMonitor() :
+//! Query the X server this long before the idle threshold may be crossed.
+static const gint64 QUERY_MARGIN = G_TIME_SPAN_MILLISECOND * 500;
+
+XScreenSaverMonitor::XScreenSaverMonitor(const string &display_name) :
+  x11_display_name(display_name),
   abort(false),
-  screen_saver_info(NULL)
+  screen_saver_info(NULL),
+  alarm_display(NULL),
+  idle_alarm(NULL)
 {
   monitor_thread = new Thread(this);
-  mutex = g_mutex_new();
-  cond = g_cond_new();
+  wakeup_pipe[0] = -1;
+  wakeup_pipe[1] = -1;
 }
 
 
@@ -56,8 +70,24 @@ XScreenSaverMonitor::~XScreenSaverMonitor()
       delete monitor_thread;
     }
 
-  g_mutex_free(mutex);
-  g_cond_free(cond);
+#ifdef HAVE_XSYNC
+  delete idle_alarm;
+#endif
+  if (alarm_display != NULL)
+    {
+      XCloseDisplay(alarm_display);
+    }
+
+  if (wakeup_pipe[0] != -1)
+    {
+      close(wakeup_pipe[0]);
+      close(wakeup_pipe[1]);
+    }
+
+  if (screen_saver_info != NULL)
+    {
+      XFree(screen_saver_info);
+    }
   TRACE_EXIT();
 }
 
@@ -72,26 +102,74 @@ XScreenSaverMonitor::init()
 
   if (has_extension)
   {
+    if (pipe(wakeup_pipe) == 0)
+      {
+        fcntl(wakeup_pipe[0], F_SETFL, O_NONBLOCK);
+        fcntl(wakeup_pipe[1], F_SETFL, O_NONBLOCK);
+      }
+    else
+      {
+        wakeup_pipe[0] = -1;
+        wakeup_pipe[1] = -1;
+      }
+
+    init_idle_alarm();
+
     screen_saver_info = XScreenSaverAllocInfo();
     monitor_thread->start();
   }
-  
+
   return has_extension;
 }
 
+
+void
+XScreenSaverMonitor::init_idle_alarm()
+{
+  TRACE_ENTER("XScreenSaverMonitor::init_idle_alarm");
+#ifdef HAVE_XSYNC
+  if (wakeup_pipe[0] == -1)
+    {
+      // Cannot interrupt an indefinite wait. Keep polling.
+      TRACE_RETURN("No pipe");
+      return;
+    }
+
+  // The alarm events must not end up in the event queue of GDK.
+  alarm_display = XOpenDisplay(x11_display_name.c_str());
+  if (alarm_display != NULL)
+    {
+      idle_alarm = new XSyncIdleAlarm();
+      if (!idle_alarm->init(alarm_display))
+        {
+          delete idle_alarm;
+          idle_alarm = NULL;
+
+          XCloseDisplay(alarm_display);
+          alarm_display = NULL;
+        }
+    }
+#endif
+  TRACE_RETURN((idle_alarm != NULL));
+}
+
+
 void
 XScreenSaverMonitor::terminate()
 {
   TRACE_ENTER("XScreenSaverMonitor::terminate");
 
-  g_mutex_lock(mutex);
   abort = true;
-  g_cond_broadcast(cond);
-  g_mutex_unlock(mutex);  
-  
+  if (wakeup_pipe[1] != -1)
+    {
+      char c = 0;
+      ssize_t ret = write(wakeup_pipe[1], &c, 1);
+      (void) ret;
+    }
+
   monitor_thread->wait();
   monitor_thread = NULL;
-  
+
   TRACE_EXIT();
 }
 
@@ -101,25 +179,121 @@ XScreenSaverMonitor::run()
 {
   TRACE_ENTER("XScreenSaverMonitor::run");
 
-  g_mutex_lock(mutex);
+  gint64 last_query_time = 0;
+
   while (!abort)
     {
       XScreenSaverQueryInfo(gdk_x11_display_get_xdisplay(gdk_display_get_default()), gdk_x11_get_default_root_xwindow(), screen_saver_info);
 
-      if (screen_saver_info->idle < 1000)
+      gint64 now = g_get_monotonic_time();
+      gint64 idle = (gint64) screen_saver_info->idle * G_TIME_SPAN_MILLISECOND;
+      gint64 since_last_query = G_TIME_SPAN_SECOND;
+
+      if (last_query_time != 0 && now - last_query_time > since_last_query)
+        {
+          since_last_query = now - last_query_time;
+        }
+      last_query_time = now;
+
+      if (idle < since_last_query)
         {
           /* Notify the activity monitor */
           fire_action();
         }
 
-#if GLIB_CHECK_VERSION(2, 32, 0)
-      gint64 end_time = g_get_monotonic_time() + G_TIME_SPAN_SECOND;
-      g_cond_wait_until(cond, mutex, end_time);
-#else
-      g_usleep(500000);
-#endif      
+      wait(get_next_timeout(idle));
     }
-  g_mutex_unlock(mutex);  
-  
+
+  TRACE_EXIT();
+}
+
+
+//! Computes when the X server must be queried next.
+/*!
+ *  While the user is active, the X server is queried every second in order
+ *  to feed the activity monitor. After the last input event the activity
+ *  monitor remains active until the idle threshold is crossed, so there is
+ *  no need to query the server before that time. Once the user is idle, the
+ *  monitor thread waits for the XSync idle alarm (if available).
+ *
+ *  \param idle idle time reported by the X server in µs.
+ *  \return timeout in µs, or -1 to wait for the idle alarm.
+ */
+gint64
+XScreenSaverMonitor::get_next_timeout(gint64 idle)
+{
+  gint64 idle_threshold = (gint64) get_idle_threshold() * G_TIME_SPAN_MILLISECOND;
+  gint64 timeout = G_TIME_SPAN_SECOND;
+
+  if (idle < G_TIME_SPAN_SECOND)
+    {
+      // User is active.
+    }
+  else if (idle < idle_threshold)
+    {
+      timeout = MAX(idle_threshold - idle - QUERY_MARGIN, G_TIME_SPAN_SECOND);
+    }
+#ifdef HAVE_XSYNC
+  else if (idle_alarm != NULL && idle_alarm->arm())
+    {
+      timeout = -1;
+    }
+#endif
+
+  return timeout;
+}
+
+
+//! Waits for a timeout, an idle alarm or termination.
+void
+XScreenSaverMonitor::wait(gint64 timeout)
+{
+  TRACE_ENTER_MSG("XScreenSaverMonitor::wait", timeout);
+
+  struct pollfd fds[2];
+  int num_fds = 0;
+
+  if (wakeup_pipe[0] != -1)
+    {
+      fds[num_fds].fd = wakeup_pipe[0];
+      fds[num_fds].events = POLLIN;
+      num_fds++;
+    }
+
+  if (alarm_display != NULL)
+    {
+      XFlush(alarm_display);
+      fds[num_fds].fd = ConnectionNumber(alarm_display);
+      fds[num_fds].events = POLLIN;
+      num_fds++;
+    }
+
+  if (alarm_display == NULL || !XPending(alarm_display))
+    {
+      int ret = poll(fds, num_fds, timeout < 0 ? -1 : (int) (timeout / G_TIME_SPAN_MILLISECOND));
+      (void) ret;
+    }
+
+#ifdef HAVE_XSYNC
+  if (alarm_display != NULL)
+    {
+      while (XPending(alarm_display))
+        {
+          XEvent event;
+          XNextEvent(alarm_display, &event);
+          if (idle_alarm->is_alarm_event(&event))
+            {
+              TRACE_MSG("Idle alarm");
+            }
+        }
+
+      if (timeout < 0)
+        {
+          // Don't receive alarms while the user is active.
+          idle_alarm->disarm();
+        }
+    }
+#endif
+
   TRACE_EXIT();
 }
@@ -31,6 +31,8 @@
 #include "Runnable.hh"
 #include "Thread.hh"
 
+class XSyncIdleAlarm;
+
 //! Activity monitor for a local X server.
 class XScreenSaverMonitor :
   public InputMonitor,
@@ -38,7 +40,7 @@ class XScreenSaverMonitor :
 {
 public:
   //! Constructor.
-  XScreenSaverMonitor();
+  XScreenSaverMonitor(const std::string &display_name);
 
   //! Destructor.
   virtual ~XScreenSaverMonitor();
@@ -53,8 +55,19 @@ private:
   //! The monitor's execution thread.
   virtual void run();
 
+  //! Initializes the XSync idle alarm
+  void init_idle_alarm();
+
+  //! Computes when the X server must be queried next.
+  gint64 get_next_timeout(gint64 idle);
+
+  //! Waits for a timeout, an idle alarm or termination.
+  void wait(gint64 timeout);
 
 private:
+  //! The X11 display name.
+  std::string x11_display_name;
+
   //! Abort the main loop
   bool abort;
 
@@ -64,8 +77,14 @@ private:
   //
   XScreenSaverInfo *screen_saver_info;
 
-  GMutex *mutex;
-  GCond *cond;
+  //! Private X connection that receives the XSync alarms.
+  Display *alarm_display;
+
+  //! Alarm on the X server idle time, NULL if unavailable.
+  XSyncIdleAlarm *idle_alarm;
+
+  //! Pipe used to wake up the monitor thread.
+  int wakeup_pipe[2];
 };
 
 #endif // XSCREENSAVERMONITOR_HH
@@ -0,0 +1,160 @@
+// XSyncIdleAlarm.cc --- Wakeup on user activity using the XSync IDLETIME counter
+//
+// Copyright (C) 2017 Rob Caelers <robc@krandor.nl>
+// All rights reserved.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "debug.hh"
+
+#include <string.h>
+
+#include "XSyncIdleAlarm.hh"
+
+XSyncIdleAlarm::XSyncIdleAlarm() :
+  display(NULL),
+  idle_counter(None),
+  alarm(None),
+  event_base(0)
+{
+}
+
+
+XSyncIdleAlarm::~XSyncIdleAlarm()
+{
+  disarm();
+}
+
+
+bool
+XSyncIdleAlarm::init(Display *display)
+{
+  TRACE_ENTER("XSyncIdleAlarm::init");
+
+  int error_base;
+  int major;
+  int minor;
+
+  this->display = display;
+
+  if (!XSyncQueryExtension(display, &event_base, &error_base) ||
+      !XSyncInitialize(display, &major, &minor))
+    {
+      TRACE_RETURN("No XSync");
+      return false;
+    }
+
+  int num_counters = 0;
+  XSyncSystemCounter *counters = XSyncListSystemCounters(display, &num_counters);
+
+  for (int i = 0; i < num_counters; i++)
+    {
+      if (strcmp(counters[i].name, "IDLETIME") == 0)
+        {
+          idle_counter = counters[i].counter;
+          break;
+        }
+    }
+
+  if (counters != NULL)
+    {
+      XSyncFreeSystemCounterList(counters);
+    }
+
+  TRACE_RETURN((idle_counter != None));
+  return idle_counter != None;
+}
+
+
+gint64
+XSyncIdleAlarm::get_idle_time()
+{
+  XSyncValue value;
+
+  if (!XSyncQueryCounter(display, idle_counter, &value))
+    {
+      return 0;
+    }
+
+  return ((gint64) XSyncValueHigh32(value) << 32) | (guint32) XSyncValueLow32(value);
+}
+
+
+bool
+XSyncIdleAlarm::arm()
+{
+  TRACE_ENTER("XSyncIdleAlarm::arm");
+
+  gint64 idle = get_idle_time();
+  if (idle < 1)
+    {
+      idle = 1;
+    }
+
+  XSyncAlarmAttributes attr;
+  attr.trigger.counter = idle_counter;
+  attr.trigger.value_type = XSyncAbsolute;
+  attr.trigger.test_type = XSyncNegativeTransition;
+  XSyncIntsToValue(&attr.trigger.wait_value, (unsigned int) (idle & 0xffffffff), (int) (idle >> 32));
+  XSyncIntToValue(&attr.delta, 0);
+  attr.events = True;
+
+  unsigned long flags = XSyncCACounter | XSyncCAValueType | XSyncCATestType |
+    XSyncCAValue | XSyncCADelta | XSyncCAEvents;
+
+  if (alarm == None)
+    {
+      alarm = XSyncCreateAlarm(display, flags, &attr);
+    }
+  else
+    {
+      XSyncChangeAlarm(display, alarm, flags, &attr);
+    }
+  XFlush(display);
+
+  // The user may have become active before the alarm was installed.
+  bool armed = get_idle_time() >= idle;
+
+  TRACE_RETURN(idle << " " << armed);
+  return armed;
+}
+
+
+void
+XSyncIdleAlarm::disarm()
+{
+  if (alarm != None)
+    {
+      XSyncDestroyAlarm(display, alarm);
+      XFlush(display);
+      alarm = None;
+    }
+}
+
+
+bool
+XSyncIdleAlarm::is_alarm_event(XEvent *event) const
+{
+  if (alarm != None && event->type == event_base + XSyncAlarmNotify)
+    {
+      XSyncAlarmNotifyEvent *alarm_event = (XSyncAlarmNotifyEvent *) event;
+      return alarm_event->alarm == alarm;
+    }
+  return false;
+}
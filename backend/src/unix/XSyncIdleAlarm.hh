@@ -0,0 +1,70 @@
+// XSyncIdleAlarm.hh --- Wakeup on user activity using the XSync IDLETIME counter
+//
+// Copyright (C) 2017 Rob Caelers <robc@krandor.nl>
+// All rights reserved.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef XSYNCIDLEALARM_HH
+#define XSYNCIDLEALARM_HH
+
+#include <X11/Xlib.h>
+#include <X11/extensions/sync.h>
+
+#include <glib.h>
+
+//! Alarm on the IDLETIME system counter of the X server.
+/*!
+ *  The X server resets the IDLETIME counter on every input event. An alarm
+ *  on a negative transition of this counter delivers an X event as soon as
+ *  the user becomes active again, so that a monitor thread can block on the
+ *  X connection instead of polling while the user is idle.
+ */
+class XSyncIdleAlarm
+{
+public:
+  XSyncIdleAlarm();
+  ~XSyncIdleAlarm();
+
+  //! Initializes the alarm on the specified display.
+  bool init(Display *display);
+
+  //! Returns the time in ms since the last input event.
+  gint64 get_idle_time();
+
+  //! Requests an alarm event on the next user activity.
+  bool arm();
+
+  //! Cancels a pending alarm.
+  void disarm();
+
+  //! Is the specified event an alarm of this object?
+  bool is_alarm_event(XEvent *event) const;
+
+private:
+  //! The X11 display handle.
+  Display *display;
+
+  //! The IDLETIME counter.
+  XSyncCounter idle_counter;
+
+  //! The currently armed alarm.
+  XSyncAlarm alarm;
+
+  //! Event base of the XSync extension.
+  int event_base;
+};
+
+#endif // XSYNCIDLEALARM_HH
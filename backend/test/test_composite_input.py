@@ -0,0 +1,47 @@
+#!/usr/bin/python
+#
+# Copyright (C) 2017 Rob Caelers <robc@krandor.nl>
+#
+# Checks the deduplication of the composite input monitor, including its
+# documented limits: events are compared by arrival time only.
+#
+
+import unittest
+
+from workrave_test_base import WorkraveTestBase
+
+class TestCompositeInput(WorkraveTestBase):
+
+    def get_num_autostart_workraves(self):
+        return 1
+
+    def dedup(self, events):
+        return self.debug[0].DeduplicateInput(events)
+
+    def test_same_source_is_never_suppressed(self):
+        self.assertEqual(self.dedup("ak0 ak10 ak20"), "111")
+
+    def test_duplicate_within_window(self):
+        self.assertEqual(self.dedup("ak0 bk20"), "10")
+        self.assertEqual(self.dedup("ak0 bk10 ak20"), "101")
+
+    def test_other_kind_is_not_a_duplicate(self):
+        self.assertEqual(self.dedup("ak0 bm10 bb20"), "111")
+
+    def test_action_after_any_event(self):
+        self.assertEqual(self.dedup("am0 ba10 ba60"), "101")
+
+    def test_late_duplicate_is_counted_twice(self):
+        # Limit: the second backend delivered the same event after the window.
+        self.assertEqual(self.dedup("ak0 bk60"), "11")
+
+    def test_different_events_within_window_are_merged(self):
+        # Limit: two keystrokes on different devices within the window.
+        self.assertEqual(self.dedup("ak0 bk49"), "10")
+
+    def test_invalid_input(self):
+        self.assertEqual(self.dedup("xk0"), "")
+        self.assertEqual(self.dedup("az0"), "")
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,112 @@
+#!/usr/bin/python
+#
+# Copyright (C) 2017 Rob Caelers <robc@krandor.nl>
+#
+# Checks the time predicates of the timers ("day/", "workday/", "week/" and
+# "cron/"), including the days of the daylight saving time transitions in
+# 2017: Europe/Amsterdam skips 02:00-03:00 on March 26, and repeats
+# 02:00-03:00 on October 29.
+#
+
+import os
+import unittest
+
+from workrave_test_base import WorkraveTestBase
+
+# Local times in Europe/Amsterdam.
+MAR_24_1200_CET  = 1490353200
+MAR_25_1200_CET  = 1490439600
+MAR_26_0000_CET  = 1490482800
+MAR_26_0130_CET  = 1490488200
+MAR_26_0145_CET  = 1490489100
+MAR_26_0300_CEST = 1490490000
+MAR_26_0315_CEST = 1490490900
+MAR_26_0330_CEST = 1490491800
+MAR_27_0000_CEST = 1490565600
+MAR_27_0230_CEST = 1490574600
+MAR_27_0400_CEST = 1490580000
+MAR_28_0230_CEST = 1490661000
+MAR_28_0400_CEST = 1490666400
+OCT_28_1200_CEST = 1509184800
+OCT_29_0230_CEST = 1509237000
+OCT_29_0245_CEST = 1509237900
+OCT_29_0300_CET  = 1509242400
+OCT_29_0315_CET  = 1509243300
+OCT_29_1200_CET  = 1509274800
+OCT_30_0230_CET  = 1509327000
+OCT_30_0400_CET  = 1509332400
+OCT_30_0415_CET  = 1509333300
+OCT_30_0430_CET  = 1509334200
+OCT_30_0445_CET  = 1509335100
+NOV_01_0400_CET  = 1509505200
+NOV_01_0415_CET  = 1509506100
+NOV_02_0400_CET  = 1509591600
+NOV_06_0400_CET  = 1509937200
+
+class TestCronTimePred(WorkraveTestBase):
+
+    def get_num_autostart_workraves(self):
+        return 1
+
+    def setUp(self):
+        self.saved_tz = os.environ.get("TZ")
+        os.environ["TZ"] = "Europe/Amsterdam"
+        WorkraveTestBase.setUp(self)
+
+    def tearDown(self):
+        WorkraveTestBase.tearDown(self)
+        if self.saved_tz is None:
+            del os.environ["TZ"]
+        else:
+            os.environ["TZ"] = self.saved_tz
+
+    def next_times(self, spec, last, count):
+        times = self.debug[0].GetNextTimes(spec, last, count)
+        return [int(t) for t in times.split()]
+
+    def test_day(self):
+        self.assertEqual(self.next_times("day/0:00", MAR_25_1200_CET, 3),
+                         [MAR_26_0000_CET, MAR_27_0000_CEST, MAR_27_0000_CEST + 86400])
+
+    def test_day_skipped_time(self):
+        # 02:30 does not exist on March 26; mktime moves it to 03:30 CEST.
+        self.assertEqual(self.next_times("day/2:30", MAR_25_1200_CET, 3),
+                         [MAR_26_0330_CEST, MAR_27_0230_CEST, MAR_28_0230_CEST])
+
+    def test_day_repeated_time(self):
+        # 02:30 occurs twice on October 29; only the first occurrence matches.
+        self.assertEqual(self.next_times("day/2:30", OCT_28_1200_CEST, 2),
+                         [OCT_29_0230_CEST, OCT_30_0230_CET])
+
+    def test_cron_steps_over_transitions(self):
+        self.assertEqual(self.next_times("cron/*/15 * * * *", MAR_26_0130_CET, 3),
+                         [MAR_26_0145_CET, MAR_26_0300_CEST, MAR_26_0315_CEST])
+        # The repeated hour is skipped.
+        self.assertEqual(self.next_times("cron/*/15 * * * *", OCT_29_0245_CEST, 2),
+                         [OCT_29_0300_CET, OCT_29_0315_CET])
+
+    def test_workday(self):
+        # From Friday noon, over the weekend of the spring transition.
+        self.assertEqual(self.next_times("workday/4:00", MAR_24_1200_CET, 2),
+                         [MAR_27_0400_CEST, MAR_28_0400_CEST])
+
+    def test_week(self):
+        # From Sunday noon, after the fall transition.
+        self.assertEqual(self.next_times("week/mon,thu 4:00", OCT_29_1200_CET, 3),
+                         [OCT_30_0400_CET, NOV_02_0400_CET, NOV_06_0400_CET])
+
+    def test_cron_either_day(self):
+        # Both the day of the month and the weekday are restricted, so
+        # either the 1st or a Monday matches.
+        self.assertEqual(self.next_times("cron/*/15 4 1 * 1", OCT_29_1200_CET, 6),
+                         [OCT_30_0400_CET, OCT_30_0415_CET, OCT_30_0430_CET, OCT_30_0445_CET,
+                          NOV_01_0400_CET, NOV_01_0415_CET])
+
+    def test_invalid(self):
+        for spec in ["day/25:00", "day/4", "week/xyz 4:00", "week/mon",
+                     "cron/* * * *", "cron/61 * * * *", "cron/5-1 * * * *",
+                     "cron/*/0 * * * *", "cron/0 4 * * 8", "bogus/4:00", "day4:00"]:
+            self.assertEqual(self.debug[0].GetNextTimes(spec, MAR_25_1200_CET, 1), "", spec)
+
+if __name__ == '__main__':
+    unittest.main()
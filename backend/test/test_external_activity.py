@@ -0,0 +1,51 @@
+#!/usr/bin/python
+#
+# Copyright (C) 2017 Rob Caelers <robc@krandor.nl>
+#
+# Checks that the statistics of external activity sources cover all their
+# leases, and that only the most recently reporting sources are kept.
+#
+
+import unittest
+
+from workrave_test_base import WorkraveTestBase
+
+# ExternalActivity::MAX_STATS
+MAX_STATS = 256
+
+class TestExternalActivity(WorkraveTestBase):
+
+    def get_num_autostart_workraves(self):
+        return 1
+
+    def stats(self, who):
+        reports, leases, active_time, found = self.core[0].GetActivityStats(who)
+        return found, reports, leases
+
+    def lease(self, who):
+        self.core[0].StartActivity(who, 60)
+        self.core[0].EndActivity(who)
+
+    def test_unknown_source(self):
+        self.assertEqual(self.stats("nobody")[0], False)
+
+    def test_stats_survive_lease(self):
+        self.lease("camera")
+        self.lease("camera")
+        self.assertEqual(self.stats("camera"), (True, 4, 2))
+
+    def test_renew_after_end_is_counted(self):
+        self.lease("camera")
+        self.assertEqual(self.core[0].RenewActivity("camera", 60), False)
+        self.assertEqual(self.stats("camera"), (True, 3, 1))
+
+    def test_least_recently_used_is_dropped(self):
+        self.lease("camera")
+        for i in range(MAX_STATS):
+            self.lease("sensor%d" % i)
+        self.assertEqual(self.stats("camera")[0], False)
+        self.assertEqual(self.stats("sensor0"), (True, 2, 1))
+        self.assertEqual(self.stats("sensor%d" % (MAX_STATS - 1)), (True, 2, 1))
+
+if __name__ == '__main__':
+    unittest.main()
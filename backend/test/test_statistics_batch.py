@@ -0,0 +1,33 @@
+#!/usr/bin/python
+#
+# Copyright (C) 2017 Rob Caelers <robc@krandor.nl>
+#
+# Checks that the input statistics are the same whether events are
+# processed one by one or in batches.
+#
+
+import unittest
+
+from workrave_test_base import WorkraveTestBase
+
+class TestStatisticsBatch(WorkraveTestBase):
+
+    def get_num_autostart_workraves(self):
+        return 1
+
+    def check(self, count):
+        # Returns "ok", or the totals that differ from the reference.
+        return self.debug[0].CheckStatisticsBatch(count)
+
+    def test_single_event(self):
+        self.assertEqual(self.check(1), "ok")
+
+    def test_short_runs(self):
+        for count in (2, 3, 199, 200, 201):
+            self.assertEqual(self.check(count), "ok", "count %d" % count)
+
+    def test_default_run(self):
+        self.assertEqual(self.check(0), "ok")
+
+if __name__ == '__main__':
+    unittest.main()
@@ -27,6 +27,8 @@
 #include <map>
 #include <list>
 
+class Mutex;
+
 namespace workrave
 {
   class DBusBindingBase;
@@ -39,11 +41,12 @@ namespace workrave
 
     typedef DBusMessage *DBusSignal;
 
-    void init();
+    void init(bool system_bus = false);
     void register_service(const std::string &service);
     void register_object_path(const std::string &object_path);
     void connect(const std::string &path, const std::string &interface_name, void *object);
     void disconnect(const std::string &path, const std::string &interface_name);
+    void set_object_lock(const std::string &path, Mutex *lock);
 
     void register_binding(const std::string &interface_name, DBusBindingBase *binding);
     DBusBindingBase *find_binding(const std::string &interface_name) const;
@@ -66,6 +69,9 @@ namespace workrave
     typedef Objects::iterator ObjectIter;
     typedef Objects::const_iterator ObjectCIter;
 
+    typedef std::map<std::string, Mutex *> Locks;
+    typedef Locks::const_iterator LockCIter;
+
     DBusHandlerResult dispatch_static(DBusConnection *connection,
                                       DBusMessage *message);
 
@@ -78,6 +84,7 @@ namespace workrave
     DBusHandlerResult handle_method(DBusConnection *connection, DBusMessage *message);
 
     void *find_object(const std::string &path, const std::string &interface_name) const;
+    Mutex *find_object_lock(const std::string &path) const;
     void send(DBusMessage *msg) const;
 
     friend class DBusBindingBase;
@@ -93,6 +100,9 @@ namespace workrave
     //!
     Objects objects;
 
+    //! Locks that serialize calls to an object path.
+    Locks locks;
+
     //!
     bool owner;
 
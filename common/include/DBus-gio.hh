@@ -29,6 +29,8 @@
 
 #include "IDBusWatch.hh"
 
+class Mutex;
+
 namespace workrave
 {
   class DBusBindingBase;
@@ -39,11 +41,12 @@ namespace workrave
     DBus();
     ~DBus();
 
-    void init();
+    void init(bool system_bus = false);
     void register_service(const std::string &service, IDBusWatch *cb);
     void register_object_path(const std::string &object_path);
     void connect(const std::string &path, const std::string &interface_name, void *object);
     void disconnect(const std::string &path, const std::string &interface_name);
+    void set_object_lock(const std::string &path, Mutex *lock);
 
     void register_binding(const std::string &interface_name, DBusBindingBase *binding);
     DBusBindingBase *find_binding(const std::string &interface_name) const;
@@ -92,6 +95,9 @@ namespace workrave
     typedef Objects::iterator ObjectIter;
     typedef Objects::const_iterator ObjectCIter;
 
+    typedef std::map<std::string, Mutex *> Locks;
+    typedef Locks::const_iterator LockCIter;
+
     struct WatchData
     {
       guint id;
@@ -104,6 +110,7 @@ namespace workrave
     typedef Watched::const_iterator WatchCIter;
     
     void *find_object(const std::string &path, const std::string &interface_name) const;
+    Mutex *find_object_lock(const std::string &path) const;
     void send() const;
 
     std::string get_introspect(const std::string &path, const std::string &interface_name);
@@ -157,9 +164,15 @@ namespace workrave
     //!
     Objects objects;
 
+    //! Locks that serialize calls to an object path.
+    Locks locks;
+
     //
     Watched watched;
     
+    //! Bus to connect to.
+    GBusType bus_type;
+
     GDBusConnection *connection;
 
     static const GDBusInterfaceVTable interface_vtable;
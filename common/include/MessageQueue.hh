@@ -0,0 +1,87 @@
+// MessageQueue.hh --- Lock-free queue between two threads
+//
+// Copyright (C) 2017 Rob Caelers <robc@krandor.nl>
+// All rights reserved.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef MESSAGEQUEUE_HH
+#define MESSAGEQUEUE_HH
+
+#include <glib.h>
+
+//! Bounded lock-free queue with a single producer and a single consumer.
+/*!
+ *  One thread may push, one (other) thread may pop. The producer owns
+ *  the tail index, the consumer owns the head index. Each index is only
+ *  published after the slot it covers has been written (or read), so
+ *  neither side ever waits for the other.
+ */
+template<class T, int SIZE = 1024>
+class MessageQueue
+{
+public:
+  MessageQueue() : head(0), tail(0)
+  {
+  }
+
+  //! Appends a message. Returns false if the queue is full.
+  bool push(const T &message)
+  {
+    gint t = g_atomic_int_get(&tail);
+    gint next = (t + 1) % SIZE;
+    if (next == g_atomic_int_get(&head))
+      {
+        return false;
+      }
+
+    slots[t] = message;
+    g_atomic_int_set(&tail, next);
+    return true;
+  }
+
+  //! Removes the oldest message. Returns false if the queue is empty.
+  bool pop(T &message)
+  {
+    gint h = g_atomic_int_get(&head);
+    if (h == g_atomic_int_get(&tail))
+      {
+        return false;
+      }
+
+    message = slots[h];
+    slots[h] = T();
+    g_atomic_int_set(&head, (h + 1) % SIZE);
+    return true;
+  }
+
+  //! Returns whether the queue is empty.
+  bool is_empty() const
+  {
+    return g_atomic_int_get(&head) == g_atomic_int_get(&tail);
+  }
+
+private:
+  //! Index of the oldest message, written by the consumer.
+  volatile gint head;
+
+  //! Index of the next free slot, written by the producer.
+  volatile gint tail;
+
+  //! Messages.
+  T slots[SIZE];
+};
+
+#endif // MESSAGEQUEUE_HH
@@ -30,4 +30,37 @@
 #error Port missing
 #endif
 
+//! Holds a mutex for the lifetime of the lock.
+class ScopedLock
+{
+public:
+  //! Locks the mutex, if any.
+  explicit ScopedLock(Mutex *mutex) : mutex(mutex)
+  {
+    if (mutex != NULL)
+      {
+        mutex->lock();
+      }
+  }
+
+  explicit ScopedLock(Mutex &mutex) : mutex(&mutex)
+  {
+    mutex.lock();
+  }
+
+  ~ScopedLock()
+  {
+    if (mutex != NULL)
+      {
+        mutex->unlock();
+      }
+  }
+
+private:
+  ScopedLock(const ScopedLock &);
+  ScopedLock &operator=(const ScopedLock &);
+
+  Mutex *mutex;
+};
+
 #endif // MUTEX_HH
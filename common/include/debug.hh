@@ -36,45 +36,95 @@
 #include <iostream>
 #include <iomanip>
 #include <fstream>
+#include <sstream>
+#include <string>
 #include <ctime>
 
+#include <glib.h>
+
 #include "Mutex.hh"
 
 extern Mutex g_log_mutex;
 extern std::ofstream g_log_stream;
 
+//! Tracing.
+/*!
+ *  Trace records are stored in a ring buffer per thread, without locking
+ *  and without I/O. The rings are written to the log file on demand
+ *  (Debug::dump, SIGUSR1), at exit and on a crash.
+ *
+ *  Tracing is enabled at runtime using the WORKRAVE_TRACE environment
+ *  variable: a comma separated list of subsystems (class names, e.g.
+ *  "Core,ActivityMonitor") or "all". Without it, nothing is traced. The
+ *  state is cached per trace site once Debug::init has run, so disabled
+ *  sites cost a single load and compare, and do not format their
+ *  message. Setting WORKRAVE_TRACE_LIVE writes every record directly to
+ *  the log instead.
+ */
 class Debug
 {
 public:
+  enum TraceKind
+    {
+      TRACE_KIND_ENTER,
+      TRACE_KIND_RETURN,
+      TRACE_KIND_EXIT,
+      TRACE_KIND_MSG,
+    };
+
   static void init();
+  static void dump();
   static std::string trace_get_time();
+
+  //! Returns whether the trace site is enabled. Resolved on first use after init.
+  static bool is_enabled(volatile int &site, const char *name)
+  {
+    if (site == SITE_UNRESOLVED)
+      {
+        site = resolve(name);
+      }
+    return site == SITE_ENABLED;
+  }
+
+  //! Stores a trace record in the ring of the current thread.
+  static void trace(const char *name, TraceKind kind, const std::string &msg = "");
+
+private:
+  enum SiteState
+    {
+      SITE_UNRESOLVED = 0,
+      SITE_ENABLED,
+      SITE_DISABLED,
+    };
+
+  static int resolve(const char *name);
 };
 
-#define TRACE_ENTER(x   ) g_log_mutex.lock(); \
-                          const char *_trace_method_name = x;   \
-                          std::cerr << Debug::trace_get_time() << ">>> " << x << std::endl; \
-                          g_log_mutex.unlock();
+#define TRACE_ENTER(x   ) const char *_trace_method_name = x;   \
+                          static volatile int _trace_site = 0; \
+                          if (Debug::is_enabled(_trace_site, _trace_method_name)) \
+                            Debug::trace(_trace_method_name, Debug::TRACE_KIND_ENTER);
 
-#define TRACE_ENTER_MSG(x, y) g_log_mutex.lock(); \
-                          const char *_trace_method_name = x; \
-                          std::cerr  << Debug::trace_get_time() << ">>> " << x << " " << y << std::endl; \
-                          g_log_mutex.unlock();
+#define TRACE_ENTER_MSG(x, y) const char *_trace_method_name = x; \
+                          static volatile int _trace_site = 0; \
+                          if (Debug::is_enabled(_trace_site, _trace_method_name)) \
+                            { std::ostringstream _trace_ss; _trace_ss << y; \
+                              Debug::trace(_trace_method_name, Debug::TRACE_KIND_ENTER, _trace_ss.str()); }
 
-#define TRACE_RETURN(y)   g_log_mutex.lock(); \
-                          std::cerr << Debug::trace_get_time() << "<<< " << _trace_method_name << y << std::endl; \
-                          g_log_mutex.unlock();
+#define TRACE_RETURN(y)   { if (Debug::is_enabled(_trace_site, _trace_method_name)) \
+                            { std::ostringstream _trace_ss; _trace_ss << y; \
+                              Debug::trace(_trace_method_name, Debug::TRACE_KIND_RETURN, _trace_ss.str()); } }
 
-#define TRACE_EXIT()      g_log_mutex.lock(); \
-                          std::cerr << Debug::trace_get_time() << "<<< " << _trace_method_name << std::endl; \
-                          g_log_mutex.unlock();
+#define TRACE_EXIT()      { if (Debug::is_enabled(_trace_site, _trace_method_name)) \
+                            Debug::trace(_trace_method_name, Debug::TRACE_KIND_EXIT); }
 
-#define TRACE_MSG(msg)    g_log_mutex.lock(); \
-                          std::cerr << Debug::trace_get_time() << "    " << _trace_method_name << " " << msg  << std::endl; \
-                          g_log_mutex.unlock();
+#define TRACE_MSG(msg)    { if (Debug::is_enabled(_trace_site, _trace_method_name)) \
+                            { std::ostringstream _trace_ss; _trace_ss << msg; \
+                              Debug::trace(_trace_method_name, Debug::TRACE_KIND_MSG, _trace_ss.str()); } }
 
-#define TRACE_MSG2(x,y)   g_log_mutex.lock(); \
-                          std::cerr << Debug::trace_get_time() << "    " << _trace_method_name << " " << x << " " << y << std::endl; \
-                          g_log_mutex.unlock();
+#define TRACE_MSG2(x,y)   { if (Debug::is_enabled(_trace_site, _trace_method_name)) \
+                            { std::ostringstream _trace_ss; _trace_ss << x << " " << y; \
+                              Debug::trace(_trace_method_name, Debug::TRACE_KIND_MSG, _trace_ss.str()); } }
 
 #endif // TRACING
 
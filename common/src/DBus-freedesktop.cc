@@ -40,6 +40,7 @@
 #include "DBus-freedesktop.hh"
 #include "DBusBinding-freedesktop.hh"
 #include "DBusException.hh"
+#include "Mutex.hh"
 
 using namespace std;
 using namespace workrave;
@@ -62,19 +63,22 @@ DBus::~DBus()
 
 
 //! Initialize D-BUS bridge
+/*!
+ *  \param system_bus connect to the system bus instead of the session bus.
+ */
 void
-DBus::init()
+DBus::init(bool system_bus)
 {
 	DBusError error;
 
 	dbus_error_init(&error);
 
-	connection = dbus_bus_get_private(DBUS_BUS_STARTER, &error);
+	connection = dbus_bus_get_private(system_bus ? DBUS_BUS_SYSTEM : DBUS_BUS_STARTER, &error);
   if (dbus_error_is_set(&error))
     {
       connection = NULL;
       dbus_error_free(&error);
-      throw DBusSystemException("Unable to obtain session bus");
+      throw DBusSystemException(system_bus ? "Unable to obtain system bus" : "Unable to obtain session bus");
     }
 
 	dbus_connection_set_exit_on_disconnect(connection, FALSE);
@@ -172,6 +176,14 @@ DBus::disconnect(const std::string &object_path, const std::string &interface_na
 }
 
 
+//! Serializes all method calls on an object path with the specified lock.
+void
+DBus::set_object_lock(const std::string &path, Mutex *lock)
+{
+  locks[path] = lock;
+}
+
+
 //! Register an interface binding
 void
 DBus::register_binding(const std::string &name, DBusBindingBase *interface)
@@ -226,6 +238,14 @@ DBus::find_object(const std::string &path, const std::string &interface_name) co
 }
 
 
+Mutex *
+DBus::find_object_lock(const std::string &path) const
+{
+  LockCIter it = locks.find(path);
+  return it != locks.end() ? it->second : NULL;
+}
+
+
 bool
 DBus::is_owner() const
 {
@@ -400,6 +420,7 @@ DBus::handle_method(DBusConnection *connection, DBusMessage *message)
       throw DBusSystemException(string("No such binding: ") + interface_name );
     }
 
+  ScopedLock lock(find_object_lock(path));
   DBusMessage *reply = binding->call(method, cobject, message);
   if (reply == NULL)
     {
@@ -32,6 +32,7 @@
 
 #include "DBusException.hh"
 #include "DBusBinding-gio.hh"
+#include "Mutex.hh"
 
 using namespace std;
 using namespace workrave;
@@ -46,7 +47,7 @@ const GDBusInterfaceVTable DBus::interface_vtable =
 
 //! Construct a new D-BUS bridge
 DBus::DBus()
-  : connection(NULL)
+  : bus_type(G_BUS_TYPE_SESSION), connection(NULL)
 {
 }
 
@@ -80,9 +81,13 @@ DBus::~DBus()
 
 
 //! Initialize D-BUS bridge
+/*!
+ *  \param system_bus connect to the system bus instead of the session bus.
+ */
 void
-DBus::init()
+DBus::init(bool system_bus)
 {
+  bus_type = system_bus ? G_BUS_TYPE_SYSTEM : G_BUS_TYPE_SESSION;
 }
 
 
@@ -92,7 +97,7 @@ DBus::register_service(const std::string &service_name, IDBusWatch *cb)
 {
   guint owner_id;
 
-  owner_id = g_bus_own_name(G_BUS_TYPE_SESSION,
+  owner_id = g_bus_own_name(bus_type,
                             service_name.c_str(),
                             G_BUS_NAME_OWNER_FLAGS_NONE,
                             &DBus::on_bus_acquired,
@@ -215,6 +220,14 @@ DBus::disconnect(const std::string &object_path, const std::string &interface_na
 }
 
 
+//! Serializes all method calls on an object path with the specified lock.
+void
+DBus::set_object_lock(const std::string &path, Mutex *lock)
+{
+  locks[path] = lock;
+}
+
+
 //! Register an interface binding
 void
 DBus::register_binding(const std::string &name, DBusBindingBase *interface)
@@ -259,6 +272,14 @@ DBus::find_object(const std::string &path, const std::string &interface_name) co
 }
 
 
+Mutex *
+DBus::find_object_lock(const std::string &path) const
+{
+  LockCIter it = locks.find(path);
+  return it != locks.end() ? it->second : NULL;
+}
+
+
 bool
 DBus::is_running(const std::string &name) const
 {
@@ -266,7 +287,7 @@ DBus::is_running(const std::string &name) const
 	GError *error = NULL;
 	gboolean running = FALSE;
 
-  GDBusProxy *proxy = g_dbus_proxy_new_for_bus_sync(G_BUS_TYPE_SESSION,
+  GDBusProxy *proxy = g_dbus_proxy_new_for_bus_sync(bus_type,
                                                     G_DBUS_PROXY_FLAGS_NONE,
                                                     NULL,
                                                     "org.freedesktop.DBus",
@@ -431,6 +452,7 @@ DBus::on_method_call(GDBusConnection       *connection,
           throw DBusSystemException(string("No such binding: ") + interface_name );
         }
 
+      ScopedLock lock(self->find_object_lock(object_path));
       binding->call(method_name, object, invocation, sender, parameters);
     }
   catch (DBusException &e)
@@ -31,14 +31,210 @@
 #include <windows.h> /* for GetFileAttributes */
 #endif
 
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <vector>
+
+#if defined(PLATFORM_OS_UNIX) && GLIB_CHECK_VERSION(2, 30, 0)
+#include <glib-unix.h>
+#define HAVE_TRACE_SIGNAL 1
+#endif
+
 #include "Mutex.hh"
 #include "debug.hh"
+#include "StringUtil.hh"
+
+#if defined(PLATFORM_OS_WIN32_NATIVE)
+#define TRACE_THREAD_LOCAL __declspec(thread)
+#else
+#define TRACE_THREAD_LOCAL __thread
+#endif
 
 using namespace std;
 
 Mutex g_log_mutex;
 std::ofstream g_log_stream;
 
+namespace
+{
+  //! Number of records per thread, a power of two.
+  const int TRACE_RING_SIZE = 1024;
+
+  //! Maximum length of the message of a record.
+  const int TRACE_MSG_SIZE = 96;
+
+  //! A single trace record.
+  struct TraceRecord
+  {
+    //! Monotonic time in µs.
+    gint64 time;
+
+    //! Static name of the trace site.
+    const char *name;
+
+    //! Debug::TraceKind
+    gint kind;
+
+    //! Formatted message, truncated.
+    char msg[TRACE_MSG_SIZE];
+  };
+
+  //! The trace records of a single thread.
+  struct TraceRing
+  {
+    TraceRing *next;
+    gpointer thread;
+
+    //! Number of records written, wraps around.
+    volatile guint head;
+
+    //! Number of records written to the log by Debug::dump.
+    guint dumped;
+
+    TraceRecord records[TRACE_RING_SIZE];
+  };
+
+  //! Returns the record at the specified position of a ring.
+  inline TraceRecord &
+  ring_record(TraceRing *ring, guint position)
+  {
+    return ring->records[position & (TRACE_RING_SIZE - 1)];
+  }
+
+  //! List of all rings.
+  TraceRing *volatile rings = NULL;
+
+  //! Ring of the current thread.
+  TRACE_THREAD_LOCAL TraceRing *thread_ring = NULL;
+
+  //! Enabled subsystems.
+  vector<string> subsystems;
+
+  //! Whether Debug::init has run.
+  bool initialized = false;
+
+  //! Write each record directly to the log.
+  bool live = true;
+
+  //! Difference between the real time and the monotonic time.
+  gint64 time_offset = 0;
+
+  //! Returns the ring of the current thread.
+  TraceRing *
+  get_ring()
+  {
+    if (thread_ring == NULL)
+      {
+        TraceRing *ring = new TraceRing;
+        ring->thread = g_thread_self();
+        ring->head = 0;
+        ring->dumped = 0;
+
+        do
+          {
+            ring->next = rings;
+          }
+        while (!g_atomic_pointer_compare_and_exchange((gpointer *) &rings, ring->next, ring));
+
+        thread_ring = ring;
+      }
+    return thread_ring;
+  }
+
+  const char *
+  kind_prefix(gint kind)
+  {
+    switch (kind)
+      {
+      case Debug::TRACE_KIND_ENTER:
+        return ">>> ";
+      case Debug::TRACE_KIND_RETURN:
+      case Debug::TRACE_KIND_EXIT:
+        return "<<< ";
+      default:
+        return "    ";
+      }
+  }
+
+  //! Formats a record as a line of text.
+  int
+  format_record(char *buffer, size_t size, const TraceRecord &record, gpointer thread)
+  {
+    gint64 t = record.time + time_offset;
+    time_t secs = (time_t) (t / G_USEC_PER_SEC);
+    struct tm *tmlt = localtime(&secs);
+
+    char logtime[64] = "";
+    if (tmlt != NULL)
+      {
+        strftime(logtime, sizeof(logtime), "%d%b%Y %H:%M:%S", tmlt);
+      }
+
+    return snprintf(buffer, size, "%s.%06d [%p] %s%s %s\n",
+                    logtime, (int) (t % G_USEC_PER_SEC), thread,
+                    kind_prefix(record.kind), record.name, record.msg);
+  }
+
+  //! Writes the rings of all threads to the log.
+  /*!
+   *  \param all write all records in the rings, instead of only the
+   *              records that were not dumped before.
+   */
+  void
+  dump_rings(std::ostream &out, bool all)
+  {
+    char line[TRACE_MSG_SIZE + 256];
+
+    for (TraceRing *ring = (TraceRing *) g_atomic_pointer_get(&rings); ring != NULL; ring = ring->next)
+      {
+        guint head = (guint) g_atomic_int_get((volatile gint *) &ring->head);
+        guint count = all ? head : head - ring->dumped;
+        if (count > (guint) TRACE_RING_SIZE)
+          {
+            count = TRACE_RING_SIZE;
+          }
+
+        for (guint i = head - count; i != head; i++)
+          {
+            format_record(line, sizeof(line), ring_record(ring, i), ring->thread);
+            out << line;
+          }
+
+        ring->dumped = head;
+      }
+    out.flush();
+  }
+
+#ifdef HAVE_TRACE_SIGNAL
+  gboolean
+  on_dump_signal(gpointer data)
+  {
+    (void) data;
+    Debug::dump();
+    return TRUE;
+  }
+#endif
+
+  void
+  on_crash(int sig)
+  {
+    signal(sig, SIG_DFL);
+
+    g_log_stream << "*** Crash (signal " << sig << "), trace follows\n";
+    dump_rings(g_log_stream, true);
+
+    raise(sig);
+  }
+
+  void
+  dump_at_exit()
+  {
+    Debug::dump();
+  }
+}
+
+
 std::string
 Debug::trace_get_time()
 {
@@ -51,6 +247,73 @@ Debug::trace_get_time()
   return logtime;
 }
 
+
+//! Returns the state of a trace site.
+/*!
+ *  Sites used before Debug::init remain unresolved, and are resolved again
+ *  on their next use.
+ */
+int
+Debug::resolve(const char *name)
+{
+  if (!initialized)
+    {
+      return SITE_UNRESOLVED;
+    }
+
+  string method = name;
+  for (vector<string>::const_iterator i = subsystems.begin(); i != subsystems.end(); i++)
+    {
+      if (*i == "all" || method.compare(0, i->size(), *i) == 0)
+        {
+          return SITE_ENABLED;
+        }
+    }
+  return SITE_DISABLED;
+}
+
+
+void
+Debug::trace(const char *name, TraceKind kind, const std::string &msg)
+{
+  TraceRing *ring = get_ring();
+  guint head = ring->head;
+  TraceRecord &record = ring_record(ring, head);
+
+  record.time = g_get_monotonic_time();
+  record.name = name;
+  record.kind = kind;
+  strncpy(record.msg, msg.c_str(), TRACE_MSG_SIZE - 1);
+  record.msg[TRACE_MSG_SIZE - 1] = '\0';
+
+  // Publish the record.
+  g_atomic_int_set((volatile gint *) &ring->head, (gint) (head + 1));
+
+  if (live)
+    {
+      char line[TRACE_MSG_SIZE + 256];
+      format_record(line, sizeof(line), record, ring->thread);
+
+      g_log_mutex.lock();
+      std::cerr << line;
+      g_log_mutex.unlock();
+    }
+}
+
+
+//! Writes all trace rings to the log.
+void
+Debug::dump()
+{
+  if (!live)
+    {
+      g_log_mutex.lock();
+      dump_rings(std::cerr, false);
+      g_log_mutex.unlock();
+    }
+}
+
+
 void
 Debug::init()
 {
@@ -92,6 +355,29 @@ Debug::init()
     {
       std::cerr.rdbuf(g_log_stream.rdbuf());
     }
+
+  time_offset = g_get_real_time() - g_get_monotonic_time();
+
+  const char *trace = getenv("WORKRAVE_TRACE");
+  if (trace != NULL)
+    {
+      StringUtil::split(trace, ',', subsystems);
+    }
+
+  live = getenv("WORKRAVE_TRACE_LIVE") != NULL;
+  initialized = true;
+  if (!live)
+    {
+      atexit(dump_at_exit);
+      signal(SIGSEGV, on_crash);
+      signal(SIGABRT, on_crash);
+#ifdef SIGBUS
+      signal(SIGBUS, on_crash);
+#endif
+#ifdef HAVE_TRACE_SIGNAL
+      g_unix_signal_add(SIGUSR1, on_dump_signal, NULL);
+#endif
+    }
 }
 
 #endif
@@ -71,6 +71,7 @@ GType workrave_timebar_get_type(void);
 
 void workrave_timebar_do_action(WorkraveTimebar *self, int param);
 void workrave_timebar_draw(WorkraveTimebar *self, cairo_t *cr);
+gboolean workrave_timebar_is_dirty(WorkraveTimebar *self);
 
 void workrave_timebar_set_progress(WorkraveTimebar *self, int value, int max_value, WorkraveColorId color);
 void workrave_timebar_set_secondary_progress(WorkraveTimebar *self, int value, int max_value, WorkraveColorId color);
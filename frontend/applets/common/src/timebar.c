@@ -26,6 +26,7 @@
 
 static void workrave_timebar_class_init(WorkraveTimebarClass *klass);
 static void workrave_timebar_init(WorkraveTimebar *self);
+static void workrave_timebar_finalize(GObject *gobject);
 
 static void workrave_timebar_init_ui(WorkraveTimebar *self);
 static void workrave_timebar_draw_filled_box(WorkraveTimebar *self, cairo_t *cr, int x, int y, int width, int height);
@@ -78,6 +79,23 @@ struct _WorkraveTimebarPrivate
   //! Text to show;
   gchar *bar_text;
 
+  //! Whether the text differs from the text in the layout.
+  gboolean text_changed;
+
+  //! Size of the laid out text.
+  int text_width;
+  int text_height;
+
+  //! Whether the bar changed since it was last rendered.
+  gboolean dirty;
+
+  //! Last rendering of the bar.
+  cairo_surface_t *surface;
+
+  //! Size of the surface.
+  int surface_width;
+  int surface_height;
+
   int width;
   int height;
 
@@ -106,6 +124,10 @@ static void set_color(cairo_t *cr, GdkRGBA color)
 static void
 workrave_timebar_class_init(WorkraveTimebarClass *klass)
 {
+  GObjectClass *gobject_class = G_OBJECT_CLASS(klass);
+
+  gobject_class->finalize = workrave_timebar_finalize;
+
   g_type_class_add_private(klass, sizeof(WorkraveTimebarPrivate));
 
   gdk_rgba_parse(&bar_colors[COLOR_ID_ACTIVE], "lightblue");
@@ -133,11 +155,32 @@ workrave_timebar_init(WorkraveTimebar *self)
   self->priv->secondary_bar_value = 100;
   self->priv->secondary_bar_max_value = 600;
   self->priv->bar_text = g_strdup("");
+  self->priv->text_changed = TRUE;
+  self->priv->dirty = TRUE;
+  self->priv->surface = NULL;
+  self->priv->surface_width = 0;
+  self->priv->surface_height = 0;
 
   workrave_timebar_init_ui(self);
 }
 
 
+static void
+workrave_timebar_finalize(GObject *gobject)
+{
+  WorkraveTimebar *self = WORKRAVE_TIMEBAR(gobject);
+
+  if (self->priv->surface != NULL)
+    {
+      cairo_surface_destroy(self->priv->surface);
+    }
+  g_free(self->priv->bar_text);
+
+  /* Chain up to the parent class */
+  G_OBJECT_CLASS(workrave_timebar_parent_class)->finalize(gobject);
+}
+
+
 void
 workrave_timebar_draw_bar(WorkraveTimebar *self, cairo_t *cr)
 {
@@ -236,18 +279,20 @@ workrave_timebar_draw_text(WorkraveTimebar *self, cairo_t *cr)
   WorkraveTimebarPrivate *priv = WORKRAVE_TIMEBAR_GET_PRIVATE(self);
 
   // g_debug("bar_text %s", priv->bar_text);
-  pango_layout_set_text(priv->pango_layout, priv->bar_text, -1);
-
-  int text_width, text_height;
-  pango_layout_get_pixel_size(priv->pango_layout, &text_width, &text_height);
+  if (priv->text_changed)
+    {
+      pango_layout_set_text(priv->pango_layout, priv->bar_text, -1);
+      pango_layout_get_pixel_size(priv->pango_layout, &priv->text_width, &priv->text_height);
+      priv->text_changed = FALSE;
+    }
 
   int text_x, text_y;
-  text_x = priv->width - text_width - MARGINX;
+  text_x = priv->width - priv->text_width - MARGINX;
   if (text_x < 0)
     {
       text_x = MARGINX;
     }
-  text_y = (priv->height - text_height) / 2;
+  text_y = (priv->height - priv->text_height) / 2;
 
   cairo_move_to(cr, text_x, text_y);
   set_color(cr, priv->bar_text_color);
@@ -396,9 +441,14 @@ workrave_timebar_set_progress(WorkraveTimebar *self, int value, int max_value, W
 {
   WorkraveTimebarPrivate *priv = WORKRAVE_TIMEBAR_GET_PRIVATE(self);
 
-  priv->bar_value = value <= max_value ? value : max_value;
-  priv->bar_max_value = max_value;
-  priv->bar_color = color;
+  value = value <= max_value ? value : max_value;
+  if (priv->bar_value != value || priv->bar_max_value != max_value || priv->bar_color != color)
+    {
+      priv->bar_value = value;
+      priv->bar_max_value = max_value;
+      priv->bar_color = color;
+      priv->dirty = TRUE;
+    }
 }
 
 void
@@ -406,24 +456,81 @@ workrave_timebar_set_secondary_progress(WorkraveTimebar *self, int value, int ma
 {
   WorkraveTimebarPrivate *priv = WORKRAVE_TIMEBAR_GET_PRIVATE(self);
 
-  priv->secondary_bar_value = value <= max_value ? value : max_value;
-  priv->secondary_bar_max_value = max_value;
-  priv->secondary_bar_color = color;
+  value = value <= max_value ? value : max_value;
+  if (priv->secondary_bar_value != value || priv->secondary_bar_max_value != max_value ||
+      priv->secondary_bar_color != color)
+    {
+      priv->secondary_bar_value = value;
+      priv->secondary_bar_max_value = max_value;
+      priv->secondary_bar_color = color;
+      priv->dirty = TRUE;
+    }
 }
 
 void
 workrave_timebar_set_text(WorkraveTimebar *self, const gchar *text)
 {
   WorkraveTimebarPrivate *priv = WORKRAVE_TIMEBAR_GET_PRIVATE(self);
-  g_free(priv->bar_text);
-  priv->bar_text = g_strdup(text);
+  if (g_strcmp0(priv->bar_text, text) != 0)
+    {
+      g_free(priv->bar_text);
+      priv->bar_text = g_strdup(text);
+      priv->text_changed = TRUE;
+      priv->dirty = TRUE;
+    }
 }
 
+/*
+ * The bar is rendered into a surface of its own, which is only updated
+ * when the progress, colors or text change. Drawing an unchanged bar is
+ * a single blit.
+ */
 void
 workrave_timebar_draw(WorkraveTimebar *self, cairo_t *cr)
 {
-  workrave_timebar_draw_bar(self, cr);
-  workrave_timebar_draw_text(self, cr);
+  WorkraveTimebarPrivate *priv = WORKRAVE_TIMEBAR_GET_PRIVATE(self);
+
+  if (priv->surface != NULL &&
+      (priv->surface_width != priv->width || priv->surface_height != priv->height))
+    {
+      cairo_surface_destroy(priv->surface);
+      priv->surface = NULL;
+    }
+
+  if (priv->surface == NULL)
+    {
+      priv->surface = cairo_surface_create_similar(cairo_get_target(cr), CAIRO_CONTENT_COLOR_ALPHA,
+                                                   priv->width, priv->height);
+      priv->surface_width = priv->width;
+      priv->surface_height = priv->height;
+      priv->dirty = TRUE;
+    }
+
+  if (priv->dirty)
+    {
+      cairo_t *surface_cr = cairo_create(priv->surface);
+      workrave_timebar_draw_bar(self, surface_cr);
+      workrave_timebar_draw_text(self, surface_cr);
+      cairo_destroy(surface_cr);
+      priv->dirty = FALSE;
+    }
+
+  cairo_save(cr);
+  cairo_set_operator(cr, CAIRO_OPERATOR_SOURCE);
+  cairo_set_source_surface(cr, priv->surface, 0, 0);
+  cairo_rectangle(cr, 0, 0, priv->width, priv->height);
+  cairo_fill(cr);
+  cairo_restore(cr);
+}
+
+/*
+ * Returns whether the bar changed since it was last drawn.
+ */
+gboolean
+workrave_timebar_is_dirty(WorkraveTimebar *self)
+{
+  WorkraveTimebarPrivate *priv = WORKRAVE_TIMEBAR_GET_PRIVATE(self);
+  return priv->dirty;
 }
 
 void
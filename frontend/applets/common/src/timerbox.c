@@ -37,7 +37,9 @@ static void workrave_timerbox_set_property(GObject *gobject, guint property_id,
 static void workrave_timerbox_get_property (GObject *gobject, guint property_id, GValue *value, GParamSpec *pspec);
 
 static void workrave_timerbox_update_sheep(WorkraveTimerbox *self, cairo_t *cr);
-static void workrave_timerbox_update_time_bars(WorkraveTimerbox *self, cairo_t *cr);
+static void workrave_timerbox_update_time_bars(WorkraveTimerbox *self, cairo_t *cr, gboolean only_dirty);
+static gboolean workrave_timerbox_time_bars_dirty(WorkraveTimerbox *self);
+static cairo_surface_t *workrave_timerbox_create_sprite(GdkPixbuf *pixbuf);
 static void workrave_timerbox_compute_dimensions(WorkraveTimerbox *self, int *width, int *height);
 
 G_DEFINE_TYPE(WorkraveTimerbox, workrave_timerbox, G_TYPE_OBJECT);
@@ -58,8 +60,12 @@ struct _WorkraveTimerboxPrivate
   GdkPixbuf *normal_sheep_icon;
   GdkPixbuf *quiet_sheep_icon;
   GdkPixbuf *suspended_sheep_icon;
+  cairo_surface_t *normal_sheep_sprite;
+  cairo_surface_t *quiet_sheep_sprite;
+  cairo_surface_t *suspended_sheep_sprite;
   WorkraveTimebar *slot_to_time_bar[BREAK_ID_SIZEOF];
   GdkPixbuf *break_to_icon[BREAK_ID_SIZEOF];
+  cairo_surface_t *break_to_sprite[BREAK_ID_SIZEOF];
   WorkraveBreakId slot_to_break[BREAK_ID_SIZEOF];
   short break_to_slot[BREAK_ID_SIZEOF];
   gboolean break_visible[BREAK_ID_SIZEOF];
@@ -69,6 +75,13 @@ struct _WorkraveTimerboxPrivate
   int height;
   gboolean force_icon;
   gchar *mode;
+
+  /* Persistent rendering of the timerbox, used by workrave_timerbox_update. */
+  cairo_surface_t *surface;
+  /* Whether the layout changed since the surface was last drawn. */
+  gboolean layout_dirty;
+  /* Image that shows the surface, a weak pointer. */
+  GtkImage *image;
 };
 
 
@@ -106,6 +119,9 @@ workrave_timerbox_init(WorkraveTimerbox *self)
   self->priv->normal_sheep_icon = gdk_pixbuf_new_from_file(WORKRAVE_PKGDATADIR "/images/workrave-icon-medium.png", NULL);
   self->priv->quiet_sheep_icon = gdk_pixbuf_new_from_file(WORKRAVE_PKGDATADIR "/images/workrave-quiet-icon-medium.png", NULL);
   self->priv->suspended_sheep_icon = gdk_pixbuf_new_from_file(WORKRAVE_PKGDATADIR "/images/workrave-suspended-icon-medium.png", NULL);
+  self->priv->normal_sheep_sprite = workrave_timerbox_create_sprite(self->priv->normal_sheep_icon);
+  self->priv->quiet_sheep_sprite = workrave_timerbox_create_sprite(self->priv->quiet_sheep_icon);
+  self->priv->suspended_sheep_sprite = workrave_timerbox_create_sprite(self->priv->suspended_sheep_icon);
 
   for (int i = 0; i < BREAK_ID_SIZEOF; i++)
     {
@@ -114,6 +130,7 @@ workrave_timerbox_init(WorkraveTimerbox *self)
       GString *filename = g_string_new("");
       g_string_printf(filename, "%s/images/%s", WORKRAVE_PKGDATADIR, icons[i]);
       self->priv->break_to_icon[i] = gdk_pixbuf_new_from_file(filename->str, NULL);
+      self->priv->break_to_sprite[i] = workrave_timerbox_create_sprite(self->priv->break_to_icon[i]);
       g_string_free(filename, TRUE);
 
       self->priv->break_visible[i] = FALSE;
@@ -124,6 +141,9 @@ workrave_timerbox_init(WorkraveTimerbox *self)
   self->priv->enabled = FALSE;
   self->priv->force_icon = FALSE;
   self->priv->mode = g_strdup("normal");
+  self->priv->surface = NULL;
+  self->priv->layout_dirty = TRUE;
+  self->priv->image = NULL;
 }
 
 
@@ -135,13 +155,29 @@ workrave_timerbox_dispose(GObject *gobject)
   g_object_unref(self->priv->normal_sheep_icon);
   g_object_unref(self->priv->quiet_sheep_icon);
   g_object_unref(self->priv->suspended_sheep_icon);
+  cairo_surface_destroy(self->priv->normal_sheep_sprite);
+  cairo_surface_destroy(self->priv->quiet_sheep_sprite);
+  cairo_surface_destroy(self->priv->suspended_sheep_sprite);
 
   for (int i = 0; i < BREAK_ID_SIZEOF; i++)
     {
       g_object_unref(self->priv->break_to_icon[i]);
+      cairo_surface_destroy(self->priv->break_to_sprite[i]);
       g_object_unref(self->priv->slot_to_time_bar[i]);
     }
 
+  if (self->priv->surface != NULL)
+    {
+      cairo_surface_destroy(self->priv->surface);
+      self->priv->surface = NULL;
+    }
+
+  if (self->priv->image != NULL)
+    {
+      g_object_remove_weak_pointer(G_OBJECT(self->priv->image), (gpointer *) &self->priv->image);
+      self->priv->image = NULL;
+    }
+
   /* Chain up to the parent class */
   G_OBJECT_CLASS(workrave_timerbox_parent_class)->dispose(gobject);
 }
@@ -201,15 +237,15 @@ workrave_timerbox_update_sheep(WorkraveTimerbox *self, cairo_t *cr)
     {
       if (!priv->enabled || g_strcmp0("normal", priv->mode) == 0)
         {
-          gdk_cairo_set_source_pixbuf(cr, priv->normal_sheep_icon, 0, 0);
+          cairo_set_source_surface(cr, priv->normal_sheep_sprite, 0, 0);
         }
       else if (g_strcmp0("suspended", priv->mode) == 0)
         {
-          gdk_cairo_set_source_pixbuf(cr, priv->suspended_sheep_icon, 0, 0);
+          cairo_set_source_surface(cr, priv->suspended_sheep_sprite, 0, 0);
         }
       else if (g_strcmp0("quiet", priv->mode) == 0)
         {
-          gdk_cairo_set_source_pixbuf(cr, priv->quiet_sheep_icon, 0, 0);
+          cairo_set_source_surface(cr, priv->quiet_sheep_sprite, 0, 0);
         }
       cairo_paint(cr);
     }
@@ -217,7 +253,7 @@ workrave_timerbox_update_sheep(WorkraveTimerbox *self, cairo_t *cr)
 
 
 void
-workrave_timerbox_update_time_bars(WorkraveTimerbox *self, cairo_t *cr)
+workrave_timerbox_update_time_bars(WorkraveTimerbox *self, cairo_t *cr, gboolean only_dirty)
 {
   WorkraveTimerboxPrivate *priv = self->priv;
 
@@ -257,6 +293,12 @@ workrave_timerbox_update_time_bars(WorkraveTimerbox *self, cairo_t *cr)
             {
               WorkraveTimebar *bar = priv->slot_to_time_bar[bid];
 
+              if (only_dirty && !workrave_timebar_is_dirty(bar))
+                {
+                  x += icon_bar_width + 2 * PADDING_X;
+                  continue;
+                }
+
               cairo_surface_t *surface =  cairo_get_target(cr);
               cairo_surface_t *bar_surface = cairo_surface_create_for_rectangle(surface, x+icon_width+PADDING_X, y + bar_dy,
                                                                                 bar_width, bar_height);
@@ -265,9 +307,11 @@ workrave_timerbox_update_time_bars(WorkraveTimerbox *self, cairo_t *cr)
               cairo_surface_destroy(bar_surface);
               cairo_destroy(bar_cr);
 
-              gdk_cairo_set_source_pixbuf(cr, priv->break_to_icon[bid], x, y + icon_dy);
-              cairo_fill(cr);
-              cairo_paint(cr);
+              if (!only_dirty)
+                {
+                  cairo_set_source_surface(cr, priv->break_to_sprite[bid], x, y + icon_dy);
+                  cairo_paint(cr);
+                }
 
               x += icon_bar_width + 2 * PADDING_X;
             }
@@ -276,6 +320,44 @@ workrave_timerbox_update_time_bars(WorkraveTimerbox *self, cairo_t *cr)
 }
 
 
+static gboolean
+workrave_timerbox_time_bars_dirty(WorkraveTimerbox *self)
+{
+  WorkraveTimerboxPrivate *priv = self->priv;
+
+  for (int i = 0; i < BREAK_ID_SIZEOF; i++)
+    {
+      WorkraveBreakId bid = priv->slot_to_break[i];
+      if (bid != BREAK_ID_NONE && workrave_timebar_is_dirty(priv->slot_to_time_bar[bid]))
+        {
+          return TRUE;
+        }
+    }
+  return FALSE;
+}
+
+
+/*
+ * Converts an icon into a cairo surface once, instead of on each paint.
+ */
+static cairo_surface_t *
+workrave_timerbox_create_sprite(GdkPixbuf *pixbuf)
+{
+  int width = pixbuf != NULL ? gdk_pixbuf_get_width(pixbuf) : 0;
+  int height = pixbuf != NULL ? gdk_pixbuf_get_height(pixbuf) : 0;
+
+  cairo_surface_t *sprite = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width, height);
+  if (pixbuf != NULL)
+    {
+      cairo_t *cr = cairo_create(sprite);
+      gdk_cairo_set_source_pixbuf(cr, pixbuf, 0, 0);
+      cairo_paint(cr);
+      cairo_destroy(cr);
+    }
+  return sprite;
+}
+
+
 static
 void workrave_timerbox_compute_dimensions(WorkraveTimerbox *self, int *width, int *height)
 {
@@ -341,6 +423,7 @@ workrave_timerbox_set_slot(WorkraveTimerbox *self, int slot, WorkraveBreakId brk
           priv->break_visible[brk] = TRUE;
           priv->break_to_slot[brk] = slot;
         }
+      priv->layout_dirty = TRUE;
     }
 }
 
@@ -354,22 +437,62 @@ workrave_timerbox_set_slot(WorkraveTimerbox *self, int slot, WorkraveBreakId brk
 void
 workrave_timerbox_update(WorkraveTimerbox *self, GtkImage *image)
 {
+  WorkraveTimerboxPrivate *priv = self->priv;
   int width = 24;
   int height = 24;
 
   workrave_timerbox_compute_dimensions(self, &width, &height);
 
-  cairo_surface_t *surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width, height);
-  cairo_t *cr = cairo_create(surface);
+  if (priv->surface != NULL &&
+      (cairo_image_surface_get_width(priv->surface) != width ||
+       cairo_image_surface_get_height(priv->surface) != height))
+    {
+      cairo_surface_destroy(priv->surface);
+      priv->surface = NULL;
+    }
 
-  workrave_timerbox_draw(self, cr);
+  if (priv->surface == NULL)
+    {
+      priv->surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width, height);
+      priv->layout_dirty = TRUE;
+    }
 
-  GdkPixbuf *pixbuf = gdk_pixbuf_get_from_surface(surface, 0, 0, width, height);
+  if (priv->layout_dirty)
+    {
+      cairo_t *cr = cairo_create(priv->surface);
+      workrave_timerbox_draw(self, cr);
+      cairo_destroy(cr);
+      priv->layout_dirty = FALSE;
+    }
+  else if (workrave_timerbox_time_bars_dirty(self))
+    {
+      cairo_t *cr = cairo_create(priv->surface);
+      workrave_timerbox_update_time_bars(self, cr, TRUE);
+      cairo_destroy(cr);
+    }
+  else if (image == priv->image)
+    {
+      /* Nothing changed, the image is up to date. */
+      return;
+    }
+
+  cairo_surface_flush(priv->surface);
+
+  if (image != priv->image)
+    {
+      /* A new image, e.g. after the applet recreated its widgets. */
+      if (priv->image != NULL)
+        {
+          g_object_remove_weak_pointer(G_OBJECT(priv->image), (gpointer *) &priv->image);
+        }
+      priv->image = image;
+      g_object_add_weak_pointer(G_OBJECT(image), (gpointer *) &priv->image);
+    }
+
+  GdkPixbuf *pixbuf = gdk_pixbuf_get_from_surface(priv->surface, 0, 0, width, height);
   gtk_image_set_from_pixbuf(image, pixbuf);
 
   g_object_unref(pixbuf);
-  cairo_surface_destroy(surface);
-  cairo_destroy(cr);
 }
 
 /**
@@ -387,7 +510,7 @@ workrave_timerbox_draw(WorkraveTimerbox *self, cairo_t *cr)
   cairo_paint(cr);
   cairo_restore(cr);
 
-  workrave_timerbox_update_time_bars(self, cr);
+  workrave_timerbox_update_time_bars(self, cr, FALSE);
   workrave_timerbox_update_sheep(self, cr);
 }
 
@@ -451,7 +574,11 @@ void
 workrave_timerbox_set_enabled(WorkraveTimerbox *self, gboolean enabled)
 {
     WorkraveTimerboxPrivate *priv = self->priv;
-    priv->enabled = enabled;
+    if (priv->enabled != enabled)
+      {
+        priv->enabled = enabled;
+        priv->layout_dirty = TRUE;
+      }
 }
 
 
@@ -465,7 +592,11 @@ void
 workrave_timerbox_set_force_icon(WorkraveTimerbox *self, gboolean force)
 {
   WorkraveTimerboxPrivate *priv = self->priv;
-  priv->force_icon = force;
+  if (priv->force_icon != force)
+    {
+      priv->force_icon = force;
+      priv->layout_dirty = TRUE;
+    }
 }
 
 /**
@@ -478,6 +609,10 @@ void
 workrave_timerbox_set_operation_mode(WorkraveTimerbox *self, gchar *mode)
 {
   WorkraveTimerboxPrivate *priv = self->priv;
-  g_free(priv->mode);
-  priv->mode = g_strdup(mode);
+  if (g_strcmp0(priv->mode, mode) != 0)
+    {
+      g_free(priv->mode);
+      priv->mode = g_strdup(mode);
+      priv->layout_dirty = TRUE;
+    }
 }
@@ -0,0 +1,77 @@
+// StartupTimeline.hh --- Timings of the startup phases
+//
+// Copyright (C) 2017 Rob Caelers & Raymond Penners
+// All rights reserved.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef STARTUPTIMELINE_HH
+#define STARTUPTIMELINE_HH
+
+#include <string>
+#include <vector>
+
+#include <glib.h>
+
+//! Timings of the startup phases.
+/*!
+ *  The GUI marks the end of each initialization phase. Once startup is
+ *  complete, the duration of all phases is written to startup.log in the
+ *  Workrave home directory.
+ */
+class StartupTimeline
+{
+public:
+  static StartupTimeline *get_instance();
+
+  //! Starts the timeline.
+  void start();
+
+  //! Marks the end of the specified phase.
+  void mark(const std::string &phase);
+
+  //! Marks the end of startup and writes the log.
+  void finish();
+
+  //! Returns whether startup is complete.
+  bool is_finished() const;
+
+private:
+  StartupTimeline();
+
+  struct Phase
+  {
+    std::string name;
+    gint64 duration;
+  };
+
+private:
+  //! The one and only instance
+  static StartupTimeline *instance;
+
+  //! Completed phases.
+  std::vector<Phase> phases;
+
+  //! Monotonic time at which startup started.
+  gint64 start_time;
+
+  //! Monotonic time at which the previous phase ended.
+  gint64 last_time;
+
+  //! Is startup complete?
+  bool finished;
+};
+
+#endif // STARTUPTIMELINE_HH
@@ -120,6 +120,12 @@ private:
 
   //! Never show any timers.
   bool force_empty;
+
+  //! Version of each timer in the view model that was last shown.
+  int timer_version[BREAK_ID_SIZEOF];
+
+  //! Does the view need an update?
+  bool view_dirty;
 };
 
 #endif // TIMERBOXCONTROL_HH
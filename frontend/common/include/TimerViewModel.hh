@@ -0,0 +1,171 @@
+// TimerViewModel.hh --- Shared display state of the break timers
+//
+// Copyright (C) 2017 Rob Caelers & Raymond Penners
+// All rights reserved.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef TIMERVIEWMODEL_HH
+#define TIMERVIEWMODEL_HH
+
+#include <string>
+#include <list>
+
+#include "ICore.hh"
+#include "ITimeBar.hh"
+
+using namespace workrave;
+
+class ITimerViewModelListener;
+
+//! Display state of all break timers, computed once per heartbeat.
+/*!
+ *  All timer displays (timerboxes, applets, tooltips) show the same
+ *  data. The model collects it from the core once per heartbeat and
+ *  keeps track of what changed, so that text is only formatted, and
+ *  views are only updated, for timers that changed.
+ *
+ *  Consumers either remember the version of each timer they last showed
+ *  (views that are not updated every heartbeat), or subscribe as a
+ *  listener and are notified after each update that changed something.
+ */
+class TimerViewModel
+{
+public:
+  //! What changed during an update.
+  enum Change
+    {
+      CHANGE_NONE = 0,
+      CHANGE_TIMERS = 1,
+      CHANGE_OPERATION_MODE = 2,
+      CHANGE_TOOLTIP = 4
+    };
+
+  //! Display state of a single timer.
+  struct Timer
+  {
+    Timer()
+      : enabled(false),
+        primary_color(ITimeBar::COLOR_ID_ACTIVE), primary_value(0), primary_max(0),
+        secondary_color(ITimeBar::COLOR_ID_INACTIVE), secondary_value(0), secondary_max(0),
+        text_time(0), version(0)
+    {
+    }
+
+    //! Is the break enabled?
+    bool enabled;
+
+    //! Formatted remaining (or elapsed) time.
+    std::string text;
+
+    //! Primary (active time) bar.
+    ITimeBar::ColorId primary_color;
+    int primary_value;
+    int primary_max;
+
+    //! Secondary (idle time) bar.
+    ITimeBar::ColorId secondary_color;
+    int secondary_value;
+    int secondary_max;
+
+    //! The time shown in text.
+    time_t text_time;
+
+    //! Incremented whenever any of the above changes.
+    int version;
+  };
+
+  static TimerViewModel *get_instance();
+
+  void update();
+
+  const Timer &get_timer(BreakId id) const;
+  OperationMode get_operation_mode() const;
+  const std::string &get_tooltip() const;
+  int get_tooltip_version() const;
+
+  void add_listener(ITimerViewModelListener *listener);
+  void remove_listener(ITimerViewModelListener *listener);
+
+private:
+  TimerViewModel();
+
+  bool update_timer(BreakId id, IBreak *b);
+  void update_tooltip();
+
+private:
+  //! The one and only instance.
+  static TimerViewModel *instance;
+
+  //! Display state per break.
+  Timer timers[BREAK_ID_SIZEOF];
+
+  //! Operation mode at the last update.
+  OperationMode operation_mode;
+
+  //! Tooltip text summarizing all timers.
+  std::string tooltip;
+
+  //! Incremented whenever the tooltip changes.
+  int tooltip_version;
+
+  //! Listeners that are notified of changes.
+  std::list<ITimerViewModelListener *> listeners;
+};
+
+
+//! Receives notifications of changes in the timer view model.
+class ITimerViewModelListener
+{
+public:
+  virtual ~ITimerViewModelListener() {}
+
+  //! The model changed, changes is a mask of TimerViewModel::Change.
+  virtual void timer_view_changed(int changes) = 0;
+};
+
+
+//! Returns the display state of the specified break.
+inline const TimerViewModel::Timer &
+TimerViewModel::get_timer(BreakId id) const
+{
+  return timers[id];
+}
+
+
+//! Returns the operation mode at the last update.
+inline OperationMode
+TimerViewModel::get_operation_mode() const
+{
+  return operation_mode;
+}
+
+
+//! Returns the tooltip summarizing all timers.
+inline const std::string &
+TimerViewModel::get_tooltip() const
+{
+  return tooltip;
+}
+
+
+//! Returns the version of the tooltip.
+inline int
+TimerViewModel::get_tooltip_version() const
+{
+  return tooltip_version;
+}
+
+#endif // TIMERVIEWMODEL_HH
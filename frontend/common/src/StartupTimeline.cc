@@ -0,0 +1,118 @@
+// StartupTimeline.cc --- Timings of the startup phases
+//
+// Copyright (C) 2017 Rob Caelers & Raymond Penners
+// All rights reserved.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "debug.hh"
+
+#include <fstream>
+#include <iomanip>
+
+#include "StartupTimeline.hh"
+#include "Util.hh"
+
+using namespace std;
+
+StartupTimeline *StartupTimeline::instance = NULL;
+
+
+//! Returns the one and only instance.
+StartupTimeline *
+StartupTimeline::get_instance()
+{
+  if (instance == NULL)
+    {
+      instance = new StartupTimeline();
+    }
+  return instance;
+}
+
+
+StartupTimeline::StartupTimeline()
+  : start_time(0),
+    last_time(0),
+    finished(false)
+{
+}
+
+
+void
+StartupTimeline::start()
+{
+  start_time = last_time = g_get_monotonic_time();
+}
+
+
+void
+StartupTimeline::mark(const string &phase)
+{
+  if (finished)
+    {
+      return;
+    }
+
+  gint64 now = g_get_monotonic_time();
+
+  Phase p;
+  p.name = phase;
+  p.duration = now - last_time;
+  phases.push_back(p);
+
+  last_time = now;
+
+  TRACE_ENTER_MSG("StartupTimeline::mark", phase);
+  TRACE_RETURN(p.duration << " us");
+}
+
+
+void
+StartupTimeline::finish()
+{
+  TRACE_ENTER("StartupTimeline::finish");
+  if (finished)
+    {
+      TRACE_EXIT();
+      return;
+    }
+  finished = true;
+
+  string filename = Util::get_home_directory() + "startup.log";
+  ofstream log(filename.c_str(), ios::out | ios::trunc);
+  if (log.good())
+    {
+      log << fixed << setprecision(1);
+      for (vector<Phase>::const_iterator i = phases.begin(); i != phases.end(); i++)
+        {
+          log << left << setw(16) << i->name << right << setw(10) << i->duration / 1000.0 << " ms" << endl;
+        }
+      log << left << setw(16) << "total" << right << setw(10) << (last_time - start_time) / 1000.0 << " ms" << endl;
+    }
+
+  TRACE_MSG("Startup took " << (last_time - start_time) << " us");
+  TRACE_EXIT();
+}
+
+
+bool
+StartupTimeline::is_finished() const
+{
+  return finished;
+}
@@ -31,6 +31,7 @@
 #include "debug.hh"
 
 #include "TimerBoxControl.hh"
+#include "TimerViewModel.hh"
 #include "ITimeBar.hh"
 #include "Util.hh"
 #include "Text.hh"
@@ -56,7 +57,8 @@ TimerBoxControl::TimerBoxControl(std::string n, ITimerBoxView &v) :
   cycle_time(10),
   name(n),
   force_duration(0),
-  force_empty(false)
+  force_empty(false),
+  view_dirty(true)
 {
   init();
 }
@@ -114,7 +116,12 @@ TimerBoxControl::update()
 
   // Update the timer widgets.
   update_widgets();
-  view->update_view();
+
+  if (view_dirty)
+    {
+      view->update_view();
+      view_dirty = false;
+    }
 }
 
 
@@ -156,6 +163,7 @@ TimerBoxControl::init()
           break_slots[i][j] = -1;
         }
       break_slot_cycle[i] = 0;
+      timer_version[i] = -1;
     }
 
   // Load the configuration
@@ -169,64 +177,26 @@ TimerBoxControl::init()
 
 
 
-//! Updates the main window.
+//! Updates the timer widgets of all timers that changed since the last update.
 void
 TimerBoxControl::update_widgets()
 {
+  TimerViewModel *model = TimerViewModel::get_instance();
+
   for (int count = 0; count < BREAK_ID_SIZEOF; count++)
     {
-      ICore *core = CoreFactory::get_core();
-      IBreak *b = core->get_break((BreakId)count);
+      const TimerViewModel::Timer &timer = model->get_timer(BreakId(count));
 
-      std::string text;
-      ITimeBar::ColorId primary_color;
-      int primary_val, primary_max;
-      ITimeBar::ColorId secondary_color;
-      int secondary_val, secondary_max;
-
-      if (b == NULL)
+      if (timer.version == timer_version[count])
         {
           continue;
         }
+      timer_version[count] = timer.version;
 
-      // Collect some data.
-      time_t maxActiveTime = b->get_limit();
-      time_t activeTime = b->get_elapsed_time();
-      time_t breakDuration = b->get_auto_reset();
-      time_t idleTime = b->get_elapsed_idle_time();
-      bool overdue = (maxActiveTime < activeTime);
-
-      // Set the text
-      if (b->is_limit_enabled() && maxActiveTime != 0)
-        {
-          text = Text::time_to_string(maxActiveTime - activeTime);
-        }
-      else
-        {
-          text = Text::time_to_string(activeTime);
-        }
-      // And set the bar.
-      secondary_val = secondary_max = 0;
-      secondary_color = ITimeBar::COLOR_ID_INACTIVE;
-
-      // Timer is running, show elapsed time.
-      primary_val = (int)activeTime;
-      primary_max = (int)maxActiveTime;
-
-      primary_color = overdue
-        ? ITimeBar::COLOR_ID_OVERDUE : ITimeBar::COLOR_ID_ACTIVE;
-
-      if (b->is_auto_reset_enabled() && breakDuration != 0)
-        {
-          // resting.
-          secondary_color = ITimeBar::COLOR_ID_INACTIVE;
-          secondary_val = (int)idleTime;
-          secondary_max = (int)breakDuration;
-        }
-
-      view->set_time_bar(BreakId(count), text,
-                         primary_color, primary_val, primary_max,
-                         secondary_color, secondary_val, secondary_max);
+      view->set_time_bar(BreakId(count), timer.text,
+                         timer.primary_color, timer.primary_value, timer.primary_max,
+                         timer.secondary_color, timer.secondary_value, timer.secondary_max);
+      view_dirty = true;
     }
 }
 
@@ -234,6 +204,8 @@ TimerBoxControl::update_widgets()
 void
 TimerBoxControl::init_icon()
 {
+  view_dirty = true;
+
   switch (operation_mode)
     {
     case OPERATION_MODE_NORMAL:
@@ -260,6 +232,8 @@ TimerBoxControl::init_table()
 {
   TRACE_ENTER("TimerBoxControl::init_table");
 
+  view_dirty = true;
+
   if (force_empty)
     {
       for (int i = 0; i < BREAK_ID_SIZEOF; i++)
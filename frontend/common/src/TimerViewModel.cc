@@ -0,0 +1,235 @@
+// TimerViewModel.cc --- Shared display state of the break timers
+//
+// Copyright (C) 2017 Rob Caelers & Raymond Penners
+// All rights reserved.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "nls.h"
+#include "debug.hh"
+
+#include "TimerViewModel.hh"
+#include "Text.hh"
+
+#include "CoreFactory.hh"
+#include "IBreak.hh"
+
+using namespace workrave;
+using namespace std;
+
+TimerViewModel *TimerViewModel::instance = NULL;
+
+
+//! Returns the one and only instance.
+TimerViewModel *
+TimerViewModel::get_instance()
+{
+  if (instance == NULL)
+    {
+      instance = new TimerViewModel();
+    }
+  return instance;
+}
+
+
+TimerViewModel::TimerViewModel()
+  : operation_mode(OPERATION_MODE_NORMAL),
+    tooltip_version(0)
+{
+}
+
+
+//! Collects the state of all timers from the core.
+/*!
+ *  Must be called once per heartbeat, after the core heartbeat.
+ */
+void
+TimerViewModel::update()
+{
+  ICore *core = CoreFactory::get_core();
+  int changes = CHANGE_NONE;
+
+  OperationMode mode = core->get_operation_mode();
+  if (mode != operation_mode)
+    {
+      operation_mode = mode;
+      changes |= CHANGE_OPERATION_MODE;
+    }
+
+  for (int i = 0; i < BREAK_ID_SIZEOF; i++)
+    {
+      IBreak *b = core->get_break(BreakId(i));
+      if (b != NULL && update_timer(BreakId(i), b))
+        {
+          changes |= CHANGE_TIMERS;
+        }
+    }
+
+  if (changes != CHANGE_NONE || tooltip_version == 0)
+    {
+      int old_version = tooltip_version;
+      update_tooltip();
+      if (tooltip_version != old_version)
+        {
+          changes |= CHANGE_TOOLTIP;
+        }
+    }
+
+  if (changes != CHANGE_NONE)
+    {
+      for (list<ITimerViewModelListener *>::iterator i = listeners.begin(); i != listeners.end(); i++)
+        {
+          (*i)->timer_view_changed(changes);
+        }
+    }
+}
+
+
+//! Updates the display state of a single timer. Returns whether it changed.
+bool
+TimerViewModel::update_timer(BreakId id, IBreak *b)
+{
+  Timer &timer = timers[id];
+
+  // Collect some data.
+  time_t maxActiveTime = b->get_limit();
+  time_t activeTime = b->get_elapsed_time();
+  time_t breakDuration = b->get_auto_reset();
+  time_t idleTime = b->get_elapsed_idle_time();
+  bool overdue = (maxActiveTime < activeTime);
+  bool enabled = b->is_enabled();
+
+  // The time to show.
+  time_t text_time = activeTime;
+  if (b->is_limit_enabled() && maxActiveTime != 0)
+    {
+      text_time = maxActiveTime - activeTime;
+    }
+
+  // Timer is running, show elapsed time.
+  int primary_value = (int)activeTime;
+  int primary_max = (int)maxActiveTime;
+  ITimeBar::ColorId primary_color = overdue ? ITimeBar::COLOR_ID_OVERDUE : ITimeBar::COLOR_ID_ACTIVE;
+
+  int secondary_value = 0;
+  int secondary_max = 0;
+  ITimeBar::ColorId secondary_color = ITimeBar::COLOR_ID_INACTIVE;
+
+  if (b->is_auto_reset_enabled() && breakDuration != 0)
+    {
+      // resting.
+      secondary_value = (int)idleTime;
+      secondary_max = (int)breakDuration;
+    }
+
+  bool text_changed = (timer.version == 0 || text_time != timer.text_time);
+
+  if (!text_changed &&
+      enabled == timer.enabled &&
+      primary_value == timer.primary_value &&
+      primary_max == timer.primary_max &&
+      primary_color == timer.primary_color &&
+      secondary_value == timer.secondary_value &&
+      secondary_max == timer.secondary_max &&
+      secondary_color == timer.secondary_color)
+    {
+      return false;
+    }
+
+  if (text_changed)
+    {
+      timer.text_time = text_time;
+      timer.text = Text::time_to_string(text_time);
+    }
+
+  timer.enabled = enabled;
+  timer.primary_value = primary_value;
+  timer.primary_max = primary_max;
+  timer.primary_color = primary_color;
+  timer.secondary_value = secondary_value;
+  timer.secondary_max = secondary_max;
+  timer.secondary_color = secondary_color;
+  timer.version++;
+
+  return true;
+}
+
+
+//! Rebuilds the tooltip.
+void
+TimerViewModel::update_tooltip()
+{
+  const char *labels[] = { _("Micro-break"), _("Rest break"), _("Daily limit") };
+  string tip = "";
+
+  switch (operation_mode)
+    {
+    case OPERATION_MODE_SUSPENDED:
+      tip = string(_("Mode: ")) +   _("Suspended");
+      break;
+
+    case OPERATION_MODE_QUIET:
+      tip = string(_("Mode: ")) +   _("Quiet");
+      break;
+
+    case OPERATION_MODE_NORMAL:
+    default:
+#if !defined(PLATFORM_OS_WIN32)
+      // Win32 tip is limited in length
+      tip = "Workrave";
+#endif
+      break;
+    }
+
+  for (int count = 0; count < BREAK_ID_SIZEOF; count++)
+    {
+      const Timer &timer = timers[count];
+
+      if (timer.enabled)
+        {
+          if (tip != "")
+            {
+              tip += "\n";
+            }
+
+          tip += labels[count];
+          tip += ": " + timer.text;
+        }
+    }
+
+  if (tip != tooltip || tooltip_version == 0)
+    {
+      tooltip = tip;
+      tooltip_version++;
+    }
+}
+
+
+void
+TimerViewModel::add_listener(ITimerViewModelListener *listener)
+{
+  listeners.push_back(listener);
+}
+
+
+void
+TimerViewModel::remove_listener(ITimerViewModelListener *listener)
+{
+  listeners.remove(listener);
+}
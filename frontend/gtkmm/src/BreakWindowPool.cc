@@ -0,0 +1,320 @@
+// BreakWindowPool.cc --- Pool of pre-created break and prelude windows
+//
+// Copyright (C) 2017 Rob Caelers & Raymond Penners
+// All rights reserved.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "preinclude.h"
+#include "debug.hh"
+
+#include <gtkmm.h>
+
+#include "BreakWindowPool.hh"
+
+#include "IBreakResponse.hh"
+#include "IBreakWindow.hh"
+#include "DailyLimitWindow.hh"
+#include "MicroBreakWindow.hh"
+#include "PreludeWindow.hh"
+#include "RestBreakWindow.hh"
+
+
+BreakWindowPool::BreakWindowPool()
+  : warm_break_id(BREAK_ID_NONE),
+    warm_break_flags(BreakWindow::BREAK_FLAGS_NONE),
+    warm_block_mode(GUIConfig::BLOCK_MODE_NONE),
+    warm_response(NULL)
+{
+}
+
+
+BreakWindowPool::~BreakWindowPool()
+{
+  theme_connection.disconnect();
+  flush();
+}
+
+
+//! Updates the head configuration.
+/*!
+ *  Pooled windows are sized and positioned for a specific head, so they
+ *  are discarded when a head is added, removed or changes geometry.
+ */
+void
+BreakWindowPool::set_heads(HeadInfo *new_heads, int num_heads)
+{
+  TRACE_ENTER_MSG("BreakWindowPool::set_heads", num_heads);
+
+  if (!theme_connection.connected())
+    {
+      Glib::RefPtr<Gtk::Settings> settings = Gtk::Settings::get_default();
+      if (settings)
+        {
+          theme_connection = settings->property_gtk_theme_name().signal_changed()
+            .connect(sigc::mem_fun(*this, &BreakWindowPool::on_theme_changed));
+        }
+    }
+
+  bool changed = (num_heads != (int)heads.size());
+  for (int i = 0; !changed && i < num_heads; i++)
+    {
+      const HeadInfo &head = heads[i];
+      const HeadInfo &new_head = new_heads[i];
+
+      changed = (head.valid != new_head.valid ||
+                 head.screen != new_head.screen ||
+                 head.monitor != new_head.monitor ||
+                 head.geometry.get_x() != new_head.geometry.get_x() ||
+                 head.geometry.get_y() != new_head.geometry.get_y() ||
+                 head.geometry.get_width() != new_head.geometry.get_width() ||
+                 head.geometry.get_height() != new_head.geometry.get_height());
+    }
+
+  if (changed)
+    {
+      TRACE_MSG("Head configuration changed");
+      flush();
+      heads.assign(new_heads, new_heads + num_heads);
+    }
+
+  TRACE_EXIT();
+}
+
+
+//! Destroys all pooled windows.
+void
+BreakWindowPool::flush()
+{
+  TRACE_ENTER("BreakWindowPool::flush");
+
+  for (int id = 0; id < BREAK_ID_SIZEOF; id++)
+    {
+      for (size_t i = 0; i < prelude_windows[id].size(); i++)
+        {
+          if (prelude_windows[id][i] != NULL)
+            {
+              prelude_windows[id][i]->destroy();
+            }
+        }
+      prelude_windows[id].clear();
+    }
+
+  flush_break_windows();
+
+  TRACE_EXIT();
+}
+
+
+//! Returns a hidden prelude window for the specified head and break.
+PreludeWindow *
+BreakWindowPool::acquire_prelude_window(int head, BreakId break_id)
+{
+  std::vector<PreludeWindow *> &windows = prelude_windows[break_id];
+
+  PreludeWindow *ret = NULL;
+  if (head < (int)windows.size() && windows[head] != NULL)
+    {
+      ret = windows[head];
+      windows[head] = NULL;
+    }
+  else
+    {
+      ret = new PreludeWindow(heads[head], break_id);
+    }
+
+  return ret;
+}
+
+
+//! Returns a stopped prelude window to the pool.
+void
+BreakWindowPool::release_prelude_window(int head, BreakId break_id, PreludeWindow *window)
+{
+  std::vector<PreludeWindow *> &windows = prelude_windows[break_id];
+
+  if (head >= (int)heads.size())
+    {
+      window->destroy();
+      return;
+    }
+
+  if ((int)windows.size() < (int)heads.size())
+    {
+      windows.resize(heads.size(), NULL);
+    }
+
+  if (windows[head] != NULL)
+    {
+      windows[head]->destroy();
+    }
+  windows[head] = window;
+}
+
+
+//! Prepares the break windows for an upcoming break.
+/*!
+ *  The windows are created from the main loop when it is idle, one head at
+ *  a time, so that the prelude window remains responsive.
+ */
+void
+BreakWindowPool::prepare_break_windows(BreakId break_id, BreakWindow::BreakFlags break_flags,
+                                       IBreakResponse *response)
+{
+  TRACE_ENTER_MSG("BreakWindowPool::prepare_break_windows", break_id << " " << break_flags);
+
+  GUIConfig::BlockMode block_mode = GUIConfig::get_block_mode();
+
+  if (break_id != warm_break_id || break_flags != warm_break_flags ||
+      block_mode != warm_block_mode || response != warm_response)
+    {
+      flush_break_windows();
+
+      warm_break_id = break_id;
+      warm_break_flags = break_flags;
+      warm_block_mode = block_mode;
+      warm_response = response;
+    }
+
+  break_windows.resize(heads.size(), NULL);
+
+  if (!prepare_connection.connected())
+    {
+      prepare_connection = Glib::signal_idle()
+        .connect(sigc::mem_fun(*this, &BreakWindowPool::on_prepare_break_windows), Glib::PRIORITY_LOW);
+    }
+
+  TRACE_EXIT();
+}
+
+
+//! Returns an initialized, hidden break window for the specified head and break.
+IBreakWindow *
+BreakWindowPool::acquire_break_window(int head, BreakId break_id, BreakWindow::BreakFlags break_flags,
+                                      IBreakResponse *response)
+{
+  TRACE_ENTER_MSG("BreakWindowPool::acquire_break_window", head << " " << break_id);
+
+  // The break is starting, windows that are still missing are created now.
+  prepare_connection.disconnect();
+
+  GUIConfig::BlockMode block_mode = GUIConfig::get_block_mode();
+
+  if (break_id != warm_break_id || break_flags != warm_break_flags ||
+      block_mode != warm_block_mode || response != warm_response)
+    {
+      flush_break_windows();
+    }
+
+  IBreakWindow *ret = NULL;
+  if (head < (int)break_windows.size() && break_windows[head] != NULL)
+    {
+      TRACE_MSG("Using pre-created window");
+      ret = break_windows[head];
+      break_windows[head] = NULL;
+    }
+  else
+    {
+      ret = create_break_window(heads[head], break_id, break_flags, block_mode, response);
+    }
+
+  TRACE_EXIT();
+  return ret;
+}
+
+
+//! Creates and initializes a break window.
+IBreakWindow *
+BreakWindowPool::create_break_window(HeadInfo &head, BreakId break_id, BreakWindow::BreakFlags break_flags,
+                                     GUIConfig::BlockMode block_mode, IBreakResponse *response)
+{
+  IBreakWindow *ret = NULL;
+  if (break_id == BREAK_ID_MICRO_BREAK)
+    {
+      ret = new MicroBreakWindow(head, break_flags, block_mode);
+    }
+  else if (break_id == BREAK_ID_REST_BREAK)
+    {
+      ret = new RestBreakWindow(head, break_flags, block_mode);
+    }
+  else if (break_id == BREAK_ID_DAILY_LIMIT)
+    {
+      ret = new DailyLimitWindow(head, break_flags, block_mode);
+    }
+
+  if (ret != NULL)
+    {
+      ret->set_response(response);
+      ret->init();
+    }
+
+  return ret;
+}
+
+
+//! Destroys all pre-created break windows.
+void
+BreakWindowPool::flush_break_windows()
+{
+  prepare_connection.disconnect();
+
+  for (size_t i = 0; i < break_windows.size(); i++)
+    {
+      if (break_windows[i] != NULL)
+        {
+          break_windows[i]->destroy();
+        }
+    }
+  break_windows.clear();
+
+  warm_break_id = BREAK_ID_NONE;
+}
+
+
+//! Creates the next missing break window. Runs when the main loop is idle.
+bool
+BreakWindowPool::on_prepare_break_windows()
+{
+  TRACE_ENTER("BreakWindowPool::on_prepare_break_windows");
+
+  for (size_t i = 0; i < break_windows.size(); i++)
+    {
+      if (break_windows[i] == NULL)
+        {
+          TRACE_MSG("Creating window for head " << i);
+          break_windows[i] = create_break_window(heads[i], warm_break_id, warm_break_flags,
+                                                 warm_block_mode, warm_response);
+          bool more = (break_windows[i] != NULL);
+          TRACE_RETURN(more);
+          return more;
+        }
+    }
+
+  TRACE_EXIT();
+  return false;
+}
+
+
+void
+BreakWindowPool::on_theme_changed()
+{
+  TRACE_ENTER("BreakWindowPool::on_theme_changed");
+  flush();
+  TRACE_EXIT();
+}
@@ -0,0 +1,120 @@
+// BreakWindowPool.hh --- Pool of pre-created break and prelude windows
+//
+// Copyright (C) 2017 Rob Caelers & Raymond Penners
+// All rights reserved.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef BREAKWINDOWPOOL_HH
+#define BREAKWINDOWPOOL_HH
+
+#include "preinclude.h"
+
+#include <vector>
+
+#include <sigc++/trackable.h>
+#include <glibmm.h>
+
+#include "ICore.hh"
+#include "HeadInfo.hh"
+#include "BreakWindow.hh"
+#include "GUIConfig.hh"
+
+namespace workrave
+{
+  class IBreakResponse;
+}
+
+class IBreakWindow;
+class PreludeWindow;
+
+//! Keeps break and prelude windows ready for instant presentation.
+/*!
+ *  Constructing a break window (widgets, exercises, pixbufs) is expensive
+ *  and used to happen at the moment the break started. The pool keeps
+ *  hidden prelude windows around for reuse, and builds the break windows
+ *  in the background as soon as a prelude starts, so that the break itself
+ *  only needs to show them.
+ *
+ *  Prelude windows are recycled. Break windows are used once, because
+ *  their exercises and panels keep state; the pool only creates them ahead
+ *  of time.
+ *
+ *  All pooled windows are discarded when the head configuration or the
+ *  GTK theme changes.
+ */
+class BreakWindowPool : public sigc::trackable
+{
+public:
+  BreakWindowPool();
+  virtual ~BreakWindowPool();
+
+  //! Updates the head configuration. Flushes the pool if it changed.
+  void set_heads(HeadInfo *heads, int num_heads);
+
+  //! Destroys all pooled windows.
+  void flush();
+
+  //! Returns a prelude window for the specified head and break.
+  PreludeWindow *acquire_prelude_window(int head, BreakId break_id);
+
+  //! Returns a prelude window to the pool.
+  void release_prelude_window(int head, BreakId break_id, PreludeWindow *window);
+
+  //! Prepares break windows in the background for an upcoming break.
+  void prepare_break_windows(BreakId break_id, BreakWindow::BreakFlags break_flags,
+                             IBreakResponse *response);
+
+  //! Returns an initialized break window for the specified head and break.
+  IBreakWindow *acquire_break_window(int head, BreakId break_id, BreakWindow::BreakFlags break_flags,
+                                     IBreakResponse *response);
+
+private:
+  IBreakWindow *create_break_window(HeadInfo &head, BreakId break_id, BreakWindow::BreakFlags break_flags,
+                                    GUIConfig::BlockMode block_mode, IBreakResponse *response);
+  void flush_break_windows();
+  bool on_prepare_break_windows();
+  void on_theme_changed();
+
+private:
+  //! Head configuration for which the windows are pooled.
+  std::vector<HeadInfo> heads;
+
+  //! Idle prelude windows, per break and per head.
+  std::vector<PreludeWindow *> prelude_windows[BREAK_ID_SIZEOF];
+
+  //! Pre-created break windows, one per head.
+  std::vector<IBreakWindow *> break_windows;
+
+  //! Break for which the break windows are created.
+  BreakId warm_break_id;
+
+  //! Flags with which the break windows are created.
+  BreakWindow::BreakFlags warm_break_flags;
+
+  //! Block mode with which the break windows are created.
+  GUIConfig::BlockMode warm_block_mode;
+
+  //! Response interface of the pre-created break windows.
+  IBreakResponse *warm_response;
+
+  //! Pending background creation of break windows.
+  sigc::connection prepare_connection;
+
+  //! Theme change notification.
+  sigc::connection theme_connection;
+};
+
+#endif // BREAKWINDOWPOOL_HH
@@ -55,6 +55,7 @@
 #include "AppletControl.hh"
 #include "AppletWindow.hh"
 #include "BreakWindow.hh"
+#include "BreakWindowPool.hh"
 #include "DailyLimitWindow.hh"
 #include "GUIConfig.hh"
 #include "MainWindow.hh"
@@ -70,6 +71,7 @@
 #include "WindowHints.hh"
 #include "Locale.hh"
 #include "Session.hh"
+#include "StartupTimeline.hh"
 #include "TimerBoxControl.hh"
 
 #if defined(PLATFORM_OS_WIN32)
@@ -120,12 +122,15 @@ GUI *GUI::instance = NULL;
 GUI::GUI(int argc, char **argv) :
   core(NULL),
   sound_player(NULL),
+  sound_player_initialized(false),
   break_windows(NULL),
   prelude_windows(NULL),
+  window_pool(NULL),
   active_break_count(0),
   active_prelude_count(0),
   response(NULL),
   active_break_id(BREAK_ID_NONE),
+  prelude_break_id(BREAK_ID_NONE),
   main_window(NULL),
   menus(0),
   break_window_destroy(false),
@@ -151,6 +156,8 @@ GUI::GUI(int argc, char **argv) :
   this->argc = argc;
   this->argv = argv;
 
+  window_pool = new BreakWindowPool();
+
   TRACE_EXIT();
 }
 
@@ -165,12 +172,15 @@ GUI::~GUI()
 
   ungrab();
 
+  TimerViewModel::get_instance()->remove_listener(this);
+
   delete core;
   delete main_window;
 
   delete applet_control;
   delete menus;
 
+  delete window_pool;
   delete [] prelude_windows;
   delete [] break_windows;
   delete [] heads;
@@ -195,6 +205,9 @@ GUI::main()
 {
   TRACE_ENTER("GUI::main");
 
+  StartupTimeline *timeline = StartupTimeline::get_instance();
+  timeline->start();
+
   Glib::OptionContext option_ctx;
 
 #ifdef PLATFORM_OS_UNIX
@@ -207,6 +220,14 @@ GUI::main()
   Glib::OptionGroup *option_group = new Glib::OptionGroup(egg_sm_client_get_option_group());
   option_ctx.add_group(*option_group);
 
+  bool core_thread = false;
+  Glib::OptionGroup *main_group = new Glib::OptionGroup("workrave", "Workrave");
+  Glib::OptionEntry core_thread_entry;
+  core_thread_entry.set_long_name("core-thread");
+  core_thread_entry.set_description("Run the timers on their own thread");
+  main_group->add_entry(core_thread_entry, core_thread);
+  option_ctx.set_main_group(*main_group);
+
   Gtk::Main *kit = NULL;
   try
     {
@@ -217,16 +238,25 @@ GUI::main()
       std::cout << "Failed to initialize: " << e.what() << std::endl;
       exit(1);
     }
-  
+  timeline->mark("gtk");
+
+  if (core_thread)
+    {
+      CoreFactory::enable_core_thread();
+    }
   init_core();
+  timeline->mark("core");
   init_nls();
   init_debug();
-  init_sound_player();
   init_multihead();
+  timeline->mark("multihead");
   init_dbus();
+  timeline->mark("dbus");
   init_platform();
   init_session();
+  timeline->mark("session");
   init_gui();
+  timeline->mark("gui");
   init_startup_warnings();
 
 #ifdef HAVE_GTK_MAC_INTEGRATION
@@ -236,11 +266,16 @@ GUI::main()
 #endif
 
   on_timer();
+  timeline->mark("heartbeat");
+
+  // The sound player is initialized on first use, or once the GUI is up.
+  Glib::signal_idle().connect(sigc::mem_fun(*this, &GUI::on_startup_idle), Glib::PRIORITY_LOW);
 
   TRACE_MSG("Initialized. Entering event loop.");
 
   // Enter the event loop
   Gtk::Main::run();
+  CoreFactory::stop_core_thread();
   System::clear();
   cleanup_session();
   for (list<sigc::connection>::iterator i = event_connections.begin(); i != event_connections.end(); i++)
@@ -274,6 +309,7 @@ GUI::terminate()
   CoreFactory::get_configurator()->save();
 
   collect_garbage();
+  window_pool->flush();
 
   Gtk::Main::quit();
   TRACE_EXIT();
@@ -321,14 +357,12 @@ GUI::on_main_window_closed()
 bool
 GUI::on_timer()
 {
-  std::string tip = get_timers_tooltip();
-
   core->heartbeat();
+  TimerViewModel::get_instance()->update();
+
   main_window->update();
 
   applet_control->heartbeat();
-  applet_control->set_tooltip(tip);
-  status_icon->set_tooltip(tip);
 
   heartbeat_signal();
 
@@ -340,7 +374,10 @@ GUI::on_timer()
 
       if (user_active)
         {
-          sound_player->restore_mute();
+          if (sound_player != NULL)
+            {
+              sound_player->restore_mute();
+            }
           muted = false;
         }
     }
@@ -567,6 +604,7 @@ GUI::init_multihead()
     }
 
   init_multihead_desktop();
+  window_pool->set_heads(heads, num_heads);
   TRACE_EXIT();
 }
 
@@ -801,6 +839,8 @@ GUI::init_gui()
   event_connections.push_back(status_icon->signal_visibility_changed().connect(sigc::mem_fun(*this, &GUI::on_visibility_changed)));
 
   process_visibility();
+
+  TimerViewModel::get_instance()->add_listener(this);
   
 #ifdef HAVE_DBUS
   DBus *dbus = CoreFactory::get_dbus();
@@ -884,34 +924,18 @@ GUI::init_startup_warnings()
 }
 
 
-//! Returns a break window for the specified break.
-IBreakWindow *
-GUI::create_break_window(HeadInfo &head, BreakId break_id, BreakWindow::BreakFlags break_flags)
-{
-  IBreakWindow *ret = NULL;
-  GUIConfig::BlockMode block_mode = GUIConfig::get_block_mode();
-  if (break_id == BREAK_ID_MICRO_BREAK)
-    {
-      ret = new MicroBreakWindow(head, break_flags, block_mode);
-    }
-  else if (break_id == BREAK_ID_REST_BREAK)
-    {
-      ret = new RestBreakWindow(head, break_flags, block_mode);
-    }
-  else if (break_id == BREAK_ID_DAILY_LIMIT)
-    {
-      ret = new DailyLimitWindow(head, break_flags, block_mode);
-    }
-
-  return ret;
-}
-
-
 //! Initializes the sound player.
 void
 GUI::init_sound_player()
 {
   TRACE_ENTER("GUI:init_sound_player");
+  if (sound_player_initialized)
+    {
+      TRACE_EXIT();
+      return;
+    }
+  sound_player_initialized = true;
+
   try
     {
       // Tell pulseaudio were are playing sound events
@@ -928,15 +952,42 @@ GUI::init_sound_player()
 }
 
 
+//! Returns the sound player, initializing it on first use.
+SoundPlayer *
+GUI::get_sound_player()
+{
+  init_sound_player();
+  return sound_player;
+}
+
+
+//! Completes startup once the event loop is idle.
+/*!
+ *  At this point the status icon and applets are shown. Subsystems that
+ *  are not needed to show them are initialized here.
+ */
+bool
+GUI::on_startup_idle()
+{
+  StartupTimeline *timeline = StartupTimeline::get_instance();
+  timeline->mark("first-idle");
+  timeline->finish();
+
+  init_sound_player();
+  return false;
+}
+
+
 void
 GUI::core_event_notify(const CoreEvent event)
 {
   TRACE_ENTER_MSG("GUI::core_event_sound_notify", event);
 
-  if (sound_player != NULL)
+  if (event >= CORE_EVENT_SOUND_FIRST &&
+      event <= CORE_EVENT_SOUND_LAST)
     {
-      if (event >= CORE_EVENT_SOUND_FIRST &&
-          event <= CORE_EVENT_SOUND_LAST)
+      init_sound_player();
+      if (sound_player != NULL)
         {
           bool mute = false;
           SoundEvent snd = (SoundEvent) ( (int)event - CORE_EVENT_SOUND_FIRST);
@@ -992,6 +1043,19 @@ GUI::core_event_usage_mode_changed(const UsageMode m)
   menus->resync();
 }
 
+void
+GUI::core_event_user_timer_limit_reached(const std::string &name)
+{
+  TRACE_ENTER_MSG("GUI::core_event_user_timer_limit_reached", name);
+  if (status_icon)
+    {
+      gchar *msg = g_strdup_printf(_("The timer \"%s\" has reached its limit."), name.c_str());
+      status_icon->show_balloon("user_timer", msg);
+      g_free(msg);
+    }
+  TRACE_EXIT();
+}
+
 void
 GUI::config_changed_notify(const std::string &key)
 {
@@ -1022,16 +1086,20 @@ void
 GUI::create_prelude_window(BreakId break_id)
 {
   hide_break_window();
-  init_multihead();
   collect_garbage();
+  init_multihead();
 
   active_break_id = break_id;
+  prelude_break_id = break_id;
   for (int i = 0; i < num_heads; i++)
     {
-      prelude_windows[i] = new PreludeWindow(heads[i], break_id);
+      prelude_windows[i] = window_pool->acquire_prelude_window(i, break_id);
     }
 
   active_prelude_count = num_heads;
+
+  // Most preludes are followed by the break itself, prepare its windows now.
+  window_pool->prepare_break_windows(break_id, get_break_flags(break_id, BREAK_HINT_NONE), response);
 }
 
 
@@ -1040,9 +1108,28 @@ GUI::create_break_window(BreakId break_id, BreakHint break_hint)
 {
   TRACE_ENTER_MSG("GUI::start_break_window", num_heads);
   hide_break_window();
-  init_multihead();
   collect_garbage();
+  init_multihead();
+
+  BreakWindow::BreakFlags break_flags = get_break_flags(break_id, break_hint);
+
+  active_break_id = break_id;
+
+  for (int i = 0; i < num_heads; i++)
+    {
+      break_windows[i] = window_pool->acquire_break_window(i, break_id, break_flags, response);
+    }
 
+  active_break_count = num_heads;
+
+  TRACE_EXIT();
+}
+
+
+//! Returns the window flags for the specified break.
+BreakWindow::BreakFlags
+GUI::get_break_flags(BreakId break_id, BreakHint break_hint)
+{
   BreakWindow::BreakFlags break_flags = BreakWindow::BREAK_FLAGS_NONE;
   bool ignorable = GUIConfig::get_ignorable(break_id);
   bool skippable = GUIConfig::get_skippable(break_id);
@@ -1076,21 +1163,7 @@ GUI::create_break_window(BreakId break_id, BreakHint break_hint)
                        BreakWindow::BREAK_FLAGS_POSTPONABLE);
     }
 
-  active_break_id = break_id;
-
-  for (int i = 0; i < num_heads; i++)
-    {
-      IBreakWindow *break_window = create_break_window(heads[i], break_id, break_flags);
-
-      break_windows[i] = break_window;
-
-      break_window->set_response(response);
-      break_window->init();
-    }
-
-  active_break_count = num_heads;
-
-  TRACE_EXIT();
+  return break_flags;
 }
 
 void
@@ -1238,7 +1311,7 @@ GUI::collect_garbage()
             {
               if (prelude_windows[i] != NULL)
                 {
-                  prelude_windows[i]->destroy();
+                  window_pool->release_prelude_window(i, prelude_break_id, prelude_windows[i]);
                   prelude_windows[i] = NULL;
                 }
             }
@@ -1502,66 +1575,31 @@ GUI::bound_head(int &x, int &y, int width, int height, int &head)
 }
 
 
-std::string
-GUI::get_timers_tooltip()
+//! Shows the timer summary in the tooltips of the status icon and applets.
+void
+GUI::update_tooltip()
 {
-  //FIXME: duplicate
-  const char *labels[] = { _("Micro-break"), _("Rest break"), _("Daily limit") };
-  string tip = "";
+  std::string tip = TimerViewModel::get_instance()->get_tooltip();
 
-  OperationMode mode = core->get_operation_mode();
-  switch (mode)
+  if (applet_control != NULL)
     {
-    case OPERATION_MODE_SUSPENDED:
-      tip = string(_("Mode: ")) +   _("Suspended");
-      break;
-
-    case OPERATION_MODE_QUIET:
-      tip = string(_("Mode: ")) +   _("Quiet");
-      break;
-
-    case OPERATION_MODE_NORMAL:
-    default:
-#if !defined(PLATFORM_OS_WIN32)
-      // Win32 tip is limited in length
-      tip = "Workrave";
-#endif
-      break;
+      applet_control->set_tooltip(tip);
     }
-
-  for (int count = 0; count < BREAK_ID_SIZEOF; count++)
+  if (status_icon != NULL)
     {
-      IBreak *b = core->get_break(BreakId(count));
-      bool on = b->is_enabled();
-
-      if (b != NULL && on)
-        {
-          // Collect some data.
-          time_t maxActiveTime = b->get_limit();
-          time_t activeTime = b->get_elapsed_time();
-          std::string text;
-
-          // Set the text
-          if (b->is_limit_enabled() && maxActiveTime != 0)
-            {
-              text = Text::time_to_string(maxActiveTime - activeTime);
-            }
-          else
-            {
-              text = Text::time_to_string(activeTime);
-            }
+      status_icon->set_tooltip(tip);
+    }
+}
 
-          if (tip != "")
-            {
-              tip += "\n";
-            }
 
-          tip += labels[count];
-          tip += ": " + text;
-        }
+//! The timer view model changed.
+void
+GUI::timer_view_changed(int changes)
+{
+  if (changes & TimerViewModel::CHANGE_TOOLTIP)
+    {
+      update_tooltip();
     }
-
-  return tip;
 }
 
 void
@@ -1584,6 +1622,7 @@ GUI::on_visibility_changed()
 {
   TRACE_ENTER("GUI::on_visibility_changed");
   process_visibility();
+  update_tooltip();
   TRACE_EXIT();
 }
 
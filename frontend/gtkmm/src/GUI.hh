@@ -33,6 +33,7 @@
 #include "BreakWindow.hh"
 #include "WindowHints.hh"
 #include "IDBusWatch.hh"
+#include "TimerViewModel.hh"
 
 namespace workrave {
   class IBreakResponse;
@@ -44,6 +45,7 @@ class MainWindow;
 class MicroBreakWindow;
 class RestBreakWindow;
 class PreludeWindow;
+class BreakWindowPool;
 class Dispatcher;
 class StatusIcon;
 class AppletControl;
@@ -66,7 +68,7 @@ public:
 
   virtual Menus *get_menus() const = 0;
   virtual MainWindow *get_main_window() const = 0;
-  virtual SoundPlayer *get_sound_player() const = 0;
+  virtual SoundPlayer *get_sound_player() = 0;
 
   virtual void open_main_window() = 0;
   virtual void restbreak_now() = 0;
@@ -87,6 +89,7 @@ class GUI :
   public ICoreEventListener,
   public IConfiguratorListener,
   public IDBusWatch,
+  public ITimerViewModelListener,
   public sigc::trackable
 {
 public:
@@ -97,7 +100,7 @@ public:
 
   AppletControl *get_applet_control() const;
   MainWindow *get_main_window() const;
-  SoundPlayer *get_sound_player() const;
+  SoundPlayer *get_sound_player();
   Menus *get_menus() const;
 
   void main();
@@ -118,6 +121,7 @@ public:
   void core_event_notify(const CoreEvent event);
   void core_event_operation_mode_changed(const OperationMode m);
   void core_event_usage_mode_changed(const UsageMode m);
+  void core_event_user_timer_limit_reached(const std::string &name);
 
   virtual void bus_name_presence(const std::string &name, bool present);
   
@@ -138,13 +142,15 @@ public:
   void interrupt_grab();
 
 private:
-  std::string get_timers_tooltip();
+  void update_tooltip();
+  void timer_view_changed(int changes);
   bool on_timer();
   void init_platform();
   void init_debug();
   void init_nls();
   void init_core();
   void init_sound_player();
+  bool on_startup_idle();
   void init_multihead_mem(int new_num_heads);
   void init_multihead_desktop();
   void init_gui();
@@ -159,7 +165,7 @@ private:
   void cleanup_session();
 
   void collect_garbage();
-  IBreakWindow *create_break_window(HeadInfo &head, BreakId break_id, BreakWindow::BreakFlags break_flags);
+  BreakWindow::BreakFlags get_break_flags(BreakId break_id, BreakHint break_hint);
   void config_changed_notify(const std::string &key);
 
   bool grab();
@@ -193,12 +199,18 @@ private:
   //! The sound player
   SoundPlayer *sound_player;
 
+  //! Has the sound player been initialized?
+  bool sound_player_initialized;
+
   //! Interface to the break window.
   IBreakWindow **break_windows;
 
   //! Interface to the prelude windows.
   PreludeWindow **prelude_windows;
 
+  //! Pool of pre-created break and prelude windows.
+  BreakWindowPool *window_pool;
+
   //! Number of active prelude windows;
   int active_break_count;
 
@@ -211,6 +223,9 @@ private:
   //! Current active break.
   BreakId active_break_id;
 
+  //! Break of the current prelude windows.
+  BreakId prelude_break_id;
+
   //! The number of command line arguments.
   int argc;
 
@@ -299,13 +314,6 @@ GUI::get_main_window() const
 }
 
 
-//! Returns the sound player
-inline SoundPlayer *
-GUI::get_sound_player() const
-{
-  return sound_player;
-}
-
 //! Returns the sound player
 inline Menus *
 GUI::get_menus() const
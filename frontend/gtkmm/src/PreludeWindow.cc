@@ -186,10 +186,7 @@ PreludeWindow::PreludeWindow(HeadInfo &head, BreakId break_id)
 PreludeWindow::~PreludeWindow()
 {
 #ifdef PLATFORM_OS_WIN32
-  if (avoid_signal.connected())
-    {
-      avoid_signal.disconnect();
-    }
+  stop_avoid_pointer();
 #endif
 }
 
@@ -213,9 +210,15 @@ PreludeWindow::start()
 
   refresh();
 
+  // The window may be reused, undo a previous pointer avoidance.
+  did_avoid = false;
   GtkUtil::center_window(*this, head);
   show_all();
 
+#ifdef PLATFORM_OS_WIN32
+  start_avoid_pointer();
+#endif
+
   WindowHints::set_always_on_top(this, true);
 
   time_bar->set_bar_color(TimeBar::COLOR_ID_OVERDUE);
@@ -258,6 +261,11 @@ PreludeWindow::stop()
 {
   TRACE_ENTER("PreludeWindow::stop");
 
+#ifdef PLATFORM_OS_WIN32
+  // Pooled windows stay around while hidden; they must not poll the pointer.
+  stop_avoid_pointer();
+#endif
+
   frame->set_frame_flashing(0);
 #ifdef HAVE_GTK3
   hide();
@@ -392,7 +400,36 @@ void
 PreludeWindow::init_avoid_pointer()
 {
   TRACE_ENTER("PreludeWindow::init_avoid_pointer");
+#ifndef PLATFORM_OS_WIN32
+  if (
+#ifdef HAVE_GTK3
+      ! get_realized()
+#else
+      ! is_realized()
+#endif
+     )
+    {
+      Gdk::EventMask events;
+
+      events = Gdk::ENTER_NOTIFY_MASK;
+      add_events(events);
+    }
+#endif
+  did_avoid = false;
+  TRACE_EXIT();
+}
+
 #ifdef PLATFORM_OS_WIN32
+
+//! Starts polling the pointer while the window is shown.
+/*!
+ *  The offset between the Windows and GDK coordinates is computed each time,
+ *  as the screen configuration may have changed since the last prelude.
+ */
+void
+PreludeWindow::start_avoid_pointer()
+{
+  TRACE_ENTER("PreludeWindow::start_avoid_pointer");
   if (! avoid_signal.connected())
     {
       POINT p;
@@ -423,26 +460,21 @@ PreludeWindow::init_avoid_pointer()
         .connect(sigc::mem_fun(*this, &PreludeWindow::on_avoid_pointer_timer),
                  150);
     }
-#else
-  if (
-#ifdef HAVE_GTK3
-      ! get_realized()
-#else
-      ! is_realized()
-#endif
-     )
-    {
-      Gdk::EventMask events;
+  TRACE_EXIT();
+}
 
-      events = Gdk::ENTER_NOTIFY_MASK;
-      add_events(events);
+
+//! Stops polling the pointer.
+void
+PreludeWindow::stop_avoid_pointer()
+{
+  if (avoid_signal.connected())
+    {
+      avoid_signal.disconnect();
     }
-#endif
-  did_avoid = false;
-  TRACE_EXIT();
 }
 
-#ifndef PLATFORM_OS_WIN32
+#else
 
 //! GDK EventNotifyEvent notification.
 bool
@@ -54,6 +54,8 @@ private:
   void add(Gtk::Widget& widget);
 
 #ifdef PLATFORM_OS_WIN32
+  void start_avoid_pointer();
+  void stop_avoid_pointer();
   bool on_avoid_pointer_timer();
 #else
   bool on_enter_notify_event(GdkEventCrossing* event);
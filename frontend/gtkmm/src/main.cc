@@ -28,6 +28,8 @@
 #include <stdio.h>
 
 #include "GUI.hh"
+#include "PolicyCompiler.hh"
+#include "StatisticsExporter.hh"
 #ifdef PLATFORM_OS_WIN32
 #include <io.h>
 #include <fcntl.h>
@@ -59,6 +61,16 @@ run(int argc, char **argv)
   Debug::init();
 #endif
 
+  int exit_code = 0;
+  if (StatisticsExporter::run_command_line(argc, argv, exit_code))
+    {
+      return exit_code;
+    }
+  if (PolicyCompiler::run_command_line(argc, argv, exit_code))
+    {
+      return exit_code;
+    }
+
   GUI *gui = new GUI(argc, argv);
 
 #if defined(PLATFORM_OS_WIN32)
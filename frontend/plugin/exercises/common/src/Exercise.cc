@@ -346,14 +346,21 @@ Exercise::get_exercises_file_name()
 }
 
 
+//! Returns all exercises. The exercises are parsed on first use.
 std::list<Exercise>
 Exercise::get_exercises()
 {
-  std::list<Exercise> exercises;
-  std::string file_name = get_exercises_file_name();
-  if (file_name.length () > 0)
+  static std::list<Exercise> exercises;
+  static bool parsed = false;
+
+  if (!parsed)
     {
-      parse_exercises(file_name.c_str(), exercises);
+      std::string file_name = get_exercises_file_name();
+      if (file_name.length () > 0)
+        {
+          parse_exercises(file_name.c_str(), exercises);
+        }
+      parsed = true;
     }
   return exercises;
 }
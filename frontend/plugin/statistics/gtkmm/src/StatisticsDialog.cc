@@ -41,9 +41,6 @@
 #include <sstream>
 #include <stdio.h>
 
-#include <ctime>
-#include <cstring>
-
 #include <gtkmm.h>
 
 #include "debug.hh"
@@ -509,91 +506,52 @@ StatisticsDialog::display_week_statistics()
   guint y, m, d;
   calendar->get_date(y, m, d);
 
-  std::tm timeinfo;
-  std::memset(&timeinfo, 0, sizeof(timeinfo));
-  timeinfo.tm_mday = d;
-  timeinfo.tm_mon = m;
-  timeinfo.tm_year = y - 1900;
-
-  std::time_t t = std::mktime(&timeinfo);
-  std::tm const *time_loc = std::localtime(&t);
+  Glib::Date date(d, Glib::Date::Month(m + 1), y);
+  int offset = (date.get_weekday() % 7 - Locale::get_week_start() + 7) % 7;
 
-  int offset = (time_loc->tm_wday - Locale::get_week_start() + 7) % 7;
-  int64_t total_week = 0;
-  for (int i = 0; i < 7; i++)
-    {
-      std::memset(&timeinfo, 0, sizeof(timeinfo));
-      timeinfo.tm_mday = d - offset + i;
-      timeinfo.tm_mon = m;
-      timeinfo.tm_year = y - 1900;
-      t = std::mktime(&timeinfo);
-      time_loc = std::localtime(&t);
-
-      int idx, next, prev;
-      statistics->get_day_index_by_date(time_loc->tm_year + 1900,
-                                        time_loc->tm_mon + 1,
-                                        time_loc->tm_mday, idx, next, prev);
-
-      if (idx >= 0)
-        {
-          IStatistics::DailyStats *stats = statistics->get_day(idx);
-          if (stats != NULL)
-            {
-              total_week += stats->misc_stats[IStatistics::STATS_VALUE_TOTAL_ACTIVE_TIME];
-            }
-
-          update_usage_real_time |= (idx == 0);
-        }
-    }
+  Glib::Date first = date;
+  first.subtract_days(offset);
+  Glib::Date last = first;
+  last.add_days(6);
 
-  weekly_usage_time_label->set_text(total_week > 0 ? Text::time_to_string(total_week) : "");
+  display_usage_statistics(weekly_usage_time_label, first, last);
 }
 
 void
-StatisticsDialog::display_month_statistics() {
+StatisticsDialog::display_month_statistics()
+{
   guint y, m, d;
   calendar->get_date(y, m, d);
 
-  guint max_mday;
-  if (m == 3 || m == 5 || m == 8 || m == 10)
-    {
-      max_mday = 30;
-    }
-  else if (m == 1)
-    {
-      bool is_leap = (y % 4 == 0 && y % 100 != 0) || (y % 400 == 0);
-      if (is_leap)
-        {
-          max_mday = 29;
-        }
-      else
-        {
-          max_mday = 28;
-        }
-    }
-  else
-    {
-      max_mday = 31;
-    }
+  Glib::Date::Month month = Glib::Date::Month(m + 1);
+  Glib::Date first(1, month, y);
+  Glib::Date last(Glib::Date::get_days_in_month(month, y), month, y);
 
-  int64_t total_month = 0;
-  for (guint i = 1; i <= max_mday; i++)
-    {
-      int idx, next, prev;
-      statistics->get_day_index_by_date(y, m + 1, i, idx, next, prev);
-      if (idx >= 0)
-        {
-          IStatistics::DailyStats *stats = statistics->get_day(idx);
-          if (stats != NULL)
-            {
-              total_month += stats->misc_stats[IStatistics::STATS_VALUE_TOTAL_ACTIVE_TIME];
-            }
+  display_usage_statistics(monthly_usage_time_label, first, last);
+}
 
-          update_usage_real_time |= (idx == 0);
-        }
-    }
+//! Shows the total active time from first to last (inclusive).
+void
+StatisticsDialog::display_usage_statistics(Gtk::Label *label, const Glib::Date &first, const Glib::Date &last)
+{
+  struct tm first_tm;
+  struct tm last_tm;
+  first.to_struct_tm(first_tm);
+  last.to_struct_tm(last_tm);
+
+  int64_t total = statistics->get_value_aggregate(IStatistics::STATS_VALUE_TOTAL_ACTIVE_TIME,
+                                                  IStatistics::AGGREGATE_SUM,
+                                                  first_tm, last_tm);
+
+  label->set_text(total > 0 ? Text::time_to_string(total) : "");
 
-  monthly_usage_time_label->set_text(total_month > 0 ? Text::time_to_string(total_month) : "");
+  IStatistics::DailyStats today;
+  if (statistics->get_current_day(today) && today.start.tm_year != 0)
+    {
+      Glib::Date date(today.start.tm_mday, Glib::Date::Month(today.start.tm_mon + 1),
+                      today.start.tm_year + 1900);
+      update_usage_real_time |= (date >= first && date <= last);
+    }
 }
 
 void
@@ -644,9 +602,12 @@ StatisticsDialog::get_calendar_day_index(int &idx, int &next, int &prev)
 void
 StatisticsDialog::set_calendar_day_index(int idx)
 {
-  IStatistics::DailyStats *stats = statistics->get_day(idx);
-  calendar->select_month(stats->start.tm_mon, stats->start.tm_year+1900);
-  calendar->select_day(stats->start.tm_mday);
+  IStatistics::DailyStats stats;
+  if (statistics->get_day(idx, stats))
+    {
+      calendar->select_month(stats.start.tm_mon, stats.start.tm_year+1900);
+      calendar->select_day(stats.start.tm_mday);
+    }
   display_calendar_date();
 }
 
@@ -655,11 +616,11 @@ StatisticsDialog::display_calendar_date()
 {
   int idx, next, prev;
   get_calendar_day_index(idx, next, prev);
-  IStatistics::DailyStats *stats = NULL;
   if (idx >= 0)
     {
-      stats = statistics->get_day(idx);
-      display_statistics(stats);
+      IStatistics::DailyStats stats;
+      bool found = statistics->get_day(idx, stats);
+      display_statistics(found ? &stats : NULL);
     }
   else
     {
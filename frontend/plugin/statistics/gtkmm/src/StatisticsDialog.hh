@@ -35,6 +35,11 @@ namespace Gtk
   class Widget;
 }
 
+namespace Glib
+{
+  class Date;
+}
+
 using namespace workrave;
 
 class StatisticsDialog : public HigDialog
@@ -114,6 +119,7 @@ private:
   void clear_display_statistics();
   void display_week_statistics();
   void display_month_statistics();
+  void display_usage_statistics(Gtk::Label *label, const Glib::Date &first, const Glib::Date &last);
   bool on_timer();
 };
 
@@ -26,12 +26,15 @@
 #include "nls.h"
 
 #include <math.h>
+#include <iostream>
 
 #include "BreakWindow.hh"
 #include "IBreakResponse.hh"
 #include "System.hh"
 #include "Util.hh"
 
+using namespace std;
+
 //! Constructor
 BreakWindow::BreakWindow(BreakId break_id, bool ignorable, GUI::BlockMode mode) :
   block_mode(mode),
@@ -39,14 +39,20 @@
 #include "BreakWindow.hh"
 #include "IBreakWindow.hh"
 #include "MainWindow.hh"
+#include "TimerViewModel.hh"
+#include "StartupTimeline.hh"
 
 #include "CoreFactory.hh"
 #include "ICore.hh"
+#include "ICoreHost.hh"
 #include "IConfigurator.hh"
+#include "IStatistics.hh"
 
 #include "System.hh"
 #include "IBreakResponse.hh"
+#ifndef HAVE_APP_HEADLESS
 #include "SoundPlayer.hh"
+#endif
 
 #include "Util.hh"
 
@@ -56,9 +62,16 @@
 
 #include <glib-object.h>
 
+#if defined(PLATFORM_OS_UNIX) && GLIB_CHECK_VERSION(2, 30, 0)
+#include <glib-unix.h>
+#include <signal.h>
+#define HAVE_TERMINATE_SIGNAL 1
+#endif
+
 GUI *GUI::instance = NULL;
 
 const string GUI::CFG_KEY_GUI_BLOCK_MODE =  "gui/breaks/block_mode";
+const string GUI::CFG_KEY_BREAK_IGNORABLE = "gui/breaks/%b/ignorable_break";
 
 
 //! GUI Constructor.
@@ -69,6 +82,7 @@ const string GUI::CFG_KEY_GUI_BLOCK_MODE =  "gui/breaks/block_mode";
 GUI::GUI(int argc, char **argv)  :
   configurator(NULL),
   core(NULL),
+  host(NULL),
   sound_player(NULL),
   break_window(NULL),
   prelude_window(NULL),
@@ -108,7 +122,7 @@ GUI::~GUI()
 void
 GUI::restbreak_now()
 {
-  core->force_break(BREAK_ID_REST_BREAK, true);
+  core->force_break(BREAK_ID_REST_BREAK, BREAK_HINT_USER_INITIATED);
 }
 
 
@@ -121,6 +135,25 @@ GUI::static_on_timer(gpointer data)
 }
 
 
+gboolean
+GUI::static_on_host_timer(gpointer data)
+{
+  GUI *gui = (GUI*) data;
+  gui->host->heartbeat();
+  return true;
+}
+
+
+//! Terminates on SIGTERM or SIGINT.
+gboolean
+GUI::static_on_terminate_signal(gpointer data)
+{
+  GUI *gui = (GUI*) data;
+  gui->terminate();
+  return false;
+}
+
+
 //! The main entry point.
 void
 GUI::main()
@@ -132,22 +165,39 @@ GUI::main()
   __try1(exception_handler);
 #endif
 
+  if (is_host_mode())
+    {
+      main_host();
+      TRACE_EXIT();
+      return;
+    }
+
+  StartupTimeline *timeline = StartupTimeline::get_instance();
+  timeline->start();
+
   g_type_init();
 
   init_debug();
   init_core();
+  timeline->mark("core");
   init_sound_player();
+  init_signals();
 
   #ifdef PLATFORM_OS_WIN32
   System::init();
 #else
   System::init(NULL);
 #endif
+  timeline->mark("system");
 
 
   // The main status window.
   main_window = new MainWindow();
 
+  on_timer();
+  timeline->mark("heartbeat");
+  timeline->finish();
+
   main_loop = g_main_loop_new(NULL, FALSE);
 
   const char *env = getenv("WORKRAVE_TEST");
@@ -172,12 +222,84 @@ GUI::main()
 }
 
 
+//! Returns whether the daemon runs the sessions of a terminal server (--host).
+bool
+GUI::is_host_mode() const
+{
+  for (int i = 1; i < argc; i++)
+    {
+      if (strcmp(argv[i], "--host") == 0)
+        {
+          return true;
+        }
+    }
+  return false;
+}
+
+
+//! Runs the sessions of a terminal server in this process.
+/*!
+ *  Sessions are given as --session=NAME:HOME, and can be added and removed
+ *  over the D-BUS. All sessions share one heartbeat.
+ */
+void
+GUI::main_host()
+{
+  TRACE_ENTER("GUI::main_host");
+
+  g_type_init();
+
+  init_debug();
+  init_signals();
+
+  host = CoreFactory::get_core_host();
+  host->init(argc, argv);
+
+  const string session_opt = "--session=";
+  for (int i = 1; i < argc; i++)
+    {
+      string arg = argv[i];
+      if (arg.compare(0, session_opt.length(), session_opt) == 0)
+        {
+          string value = arg.substr(session_opt.length());
+          string::size_type pos = value.find(':');
+          if (pos == string::npos || !host->add_session(value.substr(0, pos), value.substr(pos + 1)))
+            {
+              g_warning("Invalid session: %s", value.c_str());
+            }
+        }
+    }
+
+  main_loop = g_main_loop_new(NULL, FALSE);
+  g_timeout_add(1000, static_on_host_timer, this);
+
+  g_main_loop_run(main_loop);
+  g_main_loop_unref(main_loop);
+
+  host->shutdown();
+
+  TRACE_EXIT();
+}
+
+
 //! Terminates the GUI.
 void
 GUI::terminate()
 {
   TRACE_ENTER("GUI::terminate");
 
+  if (host != NULL)
+    {
+      // The sessions are saved when the main loop returns.
+      g_main_loop_quit(main_loop);
+      TRACE_EXIT();
+      return;
+    }
+
+  if (core != NULL)
+    {
+      core->get_statistics()->update();
+    }
   CoreFactory::get_configurator()->save();
 
   collect_garbage();
@@ -195,6 +317,7 @@ GUI::on_timer()
   if (core != NULL)
     {
       core->heartbeat();
+      TimerViewModel::get_instance()->update();
     }
 
   if (main_window != NULL)
@@ -275,7 +398,20 @@ GUI::init_core()
 void
 GUI::init_sound_player()
 {
+#ifndef HAVE_APP_HEADLESS
   sound_player = new SoundPlayer();
+#endif
+}
+
+
+//! Terminates cleanly when stopped by the session or service manager.
+void
+GUI::init_signals()
+{
+#ifdef HAVE_TERMINATE_SIGNAL
+  g_unix_signal_add(SIGTERM, static_on_terminate_signal, this);
+  g_unix_signal_add(SIGINT, static_on_terminate_signal, this);
+#endif
 }
 
 
@@ -283,6 +419,9 @@ void
 GUI::core_event_notify(CoreEvent event)
 {
   TRACE_ENTER_MSG("GUI::core_event_notify", event)
+#ifdef HAVE_APP_HEADLESS
+  (void) event;
+#else
   // FIXME: HACK
   SoundEvent snd = (SoundEvent) event;
   if (sound_player != NULL)
@@ -290,6 +429,7 @@ GUI::core_event_notify(CoreEvent event)
       TRACE_MSG("play");
       sound_player->play_sound(snd);
     }
+#endif
   TRACE_EXIT();
 }
 
@@ -300,15 +440,28 @@ GUI::core_event_operation_mode_changed(const OperationMode m)
   (void) m;
 }
 
+
+void
+GUI::core_event_usage_mode_changed(const UsageMode m)
+{
+  (void) m;
+}
+
+
+void
+GUI::core_event_user_timer_limit_reached(const std::string &name)
+{
+  TRACE_ENTER_MSG("GUI::core_event_user_timer_limit_reached", name);
+  (void) name;
+  TRACE_EXIT();
+}
+
 //! Returns a break window for the specified break.
 IBreakWindow *
-GUI::new_break_window(BreakId break_id, bool user_initiated)
+GUI::new_break_window(BreakId break_id, bool ignorable)
 {
   IBreakWindow *ret = NULL;
   BlockMode block_mode = get_block_mode();
-  bool ignorable = true;
-
-  (void) user_initiated;
 
   if (break_id == BREAK_ID_MICRO_BREAK)
     {
@@ -357,6 +510,9 @@ GUI::create_break_window(BreakId break_id, BreakHint break_hint)
 
   active_break_id = break_id;
 
+  // Breaks started by the user can always be postponed.
+  bool ignorable = (break_hint & BREAK_HINT_USER_INITIATED) != 0 || get_ignorable(break_id);
+
   break_window = new_break_window(break_id, ignorable);
   break_window->set_response(response);
 
@@ -511,3 +667,14 @@ GUI::set_block_mode(BlockMode mode)
 }
 
 
+//! Returns whether the specified break may be postponed.
+bool
+GUI::get_ignorable(BreakId break_id)
+{
+  bool ignorable;
+  CoreFactory::get_configurator()
+    ->get_value_with_default(CFG_KEY_BREAK_IGNORABLE % break_id, ignorable, true);
+  return ignorable;
+}
+
+
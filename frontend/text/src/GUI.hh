@@ -39,6 +39,7 @@ namespace workrave
 {
   // Core interfaces
   class IConfigurator;
+  class ICoreHost;
 }
 
 class GUI :
@@ -69,27 +70,36 @@ public:
   //
   void core_event_notify(CoreEvent event);
   void core_event_operation_mode_changed(const OperationMode m);
+  void core_event_usage_mode_changed(const UsageMode m);
+  void core_event_user_timer_limit_reached(const std::string &name);
 
   SoundPlayer *get_sound_player() const;
 
   static gboolean static_on_timer(gpointer data);
+  static gboolean static_on_host_timer(gpointer data);
+  static gboolean static_on_terminate_signal(gpointer data);
 
   enum BlockMode { BLOCK_MODE_NONE = 0, BLOCK_MODE_INPUT, BLOCK_MODE_ALL };
 
 private:
   bool on_timer();
+  bool is_host_mode() const;
+  void main_host();
   void init_gui();
   void init_debug();
   void init_nls();
   void init_core();
   void init_sound_player();
+  void init_signals();
 
   void collect_garbage();
   IBreakWindow *new_break_window(BreakId break_id, bool ignorable);
 
   // Prefs
   static const std::string CFG_KEY_GUI_BLOCK_MODE;
+  static const std::string CFG_KEY_BREAK_IGNORABLE;
   BlockMode get_block_mode();
+  bool get_ignorable(BreakId break_id);
   void set_block_mode(BlockMode mode);
 
 private:
@@ -104,6 +114,9 @@ private:
   //! The Core controller
   ICore *core;
 
+  //! Runs the cores of all sessions in host mode.
+  ICoreHost *host;
+
   //! The sound player
   SoundPlayer *sound_player;
 
@@ -25,6 +25,7 @@
 
 #include "debug.hh"
 #include "nls.h"
+#include <iostream>
 
 #include "Text.hh"
 #include "Util.hh"
@@ -35,6 +36,8 @@
 #include "IBreakResponse.hh"
 #include "PreludeWindow.hh"
 
+using namespace std;
+
 //! Construct a new Microbreak window.
 PreludeWindow::PreludeWindow(BreakId break_id)
   : break_id(break_id),
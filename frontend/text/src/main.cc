@@ -27,6 +27,8 @@
 #include <fstream>
 
 #include "GUI.hh"
+#include "PolicyCompiler.hh"
+#include "StatisticsExporter.hh"
 #ifdef PLATFORM_OS_WIN32
 #endif
 
@@ -35,6 +37,16 @@ extern "C" int run(int argc, char **argv);
 int
 run(int argc, char **argv)
 {
+  int exit_code = 0;
+  if (StatisticsExporter::run_command_line(argc, argv, exit_code))
+    {
+      return exit_code;
+    }
+  if (PolicyCompiler::run_command_line(argc, argv, exit_code))
+    {
+      return exit_code;
+    }
+
   GUI *gui = new GUI(argc, argv);
 
 #ifdef PLATFORM_OS_WIN32